@@ -0,0 +1,203 @@
+// ============================================================
+//  CaptureDXGI.cpp  –  DXGI Desktop Duplication capture source
+//  Zero-Latency Network Video Fuser
+// ============================================================
+
+#include "CaptureDXGI.h"
+#include "FrameOps.h"
+
+DxgiCaptureSource::~DxgiCaptureSource()
+{
+    Release();
+}
+
+void DxgiCaptureSource::Release()
+{
+    if (m_duplication)  { m_duplication->ReleaseFrame(); m_duplication->Release();  m_duplication  = nullptr; }
+    if (m_stagingTex)   { m_stagingTex->Release();   m_stagingTex   = nullptr; }
+    if (m_dxgiOutput1)  { m_dxgiOutput1->Release();  m_dxgiOutput1  = nullptr; }
+    if (m_d3dContext)   { m_d3dContext->Release();   m_d3dContext   = nullptr; }
+    if (m_d3dDevice)    { m_d3dDevice->Release();    m_d3dDevice    = nullptr; }
+}
+
+bool DxgiCaptureSource::Init()
+{
+    // Create D3D11 device on the default adapter
+    D3D_FEATURE_LEVEL featureLevel;
+    UINT createFlags = 0;
+#ifdef _DEBUG
+    createFlags |= D3D11_CREATE_DEVICE_DEBUG;
+#endif
+
+    HRESULT hr = D3D11CreateDevice(
+        nullptr,
+        D3D_DRIVER_TYPE_HARDWARE,
+        nullptr,
+        createFlags,
+        nullptr, 0,
+        D3D11_SDK_VERSION,
+        &m_d3dDevice,
+        &featureLevel,
+        &m_d3dContext
+    );
+    if (FAILED(hr))
+    {
+        FuserUtil::Log("[Capture] D3D11CreateDevice failed: 0x%08X\n", hr);
+        return false;
+    }
+
+    // Walk the DXGI adapter/output chain to find the requested monitor
+    IDXGIDevice*  dxgiDevice  = nullptr;
+    IDXGIAdapter* dxgiAdapter = nullptr;
+    m_d3dDevice->QueryInterface(__uuidof(IDXGIDevice),
+                                reinterpret_cast<void**>(&dxgiDevice));
+    dxgiDevice->GetParent(__uuidof(IDXGIAdapter),
+                          reinterpret_cast<void**>(&dxgiAdapter));
+    dxgiDevice->Release();
+
+    IDXGIOutput* output = nullptr;
+    int target = m_monitor;
+    for (int i = 0; ; ++i)
+    {
+        IDXGIOutput* candidate = nullptr;
+        if (dxgiAdapter->EnumOutputs(i, &candidate) == DXGI_ERROR_NOT_FOUND)
+            break;
+        if (i == target)
+        {
+            output = candidate;
+            break;
+        }
+        candidate->Release();
+    }
+    dxgiAdapter->Release();
+
+    if (!output)
+    {
+        FuserUtil::Log("[Capture] Monitor index %d not found.\n", target);
+        return false;
+    }
+
+    hr = output->QueryInterface(__uuidof(IDXGIOutput1),
+                                reinterpret_cast<void**>(&m_dxgiOutput1));
+    output->Release();
+    if (FAILED(hr))
+    {
+        FuserUtil::Log("[Capture] QueryInterface IDXGIOutput1 failed: 0x%08X\n", hr);
+        return false;
+    }
+
+    hr = m_dxgiOutput1->DuplicateOutput(m_d3dDevice, &m_duplication);
+    if (FAILED(hr))
+    {
+        FuserUtil::Log("[Capture] DuplicateOutput failed: 0x%08X\n", hr);
+        return false;
+    }
+
+    DXGI_OUTDUPL_DESC duplDesc{};
+    m_duplication->GetDesc(&duplDesc);
+    m_captureW = duplDesc.ModeDesc.Width;
+    m_captureH = duplDesc.ModeDesc.Height;
+
+    FuserUtil::Log("[Capture] Capture surface: %u x %u\n", m_captureW, m_captureH);
+
+    // Pre-create a CPU-accessible staging texture sized to the desktop
+    D3D11_TEXTURE2D_DESC stagingDesc{};
+    stagingDesc.Width              = m_captureW;
+    stagingDesc.Height             = m_captureH;
+    stagingDesc.MipLevels          = 1;
+    stagingDesc.ArraySize          = 1;
+    stagingDesc.Format             = DXGI_FORMAT_B8G8R8A8_UNORM;  // BGRA
+    stagingDesc.SampleDesc.Count   = 1;
+    stagingDesc.Usage              = D3D11_USAGE_STAGING;
+    stagingDesc.CPUAccessFlags     = D3D11_CPU_ACCESS_READ;
+    stagingDesc.BindFlags          = 0;
+
+    hr = m_d3dDevice->CreateTexture2D(&stagingDesc, nullptr, &m_stagingTex);
+    if (FAILED(hr))
+    {
+        FuserUtil::Log("[Capture] CreateTexture2D (staging) failed: 0x%08X\n", hr);
+        return false;
+    }
+
+    return true;
+}
+
+CaptureStatus DxgiCaptureSource::Capture(uint8_t* dst, uint32_t waitMs, CaptureRowSink* rows)
+{
+    if (!m_duplication)
+    {
+        // Previous recovery attempt failed – keep trying
+        if (FAILED(m_dxgiOutput1->DuplicateOutput(m_d3dDevice, &m_duplication)))
+            return CaptureStatus::Failed;
+    }
+
+    IDXGIResource*           deskRes    = nullptr;
+    DXGI_OUTDUPL_FRAME_INFO  frameInfo  = {};
+
+    // Blocks until the desktop presents (or only the pointer moves)
+    HRESULT hr = m_duplication->AcquireNextFrame(waitMs, &frameInfo, &deskRes);
+    if (hr == DXGI_ERROR_WAIT_TIMEOUT)
+        return CaptureStatus::Timeout;
+    if (FAILED(hr))
+    {
+        LOG_EVERY_SEC(LogLevel::Warn, 2, "[Capture] AcquireNextFrame failed: 0x%08X – reinitialising\n", hr);
+        // Attempt duplication recovery (monitor mode change, etc.)
+        m_duplication->Release();
+        m_duplication = nullptr;
+        HRESULT hr2 = m_dxgiOutput1->DuplicateOutput(m_d3dDevice, &m_duplication);
+        if (FAILED(hr2))
+            LOG_EVERY_SEC(LogLevel::Error, 2, "[Capture] DuplicateOutput recovery failed: 0x%08X\n", hr2);
+        return CaptureStatus::Failed;
+    }
+
+    // Pointer-only update: the desktop image is what we had – skip
+    // the GPU → CPU copy altogether
+    if (frameInfo.AccumulatedFrames == 0 || frameInfo.LastPresentTime.QuadPart == 0)
+    {
+        deskRes->Release();
+        m_duplication->ReleaseFrame();
+        return CaptureStatus::Unchanged;
+    }
+
+    // Get the desktop texture
+    ID3D11Texture2D* desktopTex = nullptr;
+    hr = deskRes->QueryInterface(__uuidof(ID3D11Texture2D),
+                                 reinterpret_cast<void**>(&desktopTex));
+    deskRes->Release();
+    if (FAILED(hr))
+    {
+        m_duplication->ReleaseFrame();
+        return CaptureStatus::Failed;
+    }
+
+    // Copy GPU → CPU-accessible staging texture
+    m_d3dContext->CopyResource(m_stagingTex, desktopTex);
+    desktopTex->Release();
+
+    D3D11_MAPPED_SUBRESOURCE mapped{};
+    hr = m_d3dContext->Map(m_stagingTex, 0, D3D11_MAP_READ, 0, &mapped);
+    if (FAILED(hr))
+    {
+        m_duplication->ReleaseFrame();
+        return CaptureStatus::Failed;
+    }
+
+    // Copy with stride correction (GPU pitch may be wider than width*4),
+    // a chunk of rows at a time so the sender can start on the top
+    const uint32_t destStride = m_captureW * 4;
+    const uint8_t* src        = reinterpret_cast<const uint8_t*>(mapped.pData);
+    if (rows) rows->Begin();
+    for (uint32_t y = 0; y < m_captureH; y += CAPTURE_ROW_CHUNK)
+    {
+        const uint32_t n = std::min(CAPTURE_ROW_CHUNK, m_captureH - y);
+        FrameOps::CopyRows(dst + static_cast<size_t>(y) * destStride, destStride,
+                           src + static_cast<size_t>(y) * mapped.RowPitch, mapped.RowPitch,
+                           destStride, n);
+        if (rows) rows->Rows(y + n);
+    }
+
+    m_d3dContext->Unmap(m_stagingTex, 0);
+    m_duplication->ReleaseFrame();
+
+    return CaptureStatus::Frame;
+}
@@ -0,0 +1,31 @@
+#pragma once
+// ============================================================
+//  CaptureDXGI.h  –  DXGI Desktop Duplication capture source
+// ============================================================
+#include "NetworkFuser.h"
+#include "CaptureSource.h"
+
+class DxgiCaptureSource : public ICaptureSource
+{
+public:
+    explicit DxgiCaptureSource(int monitorIndex) : m_monitor(monitorIndex) {}
+    ~DxgiCaptureSource() override;
+
+    bool          Init() override;
+    CaptureStatus Capture(uint8_t* dst, uint32_t waitMs, CaptureRowSink* rows) override;
+    uint32_t      Width()  const override { return m_captureW; }
+    uint32_t      Height() const override { return m_captureH; }
+    const char*   Name()   const override { return "dxgi"; }
+
+private:
+    void Release();
+
+    int                     m_monitor;
+    ID3D11Device*           m_d3dDevice   = nullptr;
+    ID3D11DeviceContext*    m_d3dContext  = nullptr;
+    IDXGIOutput1*           m_dxgiOutput1 = nullptr;
+    IDXGIOutputDuplication* m_duplication = nullptr;
+    ID3D11Texture2D*        m_stagingTex  = nullptr;
+    uint32_t                m_captureW    = 0;
+    uint32_t                m_captureH    = 0;
+};
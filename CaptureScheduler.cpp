@@ -0,0 +1,57 @@
+// ============================================================
+//  CaptureScheduler.cpp  –  Rate cap, unchanged-frame skipping
+//  and keepalive
+//  Zero-Latency Network Video Fuser
+// ============================================================
+
+#include "CaptureScheduler.h"
+#include <algorithm>
+
+uint64_t CaptureScheduler::NextCaptureUs(uint64_t lastCaptureUs, uint64_t minIntervalUs) const
+{
+    const uint64_t cap      = m_p.maxFps ? 1000000ull / m_p.maxFps : 0;
+    const uint64_t interval = std::max(cap, minIntervalUs);
+    return (interval == 0 || lastCaptureUs == 0) ? 0 : lastCaptureUs + interval;
+}
+
+uint32_t CaptureScheduler::WaitMs(uint64_t nowUs) const
+{
+    if (m_p.keepaliveMs == 0 || !m_sentAny)
+        return MAX_WAIT_MS;
+    const uint64_t due = m_lastSendUs + m_p.keepaliveMs * 1000ull;
+    if (nowUs >= due)
+        return 1;
+    return static_cast<uint32_t>(std::clamp<uint64_t>((due - nowUs + 999) / 1000, 1, MAX_WAIT_MS));
+}
+
+bool CaptureScheduler::KeepaliveDue(uint64_t nowUs) const
+{
+    return m_sentAny && m_p.keepaliveMs != 0 && nowUs - m_lastSendUs >= m_p.keepaliveMs * 1000ull;
+}
+
+SendReason CaptureScheduler::Decide(FrameChange change, uint64_t nowUs) const
+{
+    switch (change)
+    {
+    case FrameChange::New:
+        return SendReason::Changed;
+    case FrameChange::Empty:
+        if (!m_sentAny || !m_sentEmpty)
+            return SendReason::Changed;
+        break;
+    case FrameChange::Same:
+        if (!m_p.skipUnchanged)
+            return SendReason::Changed;
+        break;
+    case FrameChange::None:
+        break;
+    }
+    return KeepaliveDue(nowUs) ? SendReason::Keepalive : SendReason::Skip;
+}
+
+void CaptureScheduler::OnSent(bool empty, uint64_t nowUs)
+{
+    m_lastSendUs = nowUs;
+    m_sentAny    = true;
+    m_sentEmpty  = empty;
+}
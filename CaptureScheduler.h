@@ -0,0 +1,79 @@
+#pragma once
+// ============================================================
+//  CaptureScheduler.h  –  When the sender captures, and which
+//  captures it actually sends
+//
+//    rate cap   no two captures – so no two sends – closer than
+//               1/maxFps (or the loss pacer's interval, whichever
+//               is longer)
+//    unchanged  a capture identical to the last one sent – or
+//               one the source says nothing was presented for –
+//               is not sent again …
+//    keepalive  … until keepaliveMs has passed, then the last
+//               frame goes out once more so a receiver that
+//               joined late or lost it catches up
+//    empty      a fully transparent capture is sent once as an
+//               empty frame (0×0), so receivers clear the
+//               overlay instead of showing stale content, and
+//               then only at the keepalive rate
+//
+//  The capture stage blocks in the source (DXGI waits for the
+//  next present); the encode stage, which owns the decisions,
+//  waits for a capture at most WaitMs, so an idle desktop costs a
+//  wake-up per keepalive instead of a spin. NextCaptureUs only
+//  reads the parameters and may be called from the capture stage.
+//  Portable – no Windows headers.
+// ============================================================
+#include <cstdint>
+
+struct CaptureScheduleParams
+{
+    uint32_t maxFps        = 0;      // 0 = as fast as frames change
+    uint32_t keepaliveMs   = 1000;   // 0 = never resend an unchanged frame
+    bool     skipUnchanged = true;   // false = send every capture (old behaviour)
+};
+
+// What a capture attempt produced
+enum class FrameChange
+{
+    None,    // no frame (timeout, source error)
+    Same,    // identical to the frame last sent
+    New,     // different content or geometry
+    Empty,   // nothing visible
+};
+
+enum class SendReason
+{
+    Skip,
+    Changed,
+    Keepalive,   // resend of the last frame (content or empty)
+};
+
+class CaptureScheduler
+{
+public:
+    static constexpr uint32_t MAX_WAIT_MS = 100;   // bounds how long Stop() waits on a capture
+
+    explicit CaptureScheduler(const CaptureScheduleParams& p) : m_p(p) {}
+
+    // Earliest time the next capture may start: the rate cap or
+    // `minIntervalUs` (loss pacing), whichever is longer, after
+    // the last capture; 0 = now
+    uint64_t   NextCaptureUs(uint64_t lastCaptureUs, uint64_t minIntervalUs) const;
+
+    // How long to wait for a new capture before a keepalive is due
+    uint32_t   WaitMs(uint64_t nowUs) const;
+
+    SendReason Decide(FrameChange change, uint64_t nowUs) const;
+    void       OnSent(bool empty, uint64_t nowUs);
+
+    const CaptureScheduleParams& Params() const { return m_p; }
+
+private:
+    bool KeepaliveDue(uint64_t nowUs) const;
+
+    CaptureScheduleParams m_p;
+    uint64_t              m_lastSendUs = 0;
+    bool                  m_sentAny    = false;
+    bool                  m_sentEmpty  = false;
+};
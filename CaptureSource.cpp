@@ -0,0 +1,228 @@
+// ============================================================
+//  CaptureSource.cpp  –  Synthetic + memory-mapped file sources
+//  Zero-Latency Network Video Fuser
+// ============================================================
+
+#include "CaptureSource.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <thread>
+
+namespace
+{
+    uint64_t SteadyUs()
+    {
+        return static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    // Small stateless hash – every frame is a pure function of its index
+    inline uint32_t Mix(uint32_t x)
+    {
+        x ^= x >> 16; x *= 0x7FEB352Du;
+        x ^= x >> 15; x *= 0x846CA68Bu;
+        x ^= x >> 16;
+        return x;
+    }
+
+    // Position bouncing between 0 and `range` (triangle wave)
+    inline uint32_t Bounce(uint64_t t, uint32_t range)
+    {
+        if (range == 0) return 0;
+        const uint64_t period = static_cast<uint64_t>(range) * 2;
+        const uint64_t p      = t % period;
+        return static_cast<uint32_t>(p <= range ? p : period - p);
+    }
+
+    // BGRA as a little-endian word: 0xAARRGGBB
+    inline void FillRect(uint8_t* dst, uint32_t stride, uint32_t x, uint32_t y,
+                         uint32_t w, uint32_t h, uint32_t bgra)
+    {
+        for (uint32_t row = 0; row < h; ++row)
+        {
+            uint32_t* p = reinterpret_cast<uint32_t*>(dst + (y + row) * static_cast<size_t>(stride)) + x;
+            std::fill(p, p + w, bgra);
+        }
+    }
+
+    // 3x5 digit glyphs, one row per nibble (bit 2 = left column)
+    constexpr uint8_t DIGITS[10][5] = {
+        { 7, 5, 5, 5, 7 }, { 2, 6, 2, 2, 7 }, { 7, 1, 7, 4, 7 }, { 7, 1, 7, 1, 7 },
+        { 5, 5, 7, 1, 1 }, { 7, 4, 7, 1, 7 }, { 7, 4, 7, 5, 7 }, { 7, 1, 1, 1, 1 },
+        { 7, 5, 7, 5, 7 }, { 7, 5, 7, 1, 7 },
+    };
+    constexpr uint32_t GLYPH_SCALE   = 2;
+    constexpr uint32_t GLYPH_ADVANCE = 4 * GLYPH_SCALE;
+    constexpr uint32_t GLYPH_HEIGHT  = 5 * GLYPH_SCALE;
+
+    void DrawNumber(uint8_t* dst, uint32_t stride, uint32_t surfW, uint32_t surfH,
+                    uint32_t x, uint32_t y, uint32_t value, uint32_t bgra)
+    {
+        char digits[12];
+        int  n = 0;
+        do { digits[n++] = static_cast<char>(value % 10); value /= 10; } while (value && n < 12);
+
+        for (int i = n - 1; i >= 0; --i, x += GLYPH_ADVANCE)
+        {
+            if (x + 3 * GLYPH_SCALE > surfW || y + GLYPH_HEIGHT > surfH)
+                return;
+            const uint8_t* g = DIGITS[static_cast<int>(digits[i])];
+            for (uint32_t gy = 0; gy < 5; ++gy)
+                for (uint32_t gx = 0; gx < 3; ++gx)
+                    if (g[gy] & (4u >> gx))
+                        FillRect(dst, stride, x + gx * GLYPH_SCALE, y + gy * GLYPH_SCALE,
+                                 GLYPH_SCALE, GLYPH_SCALE, bgra);
+        }
+    }
+}
+
+// ─────────────────────────────────────────────────────────────
+//  FramePacer
+// ─────────────────────────────────────────────────────────────
+void FramePacer::Wait()
+{
+    if (m_intervalUs == 0)
+        return;
+
+    uint64_t now = SteadyUs();
+    if (m_nextUs == 0 || now > m_nextUs + m_intervalUs)
+        m_nextUs = now;             // first frame, or fell behind – resync
+
+    // Sleep most of the way, spin the rest
+    while (now < m_nextUs)
+    {
+        const uint64_t left = m_nextUs - now;
+        if (left > 2000)
+            std::this_thread::sleep_for(std::chrono::microseconds(left - 1000));
+        else
+            std::this_thread::yield();
+        now = SteadyUs();
+    }
+    m_nextUs += m_intervalUs;
+}
+
+// ─────────────────────────────────────────────────────────────
+//  SyntheticCaptureSource
+// ─────────────────────────────────────────────────────────────
+bool SyntheticCaptureSource::Init()
+{
+    if (m_p.width == 0 || m_p.height == 0)
+        return false;
+    m_p.fillPercent = std::min<uint32_t>(m_p.fillPercent, 100);
+    m_pacer.SetFps(m_p.fps);
+    m_index = 0;
+    return true;
+}
+
+// Draws shapes over the whole frame – no row order to report
+CaptureStatus SyntheticCaptureSource::Capture(uint8_t* dst, uint32_t /*waitMs*/, CaptureRowSink* /*rows*/)
+{
+    m_pacer.Wait();
+    Render(dst, m_index++);
+    return CaptureStatus::Frame;
+}
+
+void SyntheticCaptureSource::Render(uint8_t* dst, uint64_t index) const
+{
+    const uint32_t W      = m_p.width;
+    const uint32_t H      = m_p.height;
+    const uint32_t stride = W * 4;
+    std::memset(dst, 0, static_cast<size_t>(stride) * H);
+
+    // ── Filled patch: same aspect as the screen, ~fillPercent of it ──
+    if (m_p.fillPercent > 0)
+    {
+        const double   side = std::sqrt(m_p.fillPercent / 100.0);
+        const uint32_t pw   = std::max<uint32_t>(1, static_cast<uint32_t>(W * side));
+        const uint32_t ph   = std::max<uint32_t>(1, static_cast<uint32_t>(H * side));
+        const uint32_t px   = Bounce(index * 3, W - pw);
+        const uint32_t py   = Bounce(index * 2, H - ph);
+        const uint32_t t    = static_cast<uint32_t>(index);
+
+        for (uint32_t row = 0; row < ph; ++row)
+        {
+            uint32_t* p = reinterpret_cast<uint32_t*>(dst + (py + row) * static_cast<size_t>(stride)) + px;
+            for (uint32_t col = 0; col < pw; ++col)
+            {
+                const uint32_t b = (col + t) & 0xFF;
+                const uint32_t g = (row * 2) & 0xFF;
+                const uint32_t r = ((col ^ row) + t) & 0xFF;
+                p[col] = 0xC0000000u | (r << 16) | (g << 8) | b;
+            }
+        }
+    }
+
+    // ── ESP-style outline boxes with optional labels ─────────
+    for (uint32_t i = 0; i < m_p.boxes; ++i)
+    {
+        const uint32_t h0  = Mix(m_p.seed * 0x9E3779B9u + i);
+        const uint32_t h1  = Mix(h0);
+        const uint32_t bw  = 24 + h0 % std::max<uint32_t>(1, W / 8);
+        const uint32_t bh  = 48 + h1 % std::max<uint32_t>(1, H / 5);
+        if (bw + 2 > W || bh + GLYPH_HEIGHT + 4 > H)
+            continue;
+
+        const uint32_t vx  = 1 + (h0 >> 8)  % 7;
+        const uint32_t vy  = 1 + (h1 >> 8)  % 5;
+        const uint32_t bx  = Bounce((h0 >> 12) + index * vx, W - bw);
+        const uint32_t by  = GLYPH_HEIGHT + 2 + Bounce((h1 >> 12) + index * vy, H - bh - GLYPH_HEIGHT - 2);
+        const uint32_t col = 0xFF000000u | (Mix(h1) & 0x00FFFFFFu) | 0x00404040u;
+        const uint32_t th  = 2;
+
+        FillRect(dst, stride, bx,           by,           bw, th, col);
+        FillRect(dst, stride, bx,           by + bh - th, bw, th, col);
+        FillRect(dst, stride, bx,           by,           th, bh, col);
+        FillRect(dst, stride, bx + bw - th, by,           th, bh, col);
+
+        if (m_p.text)
+            DrawNumber(dst, stride, W, H, bx, by - GLYPH_HEIGHT - 2,
+                       static_cast<uint32_t>(index) + i * 37, 0xFFFFFFFFu);
+    }
+}
+
+// ─────────────────────────────────────────────────────────────
+//  MappedFileCaptureSource
+// ─────────────────────────────────────────────────────────────
+bool MappedFileCaptureSource::Init()
+{
+    m_frameBytes = static_cast<uint64_t>(m_p.width) * m_p.height * 4;
+    if (m_frameBytes == 0 || !m_file.OpenRead(m_p.path))
+        return false;
+
+    m_frameCount = m_file.Size() / m_frameBytes;
+    if (m_frameCount == 0)
+    {
+        m_file.Close();
+        return false;
+    }
+    m_pacer.SetFps(m_p.fps);
+    m_index = 0;
+    return true;
+}
+
+CaptureStatus MappedFileCaptureSource::Capture(uint8_t* dst, uint32_t /*waitMs*/, CaptureRowSink* rows)
+{
+    if (!m_file.IsOpen())
+        return CaptureStatus::Failed;
+
+    m_pacer.Wait();
+    const uint8_t* src    = m_file.Data() + (m_index % m_frameCount) * m_frameBytes;
+    const size_t   stride = static_cast<size_t>(m_p.width) * 4;
+    if (!rows)
+        std::memcpy(dst, src, static_cast<size_t>(m_frameBytes));
+    else
+    {
+        rows->Begin();
+        for (uint32_t y = 0; y < m_p.height; y += CAPTURE_ROW_CHUNK)
+        {
+            const uint32_t n = std::min(CAPTURE_ROW_CHUNK, m_p.height - y);
+            std::memcpy(dst + y * stride, src + y * stride, n * stride);
+            rows->Rows(y + n);
+        }
+    }
+    ++m_index;
+    return CaptureStatus::Frame;
+}
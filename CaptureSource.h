@@ -0,0 +1,136 @@
+#pragma once
+// ============================================================
+//  CaptureSource.h  –  Where the sender's BGRA frames come from
+//  DXGI Desktop Duplication lives in CaptureDXGI.h; the two
+//  sources here have no platform dependencies so the sender
+//  pipeline can be driven reproducibly without a desktop.
+// ============================================================
+#include "MappedFile.h"
+#include <cstdint>
+#include <string>
+
+enum class CaptureStatus
+{
+    Frame,     // dst holds a new frame
+    Unchanged, // the source knows nothing was presented since the last frame – dst untouched
+    Timeout,   // nothing new yet – try again
+    Failed,    // source error (may recover on a later call)
+};
+
+// ─── Row progress while a frame is being written ────────────
+// Lets the sender start on the top of a frame while the source is
+// still copying the bottom. A source that fills dst top to bottom
+// calls Begin once it is certain to return Frame, then Rows as the
+// rows land; after Begin it must write every row. Sources that
+// report nothing leave dst complete when Capture returns Frame.
+class CaptureRowSink
+{
+public:
+    virtual void Begin()                 = 0;
+    virtual void Rows(uint32_t rowsDone) = 0;   // rows [0, rowsDone) of dst are final
+
+protected:
+    ~CaptureRowSink() = default;
+};
+
+static constexpr uint32_t CAPTURE_ROW_CHUNK = 64;   // rows copied between Rows() reports
+
+class ICaptureSource
+{
+public:
+    virtual ~ICaptureSource() = default;
+
+    virtual bool          Init() = 0;
+
+    // Write the next frame into dst as tightly packed BGRA
+    // (Width()*4 bytes per row, Height() rows), waiting at most
+    // waitMs for one. Sources that pace themselves ignore waitMs.
+    // `rows` (may be null) hears how far the copy has got.
+    virtual CaptureStatus Capture(uint8_t* dst, uint32_t waitMs, CaptureRowSink* rows) = 0;
+
+    virtual uint32_t      Width()  const = 0;
+    virtual uint32_t      Height() const = 0;
+    virtual const char*   Name()   const = 0;
+};
+
+// ─── Frame pacing shared by the non-DXGI sources ────────────
+class FramePacer
+{
+public:
+    void     SetFps(uint32_t fps)  { m_intervalUs = fps ? 1000000u / fps : 0; }
+
+    // Block until the next frame is due (no-op when unpaced)
+    void     Wait();
+
+private:
+    uint32_t m_intervalUs = 0;
+    uint64_t m_nextUs     = 0;
+};
+
+// ─── Synthetic overlay generator ─────────────────────────────
+// Deterministic per frame index: black background, a filled
+// textured patch covering ~fillPercent of the screen, `boxes`
+// bouncing ESP-style outline boxes and optional digit labels.
+struct SyntheticCaptureParams
+{
+    uint32_t width       = 1920;
+    uint32_t height      = 1080;
+    uint32_t fps         = 144;   // 0 = as fast as possible
+    uint32_t fillPercent = 5;     // 0..100, area of the solid patch
+    uint32_t boxes       = 8;
+    bool     text        = true;
+    uint32_t seed        = 1;
+};
+
+class SyntheticCaptureSource : public ICaptureSource
+{
+public:
+    explicit SyntheticCaptureSource(const SyntheticCaptureParams& p) : m_p(p) {}
+
+    bool          Init() override;
+    CaptureStatus Capture(uint8_t* dst, uint32_t waitMs, CaptureRowSink* rows) override;
+    uint32_t      Width()  const override { return m_p.width; }
+    uint32_t      Height() const override { return m_p.height; }
+    const char*   Name()   const override { return "synthetic"; }
+
+    // Render frame `index` without pacing (harness / benchmarks)
+    void          Render(uint8_t* dst, uint64_t index) const;
+
+private:
+    SyntheticCaptureParams m_p;
+    FramePacer             m_pacer;
+    uint64_t               m_index = 0;
+};
+
+// ─── Raw BGRA frame sequence from a memory-mapped file ──────
+// The file is width*height*4 bytes per frame, back to back, no
+// header. Playback loops at the end of the file.
+struct MappedFileCaptureParams
+{
+    std::string path;
+    uint32_t    width  = 1920;
+    uint32_t    height = 1080;
+    uint32_t    fps    = 144;     // 0 = as fast as possible
+};
+
+class MappedFileCaptureSource : public ICaptureSource
+{
+public:
+    explicit MappedFileCaptureSource(const MappedFileCaptureParams& p) : m_p(p) {}
+
+    bool          Init() override;
+    CaptureStatus Capture(uint8_t* dst, uint32_t waitMs, CaptureRowSink* rows) override;
+    uint32_t      Width()  const override { return m_p.width; }
+    uint32_t      Height() const override { return m_p.height; }
+    const char*   Name()   const override { return "file"; }
+
+    uint64_t      FrameCount() const { return m_frameCount; }
+
+private:
+    MappedFileCaptureParams m_p;
+    MappedFile              m_file;
+    FramePacer              m_pacer;
+    uint64_t                m_frameBytes = 0;
+    uint64_t                m_frameCount = 0;
+    uint64_t                m_index      = 0;
+};
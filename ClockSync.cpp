@@ -0,0 +1,76 @@
+// ============================================================
+//  ClockSync.cpp  –  Min-RTT offset filter + drift estimate
+//  Zero-Latency Network Video Fuser
+// ============================================================
+
+#include "ClockSync.h"
+
+void ClockSyncEstimator::AddSample(uint64_t t1, uint64_t t2, uint64_t t3, uint64_t t4)
+{
+    const int64_t local  = static_cast<int64_t>(t4 - t1);
+    const int64_t remote = static_cast<int64_t>(t3 - t2);
+    if (t4 < t1 || t3 < t2 || remote > local)
+        return;   // impossible timing – discard
+
+    Sample s;
+    s.localUs  = t1 + (t4 - t1) / 2;
+    s.rttUs    = static_cast<uint64_t>(local - remote);
+    s.offsetUs = ((static_cast<int64_t>(t1) - static_cast<int64_t>(t2)) +
+                  (static_cast<int64_t>(t4) - static_cast<int64_t>(t3))) / 2;
+
+    m_window.push_back(s);
+    if (m_window.size() > CLOCK_SYNC_WINDOW)
+        m_window.pop_front();
+    ++m_samples;
+
+    // Smallest error bound wins: rtt/2 + age * PHI (ties → newer sample)
+    double bestBound = 0;
+    for (size_t i = 0; i < m_window.size(); ++i)
+    {
+        const Sample& w     = m_window[i];
+        const double  bound = w.rttUs * 0.5 +
+                              static_cast<double>(s.localUs - w.localUs) * CLOCK_SYNC_PHI_PPM * 1e-6;
+        if (i == 0 || bound <= bestBound)
+        {
+            m_best    = w;
+            bestBound = bound;
+        }
+    }
+
+    UpdateDrift();
+}
+
+void ClockSyncEstimator::UpdateDrift()
+{
+    if (m_driftPoints.empty() ||
+        m_best.localUs >= m_driftPoints.back().localUs + CLOCK_SYNC_DRIFT_STEP_US)
+    {
+        m_driftPoints.push_back(m_best);
+        if (m_driftPoints.size() > CLOCK_SYNC_DRIFT_POINTS)
+            m_driftPoints.pop_front();
+    }
+    if (m_driftPoints.size() < 3)
+        return;
+
+    // Least-squares slope of offset over local time
+    const double x0 = static_cast<double>(m_driftPoints.front().localUs);
+    double sx = 0, sy = 0, sxx = 0, sxy = 0;
+    for (const Sample& p : m_driftPoints)
+    {
+        const double x = static_cast<double>(p.localUs) - x0;
+        const double y = static_cast<double>(p.offsetUs);
+        sx += x; sy += y; sxx += x * x; sxy += x * y;
+    }
+    const double n   = static_cast<double>(m_driftPoints.size());
+    const double den = n * sxx - sx * sx;
+    if (den > 0)
+        m_driftPpm = (n * sxy - sx * sy) / den * 1e6;
+}
+
+int64_t ClockSyncEstimator::OffsetUs(uint64_t localUs) const
+{
+    if (!Valid())
+        return 0;
+    const double dt = static_cast<double>(static_cast<int64_t>(localUs - m_best.localUs));
+    return m_best.offsetUs + static_cast<int64_t>(dt * m_driftPpm * 1e-6);
+}
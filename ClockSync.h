@@ -0,0 +1,74 @@
+#pragma once
+// ============================================================
+//  ClockSync.h  –  NTP-style offset + drift between two hosts
+//  The receiver pings the sender on the discovery port (port+1);
+//  the sender stamps arrival and departure and echoes back:
+//
+//    t1 local send   t2 remote recv   t3 remote send   t4 local recv
+//    rtt    = (t4 − t1) − (t3 − t2)
+//    offset = ((t1 − t2) + (t4 − t3)) / 2        (local − remote)
+//
+//  Queueing only ever adds delay, so the sample with the smallest
+//  RTT in a sliding window is the most trustworthy one. As in NTP,
+//  a sample's error bound is RTT/2 plus dispersion growing with
+//  age at CLOCK_SYNC_PHI_PPM, so a slightly slower fresh sample
+//  beats a fast stale one. Drift is a least-squares slope through
+//  the best-of-window offsets and is applied to the chosen sample.
+//
+//  Portable – no Windows headers.
+// ============================================================
+#include <cstdint>
+#include <cstddef>
+#include <deque>
+
+static constexpr char     CLOCK_SYNC_MAGIC[8]     = { 'K','F','C','L','K','v','1','\0' };
+static constexpr size_t   CLOCK_SYNC_WINDOW       = 32;       // samples for min-RTT filtering
+static constexpr size_t   CLOCK_SYNC_DRIFT_POINTS = 16;       // filtered offsets kept for the slope
+static constexpr uint64_t CLOCK_SYNC_DRIFT_STEP_US = 1000000;  // one drift point per second
+static constexpr double   CLOCK_SYNC_PHI_PPM      = 15.0;     // dispersion growth (NTP's PHI)
+
+// ─── Wire format (same layout for ping and pong) ─────────────
+#pragma pack(push, 1)
+struct ClockSyncPacket
+{
+    char     magic[8];
+    uint32_t seq;
+    uint32_t reserved;
+    uint64_t t1;    // requester send (requester clock)
+    uint64_t t2;    // responder recv (responder clock) – 0 in a ping
+    uint64_t t3;    // responder send (responder clock) – 0 in a ping
+};
+#pragma pack(pop)
+static_assert(sizeof(ClockSyncPacket) == 40, "ClockSyncPacket layout changed");
+
+// ─── Estimator (requester side) ──────────────────────────────
+class ClockSyncEstimator
+{
+public:
+    void     AddSample(uint64_t t1, uint64_t t2, uint64_t t3, uint64_t t4);
+
+    bool     Valid()        const { return !m_window.empty(); }
+
+    // local − remote at local time `localUs`, drift-corrected
+    int64_t  OffsetUs(uint64_t localUs) const;
+
+    double   DriftPpm()     const { return m_driftPpm; }
+    uint64_t BestRttUs()    const { return m_best.rttUs; }
+    uint64_t SampleCount()  const { return m_samples; }
+
+private:
+    struct Sample
+    {
+        uint64_t localUs;   // midpoint of t1..t4
+        int64_t  offsetUs;
+        uint64_t rttUs;
+    };
+
+    void UpdateDrift();
+
+    std::deque<Sample> m_window;           // last CLOCK_SYNC_WINDOW samples
+    std::deque<Sample> m_driftPoints;      // best-of-window every DRIFT_STEP
+    Sample             m_best{};
+    double             m_driftPpm = 0.0;
+    uint64_t           m_samples  = 0;
+};
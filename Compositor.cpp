@@ -0,0 +1,166 @@
+// ============================================================
+//  Compositor.cpp  –  Damage tracking + CPU backend
+//  Zero-Latency Network Video Fuser
+// ============================================================
+
+#include "Compositor.h"
+#include "FrameScale.h"
+#include <algorithm>
+#include <cstring>
+
+// ─── a − b as up to four non-overlapping rectangles ─────────
+void Compositor::Subtract(const CompositeRect& a, const CompositeRect& b,
+                          std::vector<CompositeRect>& out)
+{
+    if (a.w == 0 || a.h == 0)
+        return;
+
+    const uint32_t ax1 = a.x + a.w, ay1 = a.y + a.h;
+    const uint32_t bx1 = b.x + b.w, by1 = b.y + b.h;
+
+    // No overlap – a survives whole
+    if (b.w == 0 || b.h == 0 || b.x >= ax1 || bx1 <= a.x || b.y >= ay1 || by1 <= a.y)
+    {
+        out.push_back(a);
+        return;
+    }
+
+    const uint32_t iy0 = std::max(a.y, b.y), iy1 = std::min(ay1, by1);
+    const uint32_t ix0 = std::max(a.x, b.x), ix1 = std::min(ax1, bx1);
+
+    if (a.y < iy0)  out.push_back({ a.x, a.y, a.w, iy0 - a.y });         // band above
+    if (iy1 < ay1)  out.push_back({ a.x, iy1, a.w, ay1 - iy1 });         // band below
+    if (a.x < ix0)  out.push_back({ a.x, iy0, ix0 - a.x, iy1 - iy0 });   // left of overlap
+    if (ix1 < ax1)  out.push_back({ ix1, iy0, ax1 - ix1, iy1 - iy0 });   // right of overlap
+}
+
+// ─── Clean layer i is on the surface untouched ───────────────
+//  Its rect was drawn last time and no other rect – new or
+//  previous – overlaps it, so nothing can have overdrawn it.
+bool Compositor::StillShown(size_t i) const
+{
+    const CompositeRect& r = m_clipped[i].rect;
+    auto overlaps = [&r](const CompositeRect& o)
+    {
+        return o.x < r.x + r.w && r.x < o.x + o.w && o.y < r.y + r.h && r.y < o.y + o.h;
+    };
+    auto same = [&r](const CompositeRect& o)
+    {
+        return o.x == r.x && o.y == r.y && o.w == r.w && o.h == r.h;
+    };
+
+    for (size_t j = 0; j < m_clipped.size(); ++j)
+        if (j != i && overlaps(m_clipped[j].rect))
+            return false;
+
+    bool drawn = false;
+    for (const CompositeRect& p : m_prevRects)
+    {
+        if (!drawn && same(p)) drawn = true;
+        else if (overlaps(p))  return false;
+    }
+    return drawn;
+}
+
+// ─────────────────────────────────────────────────────────────
+void Compositor::Compose(const CompositeLayer* layers, size_t count)
+{
+    // ── Clip incoming layers to the surface ──────────────────
+    m_clipped.clear();
+    m_nextRects.clear();
+    for (size_t i = 0; i < count; ++i)
+    {
+        CompositeLayer l = layers[i];
+        if (!l.bgra || l.rect.w == 0 || l.rect.h == 0)
+            continue;
+        if (l.rect.x >= m_surfaceW || l.rect.y >= m_surfaceH)
+            continue;
+        l.rect.w = std::min(l.rect.w, m_surfaceW - l.rect.x);
+        l.rect.h = std::min(l.rect.h, m_surfaceH - l.rect.y);
+        m_clipped.push_back(l);
+        m_nextRects.push_back(l.rect);
+    }
+
+    // ── Previously drawn area no longer covered → clear ──────
+    for (const CompositeRect& prev : m_prevRects)
+    {
+        m_stale.clear();
+        m_stale.push_back(prev);
+        for (const CompositeRect& next : m_nextRects)
+        {
+            m_scratch.clear();
+            for (const CompositeRect& s : m_stale)
+                Subtract(s, next, m_scratch);
+            m_stale.swap(m_scratch);
+            if (m_stale.empty())
+                break;
+        }
+        for (const CompositeRect& s : m_stale)
+            ClearRect(s);
+    }
+
+    // ── Upload only what arrived ─────────────────────────────
+    for (size_t i = 0; i < m_clipped.size(); ++i)
+    {
+        const CompositeLayer& l = m_clipped[i];
+        if (!l.dirty && StillShown(i))
+            continue;
+        if (l.scale <= 1)
+        {
+            UploadRect(l);
+            continue;
+        }
+
+        // Clipping only trims the right / bottom edge, so the source
+        // still starts at l.bgra; scale up just the visible part
+        const uint32_t w = l.rect.w, h = l.rect.h;
+        m_upscaled.resize(static_cast<size_t>(w) * h * 4);
+        FrameScale::Upscale(l.bgra, l.stride, FrameScale::ScaledSize(w, l.scale), FrameScale::ScaledSize(h, l.scale),
+                            l.scale, m_upscaled.data(), static_cast<size_t>(w) * 4, w, h);
+        CompositeLayer full = l;
+        full.bgra   = m_upscaled.data();
+        full.stride = w * 4;
+        full.scale  = 1;
+        UploadRect(full);
+    }
+
+    m_prevRects.swap(m_nextRects);
+}
+
+// ─────────────────────────────────────────────────────────────
+//  SoftwareCompositor
+// ─────────────────────────────────────────────────────────────
+bool SoftwareCompositor::Init(uint32_t surfaceW, uint32_t surfaceH)
+{
+    m_surfaceW = surfaceW;
+    m_surfaceH = surfaceH;
+    m_surface.assign(static_cast<size_t>(surfaceW) * surfaceH * 4, 0);
+    return surfaceW != 0 && surfaceH != 0;
+}
+
+void SoftwareCompositor::UploadRect(const CompositeLayer& l)
+{
+    const size_t   dstStride = Stride();
+    const uint32_t rowBytes  = l.rect.w * 4;
+    uint8_t*       dst       = m_surface.data() + l.rect.y * dstStride + l.rect.x * 4;
+    const uint8_t* src       = l.bgra;
+
+    for (uint32_t row = 0; row < l.rect.h; ++row)
+    {
+        std::memcpy(dst, src, rowBytes);
+        dst += dstStride;
+        src += l.stride;
+    }
+}
+
+void SoftwareCompositor::ClearRect(const CompositeRect& r)
+{
+    const size_t dstStride = Stride();
+    uint8_t*     dst       = m_surface.data() + r.y * dstStride + r.x * 4;
+
+    for (uint32_t row = 0; row < r.h; ++row)
+    {
+        std::memset(dst, 0, r.w * 4);
+        dst += dstStride;
+    }
+}
@@ -0,0 +1,97 @@
+#pragma once
+// ============================================================
+//  Compositor.h  –  Persistent full-surface frame compositor
+//  Keeps one screen-sized BGRA surface alive, uploads only the
+//  received rectangle(s) at their origin and clears only the
+//  regions that were covered last frame but are empty now.
+//  Layers that haven't changed since the last Compose (one
+//  stream of several got a new frame) are left in place, and
+//  layers sent at reduced resolution are scaled back up first.
+//
+//  Deliberately free of Windows / D3D headers so the damage
+//  logic and the CPU backend build and run headless anywhere.
+// ============================================================
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+// ─── Surface-space rectangle ─────────────────────────────────
+struct CompositeRect
+{
+    uint32_t x, y, w, h;   // w==0 || h==0 means empty
+};
+
+// ─── One received rectangle of BGRA pixels ──────────────────
+struct CompositeLayer
+{
+    const uint8_t* bgra;    // top-left pixel of the rectangle
+    uint32_t       stride;  // bytes between source rows
+    CompositeRect  rect;    // destination on the surface
+    bool           dirty = true;   // false: same pixels + rect as last Compose
+    uint32_t       scale = 1;      // bgra is rect shrunk by this (FrameScale); scaled up on upload
+};
+
+// ─── Compositor (backend-independent part) ───────────────────
+class Compositor
+{
+public:
+    virtual ~Compositor() = default;
+
+    // Allocate the persistent surface. Must be called before Compose.
+    virtual bool Init(uint32_t surfaceW, uint32_t surfaceH) = 0;
+
+    // Replace the visible content with `layers`. Layers are clipped
+    // to the surface; areas covered by the previous Compose but not
+    // by any new layer are cleared, everything else is left alone.
+    // A clean layer is re-uploaded only if it overlaps another one
+    // (now or last time), since then its pixels may be overdrawn.
+    void Compose(const CompositeLayer* layers, size_t count);
+
+    // Show the surface (no-op for backends without a display)
+    virtual void Present() = 0;
+
+    uint32_t SurfaceWidth()  const { return m_surfaceW; }
+    uint32_t SurfaceHeight() const { return m_surfaceH; }
+
+    // Geometry helper: append a − b (0..4 rects) to `out`
+    static void Subtract(const CompositeRect& a, const CompositeRect& b,
+                         std::vector<CompositeRect>& out);
+
+protected:
+    virtual void UploadRect(const CompositeLayer& layer) = 0;
+    virtual void ClearRect (const CompositeRect&  rect)  = 0;
+
+    uint32_t m_surfaceW = 0;
+    uint32_t m_surfaceH = 0;
+
+private:
+    bool StillShown(size_t clippedIndex) const;
+
+    std::vector<CompositeRect>  m_prevRects;   // what is currently on the surface
+    std::vector<CompositeRect>  m_nextRects;
+    std::vector<CompositeRect>  m_stale;
+    std::vector<CompositeRect>  m_scratch;
+    std::vector<CompositeLayer> m_clipped;
+    std::vector<uint8_t>        m_upscaled;    // full-size pixels of a scaled layer
+};
+
+// ─── CPU backend ─────────────────────────────────────────────
+// Plain memory surface; used headless and for tests/benchmarks.
+class SoftwareCompositor : public Compositor
+{
+public:
+    bool Init(uint32_t surfaceW, uint32_t surfaceH) override;
+    void Present() override { ++m_presentCount; }
+
+    const uint8_t* Surface()      const { return m_surface.data(); }
+    uint32_t       Stride()       const { return m_surfaceW * 4; }
+    uint64_t       PresentCount() const { return m_presentCount; }
+
+protected:
+    void UploadRect(const CompositeLayer& layer) override;
+    void ClearRect (const CompositeRect&  rect)  override;
+
+private:
+    std::vector<uint8_t> m_surface;
+    uint64_t             m_presentCount = 0;
+};
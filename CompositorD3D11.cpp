@@ -0,0 +1,85 @@
+// ============================================================
+//  CompositorD3D11.cpp  –  Direct3D 11 compositor backend
+//  Zero-Latency Network Video Fuser
+// ============================================================
+
+#include "NetworkFuser.h"
+#include "CompositorD3D11.h"
+
+D3D11Compositor::~D3D11Compositor()
+{
+    if (m_surfaceSrv) { m_surfaceSrv->Release(); m_surfaceSrv = nullptr; }
+    if (m_surfaceTex) { m_surfaceTex->Release(); m_surfaceTex = nullptr; }
+}
+
+bool D3D11Compositor::Init(uint32_t surfaceW, uint32_t surfaceH)
+{
+    // Created once for the lifetime of the overlay – never resized
+    // per frame, whatever the bounding box of the content does.
+    D3D11_TEXTURE2D_DESC td{};
+    td.Width            = surfaceW;
+    td.Height           = surfaceH;
+    td.MipLevels        = 1;
+    td.ArraySize        = 1;
+    td.Format           = DXGI_FORMAT_B8G8R8A8_UNORM;
+    td.SampleDesc.Count = 1;
+    td.Usage            = D3D11_USAGE_DEFAULT;
+    td.BindFlags        = D3D11_BIND_SHADER_RESOURCE;
+
+    // Start fully transparent
+    std::vector<uint8_t> init(static_cast<size_t>(surfaceW) * surfaceH * 4, 0);
+    D3D11_SUBRESOURCE_DATA sd{};
+    sd.pSysMem     = init.data();
+    sd.SysMemPitch = surfaceW * 4;
+
+    HRESULT hr = m_t.device->CreateTexture2D(&td, &sd, &m_surfaceTex);
+    if (FAILED(hr))
+    {
+        FuserUtil::Log("[Compositor] CreateTexture2D (surface) failed: 0x%08X\n", hr);
+        return false;
+    }
+    hr = m_t.device->CreateShaderResourceView(m_surfaceTex, nullptr, &m_surfaceSrv);
+    if (FAILED(hr))
+    {
+        FuserUtil::Log("[Compositor] CreateShaderResourceView failed: 0x%08X\n", hr);
+        return false;
+    }
+
+    m_surfaceW = surfaceW;
+    m_surfaceH = surfaceH;
+    FuserUtil::Log("[Compositor] D3D11 surface %u x %u\n", surfaceW, surfaceH);
+    return true;
+}
+
+void D3D11Compositor::UploadRect(const CompositeLayer& l)
+{
+    D3D11_BOX box{ l.rect.x, l.rect.y, 0, l.rect.x + l.rect.w, l.rect.y + l.rect.h, 1 };
+    m_t.context->UpdateSubresource(m_surfaceTex, 0, &box, l.bgra, l.stride, 0);
+}
+
+void D3D11Compositor::ClearRect(const CompositeRect& r)
+{
+    const size_t need = static_cast<size_t>(r.w) * r.h * 4;
+    if (m_zeros.size() < need)
+        m_zeros.resize(need, 0);
+
+    D3D11_BOX box{ r.x, r.y, 0, r.x + r.w, r.y + r.h, 1 };
+    m_t.context->UpdateSubresource(m_surfaceTex, 0, &box, m_zeros.data(), r.w * 4, 0);
+}
+
+void D3D11Compositor::Present()
+{
+    float clear[4] = {0,0,0,0};
+    ID3D11DeviceContext* ctx = m_t.context;
+    ctx->ClearRenderTargetView(m_t.renderTarget, clear);
+    ctx->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
+    ctx->VSSetShader(m_t.vertexShader, nullptr, 0);
+    ctx->PSSetShader(m_t.pixelShader, nullptr, 0);
+    ctx->PSSetShaderResources(0, 1, &m_surfaceSrv);
+    ctx->PSSetSamplers(0, 1, &m_t.sampler);
+    ctx->OMSetRenderTargets(1, &m_t.renderTarget, nullptr);
+    ctx->OMSetBlendState(m_t.blendState, nullptr, 0xFFFFFFFF);
+    ctx->RSSetViewports(1, &m_t.viewport);
+    ctx->Draw(4, 0);
+    m_t.swapChain->Present(0, 0);
+}
@@ -0,0 +1,42 @@
+#pragma once
+// ============================================================
+//  CompositorD3D11.h  –  Direct3D 11 compositor backend
+//  One screen-sized DEFAULT texture created once; received
+//  rectangles go in via UpdateSubresource at their origin.
+// ============================================================
+#include "NetworkFuser.h"
+#include "Compositor.h"
+
+// Pipeline objects owned by ReceiverModule (borrowed, not released here)
+struct D3D11PresentTargets
+{
+    ID3D11Device*           device       = nullptr;
+    ID3D11DeviceContext*    context      = nullptr;
+    IDXGISwapChain*         swapChain    = nullptr;
+    ID3D11RenderTargetView* renderTarget = nullptr;
+    ID3D11VertexShader*     vertexShader = nullptr;
+    ID3D11PixelShader*      pixelShader  = nullptr;
+    ID3D11SamplerState*     sampler      = nullptr;
+    ID3D11BlendState*       blendState   = nullptr;
+    D3D11_VIEWPORT          viewport{};
+};
+
+class D3D11Compositor : public Compositor
+{
+public:
+    explicit D3D11Compositor(const D3D11PresentTargets& t) : m_t(t) {}
+    ~D3D11Compositor() override;
+
+    bool Init(uint32_t surfaceW, uint32_t surfaceH) override;
+    void Present() override;
+
+protected:
+    void UploadRect(const CompositeLayer& layer) override;
+    void ClearRect (const CompositeRect&  rect)  override;
+
+private:
+    D3D11PresentTargets       m_t;
+    ID3D11Texture2D*          m_surfaceTex = nullptr;
+    ID3D11ShaderResourceView* m_surfaceSrv = nullptr;
+    std::vector<uint8_t>      m_zeros;     // source for ClearRect uploads
+};
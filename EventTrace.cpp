@@ -0,0 +1,200 @@
+// ============================================================
+//  EventTrace.cpp  –  Binary event trace writer + reader
+//  Zero-Latency Network Video Fuser
+// ============================================================
+
+#include "EventTrace.h"
+#include <chrono>
+#include <cstring>
+
+namespace
+{
+    uint64_t SteadyNs()
+    {
+        return static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    std::atomic<uint16_t> g_nextThread{0};
+    thread_local uint16_t t_thread = 0;
+
+    uint16_t ThreadNumber()
+    {
+        if (!t_thread)
+            t_thread = static_cast<uint16_t>(g_nextThread.fetch_add(1, std::memory_order_relaxed) + 1);
+        return t_thread;
+    }
+
+    struct EventInfo
+    {
+        const char* name;
+        const char* args[4];
+    };
+
+    constexpr EventInfo EVENT_INFO[static_cast<size_t>(TraceEvent::Count)] = {
+        { "None",          { nullptr,    nullptr,  nullptr,  nullptr } },
+        { "FrameCaptured", { "width",    "height", nullptr,  nullptr } },
+        { "FrameEmpty",    { nullptr,    nullptr,  nullptr,  nullptr } },
+        { "FrameCropped",  { "w",        "h",      "bytes",  "band"  } },
+        { "SendBegin",     { "packets",  "bytes",  nullptr,  nullptr } },
+        { "SendEnd",       { "packets",  "bytes",  "errors", nullptr } },
+        { "FirstPacket",   { "packets",  nullptr,  nullptr,  nullptr } },
+        { "FrameComplete", { "packets",  "bytes",  "spanUs", nullptr } },
+        { "FrameTimedOut", { "received", "total",  nullptr,  nullptr } },
+        { "FrameEvicted",  { "received", "total",  nullptr,  nullptr } },
+        { "RenderBegin",   { "width",    "height", nullptr,  nullptr } },
+        { "RenderEnd",     { "width",    "height", "shown",  nullptr } },
+    };
+}
+
+// ─────────────────────────────────────────────────────────────
+//  EventTraceWriter
+// ─────────────────────────────────────────────────────────────
+bool EventTraceWriter::Open(const std::string& path, uint64_t maxBytes, TraceRole role)
+{
+    Close();
+    if (maxBytes < sizeof(EventTraceHeader) + sizeof(EventRecord))
+        return false;
+    if (!m_file.CreateWrite(path, maxBytes))
+        return false;
+
+    m_hdr      = reinterpret_cast<EventTraceHeader*>(m_file.Data());
+    m_records  = reinterpret_cast<EventRecord*>(m_file.Data() + sizeof(EventTraceHeader));
+    m_capacity = (maxBytes - sizeof(EventTraceHeader)) / sizeof(EventRecord);
+
+    EventTraceHeader hdr{};
+    std::memcpy(hdr.magic, EVENT_TRACE_MAGIC, sizeof(hdr.magic));
+    hdr.version    = EVENT_TRACE_VERSION;
+    hdr.recordSize = sizeof(EventRecord);
+    hdr.role       = static_cast<uint32_t>(role);
+    hdr.startNs    = SteadyNs();
+    hdr.capacity   = m_capacity;
+    std::memcpy(m_hdr, &hdr, sizeof(hdr));
+
+    m_next.store(0, std::memory_order_relaxed);
+    m_dropped.store(0, std::memory_order_relaxed);
+    return true;
+}
+
+void EventTraceWriter::Emit(TraceEvent ev, uint32_t frameID,
+                            uint32_t a0, uint32_t a1, uint32_t a2, uint32_t a3)
+{
+    const uint64_t idx = m_next.fetch_add(1, std::memory_order_relaxed);
+    if (idx >= m_capacity)
+    {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    EventRecord r;
+    r.timeNs  = SteadyNs();
+    r.event   = static_cast<uint16_t>(ev);
+    r.thread  = ThreadNumber();
+    r.frameID = frameID;
+    r.args[0] = a0;
+    r.args[1] = a1;
+    r.args[2] = a2;
+    r.args[3] = a3;
+    std::memcpy(&m_records[idx], &r, sizeof(r));
+}
+
+void EventTraceWriter::SetClockOffsetUs(int64_t offsetUs)
+{
+    if (!m_hdr) return;
+    m_hdr->clockOffsetUs  = offsetUs;
+    m_hdr->hasClockOffset = 1;
+}
+
+uint64_t EventTraceWriter::RecordCount() const
+{
+    const uint64_t n = m_next.load(std::memory_order_relaxed);
+    return n < m_capacity ? n : m_capacity;
+}
+
+void EventTraceWriter::Close()
+{
+    if (!m_file.IsOpen()) return;
+
+    const uint64_t count = RecordCount();
+    m_hdr->recordCount  = count;
+    m_hdr->droppedCount = DroppedCount();
+    m_file.Close(sizeof(EventTraceHeader) + count * sizeof(EventRecord));
+
+    m_hdr      = nullptr;
+    m_records  = nullptr;
+    m_capacity = 0;
+}
+
+// ─────────────────────────────────────────────────────────────
+//  EventTraceReader
+// ─────────────────────────────────────────────────────────────
+bool EventTraceReader::Open(const std::string& path)
+{
+    m_hdr = nullptr;
+    m_count = 0;
+    if (!m_file.OpenRead(path) || m_file.Size() < sizeof(EventTraceHeader))
+        return false;
+
+    const auto* hdr = reinterpret_cast<const EventTraceHeader*>(m_file.Data());
+    if (std::memcmp(hdr->magic, EVENT_TRACE_MAGIC, sizeof(hdr->magic)) != 0 ||
+        hdr->version != EVENT_TRACE_VERSION || hdr->recordSize != sizeof(EventRecord))
+        return false;
+
+    // A crashed session leaves recordCount at 0 and the file at full
+    // capacity: take every slot and let the caller skip empty ones
+    const uint64_t inFile = (m_file.Size() - sizeof(EventTraceHeader)) / sizeof(EventRecord);
+    m_count   = hdr->recordCount ? (hdr->recordCount < inFile ? hdr->recordCount : inFile) : inFile;
+    m_records = reinterpret_cast<const EventRecord*>(m_file.Data() + sizeof(EventTraceHeader));
+    m_hdr     = hdr;
+    return true;
+}
+
+// ─────────────────────────────────────────────────────────────
+//  Process-wide trace
+// ─────────────────────────────────────────────────────────────
+namespace EventTrace
+{
+    std::atomic<EventTraceWriter*> g_writer{nullptr};
+
+    namespace
+    {
+        EventTraceWriter g_instance;
+    }
+
+    bool Start(const std::string& path, uint64_t maxBytes, TraceRole role)
+    {
+        Stop();
+        if (!g_instance.Open(path, maxBytes, role))
+            return false;
+        g_writer.store(&g_instance, std::memory_order_release);
+        return true;
+    }
+
+    void Stop()
+    {
+        if (!g_writer.exchange(nullptr, std::memory_order_acq_rel))
+            return;
+        g_instance.Close();
+    }
+
+    void SetClockOffsetUs(int64_t offsetUs)
+    {
+        if (EventTraceWriter* w = g_writer.load(std::memory_order_acquire))
+            w->SetClockOffsetUs(offsetUs);
+    }
+
+    const char* Name(TraceEvent ev)
+    {
+        const size_t i = static_cast<size_t>(ev);
+        return i < static_cast<size_t>(TraceEvent::Count) ? EVENT_INFO[i].name : "?";
+    }
+
+    const char* ArgName(TraceEvent ev, int i)
+    {
+        const size_t e = static_cast<size_t>(ev);
+        if (e >= static_cast<size_t>(TraceEvent::Count) || i < 0 || i >= 4)
+            return nullptr;
+        return EVENT_INFO[e].args[i];
+    }
+}
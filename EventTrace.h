@@ -0,0 +1,144 @@
+#pragma once
+// ============================================================
+//  EventTrace.h  –  Binary per-frame event trace
+//  Fixed 32-byte records (event, thread, frame ID, timestamp,
+//  four integer fields) appended to a memory-mapped file by any
+//  thread: one atomic fetch_add + one 32-byte copy, no syscalls,
+//  no formatting. Decode offline with tools/TraceDecode (text or
+//  Chrome trace JSON).
+//
+//  File layout:
+//    EventTraceHeader (64 B)
+//    EventRecord[capacity]        (zero-filled until written)
+//  Timestamps are steady-clock nanoseconds (QueryPerformanceCounter
+//  on MSVC), i.e. the clock behind FuserUtil::NowUs() × 1000. The
+//  receiver stores its measured clock offset to the sender in the
+//  header so both machines' traces can be merged on one timeline.
+//
+//  Portable – no Windows headers.
+// ============================================================
+#include "MappedFile.h"
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+static constexpr char     EVENT_TRACE_MAGIC[8]  = { 'K','F','E','V','E','N','T','1' };
+static constexpr uint32_t EVENT_TRACE_VERSION   = 1;
+
+enum class TraceEvent : uint16_t
+{
+    None = 0,             // unwritten record
+
+    // Sender (frame = ID the frame is sent under)
+    FrameCaptured,        // a0 width, a1 height
+    FrameEmpty,           // nothing visible – sent as a 0×0 frame if the overlay wasn't empty already
+    FrameCropped,         // a0 w, a1 h as sent (bbox ÷ scale), a2 bytes, a3 band (FrameBands)
+    SendBegin,            // a0 packets, a1 bytes
+    SendEnd,              // a0 packets, a1 bytes sent, a2 send errors
+
+    // Receiver
+    FirstPacket,          // a0 total packets
+    FrameComplete,        // a0 packets, a1 bytes, a2 first→last packet µs
+    FrameTimedOut,        // a0 packets received, a1 total packets
+    FrameEvicted,         // a0 packets received, a1 total packets
+    RenderBegin,          // a0 width, a1 height
+    RenderEnd,            // a0 width, a1 height, a2 1 = presented / 0 = dropped
+
+    Count
+};
+
+enum class TraceRole : uint32_t { Unknown = 0, Sender = 1, Receiver = 2 };
+
+#pragma pack(push, 1)
+struct EventTraceHeader
+{
+    char     magic[8];
+    uint32_t version;
+    uint32_t recordSize;      // sizeof(EventRecord)
+    uint32_t role;            // TraceRole
+    uint32_t hasClockOffset;
+    int64_t  clockOffsetUs;   // receiver − sender (receiver traces only)
+    uint64_t startNs;         // steady clock when the trace was opened
+    uint64_t capacity;        // records the file was sized for
+    uint64_t recordCount;     // set on Close; 0 after a crash → scan
+    uint64_t droppedCount;    // events not recorded (file full)
+};
+
+struct EventRecord
+{
+    uint64_t timeNs;
+    uint16_t event;           // TraceEvent
+    uint16_t thread;          // small per-process thread number, from 1
+    uint32_t frameID;
+    uint32_t args[4];
+};
+#pragma pack(pop)
+static_assert(sizeof(EventTraceHeader) == 64, "EventTraceHeader layout changed");
+static_assert(sizeof(EventRecord)      == 32, "EventRecord layout changed");
+
+// ─── Writer (any number of threads) ──────────────────────────
+class EventTraceWriter
+{
+public:
+    ~EventTraceWriter() { Close(); }
+
+    bool Open(const std::string& path, uint64_t maxBytes, TraceRole role);
+    void Emit(TraceEvent ev, uint32_t frameID,
+              uint32_t a0, uint32_t a1, uint32_t a2, uint32_t a3);
+    void SetClockOffsetUs(int64_t offsetUs);
+
+    // Not safe against concurrent Emit – stop the emitting threads first
+    void Close();
+
+    uint64_t RecordCount()  const;
+    uint64_t DroppedCount() const { return m_dropped.load(std::memory_order_relaxed); }
+
+private:
+    MappedFile            m_file;
+    EventTraceHeader*     m_hdr      = nullptr;
+    EventRecord*          m_records  = nullptr;
+    uint64_t              m_capacity = 0;
+    std::atomic<uint64_t> m_next{0};
+    std::atomic<uint64_t> m_dropped{0};
+};
+
+// ─── Reader (decoder side) ───────────────────────────────────
+class EventTraceReader
+{
+public:
+    bool Open(const std::string& path);
+
+    const EventTraceHeader& Header()  const { return *m_hdr; }
+    // Records present in the file (written or not; skip event None)
+    uint64_t                Count()   const { return m_count; }
+    const EventRecord&      operator[](uint64_t i) const { return m_records[i]; }
+
+private:
+    MappedFile               m_file;
+    const EventTraceHeader*  m_hdr     = nullptr;
+    const EventRecord*       m_records = nullptr;
+    uint64_t                 m_count   = 0;
+};
+
+// ─── Process-wide trace ──────────────────────────────────────
+// Emit is a relaxed pointer load when no trace is open.
+namespace EventTrace
+{
+    extern std::atomic<EventTraceWriter*> g_writer;
+
+    bool Start(const std::string& path, uint64_t maxBytes, TraceRole role);
+    void Stop();                               // after all emitting threads have stopped
+    void SetClockOffsetUs(int64_t offsetUs);
+
+    inline void Emit(TraceEvent ev, uint32_t frameID,
+                     uint32_t a0 = 0, uint32_t a1 = 0, uint32_t a2 = 0, uint32_t a3 = 0)
+    {
+        if (EventTraceWriter* w = g_writer.load(std::memory_order_relaxed))
+            w->Emit(ev, frameID, a0, a1, a2, a3);
+    }
+
+    const char* Name(TraceEvent ev);
+    // Label of payload field i for `ev`, nullptr if unused
+    const char* ArgName(TraceEvent ev, int i);
+}
@@ -0,0 +1,158 @@
+// ============================================================
+//  FrameDelta.cpp  –  XOR residual + zero-run coding
+//  Zero-Latency Network Video Fuser
+// ============================================================
+
+#include "FrameDelta.h"
+#include <cstring>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace
+{
+    inline uint64_t Load64(const uint8_t* p)           { uint64_t v; std::memcpy(&v, p, 8); return v; }
+    inline void     Store64(uint8_t* p, uint64_t v)    { std::memcpy(p, &v, 8); }
+
+    inline uint32_t LowestSetByte(uint64_t x)
+    {
+#if defined(_MSC_VER)
+        unsigned long bit;
+        _BitScanForward64(&bit, x);
+        return static_cast<uint32_t>(bit) / 8;
+#else
+        return static_cast<uint32_t>(__builtin_ctzll(x)) / 8;
+#endif
+    }
+
+    inline uint32_t HighestSetByte(uint64_t x)
+    {
+#if defined(_MSC_VER)
+        unsigned long bit;
+        _BitScanReverse64(&bit, x);
+        return static_cast<uint32_t>(bit) / 8;
+#else
+        return static_cast<uint32_t>(63 - __builtin_clzll(x)) / 8;
+#endif
+    }
+
+    // dst[i] = a[i] ^ b[i]; dst may be a
+    inline void Xor(uint8_t* dst, const uint8_t* a, const uint8_t* b, size_t n)
+    {
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8)
+            Store64(dst + i, Load64(a + i) ^ Load64(b + i));
+        for (; i < n; ++i)
+            dst[i] = a[i] ^ b[i];
+    }
+
+    // First index ≥ pos where the frames differ; n if none
+    size_t NextDiff(const uint8_t* a, const uint8_t* b, size_t pos, size_t n)
+    {
+        for (; pos + 8 <= n; pos += 8)
+        {
+            const uint64_t x = Load64(a + pos) ^ Load64(b + pos);
+            if (x)
+                return pos + LowestSetByte(x);   // little-endian: lowest byte first
+        }
+        for (; pos < n; ++pos)
+            if (a[pos] != b[pos])
+                return pos;
+        return n;
+    }
+
+    inline size_t VarintSize(size_t v)
+    {
+        size_t n = 1;
+        while (v >= 0x80) { v >>= 7; ++n; }
+        return n;
+    }
+
+    inline uint8_t* PutVarint(uint8_t* p, size_t v)
+    {
+        while (v >= 0x80)
+        {
+            *p++ = static_cast<uint8_t>(v | 0x80);
+            v >>= 7;
+        }
+        *p++ = static_cast<uint8_t>(v);
+        return p;
+    }
+
+    inline bool GetVarint(const uint8_t*& p, const uint8_t* end, size_t& v)
+    {
+        v = 0;
+        for (uint32_t shift = 0; p < end && shift < 64; shift += 7)
+        {
+            const uint8_t b = *p++;
+            v |= static_cast<size_t>(b & 0x7F) << shift;
+            if (!(b & 0x80))
+                return true;
+        }
+        return false;
+    }
+}
+
+namespace FrameDelta
+{
+    bool Encode(const uint8_t* cur, const uint8_t* ref, size_t n,
+                uint8_t* dst, size_t cap, size_t& codedBytes)
+    {
+        size_t out = 0;
+        size_t pos = 0;   // end of the last run written
+        for (;;)
+        {
+            const size_t start = NextDiff(cur, ref, pos, n);
+            if (start == n)
+                break;
+
+            // The run goes on a word at a time until a whole word
+            // (MIN_GAP bytes) is unchanged, then ends after the last
+            // changed byte; shorter gaps stay inside it
+            size_t   at   = start;
+            uint64_t last = 0;
+            for (; at + 8 <= n; at += 8)
+            {
+                const uint64_t x = Load64(cur + at) ^ Load64(ref + at);
+                if (!x)
+                    break;
+                last = x;
+            }
+            size_t end = at > start ? at - 8 + HighestSetByte(last) + 1 : start + 1;
+            if (at + 8 > n)
+                for (size_t i = at; i < n; ++i)   // tail shorter than a word
+                    if (cur[i] != ref[i])
+                        end = i + 1;
+
+            const size_t len = end - start;
+            if (out + VarintSize(start - pos) + VarintSize(len) + len > cap)
+                return false;
+            uint8_t* p = PutVarint(PutVarint(dst + out, start - pos), len);
+            Xor(p, cur + start, ref + start, len);
+            out = (p - dst) + len;
+            pos = end;
+        }
+        codedBytes = out;
+        return true;
+    }
+
+    bool Apply(const uint8_t* coded, size_t codedBytes, uint8_t* frame, size_t n)
+    {
+        const uint8_t* p   = coded;
+        const uint8_t* end = coded + codedBytes;
+        size_t         pos = 0;
+        while (p < end)
+        {
+            size_t skip, len;
+            if (!GetVarint(p, end, skip) || !GetVarint(p, end, len))
+                return false;
+            if (skip > n - pos || len > n - pos - skip || len > static_cast<size_t>(end - p))
+                return false;
+            pos += skip;
+            Xor(frame + pos, frame + pos, p, len);
+            pos += len;
+            p   += len;
+        }
+        return true;
+    }
+}
@@ -0,0 +1,56 @@
+#pragma once
+// ============================================================
+//  FrameDelta.h  –  Temporal delta coding of wire pixels
+//  Consecutive overlay frames mostly repeat the one before. With
+//  DeltaCodec on, the sender codes a band's packed wire pixels
+//  as the XOR against the last frame it sent of that band and
+//  ships only the runs that changed; the receiver XORs them back
+//  onto its copy of that frame (FrameMetaPayload::codec,
+//  refFrameID).
+//
+//  Coded stream: (skip, length, length residual bytes)*, skip and
+//  length as LEB128 varints. `skip` bytes are unchanged, the next
+//  `length` are cur ^ ref; whatever follows the last run is
+//  unchanged. Changed runs closer than MIN_GAP bytes are merged,
+//  so a token never costs more than the bytes it saves.
+//
+//    PLAIN  pixels stand alone, receivers keep no copy
+//    KEY    pixels stand alone and are the band's new reference
+//    DELTA  residual against frame refFrameID of the same band,
+//           same rectangle, scale and format; the result is the
+//           new reference. A receiver that doesn't hold that
+//           frame drops it and asks for a keyframe.
+//    TILES  tile-cache code (TileCache.h) against the stream's
+//           tiled frame refFrameID; stands in for KEY, so the
+//           result is the band's new reference too.
+//  Portable – no Windows headers.
+// ============================================================
+#include <cstddef>
+#include <cstdint>
+
+namespace FrameDelta
+{
+    enum Codec : uint8_t
+    {
+        PLAIN = 0,
+        KEY   = 1,
+        DELTA = 2,
+        TILES = 3,   // see TileCache.h
+        CODEC_COUNT
+    };
+
+    inline bool ValidCodec(uint32_t c) { return c < CODEC_COUNT; }
+
+    static constexpr size_t MIN_GAP = 8;   // unchanged bytes that end a run
+
+    // `n` bytes of `cur` against `ref` into `dst`; false if the code
+    // would take more than `cap` bytes (send a keyframe instead).
+    // Identical frames code to 0 bytes.
+    bool Encode(const uint8_t* cur, const uint8_t* ref, size_t n,
+                uint8_t* dst, size_t cap, size_t& codedBytes);
+
+    // Apply `codedBytes` of code to the `n`-byte reference `frame`,
+    // in place. False if the code is malformed or runs past `n` –
+    // `frame` is then partly updated and no longer a reference.
+    bool Apply(const uint8_t* coded, size_t codedBytes, uint8_t* frame, size_t n);
+}
@@ -0,0 +1,77 @@
+// ============================================================
+//  FrameOps.cpp  –  Bounding box, crop and pitch-correcting copy
+//  Zero-Latency Network Video Fuser
+// ============================================================
+
+#include "FrameOps.h"
+
+namespace FrameOps
+{
+    BoundingBox ComputeBoundingBox(const uint8_t* bgra,
+                                   uint32_t       width,
+                                   uint32_t       height,
+                                   uint8_t        threshold)
+    {
+        uint32_t xMin = width,  yMin = height;
+        uint32_t xMax = 0,      yMax = 0;
+        bool     found = false;
+
+        const uint32_t stride = width * 4;
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            const uint8_t* row = bgra + y * stride;
+            for (uint32_t x = 0; x < width; ++x)
+            {
+                const uint8_t b = row[x * 4 + 0];
+                const uint8_t g = row[x * 4 + 1];
+                const uint8_t r = row[x * 4 + 2];
+                const uint8_t a = row[x * 4 + 3];
+                if (b > threshold || g > threshold || r > threshold || a > threshold)
+                {
+                    if (x < xMin) xMin = x;
+                    if (x > xMax) xMax = x;
+                    if (y < yMin) yMin = y;
+                    if (y > yMax) yMax = y;
+                    found = true;
+                }
+            }
+        }
+
+        if (!found)
+            return BoundingBox{0, 0, 0, 0};
+
+        return BoundingBox{
+            xMin,
+            yMin,
+            xMax - xMin + 1,
+            yMax - yMin + 1
+        };
+    }
+
+    void CropBGRA(const uint8_t* src, uint32_t srcWidth,
+                  uint8_t*       dst,
+                  const BoundingBox& bb)
+    {
+        const uint32_t srcStride = srcWidth * 4;
+        const uint32_t dstStride = bb.w    * 4;
+
+        for (uint32_t row = 0; row < bb.h; ++row)
+        {
+            const uint8_t* srcRow = src + (bb.y + row) * srcStride + bb.x * 4;
+            uint8_t*       dstRow = dst + row * dstStride;
+            std::memcpy(dstRow, srcRow, dstStride);
+        }
+    }
+
+    void CopyRows(uint8_t* dst, size_t dstStride,
+                  const uint8_t* src, size_t srcStride,
+                  size_t rowBytes, uint32_t rows)
+    {
+        for (uint32_t row = 0; row < rows; ++row)
+        {
+            std::memcpy(dst, src, rowBytes);
+            dst += dstStride;
+            src += srcStride;
+        }
+    }
+}
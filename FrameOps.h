@@ -0,0 +1,36 @@
+#pragma once
+// ============================================================
+//  FrameOps.h  –  CPU pixel kernels on the capture / send path
+//  Shared by the sender, the DXGI capture source and the
+//  benchmark suite (bench/FuserBench).
+// ============================================================
+#include "NetworkFuser.h"
+
+namespace FrameOps
+{
+    // Tightest box around pixels with alpha or any colour channel
+    // above `threshold`; w == 0 when the whole frame is black.
+    BoundingBox ComputeBoundingBox(const uint8_t* bgra,
+                                   uint32_t       width,
+                                   uint32_t       height,
+                                   uint8_t        threshold = 2);
+
+    // Copy a sub-rectangle of a full-width BGRA buffer into a tight dst
+    void CropBGRA(const uint8_t* src, uint32_t srcWidth,
+                  uint8_t*       dst,
+                  const BoundingBox& bb);
+
+    // `rows` rows of `rowBytes` between buffers with different pitches
+    // (GPU staging texture → tight frame buffer)
+    void CopyRows(uint8_t* dst, size_t dstStride,
+                  const uint8_t* src, size_t srcStride,
+                  size_t rowBytes, uint32_t rows);
+
+    // First row of band `band` when `height` rows are cut into
+    // `bands` near-equal horizontal bands; BandStart(h, bands, bands)
+    // is h, so band k spans [BandStart(k), BandStart(k + 1))
+    inline uint32_t BandStart(uint32_t height, uint32_t band, uint32_t bands)
+    {
+        return static_cast<uint32_t>(static_cast<uint64_t>(height) * band / (bands ? bands : 1));
+    }
+}
@@ -0,0 +1,249 @@
+// ============================================================
+//  FrameRing.cpp  –  Shared-memory frame ring (seqlock slots)
+//  Zero-Latency Network Video Fuser
+// ============================================================
+
+#include "FrameRing.h"
+#include <cstring>
+#include <new>
+
+#ifdef _WIN32
+  #ifndef WIN32_LEAN_AND_MEAN
+  #define WIN32_LEAN_AND_MEAN
+  #endif
+  #include <windows.h>
+#else
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <fcntl.h>
+  #include <unistd.h>
+#endif
+
+namespace
+{
+    constexpr size_t SLOT_HDR = sizeof(FrameRingSlot);
+
+    inline size_t Align64(size_t n) { return (n + 63) & ~static_cast<size_t>(63); }
+
+    inline FrameRingSlot* SlotAt(uint8_t* base, const FrameRingHeader* h, uint64_t idx)
+    {
+        return reinterpret_cast<FrameRingSlot*>(
+            base + sizeof(FrameRingHeader) + idx * h->slotStride);
+    }
+}
+
+// ─────────────────────────────────────────────────────────────
+//  FrameRingMapping
+// ─────────────────────────────────────────────────────────────
+bool FrameRingMapping::Create(const std::string& name, size_t bytes)
+{
+    Close();
+#ifdef _WIN32
+    const std::string full = "Local\\" + name;
+    HANDLE h = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                                  static_cast<DWORD>(static_cast<uint64_t>(bytes) >> 32),
+                                  static_cast<DWORD>(bytes & 0xFFFFFFFFu),
+                                  full.c_str());
+    if (!h) return false;
+    void* p = MapViewOfFile(h, FILE_MAP_ALL_ACCESS, 0, 0, bytes);
+    if (!p) { CloseHandle(h); return false; }
+    m_handle = h;
+    m_base   = static_cast<uint8_t*>(p);
+#else
+    const std::string full = "/" + name;
+    int fd = shm_open(full.c_str(), O_CREAT | O_RDWR, 0600);
+    if (fd < 0) return false;
+    if (ftruncate(fd, static_cast<off_t>(bytes)) != 0) { close(fd); return false; }
+    void* p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED) { close(fd); return false; }
+    m_fd   = fd;
+    m_base = static_cast<uint8_t*>(p);
+#endif
+    m_bytes = bytes;
+    m_owner = true;
+    m_name  = full;
+    return true;
+}
+
+bool FrameRingMapping::Open(const std::string& name)
+{
+    Close();
+#ifdef _WIN32
+    const std::string full = "Local\\" + name;
+    HANDLE h = OpenFileMappingA(FILE_MAP_READ, FALSE, full.c_str());
+    if (!h) return false;
+    // Map the header first to learn the full size
+    void* p = MapViewOfFile(h, FILE_MAP_READ, 0, 0, 0);
+    if (!p) { CloseHandle(h); return false; }
+    MEMORY_BASIC_INFORMATION mbi{};
+    VirtualQuery(p, &mbi, sizeof(mbi));
+    m_handle = h;
+    m_base   = static_cast<uint8_t*>(p);
+    m_bytes  = mbi.RegionSize;
+#else
+    const std::string full = "/" + name;
+    int fd = shm_open(full.c_str(), O_RDONLY, 0);
+    if (fd < 0) return false;
+    struct stat st{};
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) { close(fd); return false; }
+    void* p = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED) { close(fd); return false; }
+    m_fd    = fd;
+    m_base  = static_cast<uint8_t*>(p);
+    m_bytes = static_cast<size_t>(st.st_size);
+#endif
+    m_owner = false;
+    m_name  = full;
+    return true;
+}
+
+void FrameRingMapping::Close()
+{
+    if (!m_base) return;
+#ifdef _WIN32
+    UnmapViewOfFile(m_base);
+    CloseHandle(static_cast<HANDLE>(m_handle));
+    m_handle = nullptr;
+#else
+    munmap(m_base, m_bytes);
+    close(m_fd);
+    m_fd = -1;
+    if (m_owner) shm_unlink(m_name.c_str());
+#endif
+    m_base  = nullptr;
+    m_bytes = 0;
+}
+
+// ─────────────────────────────────────────────────────────────
+//  FrameRingWriter
+// ─────────────────────────────────────────────────────────────
+bool FrameRingWriter::Create(const std::string& name, uint32_t slotCount, uint32_t slotBytes)
+{
+    if (slotCount == 0) return false;
+
+    const size_t stride = Align64(SLOT_HDR + slotBytes);
+    const size_t total  = sizeof(FrameRingHeader) + stride * slotCount;
+    if (!m_map.Create(name, total))
+        return false;
+
+    uint8_t* base = m_map.Base();
+    m_hdr = new (base) FrameRingHeader;
+    m_hdr->magic      = FRAME_RING_MAGIC;
+    m_hdr->version    = FRAME_RING_VERSION;
+    m_hdr->slotCount  = slotCount;
+    m_hdr->slotBytes  = slotBytes;
+    m_hdr->slotStride = stride;
+    m_hdr->publishSeq.store(0, std::memory_order_relaxed);
+
+    for (uint32_t i = 0; i < slotCount; ++i)
+    {
+        FrameRingSlot* s = new (SlotAt(base, m_hdr, i)) FrameRingSlot;
+        s->seq.store(0, std::memory_order_relaxed);
+        s->publishSeq = 0;
+        s->bytes      = 0;
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    return true;
+}
+
+bool FrameRingWriter::Publish(uint32_t frameID, uint32_t x, uint32_t y,
+                              uint32_t w, uint32_t h,
+                              const uint8_t* bgra, uint32_t stride, uint64_t nowUs,
+                              uint32_t stream, uint32_t band, uint32_t bandCount)
+{
+    const uint64_t rowBytes = static_cast<uint64_t>(w) * 4;
+    const uint64_t bytes    = rowBytes * h;
+    if (!m_hdr || bytes > m_hdr->slotBytes)
+        return false;
+
+    const uint64_t seq  = m_hdr->publishSeq.load(std::memory_order_relaxed);
+    FrameRingSlot* slot = SlotAt(m_map.Base(), m_hdr, seq % m_hdr->slotCount);
+
+    // Enter: odd sequence tells readers the slot is unstable
+    const uint32_t s0 = slot->seq.load(std::memory_order_relaxed);
+    slot->seq.store(s0 + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot->frameID    = frameID;
+    slot->publishSeq = seq + 1;
+    slot->publishUs  = nowUs;
+    slot->x = x; slot->y = y; slot->w = w; slot->h = h;
+    slot->bytes      = static_cast<uint32_t>(bytes);
+    slot->stream     = stream;
+    slot->band       = band;
+    slot->bandCount  = bandCount;
+
+    uint8_t* dst = reinterpret_cast<uint8_t*>(slot) + SLOT_HDR;
+    if (stride == rowBytes)
+        std::memcpy(dst, bgra, static_cast<size_t>(bytes));
+    else
+        for (uint32_t row = 0; row < h; ++row)
+            std::memcpy(dst + row * rowBytes, bgra + static_cast<size_t>(row) * stride,
+                        static_cast<size_t>(rowBytes));
+
+    // Leave: even again, then advertise the new frame
+    slot->seq.store(s0 + 2, std::memory_order_release);
+    m_hdr->publishSeq.store(seq + 1, std::memory_order_release);
+    return true;
+}
+
+uint64_t FrameRingWriter::Published() const
+{
+    return m_hdr ? m_hdr->publishSeq.load(std::memory_order_relaxed) : 0;
+}
+
+// ─────────────────────────────────────────────────────────────
+//  FrameRingReader
+// ─────────────────────────────────────────────────────────────
+bool FrameRingReader::Open(const std::string& name)
+{
+    if (!m_map.Open(name))
+        return false;
+    if (m_map.Bytes() < sizeof(FrameRingHeader))
+        return false;
+
+    m_hdr = reinterpret_cast<const FrameRingHeader*>(m_map.Base());
+    if (m_hdr->magic != FRAME_RING_MAGIC || m_hdr->version != FRAME_RING_VERSION ||
+        m_hdr->slotCount == 0 ||
+        sizeof(FrameRingHeader) + m_hdr->slotStride * m_hdr->slotCount > m_map.Bytes())
+    {
+        m_hdr = nullptr;
+        return false;
+    }
+    return true;
+}
+
+bool FrameRingReader::AcquireLatest(FrameRingView& out, uint64_t afterSeq) const
+{
+    if (!m_hdr) return false;
+
+    const uint64_t pub = m_hdr->publishSeq.load(std::memory_order_acquire);
+    if (pub == 0 || pub <= afterSeq)
+        return false;
+
+    const FrameRingSlot* slot = SlotAt(m_map.Base(), m_hdr, (pub - 1) % m_hdr->slotCount);
+    const uint32_t s = slot->seq.load(std::memory_order_acquire);
+    if (s & 1u)
+        return false;
+
+    out.frameID    = slot->frameID;
+    out.publishSeq = slot->publishSeq;
+    out.publishUs  = slot->publishUs;
+    out.x = slot->x; out.y = slot->y; out.w = slot->w; out.h = slot->h;
+    out.bytes      = slot->bytes;
+    out.stream     = slot->stream;
+    out.band       = slot->band;
+    out.bandCount  = slot->bandCount;
+    out.pixels     = reinterpret_cast<const uint8_t*>(slot) + SLOT_HDR;
+    out.slot       = slot;
+    out.slotSeq    = s;
+
+    // Header fields torn by a concurrent write are caught here already
+    return Validate(out) && out.bytes <= m_hdr->slotBytes;
+}
+
+bool FrameRingReader::Validate(const FrameRingView& v)
+{
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return v.slot && v.slot->seq.load(std::memory_order_relaxed) == v.slotSeq;
+}
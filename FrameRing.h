@@ -0,0 +1,136 @@
+#pragma once
+// ============================================================
+//  FrameRing.h  –  Shared-memory ring of completed frames
+//  Written by a headless ReceiverModule, read zero-copy by any
+//  number of local consumer processes.
+//
+//  Layout (one named mapping):
+//    FrameRingHeader | slot 0 | slot 1 | ... | slot N-1
+//    slot = FrameRingSlot (64 B) | pixel bytes (slotBytes)
+//
+//  Each slot is guarded by a seqlock: the writer makes `seq` odd
+//  while it is inside the slot and even again when done. Readers
+//  look at pixels in place and re-check `seq` afterwards; if it
+//  moved, the frame was overwritten underneath them.
+//
+//  Portable: CreateFileMapping on Windows, shm_open elsewhere.
+// ============================================================
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <string>
+
+static constexpr uint32_t FRAME_RING_MAGIC   = 0x47524B46;   // 'FKRG'
+static constexpr uint32_t FRAME_RING_VERSION = 3;
+
+struct alignas(64) FrameRingHeader
+{
+    uint32_t              magic;
+    uint32_t              version;
+    uint32_t              slotCount;
+    uint32_t              slotBytes;     // pixel capacity of one slot
+    uint64_t              slotStride;    // bytes from one slot header to the next
+    std::atomic<uint64_t> publishSeq;    // frames published so far
+};
+
+struct alignas(64) FrameRingSlot
+{
+    std::atomic<uint32_t> seq;           // seqlock (odd = write in progress)
+    uint32_t              frameID;
+    uint64_t              publishSeq;    // 1-based sequence number of this frame
+    uint64_t              publishUs;     // writer's steady-clock time
+    uint32_t              x, y, w, h;    // placement on the sender surface
+    uint32_t              bytes;         // valid pixel bytes (w*h*4)
+    uint32_t              stream;        // receiver's index of the sending stream
+    uint32_t              band;          // the sender's band this frame replaces …
+    uint32_t              bandCount;     // … of this many (1 = the whole surface)
+};
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free &&
+              std::atomic<uint64_t>::is_always_lock_free,
+              "FrameRing atomics must be address-free for cross-process use");
+static_assert(sizeof(FrameRingHeader) == 64 && sizeof(FrameRingSlot) == 64,
+              "FrameRing layout changed");
+
+// ─── Reader's view of one frame (valid until Validate fails) ─
+struct FrameRingView
+{
+    const uint8_t* pixels     = nullptr;
+    uint32_t       frameID    = 0;
+    uint64_t       publishSeq = 0;
+    uint64_t       publishUs  = 0;
+    uint32_t       x = 0, y = 0, w = 0, h = 0;
+    uint32_t       bytes      = 0;
+    uint32_t       stream     = 0;
+    uint32_t       band       = 0;
+    uint32_t       bandCount  = 1;
+
+    const FrameRingSlot* slot = nullptr;   // for Validate
+    uint32_t       slotSeq    = 0;
+};
+
+// ─── Mapping shared by writer + reader ───────────────────────
+class FrameRingMapping
+{
+public:
+    FrameRingMapping() = default;
+    ~FrameRingMapping() { Close(); }
+    FrameRingMapping(const FrameRingMapping&)            = delete;
+    FrameRingMapping& operator=(const FrameRingMapping&) = delete;
+
+    bool  Create(const std::string& name, size_t bytes);
+    bool  Open  (const std::string& name);
+    void  Close ();
+
+    uint8_t* Base()  const { return m_base; }
+    size_t   Bytes() const { return m_bytes; }
+
+private:
+    uint8_t*    m_base   = nullptr;
+    size_t      m_bytes  = 0;
+    void*       m_handle = nullptr;   // HANDLE on Windows
+    int         m_fd     = -1;        // POSIX shm fd
+    bool        m_owner  = false;
+    std::string m_name;
+};
+
+// ─── Writer (receiver side) ──────────────────────────────────
+class FrameRingWriter
+{
+public:
+    bool Create(const std::string& name, uint32_t slotCount, uint32_t slotBytes);
+
+    // Copy one frame of `stream` in and publish it. Returns false if
+    // it doesn't fit. A frame of band `band` of `bandCount` replaces
+    // only that band's earlier content; the other bands stay.
+    bool Publish(uint32_t frameID, uint32_t x, uint32_t y,
+                 uint32_t w, uint32_t h,
+                 const uint8_t* bgra, uint32_t stride, uint64_t nowUs,
+                 uint32_t stream = 0, uint32_t band = 0, uint32_t bandCount = 1);
+
+    uint64_t Published() const;
+
+private:
+    FrameRingMapping m_map;
+    FrameRingHeader* m_hdr = nullptr;
+};
+
+// ─── Reader (consumer side) ──────────────────────────────────
+class FrameRingReader
+{
+public:
+    bool Open(const std::string& name);
+
+    // Latest published frame. Returns false if nothing new since
+    // `afterSeq` or if the slot is mid-write (caller just retries).
+    bool AcquireLatest(FrameRingView& out, uint64_t afterSeq = 0) const;
+
+    // True if the frame behind `v` was not overwritten while in use
+    static bool Validate(const FrameRingView& v);
+
+    const FrameRingHeader* Header() const { return m_hdr; }
+
+private:
+    FrameRingMapping       m_map;
+    const FrameRingHeader* m_hdr = nullptr;
+};
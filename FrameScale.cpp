@@ -0,0 +1,363 @@
+// ============================================================
+//  FrameScale.cpp  –  Alpha-aware 2:1 / 4:1 down- and upscaling
+//  Zero-Latency Network Video Fuser
+// ============================================================
+
+#include "FrameScale.h"
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define FRAMESCALE_X64 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define FRAMESCALE_AVX2
+#else
+#define FRAMESCALE_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace
+{
+    // x / 255, rounded, for x ≤ 255·255 – exact, and the same
+    // shift-add the AVX2 path does on 16-bit lanes
+    inline uint32_t Div255(uint32_t x)
+    {
+        x += 128;
+        return (x + (x >> 8)) >> 8;
+    }
+
+    // Premultiplied colour sum back to straight colour:
+    // sum·255 / alphaSum + ½, 0 when fully transparent
+    inline uint8_t Unpremultiply(uint32_t sum, uint32_t alphaSum)
+    {
+        return alphaSum ? static_cast<uint8_t>(static_cast<float>(sum) * 255.0f / static_cast<float>(alphaSum) + 0.5f)
+                        : 0;
+    }
+
+    // One output pixel from a bw×bh block. Colour = Σ(c·a) / Σa with
+    // c·a rounded to 8 bits first, alpha = max; all-transparent → 0.
+    void BlockScalar(const uint8_t* src, size_t stride, uint32_t bw, uint32_t bh, uint8_t* out)
+    {
+        uint32_t sum[3] = {}, sumA = 0, maxA = 0;
+        for (uint32_t y = 0; y < bh; ++y)
+        {
+            const uint8_t* p = src + y * stride;
+            for (uint32_t x = 0; x < bw; ++x, p += 4)
+            {
+                const uint32_t a = p[3];
+                sum[0] += Div255(p[0] * a);
+                sum[1] += Div255(p[1] * a);
+                sum[2] += Div255(p[2] * a);
+                sumA   += a;
+                maxA    = std::max(maxA, a);
+            }
+        }
+        for (int c = 0; c < 3; ++c)
+            out[c] = Unpremultiply(sum[c], sumA);
+        out[3] = static_cast<uint8_t>(maxA);
+    }
+
+    // Upscale tap: destination pixel centre x + ½ sits at (x + ½)/f − ½
+    // in the source; in units of 1/(2f) that is 2x + 1 − f, shifted
+    // by 2f so it stays positive. Interior pixels f·k + f/2 + j blend
+    // k and k+1 with weight 2j+1 on k+1.
+    struct Tap { uint32_t i0, i1, w1; };   // weight of i0 is 2f − w1
+
+    inline Tap TapFor(uint32_t x, uint32_t n, uint32_t f)
+    {
+        const uint32_t D   = 2 * f;
+        const uint32_t num = 2 * x + 1 + D - f;
+        const int32_t  i0  = static_cast<int32_t>(num / D) - 1;
+        const uint32_t a   = static_cast<uint32_t>(std::clamp<int32_t>(i0, 0, static_cast<int32_t>(n) - 1));
+        const uint32_t b   = std::min(static_cast<uint32_t>(i0 + 1), n - 1);
+        return Tap{ a, b, num % D };
+    }
+
+#ifdef FRAMESCALE_X64
+    // Premultiply 4 BGRA pixels widened to 16 bits: (c·a)/255 in the
+    // colour slots, a itself in the alpha slot
+    FRAMESCALE_AVX2 inline __m256i Premul(__m256i px)
+    {
+        const __m256i alphaOf = _mm256_setr_epi8(6, 7, 6, 7, 6, 7, 6, 7, 14, 15, 14, 15, 14, 15, 14, 15,
+                                                 6, 7, 6, 7, 6, 7, 6, 7, 14, 15, 14, 15, 14, 15, 14, 15);
+        const __m256i mul = _mm256_blend_epi16(_mm256_shuffle_epi8(px, alphaOf), _mm256_set1_epi16(255), 0x88);
+        __m256i x = _mm256_add_epi16(_mm256_mullo_epi16(px, mul), _mm256_set1_epi16(128));
+        return _mm256_srli_epi16(_mm256_add_epi16(x, _mm256_srli_epi16(x, 8)), 8);
+    }
+
+    // Sums / maxima of 8 / f neighbouring pixels within one
+    // 4-pixel half (lanes hold pixels 0-1 and 2-3)
+    FRAMESCALE_AVX2 inline __m256i SumAcross(__m256i v, uint32_t f)
+    {
+        v = _mm256_add_epi16(v, _mm256_shuffle_epi32(v, 0x4E));
+        if (f == 4) v = _mm256_add_epi16(v, _mm256_permute2x128_si256(v, v, 1));
+        return v;
+    }
+    FRAMESCALE_AVX2 inline __m256i MaxAcross(__m256i v, uint32_t f)
+    {
+        v = _mm256_max_epu16(v, _mm256_shuffle_epi32(v, 0x4E));
+        if (f == 4) v = _mm256_max_epu16(v, _mm256_permute2x128_si256(v, v, 1));
+        return v;
+    }
+
+    // Two pixels of 16-bit premultiplied sums → 32-bit straight BGRA:
+    // Unpremultiply() on each colour slot by its pixel's alpha slot,
+    // then the alpha slot replaced by `alpha`'s
+    FRAMESCALE_AVX2 inline __m256i Resolve(__m128i sums, __m128i alpha)
+    {
+        const __m256i s = _mm256_cvtepu16_epi32(sums);
+        const __m256i a = _mm256_shuffle_epi32(s, 0xFF);   // alpha slot into every slot of its pixel
+        const __m256 c  = _mm256_add_ps(_mm256_div_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(s), _mm256_set1_ps(255.0f)),
+                                                      _mm256_cvtepi32_ps(a)),
+                                        _mm256_set1_ps(0.5f));
+        const __m256i has = _mm256_cmpgt_epi32(a, _mm256_setzero_si256());
+        const __m256i rgb = _mm256_and_si256(_mm256_cvttps_epi32(c), has);
+        return _mm256_blend_epi32(rgb, _mm256_cvtepu16_epi32(alpha), 0x88);
+    }
+
+    // Resolve two pairs of pixels and store them as 4 BGRA pixels
+    FRAMESCALE_AVX2 inline void Store4(uint8_t* out, __m128i first, __m128i second)
+    {
+        __m256i packed = _mm256_packus_epi32(Resolve(first, first), Resolve(second, second));
+        packed = _mm256_packus_epi16(packed, packed);
+        packed = _mm256_permutevar8x32_epi32(packed, _mm256_setr_epi32(0, 4, 1, 5, 0, 4, 1, 5));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm256_castsi256_si128(packed));
+    }
+
+    // One band of f full rows: every run of 8 source pixels that ends
+    // inside the last full block. Returns the output pixels written.
+    FRAMESCALE_AVX2 uint32_t DownBandAVX2(const uint8_t* src, size_t stride, uint32_t fullW, uint32_t f, uint8_t* dst)
+    {
+        const uint32_t outPerRun = 8 / f;
+        // Output order after the packs below: f = 2 → o0 o1 o2 o3, f = 4 → o0 o1
+        const __m256i order = (f == 2) ? _mm256_setr_epi32(0, 1, 4, 5, 0, 1, 4, 5)
+                                       : _mm256_setr_epi32(0, 4, 0, 4, 0, 4, 0, 4);
+        uint32_t x = 0, o = 0;
+        for (; x + 8 <= fullW; x += 8, o += outPerRun)
+        {
+            __m256i sumLo = _mm256_setzero_si256(), sumHi = sumLo, maxLo = sumLo, maxHi = sumLo;
+            for (uint32_t r = 0; r < f; ++r)
+            {
+                const __m256i raw = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + r * stride + x * 4));
+                const __m256i lo  = _mm256_cvtepu8_epi16(_mm256_castsi256_si128(raw));       // pixels 0-3
+                const __m256i hi  = _mm256_cvtepu8_epi16(_mm256_extracti128_si256(raw, 1));  // pixels 4-7
+                sumLo = _mm256_add_epi16(sumLo, Premul(lo));
+                sumHi = _mm256_add_epi16(sumHi, Premul(hi));
+                maxLo = _mm256_max_epu16(maxLo, lo);
+                maxHi = _mm256_max_epu16(maxHi, hi);
+            }
+            // f = 2: lane 0 of lo → o0, lane 1 → o1, hi → o2, o3
+            // f = 4: lo → o0, hi → o1 (in every slot)
+            const __m256i s = _mm256_unpacklo_epi64(SumAcross(sumLo, f), SumAcross(sumHi, f));
+            const __m256i m = _mm256_unpacklo_epi64(MaxAcross(maxLo, f), MaxAcross(maxHi, f));
+
+            const __m256i r0 = Resolve(_mm256_castsi256_si128(s), _mm256_castsi256_si128(m));
+            const __m256i r1 = Resolve(_mm256_extracti128_si256(s, 1), _mm256_extracti128_si256(m, 1));
+            __m256i packed = _mm256_packus_epi32(r0, r1);
+            packed = _mm256_packus_epi16(packed, packed);
+            packed = _mm256_permutevar8x32_epi32(packed, order);
+
+            uint8_t* out = dst + o * 4;
+            if (f == 2) _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm256_castsi256_si128(packed));
+            else        _mm_storel_epi64(reinterpret_cast<__m128i*>(out), _mm256_castsi256_si128(packed));
+        }
+        return o;
+    }
+
+    // Vertical upscale pass: premultiplied row0·w0 + row1·w1 for the
+    // first multiple of 8 pixels of `n`. Returns the pixels done.
+    FRAMESCALE_AVX2 uint32_t UpRowsAVX2(const uint8_t* row0, const uint8_t* row1, uint32_t w0, uint32_t w1,
+                                        uint32_t n, uint16_t* out)
+    {
+        const __m256i m0 = _mm256_set1_epi16(static_cast<short>(w0));
+        const __m256i m1 = _mm256_set1_epi16(static_cast<short>(w1));
+        uint32_t i = 0;
+        for (; i + 8 <= n; i += 8)
+        {
+            const __m256i r0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row0 + i * 4));
+            const __m256i r1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row1 + i * 4));
+            const __m256i lo = _mm256_add_epi16(
+                _mm256_mullo_epi16(Premul(_mm256_cvtepu8_epi16(_mm256_castsi256_si128(r0))), m0),
+                _mm256_mullo_epi16(Premul(_mm256_cvtepu8_epi16(_mm256_castsi256_si128(r1))), m1));
+            const __m256i hi = _mm256_add_epi16(
+                _mm256_mullo_epi16(Premul(_mm256_cvtepu8_epi16(_mm256_extracti128_si256(r0, 1))), m0),
+                _mm256_mullo_epi16(Premul(_mm256_cvtepu8_epi16(_mm256_extracti128_si256(r1, 1))), m1));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i * 4),      lo);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i * 4 + 16), hi);
+        }
+        return i;
+    }
+
+    // Horizontal upscale pass over interior destination pixels
+    // f·k + f/2 + j, 4 source pixels k at a time, while k+4 exists
+    // and the run stays inside dstW. Returns the source pixels done.
+    FRAMESCALE_AVX2 uint32_t UpColsAVX2(const uint16_t* rows, uint32_t n, uint32_t f, uint32_t dstW, uint8_t* out)
+    {
+        const uint32_t D     = 2 * f;
+        const int      shift = (f == 2) ? 4 : 6;
+        const __m256i  half  = _mm256_set1_epi16(static_cast<short>(1 << (shift - 1)));
+        uint32_t k = 0;
+        for (; k + 4 < n && f * (k + 4) + f / 2 <= dstW; k += 4)
+        {
+            const __m256i p = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rows + k * 4));
+            const __m256i q = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rows + k * 4 + 4));
+            __m256i r[4];
+            for (uint32_t j = 0; j < f; ++j)
+            {
+                const __m256i w1 = _mm256_set1_epi16(static_cast<short>(2 * j + 1));
+                const __m256i w0 = _mm256_set1_epi16(static_cast<short>(D - 2 * j - 1));
+                r[j] = _mm256_srli_epi16(_mm256_add_epi16(_mm256_add_epi16(_mm256_mullo_epi16(p, w0),
+                                                                           _mm256_mullo_epi16(q, w1)), half), shift);
+            }
+            // r[j] holds phase j of pixels k..k+3 (lane 0: k, k+1; lane 1: k+2, k+3)
+            uint8_t* o = out + static_cast<size_t>(f * k + f / 2) * 4;
+            if (f == 2)
+            {
+                const __m256i even = _mm256_unpacklo_epi64(r[0], r[1]);   // k, k+2
+                const __m256i odd  = _mm256_unpackhi_epi64(r[0], r[1]);   // k+1, k+3
+                Store4(o,      _mm256_castsi256_si128(even),      _mm256_castsi256_si128(odd));
+                Store4(o + 16, _mm256_extracti128_si256(even, 1), _mm256_extracti128_si256(odd, 1));
+            }
+            else
+            {
+                const __m256i even01 = _mm256_unpacklo_epi64(r[0], r[1]), even23 = _mm256_unpacklo_epi64(r[2], r[3]);
+                const __m256i odd01  = _mm256_unpackhi_epi64(r[0], r[1]), odd23  = _mm256_unpackhi_epi64(r[2], r[3]);
+                Store4(o,      _mm256_castsi256_si128(even01),      _mm256_castsi256_si128(even23));
+                Store4(o + 16, _mm256_castsi256_si128(odd01),       _mm256_castsi256_si128(odd23));
+                Store4(o + 32, _mm256_extracti128_si256(even01, 1), _mm256_extracti128_si256(even23, 1));
+                Store4(o + 48, _mm256_extracti128_si256(odd01, 1),  _mm256_extracti128_si256(odd23, 1));
+            }
+        }
+        return k;
+    }
+#endif
+}
+
+namespace FrameScale
+{
+    bool HasAVX2()
+    {
+#ifdef FRAMESCALE_X64
+#if defined(_MSC_VER)
+        static const bool has = []
+        {
+            int r[4];
+            __cpuid(r, 0);
+            if (r[0] < 7) return false;
+            __cpuid(r, 1);
+            const bool osxsave = (r[2] & (1 << 27)) != 0;
+            if (!osxsave || (_xgetbv(0) & 0x6) != 0x6) return false;   // OS saves YMM state
+            __cpuidex(r, 7, 0);
+            return (r[1] & (1 << 5)) != 0;
+        }();
+        return has;
+#else
+        static const bool has = __builtin_cpu_supports("avx2");
+        return has;
+#endif
+#else
+        return false;
+#endif
+    }
+
+    void Downscale(const uint8_t* src, size_t srcStride, uint32_t w, uint32_t h,
+                   uint32_t factor, uint8_t* dst)
+    {
+        const uint32_t outW  = ScaledSize(w, factor);
+        const uint32_t outH  = ScaledSize(h, factor);
+        const uint32_t fullW = (w / factor) * factor;   // columns in whole blocks
+        const bool     simd  = HasAVX2() && (factor == 2 || factor == 4);
+
+        for (uint32_t oy = 0; oy < outH; ++oy)
+        {
+            const uint8_t* band = src + static_cast<size_t>(oy) * factor * srcStride;
+            uint8_t*       out  = dst + static_cast<size_t>(oy) * outW * 4;
+            const uint32_t bh   = std::min(factor, h - oy * factor);
+
+            uint32_t ox = 0;
+#ifdef FRAMESCALE_X64
+            if (simd && bh == factor)
+                ox = DownBandAVX2(band, srcStride, fullW, factor, out);
+#else
+            (void)simd; (void)fullW;
+#endif
+            for (; ox < outW; ++ox)
+                BlockScalar(band + ox * factor * 4, srcStride, std::min(factor, w - ox * factor), bh, out + ox * 4);
+        }
+    }
+
+    void Upscale(const uint8_t* src, size_t srcStride, uint32_t srcW, uint32_t srcH,
+                 uint32_t factor, uint8_t* dst, size_t dstStride, uint32_t dstW, uint32_t dstH)
+    {
+        if (srcW == 0 || srcH == 0 || dstW == 0)
+            return;
+        if (factor <= 1)
+        {
+            for (uint32_t y = 0; y < dstH; ++y)
+                std::memcpy(dst + y * dstStride, src + y * srcStride, static_cast<size_t>(dstW) * 4);
+            return;
+        }
+
+        const uint32_t D     = 2 * factor;
+        const uint32_t shift = (factor == 2) ? 4 : 6;   // log2(D·D)
+        const uint32_t half  = 1u << (shift - 1);
+        const bool     simd  = HasAVX2();
+
+        std::vector<Tap> cols(dstW);
+        for (uint32_t x = 0; x < dstW; ++x)
+            cols[x] = TapFor(x, srcW, factor);
+        const uint32_t usedW = cols[dstW - 1].i1 + 1;
+
+        // Separable, in premultiplied space: two source rows blend into
+        // `rows` (×D, ≤ 2040), then pairs of its pixels into the output
+        // (×D², ≤ 16320 – both fit 16 bits), which is unpremultiplied
+        std::vector<uint16_t> rows(static_cast<size_t>(usedW) * 4 + 16);
+        for (uint32_t y = 0; y < dstH; ++y)
+        {
+            const Tap      ty   = TapFor(y, srcH, factor);
+            const uint8_t* row0 = src + ty.i0 * srcStride;
+            const uint8_t* row1 = src + ty.i1 * srcStride;
+            const uint32_t wy0  = D - ty.w1, wy1 = ty.w1;
+
+            uint32_t i = 0;
+#ifdef FRAMESCALE_X64
+            if (simd) i = UpRowsAVX2(row0, row1, wy0, wy1, usedW, rows.data());
+#endif
+            for (i *= 4; i < usedW * 4; i += 4)
+            {
+                const uint32_t a0 = row0[i + 3], a1 = row1[i + 3];
+                for (int c = 0; c < 3; ++c)
+                    rows[i + c] = static_cast<uint16_t>(Div255(row0[i + c] * a0) * wy0 + Div255(row1[i + c] * a1) * wy1);
+                rows[i + 3] = static_cast<uint16_t>(a0 * wy0 + a1 * wy1);
+            }
+
+            uint8_t* out = dst + y * dstStride;
+            auto pixel = [&](uint32_t x)
+            {
+                const Tap&      tx = cols[x];
+                const uint16_t* p0 = rows.data() + tx.i0 * 4;
+                const uint16_t* p1 = rows.data() + tx.i1 * 4;
+                const uint32_t  w0 = D - tx.w1, w1 = tx.w1;
+                const uint32_t  a  = (p0[3] * w0 + p1[3] * w1 + half) >> shift;
+                uint8_t*        o  = out + x * 4;
+                for (int c = 0; c < 3; ++c)
+                    o[c] = Unpremultiply((p0[c] * w0 + p1[c] * w1 + half) >> shift, a);
+                o[3] = static_cast<uint8_t>(a);
+            };
+
+            // Left edge (clamped), interior runs, then the rest
+            uint32_t x = 0;
+            for (; x < std::min(factor / 2, dstW); ++x)
+                pixel(x);
+#ifdef FRAMESCALE_X64
+            if (simd)
+                x += factor * UpColsAVX2(rows.data(), usedW, factor, dstW, out);
+#endif
+            for (; x < dstW; ++x)
+                pixel(x);
+        }
+    }
+}
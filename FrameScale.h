@@ -0,0 +1,37 @@
+#pragma once
+// ============================================================
+//  FrameScale.h  –  2:1 / 4:1 resolution scaling of BGRA rects
+//  The sender can shrink a cropped frame before packetising it
+//  (FrameMetaPayload::scale); the receiver scales it back up to
+//  the original rectangle before it reaches the surface.
+//
+//  Both directions are alpha-aware: colour is averaged weighted
+//  by alpha, so fully transparent pixels don't darken the edges
+//  of what is drawn. Downscaling keeps the block's highest alpha,
+//  so a one-pixel line stays opaque.
+//  Portable – no Windows headers.
+// ============================================================
+#include <cstddef>
+#include <cstdint>
+
+namespace FrameScale
+{
+    static constexpr uint32_t MAX_FACTOR = 4;   // supported factors: 1, 2, 4
+
+    inline bool     ValidFactor(uint32_t f)               { return f == 1 || f == 2 || f == 4; }
+    inline uint32_t ScaledSize(uint32_t n, uint32_t f)     { return (n + f - 1) / f; }
+
+    // Box-filter `w`×`h` pixels (rows `srcStride` bytes apart) by
+    // `factor` (2 or 4) into a tight ScaledSize(w)×ScaledSize(h)
+    // dst. Edge blocks cover only the pixels that exist. AVX2 when
+    // the CPU has it; same result either way.
+    void Downscale(const uint8_t* src, size_t srcStride, uint32_t w, uint32_t h,
+                   uint32_t factor, uint8_t* dst);
+
+    // Bilinear: `srcW`×`srcH` (rows `srcStride` bytes apart) → the
+    // top-left `dstW`×`dstH` of the image `factor` times larger
+    void Upscale(const uint8_t* src, size_t srcStride, uint32_t srcW, uint32_t srcH,
+                 uint32_t factor, uint8_t* dst, size_t dstStride, uint32_t dstW, uint32_t dstH);
+
+    bool HasAVX2();
+}
@@ -0,0 +1,54 @@
+// ============================================================
+//  FuserUtil.cpp  –  FuserUtil helpers (INI, logging, priority)
+//  Zero-Latency Network Video Fuser
+// ============================================================
+
+#include "NetworkFuser.h"
+
+namespace FuserUtil
+{
+    // Minimal INI reader – no external deps
+    std::string ReadIniString(const std::string& path,
+                              const std::string& section,
+                              const std::string& key,
+                              const std::string& defaultVal)
+    {
+        char buf[1024]{};
+        DWORD ret = GetPrivateProfileStringA(
+            section.c_str(), key.c_str(), defaultVal.c_str(),
+            buf, sizeof(buf), path.c_str());
+        return std::string(buf, ret);
+    }
+
+    int ReadIniInt(const std::string& path,
+                   const std::string& section,
+                   const std::string& key,
+                   int defaultVal)
+    {
+        return static_cast<int>(GetPrivateProfileIntA(
+            section.c_str(), key.c_str(), defaultVal, path.c_str()));
+    }
+
+    void Log(const char* fmt, ...)
+    {
+        va_list args;
+        va_start(args, fmt);
+        // Route through Logger so every existing call goes to the log file
+        Logger::WriteV(LogLevel::Info, fmt, args);
+        va_end(args);
+    }
+
+    void ElevateProcessPriority()
+    {
+        if (!SetPriorityClass(GetCurrentProcess(), REALTIME_PRIORITY_CLASS))
+            FuserUtil::Log("[Main] SetPriorityClass REALTIME failed: %u\n", GetLastError());
+        if (!SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL))
+            FuserUtil::Log("[Main] SetThreadPriority TIME_CRITICAL failed: %u\n", GetLastError());
+    }
+
+    void PinThreadToCore(DWORD coreIndex)
+    {
+        DWORD_PTR mask = static_cast<DWORD_PTR>(1) << coreIndex;
+        SetThreadAffinityMask(GetCurrentThread(), mask);
+    }
+}
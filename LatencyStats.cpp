@@ -0,0 +1,165 @@
+// ============================================================
+//  LatencyStats.cpp  –  Log-linear latency histograms
+//  Zero-Latency Network Video Fuser
+// ============================================================
+
+#include "LatencyStats.h"
+#include <cstdio>
+
+// ─────────────────────────────────────────────────────────────
+//  LatencyHistogram
+// ─────────────────────────────────────────────────────────────
+uint32_t LatencyHistogram::BucketOf(uint64_t us)
+{
+    if (us < LATENCY_LINEAR)
+        return static_cast<uint32_t>(us);
+    if (us >= (1ull << LATENCY_MAX_LOG2))
+        return LATENCY_BUCKETS - 1;
+
+    uint32_t e = 0;
+    for (uint64_t v = us; v > 1; v >>= 1) ++e;            // floor(log2)
+
+    const uint32_t shift = e - LATENCY_SUB_BITS;
+    const uint32_t sub   = static_cast<uint32_t>(us >> shift) - (1u << LATENCY_SUB_BITS);
+    return LATENCY_LINEAR + (e - LATENCY_SUB_BITS - 1) * (1u << LATENCY_SUB_BITS) + sub;
+}
+
+uint64_t LatencyHistogram::BucketMidUs(uint32_t bucket)
+{
+    if (bucket < LATENCY_LINEAR)
+        return bucket;
+
+    const uint32_t rel   = bucket - LATENCY_LINEAR;
+    const uint32_t e     = LATENCY_SUB_BITS + 1 + rel / (1u << LATENCY_SUB_BITS);
+    const uint32_t sub   = rel % (1u << LATENCY_SUB_BITS);
+    const uint32_t shift = e - LATENCY_SUB_BITS;
+    const uint64_t lo    = static_cast<uint64_t>((1u << LATENCY_SUB_BITS) + sub) << shift;
+    return lo + ((1ull << shift) >> 1);
+}
+
+void LatencyHistogram::Record(uint64_t us)
+{
+    m_counts[BucketOf(us)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void LatencyHistogram::Snapshot(LatencySnapshot& out) const
+{
+    out.total = 0;
+    for (uint32_t i = 0; i < LATENCY_BUCKETS; ++i)
+    {
+        out.counts[i] = m_counts[i].load(std::memory_order_relaxed);
+        out.total    += out.counts[i];
+    }
+}
+
+// ─────────────────────────────────────────────────────────────
+//  LatencySnapshot
+// ─────────────────────────────────────────────────────────────
+uint64_t LatencySnapshot::Percentile(double q) const
+{
+    if (total == 0)
+        return 0;
+
+    // Smallest bucket whose cumulative count reaches ceil(q * total)
+    uint64_t rank = static_cast<uint64_t>(q * static_cast<double>(total) + 0.999999);
+    if (rank == 0)     rank = 1;
+    if (rank > total)  rank = total;
+
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < LATENCY_BUCKETS; ++i)
+    {
+        seen += counts[i];
+        if (seen >= rank)
+            return LatencyHistogram::BucketMidUs(i);
+    }
+    return LatencyHistogram::BucketMidUs(LATENCY_BUCKETS - 1);
+}
+
+LatencySnapshot LatencySnapshot::Since(const LatencySnapshot& older) const
+{
+    LatencySnapshot d;
+    for (uint32_t i = 0; i < LATENCY_BUCKETS; ++i)
+    {
+        d.counts[i] = counts[i] - older.counts[i];
+        d.total    += d.counts[i];
+    }
+    return d;
+}
+
+// ─────────────────────────────────────────────────────────────
+//  LatencyStats
+// ─────────────────────────────────────────────────────────────
+const char* LatencyStageName(LatencyStage s)
+{
+    switch (s)
+    {
+    case LatencyStage::CaptureToEncode:   return "capture->encode";
+    case LatencyStage::EncodeToSend:      return "encode->send";
+    case LatencyStage::SendToArrival:     return "send->arrival";
+    case LatencyStage::ArrivalToComplete: return "arrival->complete";
+    case LatencyStage::CompleteToPresent: return "complete->present";
+    case LatencyStage::CaptureToPresent:  return "capture->present";
+    default:                              return "?";
+    }
+}
+
+void LatencyStats::SetClockOffsetUs(int64_t offsetUs)
+{
+    m_offsetUs.store(offsetUs, std::memory_order_relaxed);
+    m_offsetValid.store(true, std::memory_order_release);
+}
+
+void LatencyStats::RecordFrame(const FrameTimestamps& t, bool senderSynced)
+{
+    auto span = [](uint64_t from, uint64_t to) -> uint64_t { return to > from ? to - from : 0; };
+    auto rec  = [this](LatencyStage s, uint64_t us) { m_hist[static_cast<size_t>(s)].Record(us); };
+
+    // Same-clock stages. A zero sender stamp means the sender didn't
+    // fill it (e.g. a replayed trace from an older build).
+    if (t.senderCaptureUs && t.senderEncodeUs)
+        rec(LatencyStage::CaptureToEncode, span(t.senderCaptureUs, t.senderEncodeUs));
+    if (t.senderEncodeUs && t.senderSendUs)
+        rec(LatencyStage::EncodeToSend,    span(t.senderEncodeUs, t.senderSendUs));
+    rec(LatencyStage::ArrivalToComplete,   span(t.arrivalUs,  t.completeUs));
+    rec(LatencyStage::CompleteToPresent,   span(t.completeUs, t.presentUs));
+
+    // Cross-machine stages: map sender stamps onto the receiver clock
+    if (!senderSynced || !HasClockOffset())
+        return;
+    const int64_t off = ClockOffsetUs();
+    auto toLocal = [off](uint64_t senderUs) { return static_cast<uint64_t>(static_cast<int64_t>(senderUs) + off); };
+
+    if (t.senderSendUs)
+        rec(LatencyStage::SendToArrival,    span(toLocal(t.senderSendUs),    t.arrivalUs));
+    if (t.senderCaptureUs)
+        rec(LatencyStage::CaptureToPresent, span(toLocal(t.senderCaptureUs), t.presentUs));
+}
+
+void LatencyStats::Snapshot(LatencyStage s, LatencySnapshot& out) const
+{
+    m_hist[static_cast<size_t>(s)].Snapshot(out);
+}
+
+void LatencyStats::WindowReport(std::string& out)
+{
+    out.clear();
+    LatencySnapshot now;
+    char line[160];
+    for (size_t i = 0; i < STAGES; ++i)
+    {
+        m_hist[i].Snapshot(now);
+        const LatencySnapshot w = now.Since(m_windowStart[i]);
+        m_windowStart[i] = now;
+        if (w.total == 0)
+            continue;
+
+        std::snprintf(line, sizeof(line),
+                      "  %-18s p50 %6llu  p99 %6llu  p99.9 %6llu us  (n=%llu)\n",
+                      LatencyStageName(static_cast<LatencyStage>(i)),
+                      static_cast<unsigned long long>(w.Percentile(0.50)),
+                      static_cast<unsigned long long>(w.Percentile(0.99)),
+                      static_cast<unsigned long long>(w.Percentile(0.999)),
+                      static_cast<unsigned long long>(w.total));
+        out += line;
+    }
+}
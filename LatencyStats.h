@@ -0,0 +1,105 @@
+#pragma once
+// ============================================================
+//  LatencyStats.h  –  Per-stage frame latency histograms
+//  The sender stamps capture / encode-done / first-send times
+//  into FrameMetaPayload; the receiver adds first-arrival,
+//  frame-complete and present times and records every stage.
+//
+//  Histograms are log-linear in µs (exact below 64 µs, ~3 %
+//  bucket width above). One thread records; any thread may take
+//  a snapshot.
+//
+//  Portable – no Windows headers.
+// ============================================================
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// ─── Histogram ───────────────────────────────────────────────
+static constexpr uint32_t LATENCY_SUB_BITS = 5;                         // 32 buckets per octave
+static constexpr uint32_t LATENCY_LINEAR   = 2u << LATENCY_SUB_BITS;    // exact below 64 µs
+static constexpr uint32_t LATENCY_MAX_LOG2 = 31;                        // clamp at ~35 min
+static constexpr uint32_t LATENCY_BUCKETS  =
+    LATENCY_LINEAR + (LATENCY_MAX_LOG2 - LATENCY_SUB_BITS - 1) * (1u << LATENCY_SUB_BITS);
+
+struct LatencySnapshot
+{
+    std::array<uint64_t, LATENCY_BUCKETS> counts{};
+    uint64_t total = 0;
+
+    // Value (µs) at quantile q in [0,1]; 0 if empty
+    uint64_t Percentile(double q) const;
+
+    // this − older (for a windowed view of a cumulative histogram)
+    LatencySnapshot Since(const LatencySnapshot& older) const;
+};
+
+class LatencyHistogram
+{
+public:
+    void Record(uint64_t us);
+    void Snapshot(LatencySnapshot& out) const;
+
+    static uint32_t BucketOf(uint64_t us);
+    static uint64_t BucketMidUs(uint32_t bucket);
+
+private:
+    std::array<std::atomic<uint64_t>, LATENCY_BUCKETS> m_counts{};
+};
+
+// ─── Pipeline stages ─────────────────────────────────────────
+enum class LatencyStage : uint32_t
+{
+    CaptureToEncode,    // sender: frame acquired → bbox + crop done
+    EncodeToSend,       // sender: crop done → first packet handed to the socket
+    SendToArrival,      // wire:   first packet sent → first packet received   (needs clock offset)
+    ArrivalToComplete,  // receiver: first packet → last packet of the frame
+    CompleteToPresent,  // receiver: frame complete → presented / published
+    CaptureToPresent,   // end to end                                           (needs clock offset)
+    Count
+};
+
+const char* LatencyStageName(LatencyStage s);
+
+// Timestamps of one frame. sender* are on the sender's steady
+// clock, the rest on the receiver's.
+struct FrameTimestamps
+{
+    uint64_t senderCaptureUs = 0;
+    uint64_t senderEncodeUs  = 0;
+    uint64_t senderSendUs    = 0;
+    uint64_t arrivalUs       = 0;
+    uint64_t completeUs      = 0;
+    uint64_t presentUs       = 0;
+};
+
+// ─── All stages + reporting window ───────────────────────────
+class LatencyStats
+{
+public:
+    // receiverClock − senderClock. Until this is set the two
+    // cross-machine stages are not recorded.
+    void    SetClockOffsetUs(int64_t offsetUs);
+    bool    HasClockOffset() const { return m_offsetValid.load(std::memory_order_relaxed); }
+    int64_t ClockOffsetUs()  const { return m_offsetUs.load(std::memory_order_relaxed); }
+
+    // senderSynced = false: the frame came from a sender other than
+    // the one the clock offset was measured against
+    void    RecordFrame(const FrameTimestamps& t, bool senderSynced = true);
+
+    void    Snapshot(LatencyStage s, LatencySnapshot& out) const;
+
+    // One line per stage with p50/p99/p99.9 over the frames recorded
+    // since the previous call, then starts a new window.
+    // Call from a single thread.
+    void    WindowReport(std::string& out);
+
+private:
+    static constexpr size_t STAGES = static_cast<size_t>(LatencyStage::Count);
+
+    std::array<LatencyHistogram, STAGES> m_hist;
+    std::array<LatencySnapshot,  STAGES> m_windowStart;
+    std::atomic<int64_t>                 m_offsetUs{0};
+    std::atomic<bool>                    m_offsetValid{false};
+};
@@ -10,6 +10,8 @@
 #include <ctime>
 #include <cassert>
 #include <algorithm>
+#include <atomic>
+#include <cstddef>
 #include <shlobj.h>    // SHCreateDirectoryExA
 
 #pragma comment(lib, "dbghelp.lib")
@@ -36,6 +38,278 @@ namespace
     size_t    g_ringCount= 0;
 }
 
+// ─── Async mode: bounded MPSC ring of captured log calls ─────
+//  Producers claim a slot with one CAS on g_tail (Vyukov bounded
+//  queue), fill it and publish it through the slot's sequence
+//  number. The single writer thread consumes in order.
+namespace
+{
+    constexpr size_t   ASYNC_SLOTS    = 2048;             // power of two
+    constexpr size_t   ASYNC_MAX_ARGS = 16;
+    constexpr size_t   ASYNC_TEXT     = 448;              // copied %s args / preformatted text (record = 640 B)
+    constexpr size_t   ASYNC_BATCH    = 64 * 1024;        // bytes per WriteFile
+    constexpr DWORD    ASYNC_IDLE_MS  = 2;
+
+    enum class ArgType : uint8_t { Int, Long, LongLong, SizeT, PtrDiff, Double, Ptr, Str };
+
+    union ArgValue
+    {
+        int         i;
+        long        l;
+        long long   ll;
+        size_t      z;
+        ptrdiff_t   t;
+        double      d;
+        const void* p;
+        size_t      str;      // offset into LogRecord::text
+    };
+
+    struct alignas(64) LogRecord
+    {
+        std::atomic<uint64_t> seq;
+        FILETIME              time;
+        const char*           fmt;      // nullptr → text holds the finished message
+        LogLevel              level;
+        uint8_t               argc;
+        uint32_t              suppressed;   // rate-limited site: calls skipped before this one
+        ArgType               types[ASYNC_MAX_ARGS];
+        ArgValue              args[ASYNC_MAX_ARGS];
+        char                  text[ASYNC_TEXT];
+    };
+
+    LogRecord                 g_async[ASYNC_SLOTS];
+    alignas(64) std::atomic<uint64_t> g_tail{0};
+    alignas(64) uint64_t      g_head = 0;                 // writer only
+    std::atomic<uint64_t>     g_dropped{0};
+    std::atomic<bool>         g_asyncRun{false};
+    HANDLE                    g_asyncThread = nullptr;
+
+    // ── printf conversion parser shared by capture + replay ──
+    struct FmtSpec
+    {
+        const char* end;      // one past the conversion character
+        int         stars;    // '*' width / precision arguments
+        ArgType     intType;  // from the length modifier
+        char        conv;
+        bool        wide;     // %ls / %lc – not replayable
+        bool        longDbl;  // %Lf – not replayable
+    };
+
+    // p points just past '%'
+    FmtSpec ParseSpec(const char* p)
+    {
+        FmtSpec s{ p, 0, ArgType::Int, '\0', false, false };
+        while (*p == '-' || *p == '+' || *p == ' ' || *p == '#' || *p == '0' || *p == '\'') ++p;
+        if (*p == '*') { ++s.stars; ++p; } else while (*p >= '0' && *p <= '9') ++p;
+        if (*p == '.')
+        {
+            ++p;
+            if (*p == '*') { ++s.stars; ++p; } else while (*p >= '0' && *p <= '9') ++p;
+        }
+
+        if (*p == 'h')      { ++p; if (*p == 'h') ++p; }
+        else if (*p == 'l') { ++p; if (*p == 'l') { ++p; s.intType = ArgType::LongLong; }
+                              else { s.intType = ArgType::Long; s.wide = true; } }
+        else if (*p == 'z') { ++p; s.intType = ArgType::SizeT; }
+        else if (*p == 't') { ++p; s.intType = ArgType::PtrDiff; }
+        else if (*p == 'L') { ++p; s.longDbl = true; }
+        else if (*p == 'I')
+        {
+            if      (p[1] == '6' && p[2] == '4') { p += 3; s.intType = ArgType::LongLong; }
+            else if (p[1] == '3' && p[2] == '2') { p += 3; }
+            else                                 { p += 1; s.intType = ArgType::SizeT; }
+        }
+
+        s.conv = *p;
+        s.end  = *p ? p + 1 : p;
+        return s;
+    }
+
+    // Pull every argument off the va_list with its real type.
+    // Returns false for anything that can't be replayed faithfully
+    // (%n, %j, wide chars/strings, long double, too many args or too
+    // much string data) – the caller then preformats instead.
+    bool CaptureArgs(LogRecord& r, const char* fmt, va_list args)
+    {
+        size_t textUsed = 0;
+        r.argc = 0;
+        for (const char* p = fmt; *p; )
+        {
+            if (*p++ != '%') continue;
+            if (*p == '%') { ++p; continue; }
+
+            const FmtSpec s = ParseSpec(p);
+            p = s.end;
+            if (r.argc + static_cast<size_t>(s.stars) + 1 > ASYNC_MAX_ARGS || s.longDbl)
+                return false;
+            for (int i = 0; i < s.stars; ++i)
+            {
+                r.types[r.argc]  = ArgType::Int;
+                r.args[r.argc++].i = va_arg(args, int);
+            }
+
+            ArgType&  t = r.types[r.argc];
+            ArgValue& v = r.args[r.argc];
+            switch (s.conv)
+            {
+            case 'd': case 'i': case 'u': case 'o': case 'x': case 'X':
+                t = s.intType;
+                switch (t)
+                {
+                case ArgType::Long:     v.l  = va_arg(args, long);      break;
+                case ArgType::LongLong: v.ll = va_arg(args, long long); break;
+                case ArgType::SizeT:    v.z  = va_arg(args, size_t);    break;
+                case ArgType::PtrDiff:  v.t  = va_arg(args, ptrdiff_t); break;
+                default:                v.i  = va_arg(args, int);       break;
+                }
+                break;
+            case 'c':
+                if (s.wide) return false;
+                t = ArgType::Int; v.i = va_arg(args, int);
+                break;
+            case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+                t = ArgType::Double; v.d = va_arg(args, double);
+                break;
+            case 'p':
+                t = ArgType::Ptr; v.p = va_arg(args, const void*);
+                break;
+            case 's':
+            {
+                if (s.wide) return false;
+                const char* str = va_arg(args, const char*);
+                if (!str) str = "(null)";
+                const size_t n = strlen(str) + 1;
+                if (textUsed + n > ASYNC_TEXT) return false;
+                memcpy(r.text + textUsed, str, n);
+                t = ArgType::Str; v.str = textUsed;
+                textUsed += n;
+                break;
+            }
+            default:
+                return false;
+            }
+            ++r.argc;
+        }
+        return true;
+    }
+
+    // Re-run each conversion through snprintf with its own argument
+    size_t RenderRecord(const LogRecord& r, char* out, size_t cap)
+    {
+        if (!r.fmt)
+        {
+            const size_t n = strnlen(r.text, std::min(cap - 1, ASYNC_TEXT));
+            memcpy(out, r.text, n);
+            out[n] = '\0';
+            return n;
+        }
+
+        size_t  n  = 0;
+        uint8_t ai = 0;
+        char    spec[32];
+        for (const char* p = r.fmt; *p && n + 1 < cap; )
+        {
+            if (*p != '%')      { out[n++] = *p++; continue; }
+            if (p[1] == '%')    { out[n++] = '%'; p += 2; continue; }
+
+            const FmtSpec s   = ParseSpec(p + 1);
+            const size_t  len = static_cast<size_t>(s.end - p);
+            if (len >= sizeof(spec) || ai + s.stars >= r.argc + 1) break;
+            memcpy(spec, p, len);
+            spec[len] = '\0';
+            p = s.end;
+
+            int st[2] = { 0, 0 };
+            for (int i = 0; i < s.stars; ++i) st[i] = r.args[ai++].i;
+            if (ai >= r.argc) break;
+
+            const ArgType  t = r.types[ai];
+            const ArgValue v = r.args[ai++];
+            auto put = [&](auto val)
+            {
+                int w = 0;
+                switch (s.stars)
+                {
+                case 0:  w = snprintf(out + n, cap - n, spec, val);               break;
+                case 1:  w = snprintf(out + n, cap - n, spec, st[0], val);        break;
+                default: w = snprintf(out + n, cap - n, spec, st[0], st[1], val); break;
+                }
+                if (w > 0) n += std::min(static_cast<size_t>(w), cap - n - 1);
+            };
+            switch (t)
+            {
+            case ArgType::Int:      put(v.i);  break;
+            case ArgType::Long:     put(v.l);  break;
+            case ArgType::LongLong: put(v.ll); break;
+            case ArgType::SizeT:    put(v.z);  break;
+            case ArgType::PtrDiff:  put(v.t);  break;
+            case ArgType::Double:   put(v.d);  break;
+            case ArgType::Ptr:      put(v.p);  break;
+            case ArgType::Str:      put(static_cast<const char*>(r.text + v.str)); break;
+            }
+        }
+        out[n] = '\0';
+        return n;
+    }
+
+    // Rate-limited sites report what they skipped at the end of the
+    // line they do let through. Works on a message with or without
+    // its trailing newline; returns the new length.
+    size_t AppendSuppressed(char* msg, size_t len, size_t cap, uint32_t suppressed)
+    {
+        if (!suppressed) return len;
+        while (len > 0 && msg[len - 1] == '\n') --len;
+        int n = snprintf(msg + len, cap - len, " [+%u suppressed]", suppressed);
+        return n > 0 ? std::min(len + static_cast<size_t>(n), cap - 1) : len;
+    }
+
+    // Producer side. Never blocks: a full ring drops the message.
+    void EnqueueAsync(LogLevel level, uint32_t suppressed, const char* fmt, va_list args)
+    {
+        uint64_t   pos  = g_tail.load(std::memory_order_relaxed);
+        LogRecord* slot = nullptr;
+        for (;;)
+        {
+            slot = &g_async[pos & (ASYNC_SLOTS - 1)];
+            const uint64_t  seq = slot->seq.load(std::memory_order_acquire);
+            const int64_t   dif = static_cast<int64_t>(seq) - static_cast<int64_t>(pos);
+            if (dif == 0)
+            {
+                if (g_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (dif < 0)
+            {
+                g_dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            else
+            {
+                pos = g_tail.load(std::memory_order_relaxed);
+            }
+        }
+
+        GetSystemTimePreciseAsFileTime(&slot->time);
+        slot->level      = level;
+        slot->suppressed = suppressed;
+
+        va_list copy;
+        va_copy(copy, args);
+        if (CaptureArgs(*slot, fmt, copy))
+        {
+            slot->fmt = fmt;
+        }
+        else
+        {
+            slot->fmt = nullptr;
+            vsnprintf(slot->text, ASYNC_TEXT, fmt, args);
+        }
+        va_end(copy);
+
+        slot->seq.store(pos + 1, std::memory_order_release);
+    }
+}
+
 // ─────────────────────────────────────────────────────────────
 //  Internal: timestamp string
 // ─────────────────────────────────────────────────────────────
@@ -59,10 +333,25 @@ std::string Logger::TimestampNow(bool forFileName)
     return std::string(buf);
 }
 
+// Same layout as TimestampNow(false), for a time captured earlier
+int Logger::FormatTimestamp(const FILETIME& ft, char* buf, size_t cap)
+{
+    SYSTEMTIME utc{}, st{};
+    FileTimeToSystemTime(&ft, &utc);
+    if (!SystemTimeToTzSpecificLocalTime(nullptr, &utc, &st))
+        st = utc;
+
+    return _snprintf_s(buf, cap, _TRUNCATE,
+                       "%04d-%02d-%02d %02d:%02d:%02d.%03d",
+                       st.wYear, st.wMonth, st.wDay,
+                       st.wHour, st.wMinute, st.wSecond, st.wMilliseconds);
+}
+
 std::string Logger::LevelStr(LogLevel l)
 {
     switch (l)
     {
+    case LogLevel::Debug: return "DEBUG";
     case LogLevel::Info:  return "INFO ";
     case LogLevel::Warn:  return "WARN ";
     case LogLevel::Error: return "ERROR";
@@ -136,7 +425,12 @@ void Logger::WriteRaw(const char* line, size_t len)
     // Also surface in the VS output window / DebugView
     OutputDebugStringA(line);
 
-    // Keep in ring buffer for crash summaries
+    AppendRing(line);
+}
+
+// Keep in ring buffer for crash summaries
+void Logger::AppendRing(const char* line)
+{
     size_t slot = g_ringHead % RING_LINES;
     _snprintf_s(g_ring[slot], LINE_BUF_SIZE, _TRUNCATE, "%s", line);
     ++g_ringHead;
@@ -157,6 +451,145 @@ void Logger::RotateIfNeeded()
     OpenLogFile();
 }
 
+// ─────────────────────────────────────────────────────────────
+//  Async writer: drain the MPSC ring in batches
+// ─────────────────────────────────────────────────────────────
+bool Logger::DrainAsync(bool tryLock)
+{
+    if (!g_csInit) return false;
+    if (tryLock)
+    {
+        if (!TryEnterCriticalSection(&g_cs)) return false;
+    }
+    else
+    {
+        EnterCriticalSection(&g_cs);
+    }
+
+    static char batch[ASYNC_BATCH];   // guarded by g_cs
+    size_t used    = 0;
+    bool   drained = false;
+
+    auto flush = [&]()
+    {
+        if (!used) return;
+        RotateIfNeeded();
+        if (g_hFile != INVALID_HANDLE_VALUE)
+        {
+            DWORD written = 0;
+            WriteFile(g_hFile, batch, static_cast<DWORD>(used), &written, nullptr);
+            g_bytesWritten += written;
+        }
+        fwrite(batch, 1, used, stdout);
+        fflush(stdout);
+        used = 0;
+    };
+
+    auto emit = [&](const char* line, size_t len)
+    {
+        if (used + len > sizeof(batch)) flush();
+        memcpy(batch + used, line, len);
+        used += len;
+        OutputDebugStringA(line);
+        AppendRing(line);
+    };
+
+    char msg [LINE_BUF_SIZE - 64];
+    char line[LINE_BUF_SIZE];
+    char ts  [64];
+
+    const uint64_t dropped = g_dropped.exchange(0, std::memory_order_relaxed);
+    if (dropped)
+    {
+        int n = _snprintf_s(line, sizeof(line), _TRUNCATE,
+                            "[Logger] %llu messages dropped (queue full)\n",
+                            static_cast<unsigned long long>(dropped));
+        if (n > 0) emit(line, static_cast<size_t>(n));
+    }
+
+    for (;;)
+    {
+        LogRecord& r = g_async[g_head & (ASYNC_SLOTS - 1)];
+        if (r.seq.load(std::memory_order_acquire) != g_head + 1)
+            break;
+
+        // Same layout as the synchronous path in WriteV
+        size_t mlen = RenderRecord(r, msg, sizeof(msg) - 1);
+        mlen = AppendSuppressed(msg, mlen, sizeof(msg) - 1, r.suppressed);
+        if (mlen > 0 && msg[mlen - 1] != '\n')
+        {
+            msg[mlen]     = '\n';
+            msg[mlen + 1] = '\0';
+        }
+        FormatTimestamp(r.time, ts, sizeof(ts));
+        const LogLevel level = r.level;
+
+        // Slot can be reused as soon as it has been rendered
+        r.seq.store(g_head + ASYNC_SLOTS, std::memory_order_release);
+        ++g_head;
+        drained = true;
+
+        int n = _snprintf_s(line, sizeof(line), _TRUNCATE,
+                            "[%s] [%s] %s", ts, LevelStr(level).c_str(), msg);
+        if (n < 0) n = static_cast<int>(sizeof(line) - 1);
+        emit(line, static_cast<size_t>(n));
+    }
+
+    flush();
+    LeaveCriticalSection(&g_cs);
+    return drained;
+}
+
+DWORD WINAPI Logger::AsyncWriterProc(LPVOID)
+{
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_BELOW_NORMAL);
+    while (g_asyncRun.load(std::memory_order_acquire))
+    {
+        if (!DrainAsync(false))
+            Sleep(ASYNC_IDLE_MS);
+    }
+    DrainAsync(false);
+    return 0;
+}
+
+bool Logger::StartAsync()
+{
+    if (!g_initialised || g_asyncThread) return g_asyncThread != nullptr;
+
+    // Slot i expects position i; after a Stop the sequence numbers
+    // are already consistent, so only the first start seeds them
+    static bool s_seeded = false;
+    if (!s_seeded)
+    {
+        for (size_t i = 0; i < ASYNC_SLOTS; ++i)
+            g_async[i].seq.store(i, std::memory_order_relaxed);
+        s_seeded = true;
+    }
+
+    g_asyncRun.store(true, std::memory_order_release);
+    g_asyncThread = CreateThread(nullptr, 0, AsyncWriterProc, nullptr, 0, nullptr);
+    if (!g_asyncThread)
+    {
+        g_asyncRun.store(false, std::memory_order_release);
+        return false;
+    }
+
+    Info("[Logger] Asynchronous mode (%zu-entry queue).", ASYNC_SLOTS);
+    return true;
+}
+
+void Logger::StopAsync()
+{
+    if (!g_asyncThread) return;
+
+    g_asyncRun.store(false, std::memory_order_release);
+    WaitForSingleObject(g_asyncThread, INFINITE);
+    CloseHandle(g_asyncThread);
+    g_asyncThread = nullptr;
+
+    DrainAsync(false);
+}
+
 // ─────────────────────────────────────────────────────────────
 //  Public API
 // ─────────────────────────────────────────────────────────────
@@ -191,6 +624,8 @@ bool Logger::Init(const std::string& logDirectory)
 void Logger::Shutdown()
 {
     if (!g_initialised) return;
+
+    StopAsync();
     g_initialised = false;
 
     EnterCriticalSection(&g_cs);
@@ -204,9 +639,9 @@ void Logger::Shutdown()
 }
 
 // ─────────────────────────────────────────────────────────────
-//  WriteV: core formatted write
+//  WriteCore: core formatted write
 // ─────────────────────────────────────────────────────────────
-void Logger::WriteV(LogLevel level, const char* fmt, va_list args)
+void Logger::WriteCore(LogLevel level, uint32_t suppressed, const char* fmt, va_list args)
 {
     if (!g_initialised && g_hFile == INVALID_HANDLE_VALUE)
     {
@@ -217,12 +652,20 @@ void Logger::WriteV(LogLevel level, const char* fmt, va_list args)
         return;
     }
 
+    // Async: capture and return; Fatal stays synchronous so it is on
+    // disk before the caller goes down
+    if (level != LogLevel::Fatal && g_asyncRun.load(std::memory_order_acquire))
+    {
+        EnqueueAsync(level, suppressed, fmt, args);
+        return;
+    }
+
     // Format: [2026-02-27 15:30:00.123] [INFO ] <message>\n
     char msgBuf[LINE_BUF_SIZE - 64]{};
     vsnprintf(msgBuf, sizeof(msgBuf), fmt, args);
 
     // Ensure single trailing newline
-    size_t mlen = strlen(msgBuf);
+    size_t mlen = AppendSuppressed(msgBuf, strlen(msgBuf), sizeof(msgBuf) - 1, suppressed);
     if (mlen > 0 && msgBuf[mlen - 1] != '\n')
     {
         if (mlen + 1 < sizeof(msgBuf))
@@ -242,6 +685,11 @@ void Logger::WriteV(LogLevel level, const char* fmt, va_list args)
     if (lineLen < 0) lineLen = static_cast<int>(sizeof(line) - 1);
 
     if (g_csInit) EnterCriticalSection(&g_cs);
+
+    // Anything still queued goes out first to keep the order
+    if (g_tail.load(std::memory_order_acquire) != g_head)
+        DrainAsync(false);
+
     WriteRaw(line, static_cast<size_t>(lineLen));
 
     // Additionally print to stdout (console) if attached
@@ -251,6 +699,19 @@ void Logger::WriteV(LogLevel level, const char* fmt, va_list args)
     if (g_csInit) LeaveCriticalSection(&g_cs);
 }
 
+void Logger::WriteV(LogLevel level, const char* fmt, va_list args)
+{
+    WriteCore(level, 0, fmt, args);
+}
+
+void Logger::WriteSuppressed(LogLevel level, uint32_t suppressed, const char* fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    WriteCore(level, suppressed, fmt, args);
+    va_end(args);
+}
+
 void Logger::Write(LogLevel level, const char* fmt, ...)
 {
     va_list args;
@@ -445,6 +906,11 @@ LONG WINAPI Logger::UnhandledExceptionHandler(EXCEPTION_POINTERS* ep)
     if (InterlockedExchange(&s_entered, 1) != 0)
         return EXCEPTION_CONTINUE_SEARCH;
 
+    // Stop queueing and pull what is already queued into the file and
+    // the crash ring. TryEnter: the crashing thread may hold g_cs.
+    g_asyncRun.store(false, std::memory_order_release);
+    DrainAsync(true);
+
     // Flush normal log first
     if (g_hFile != INVALID_HANDLE_VALUE)
     {
@@ -7,16 +7,19 @@
 #define WIN32_LEAN_AND_MEAN
 #endif
 #include <windows.h>
+#include <atomic>
 #include <cstdarg>
+#include <cstdint>
 #include <string>
 
 // ─── Log levels ──────────────────────────────────────────────
 enum class LogLevel : uint8_t
 {
-    Info  = 0,
-    Warn  = 1,
-    Error = 2,
-    Fatal = 3,
+    Debug = 0,
+    Info  = 1,
+    Warn  = 2,
+    Error = 3,
+    Fatal = 4,
 };
 
 // ─── Logger ──────────────────────────────────────────────────
@@ -31,10 +34,24 @@ public:
     // normal exit via atexit(); call explicitly for early exit.
     static void Shutdown();
 
+    // Asynchronous mode: log calls only capture the format pointer
+    // and arguments into a lock-free ring; a low-priority writer
+    // thread formats and writes them in batches. Fatal() and the
+    // crash handler drain the ring first, so ordering and the crash
+    // ring are preserved. Format strings must be literals (they are
+    // read later by the writer). Full ring → message is dropped and
+    // counted, the caller never blocks.
+    static bool StartAsync();
+    static void StopAsync();   // drains; also done by Shutdown()
+
     // Core write (fmt is printf-style)
     static void Write(LogLevel level, const char* fmt, ...);
     static void WriteV(LogLevel level, const char* fmt, va_list args);
 
+    // Write from a rate-limited site: appends " [+N suppressed]"
+    // when N > 0 (see LOG_EVERY_SEC / LOG_SAMPLED below)
+    static void WriteSuppressed(LogLevel level, uint32_t suppressed, const char* fmt, ...);
+
     // Convenience wrappers
     static void Info (const char* fmt, ...);
     static void Warn (const char* fmt, ...);
@@ -55,10 +72,121 @@ private:
     static void        RotateIfNeeded();
     static bool        OpenLogFile();
     static void        CloseLogFile();
+    static void        WriteCore(LogLevel level, uint32_t suppressed,
+                                 const char* fmt, va_list args);
     static void        WriteRaw(const char* line, size_t len);
+    static void        AppendRing(const char* line);
+    static bool        DrainAsync(bool tryLock);
+    static DWORD WINAPI AsyncWriterProc(LPVOID);
     static void        WriteCrashLog(EXCEPTION_POINTERS* ep);
     static bool        WriteMiniDump(EXCEPTION_POINTERS* ep,
                                      const std::string& dumpPath);
     static std::string TimestampNow(bool forFileName);
+    static int         FormatTimestamp(const FILETIME& ft, char* buf, size_t cap);
     static std::string LevelStr(LogLevel l);
 };
+
+// ─── Compile-time level filter ───────────────────────────────
+// Calls below FUSER_LOG_LEVEL are discarded by the compiler: the
+// arguments are still type-checked but never evaluated. Override
+// per build in the project's PreprocessorDefinitions, e.g.
+// FUSER_LOG_LEVEL=0 to keep LOG_DEBUG in a Release build.
+#ifndef FUSER_LOG_LEVEL
+#  ifdef NDEBUG
+#    define FUSER_LOG_LEVEL 1     // Info and above
+#  else
+#    define FUSER_LOG_LEVEL 0     // everything
+#  endif
+#endif
+
+#define FUSER_LOG_ENABLED(level) (static_cast<int>(level) >= FUSER_LOG_LEVEL)
+
+#define LOG_AT(level, ...)                                                  \
+    do { if constexpr (FUSER_LOG_ENABLED(level))                            \
+             Logger::Write(level, __VA_ARGS__); } while (0)
+
+#define LOG_DEBUG(...) LOG_AT(LogLevel::Debug, __VA_ARGS__)
+#define LOG_INFO(...)  LOG_AT(LogLevel::Info,  __VA_ARGS__)
+#define LOG_WARN(...)  LOG_AT(LogLevel::Warn,  __VA_ARGS__)
+#define LOG_ERROR(...) LOG_AT(LogLevel::Error, __VA_ARGS__)
+
+// ─── Per-call-site rate limiting ─────────────────────────────
+// Each macro expansion owns one static limiter, so a noisy site
+// only throttles itself. A call that is let through after others
+// were skipped reports how many, e.g.
+//   [Sender] sendto failed: 10055 [+4999 suppressed]
+// Admit() is lock-free; the skipped path costs an atomic add.
+
+// At most `perSecond` lines per one-second window
+class LogRateLimiter
+{
+public:
+    explicit constexpr LogRateLimiter(uint32_t perSecond) : m_perSecond(perSecond) {}
+
+    bool Admit(uint32_t& suppressed)
+    {
+        const uint64_t now   = GetTickCount64();
+        uint64_t       start = m_windowStart.load(std::memory_order_relaxed);
+        if (now - start >= 1000 &&
+            m_windowStart.compare_exchange_strong(start, now, std::memory_order_relaxed))
+            m_inWindow.store(0, std::memory_order_relaxed);
+
+        if (m_inWindow.fetch_add(1, std::memory_order_relaxed) < m_perSecond)
+        {
+            suppressed = m_suppressed.exchange(0, std::memory_order_relaxed);
+            return true;
+        }
+        m_suppressed.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+private:
+    const uint32_t        m_perSecond;
+    std::atomic<uint64_t> m_windowStart{0};
+    std::atomic<uint32_t> m_inWindow{0};
+    std::atomic<uint32_t> m_suppressed{0};
+};
+
+// First `first` calls, then every `every`-th (0 = never again)
+class LogSampler
+{
+public:
+    constexpr LogSampler(uint32_t first, uint32_t every) : m_first(first), m_every(every) {}
+
+    bool Admit(uint32_t& suppressed)
+    {
+        const uint64_t n = m_count.fetch_add(1, std::memory_order_relaxed);
+        if (n < m_first)
+        {
+            suppressed = 0;
+            return true;
+        }
+        if (m_every && (n - m_first + 1) % m_every == 0)
+        {
+            suppressed = m_every - 1;
+            return true;
+        }
+        return false;
+    }
+
+private:
+    const uint32_t        m_first;
+    const uint32_t        m_every;
+    std::atomic<uint64_t> m_count{0};
+};
+
+#define LOG_EVERY_SEC(level, perSecond, ...)                                \
+    do { if constexpr (FUSER_LOG_ENABLED(level)) {                          \
+        static LogRateLimiter logSite_(perSecond);                          \
+        uint32_t logSkipped_ = 0;                                           \
+        if (logSite_.Admit(logSkipped_))                                    \
+            Logger::WriteSuppressed(level, logSkipped_, __VA_ARGS__);       \
+    } } while (0)
+
+#define LOG_SAMPLED(level, first, every, ...)                               \
+    do { if constexpr (FUSER_LOG_ENABLED(level)) {                          \
+        static LogSampler logSite_(first, every);                           \
+        uint32_t logSkipped_ = 0;                                           \
+        if (logSite_.Admit(logSkipped_))                                    \
+            Logger::WriteSuppressed(level, logSkipped_, __VA_ARGS__);       \
+    } } while (0)
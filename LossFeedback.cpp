@@ -0,0 +1,71 @@
+// ============================================================
+//  LossFeedback.cpp  –  Receiver loss reports + rate control
+//  Zero-Latency Network Video Fuser
+// ============================================================
+
+#include "LossFeedback.h"
+#include <algorithm>
+
+// ─────────────────────────────────────────────────────────────
+//  ReceiverFeedback
+// ─────────────────────────────────────────────────────────────
+void ReceiverFeedback::OnReport(uint64_t key, const ReceiverReportPacket& r, uint64_t nowUs)
+{
+    // Forget receivers that went quiet so a stale bad one doesn't pin the rate
+    m_rx.erase(std::remove_if(m_rx.begin(), m_rx.end(),
+                              [nowUs](const Receiver& x) { return nowUs - x.lastUs > FEEDBACK_STALE_US; }),
+               m_rx.end());
+
+    auto it = std::find_if(m_rx.begin(), m_rx.end(), [key](const Receiver& x) { return x.key == key; });
+    if (it == m_rx.end())
+    {
+        m_rx.push_back({ key, 0, r.seq - 1, 0.0 });
+        it = m_rx.end() - 1;
+    }
+    if (r.seq == it->lastSeq)
+        return;   // duplicate
+    it->lastSeq = r.seq;
+    it->lastUs  = nowUs;
+
+    if (r.framesExpected == 0)
+        return;   // nothing sent in the interval – says nothing about the link
+    const uint32_t done   = std::min(r.framesCompleted, r.framesExpected);
+    const double   sample = 100.0 * (r.framesExpected - done) / r.framesExpected;
+    it->lossPct += (sample - it->lossPct) / 4.0;
+}
+
+double ReceiverFeedback::WorstLossPercent(uint64_t nowUs) const
+{
+    double worst = 0;
+    for (const Receiver& x : m_rx)
+        if (nowUs - x.lastUs <= FEEDBACK_STALE_US)
+            worst = std::max(worst, x.lossPct);
+    return worst;
+}
+
+uint32_t ReceiverFeedback::ActiveReceivers(uint64_t nowUs) const
+{
+    return static_cast<uint32_t>(std::count_if(m_rx.begin(), m_rx.end(),
+        [nowUs](const Receiver& x) { return nowUs - x.lastUs <= FEEDBACK_STALE_US; }));
+}
+
+// ─────────────────────────────────────────────────────────────
+//  LossAdaptivePacer
+// ─────────────────────────────────────────────────────────────
+void LossAdaptivePacer::Update(double worstLossPct, uint64_t sendIntervalUs)
+{
+    if (worstLossPct > FEEDBACK_LOSS_HIGH_PCT)
+    {
+        // Rate × 3/4 ⇒ interval × 4/3, starting from the current pace
+        const uint64_t from = std::max<uint64_t>({ m_intervalUs, sendIntervalUs, 1000 });
+        m_intervalUs = std::min(from * 4 / 3, FEEDBACK_MAX_INTERVAL_US);
+    }
+    else if (worstLossPct < FEEDBACK_LOSS_LOW_PCT && m_intervalUs != 0)
+    {
+        // Rate × 9/8; once the cap is looser than the sender's own
+        // pace it no longer does anything – drop it
+        m_intervalUs = m_intervalUs * 8 / 9;
+        if (m_intervalUs < sendIntervalUs * 3 / 4 || m_intervalUs < 1000)
+            m_intervalUs = 0;
+    }
+}
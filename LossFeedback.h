@@ -0,0 +1,95 @@
+#pragma once
+// ============================================================
+//  LossFeedback.h  –  Receiver loss reports and the sender's
+//  worst-receiver rate control
+//  Every receiver sends a ReceiverReportPacket per stream to the
+//  stream's sender on FuserUtil::FeedbackPort (port+1 for StreamId
+//  0, with discovery) each cfg.feedbackIntervalMs. Frame IDs are
+//  consecutive over encoded frames, so the advance of the highest
+//  completed frame ID is what was encoded; the share of those
+//  frames that didn't complete is the receiver's loss. That
+//  includes frames the sender superseded before sending them
+//  (Sender.h, m_encoded), so a sender that falls behind its
+//  capture reads as lossy too. A receiver that lost the reference
+//  of a delta-coded or tiled frame (FrameDelta.h, TileCache.h)
+//  sends a report flagged REPORT_FLAG_KEYFRAME at once, with no
+//  loss sample (intervalUs 0).
+//
+//  The sender keeps one smoothed loss per receiver and adapts to
+//  the worst one it has heard from recently: with one multicast
+//  stream feeding several displays, the weakest link sets the
+//  pace. The knob is the frame rate – raw BGRA has no quality or
+//  redundancy setting – cut quickly under loss and recovered
+//  gradually once every receiver is clean.
+//
+//  Portable – no Windows headers.
+// ============================================================
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+static constexpr char     FEEDBACK_MAGIC[8]        = { 'K','F','R','R','v','1','\0','\0' };
+static constexpr uint64_t FEEDBACK_STALE_US        = 3000000;   // receiver forgotten after 3 s of silence
+static constexpr double   FEEDBACK_LOSS_HIGH_PCT   = 2.0;       // back off above this
+static constexpr double   FEEDBACK_LOSS_LOW_PCT    = 0.5;       // recover below this
+static constexpr uint64_t FEEDBACK_MAX_INTERVAL_US = 100000;    // never pace below 10 frames/s
+static constexpr uint64_t FEEDBACK_KEY_RETRY_US    = 100000;    // keyframe asked for again at most this often
+
+// ─── Wire format (receiver → sender, FeedbackPort) ───────────
+#pragma pack(push, 1)
+struct ReceiverReportPacket
+{
+    char     magic[8];
+    uint32_t seq;
+    uint16_t streamID;          // FuserPacketHeader::StreamID the report is about
+    uint16_t flags;             // REPORT_FLAG_*
+    uint32_t highestFrameID;    // highest completed frame so far
+    uint32_t framesExpected;    // frame IDs advanced since the previous report
+    uint32_t framesCompleted;   // of those, completed
+    uint32_t intervalUs;        // time since the previous report
+};
+#pragma pack(pop)
+static_assert(sizeof(ReceiverReportPacket) == 32, "ReceiverReportPacket layout changed");
+
+// ReceiverReportPacket::flags
+static constexpr uint16_t REPORT_FLAG_KEYFRAME = 0x0001;   // send every band as a keyframe next (and empty the tile cache)
+
+// ─── Per-receiver loss, worst-of aggregation (sender side) ───
+class ReceiverFeedback
+{
+public:
+    // One report from receiver `key` (its address and port)
+    void     OnReport(uint64_t key, const ReceiverReportPacket& r, uint64_t nowUs);
+
+    // Worst smoothed loss among receivers heard within FEEDBACK_STALE_US
+    double   WorstLossPercent(uint64_t nowUs) const;
+    uint32_t ActiveReceivers(uint64_t nowUs) const;
+
+private:
+    struct Receiver
+    {
+        uint64_t key;
+        uint64_t lastUs;
+        uint32_t lastSeq;
+        double   lossPct;    // EWMA over reports, gain 1/4
+    };
+    std::vector<Receiver> m_rx;
+};
+
+// ─── Frame-rate pacing from the worst receiver's loss ────────
+// Multiplicative back-off on loss (rate × 3/4), gradual recovery
+// (rate × 9/8 per clean report) until the cap no longer binds.
+class LossAdaptivePacer
+{
+public:
+    // Apply one aggregated loss sample. `sendIntervalUs` is the
+    // sender's own recent frame interval, the starting point of
+    // the first back-off.
+    void     Update(double worstLossPct, uint64_t sendIntervalUs);
+
+    // Minimum time between two frames; 0 = unpaced
+    uint64_t MinIntervalUs() const { return m_intervalUs; }
+
+private:
+    uint64_t m_intervalUs = 0;
+};
@@ -0,0 +1,107 @@
+// ============================================================
+//  MappedFile.cpp  –  Memory-mapped file wrapper
+//  Zero-Latency Network Video Fuser
+// ============================================================
+
+#include "MappedFile.h"
+
+#ifdef _WIN32
+  #ifndef WIN32_LEAN_AND_MEAN
+  #define WIN32_LEAN_AND_MEAN
+  #endif
+  #include <windows.h>
+#else
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <fcntl.h>
+  #include <unistd.h>
+#endif
+
+bool MappedFile::CreateWrite(const std::string& path, uint64_t bytes)
+{
+    Close();
+    if (bytes == 0) return false;
+#ifdef _WIN32
+    HANDLE f = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ,
+                           nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (f == INVALID_HANDLE_VALUE) return false;
+    HANDLE m = CreateFileMappingA(f, nullptr, PAGE_READWRITE,
+                                  static_cast<DWORD>(bytes >> 32),
+                                  static_cast<DWORD>(bytes & 0xFFFFFFFFu), nullptr);
+    if (!m) { CloseHandle(f); return false; }
+    void* p = MapViewOfFile(m, FILE_MAP_WRITE, 0, 0, static_cast<SIZE_T>(bytes));
+    if (!p) { CloseHandle(m); CloseHandle(f); return false; }
+    m_file    = f;
+    m_mapping = m;
+#else
+    int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return false;
+    if (ftruncate(fd, static_cast<off_t>(bytes)) != 0) { close(fd); return false; }
+    void* p = mmap(nullptr, static_cast<size_t>(bytes), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED) { close(fd); return false; }
+    m_fd = fd;
+#endif
+    m_base     = static_cast<uint8_t*>(p);
+    m_size     = bytes;
+    m_writable = true;
+    return true;
+}
+
+bool MappedFile::OpenRead(const std::string& path)
+{
+    Close();
+#ifdef _WIN32
+    HANDLE f = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE,
+                           nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (f == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER sz{};
+    if (!GetFileSizeEx(f, &sz) || sz.QuadPart <= 0) { CloseHandle(f); return false; }
+    HANDLE m = CreateFileMappingA(f, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!m) { CloseHandle(f); return false; }
+    void* p = MapViewOfFile(m, FILE_MAP_READ, 0, 0, 0);
+    if (!p) { CloseHandle(m); CloseHandle(f); return false; }
+    m_file    = f;
+    m_mapping = m;
+    m_size    = static_cast<uint64_t>(sz.QuadPart);
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st{};
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) { close(fd); return false; }
+    void* p = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED) { close(fd); return false; }
+    m_fd   = fd;
+    m_size = static_cast<uint64_t>(st.st_size);
+#endif
+    m_base     = static_cast<uint8_t*>(p);
+    m_writable = false;
+    return true;
+}
+
+void MappedFile::Close(uint64_t finalBytes)
+{
+    if (!m_base) return;
+    const bool truncate = m_writable && finalBytes < m_size;
+#ifdef _WIN32
+    if (m_writable) FlushViewOfFile(m_base, 0);
+    UnmapViewOfFile(m_base);
+    CloseHandle(static_cast<HANDLE>(m_mapping));
+    if (truncate)
+    {
+        LARGE_INTEGER pos{};
+        pos.QuadPart = static_cast<LONGLONG>(finalBytes);
+        SetFilePointerEx(static_cast<HANDLE>(m_file), pos, nullptr, FILE_BEGIN);
+        SetEndOfFile(static_cast<HANDLE>(m_file));
+    }
+    CloseHandle(static_cast<HANDLE>(m_file));
+    m_file    = nullptr;
+    m_mapping = nullptr;
+#else
+    munmap(m_base, static_cast<size_t>(m_size));
+    if (truncate && ftruncate(m_fd, static_cast<off_t>(finalBytes)) != 0) { /* keep full size */ }
+    close(m_fd);
+    m_fd = -1;
+#endif
+    m_base = nullptr;
+    m_size = 0;
+}
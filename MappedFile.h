@@ -0,0 +1,41 @@
+#pragma once
+// ============================================================
+//  MappedFile.h  –  Minimal memory-mapped file (read or write)
+//  CreateFileMapping on Windows, mmap elsewhere. No Windows
+//  headers leak out of this file.
+// ============================================================
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    ~MappedFile() { Close(); }
+    MappedFile(const MappedFile&)            = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Create/overwrite `path` pre-sized to `bytes`, mapped read-write
+    bool CreateWrite(const std::string& path, uint64_t bytes);
+
+    // Map an existing file read-only (whole file)
+    bool OpenRead(const std::string& path);
+
+    // Unmap and close. For a write mapping, `finalBytes` (if not
+    // UINT64_MAX) truncates the file to the bytes actually used.
+    void Close(uint64_t finalBytes = UINT64_MAX);
+
+    uint8_t*       Data()       { return m_base; }
+    const uint8_t* Data() const { return m_base; }
+    uint64_t       Size() const { return m_size; }
+    bool           IsOpen() const { return m_base != nullptr; }
+
+private:
+    uint8_t*    m_base     = nullptr;
+    uint64_t    m_size     = 0;
+    bool        m_writable = false;
+    void*       m_file     = nullptr;   // HANDLE (Windows)
+    void*       m_mapping  = nullptr;   // HANDLE (Windows)
+    int         m_fd       = -1;        // POSIX
+};
@@ -5,180 +5,413 @@
 
 #include "NetworkFuser.h"
 #include "MemoryReassembly.h"
+#include "Metrics.h"
+#include "EventTrace.h"
+#include "FrameScale.h"
+#include "WirePixels.h"
+#include "FrameDelta.h"
+#include "TileCache.h"
 
 // ─────────────────────────────────────────────────────────────
-MemoryReassembly::MemoryReassembly()
+//  ArrivalJitterTracker
+// ─────────────────────────────────────────────────────────────
+void ArrivalJitterTracker::OnPacket(uint32_t frameID, uint64_t nowUs)
 {
-    m_slots.resize(REASSEMBLY_SLOTS);
+    // Only intra-frame gaps describe the link; the idle time between
+    // two frames is the capture interval and would swamp the estimate.
+    if (frameID == m_lastFrameID && m_lastUs != 0 && nowUs >= m_lastUs)
+    {
+        const uint64_t sample = (nowUs - m_lastUs) << FIXED_SHIFT;
+        const uint64_t dev    = (sample > m_gapUs) ? sample - m_gapUs : m_gapUs - sample;
+
+        m_gapUs = m_gapUs - (m_gapUs >> EWMA_SHIFT) + (sample >> EWMA_SHIFT);
+        m_jitUs = m_jitUs - (m_jitUs >> EWMA_SHIFT) + (dev    >> EWMA_SHIFT);
+    }
+    m_lastFrameID = frameID;
+    m_lastUs      = nowUs;
 }
 
+uint64_t ArrivalJitterTracker::BudgetUs(uint32_t packets) const
+{
+    return ((static_cast<uint64_t>(packets) * m_gapUs +
+             JITTER_MULT * m_jitUs) >> FIXED_SHIFT) + SLACK_US;
+}
+
+// ─────────────────────────────────────────────────────────────
+namespace
+{
+    // Upper bound on a frame's pixel bytes from any one of its
+    // packets, so the buffer can be sized before other lanes start
+    // writing into it. The metadata says it exactly. Otherwise the
+    // packet is either full-size (no packet is larger) or short,
+    // and PacketizeFrame only cuts a slice short where the pixels
+    // run out, so its slice ends the frame.
+    uint32_t FrameBytesHint(const FuserPacketHeader& hdr, const uint8_t* payload, uint32_t payloadLen)
+    {
+        if ((hdr.Flags & PKT_FLAG_META) && payloadLen >= FRAME_META_SIZE)
+        {
+            FrameMetaPayload meta;
+            std::memcpy(&meta, payload, FRAME_META_SIZE);
+            return std::min(meta.rawBytes, MAX_FRAME_BYTES);
+        }
+        const uint64_t full  = static_cast<uint64_t>(hdr.TotalPackets) * payloadLen;
+        const uint64_t slice = static_cast<uint64_t>(hdr.PayloadOffset) + payloadLen;
+        return static_cast<uint32_t>(std::min<uint64_t>(std::max(full, slice), MAX_FRAME_BYTES));
+    }
+}
+
+MemoryReassembly::MemoryReassembly(uint32_t minTimeoutUs, uint32_t maxTimeoutUs, uint32_t lanes)
+    : m_slots(new FrameSlot[REASSEMBLY_SLOTS])
+    , m_lanes(std::max<uint32_t>(lanes, 1))
+    , m_minTimeoutUs(minTimeoutUs)
+    , m_maxTimeoutUs(std::max(minTimeoutUs, maxTimeoutUs))
+{}
+
 MemoryReassembly::~MemoryReassembly() = default;
 
 // ─── Feed one UDP packet into the reassembly engine ─────────
-//  Returns pointer to completed FrameSlot (owned by ring buffer,
-//  valid until the next call that reuses the same slot),
-//  or nullptr if the frame is not yet complete.
-FrameSlot* MemoryReassembly::ConsumePacket(const uint8_t* rawData, int rawLen)
+//  Returns the completed FrameSlot (owned by the caller until
+//  ReleaseSlot), or nullptr if the frame is not yet complete.
+FrameSlot* MemoryReassembly::ConsumePacket(const uint8_t* rawData, int rawLen, uint32_t lane, uint64_t nowUs)
 {
     if (rawLen < static_cast<int>(HEADER_SIZE))
+    {
+        Metrics::Add(MetricCounter::PacketsMalformed);
         return nullptr;
+    }
 
     // Parse header
     FuserPacketHeader hdr;
     std::memcpy(&hdr, rawData, HEADER_SIZE);
     const uint8_t* payload    = rawData    + HEADER_SIZE;
-    const int      payloadLen = rawLen     - static_cast<int>(HEADER_SIZE);
+    const uint32_t payloadLen = static_cast<uint32_t>(rawLen) - HEADER_SIZE;
 
-    if (hdr.TotalPackets == 0 || hdr.PacketIndex >= hdr.TotalPackets)
+    if (hdr.TotalPackets == 0 || hdr.PacketIndex >= hdr.TotalPackets || hdr.FrameID == 0)
+    {
+        Metrics::Add(MetricCounter::PacketsOutOfRange);
         return nullptr;
+    }
 
-    // Locate or allocate a slot for this FrameID
-    FrameSlot* slot = FindOrAllocSlot(hdr.FrameID, hdr.TotalPackets);
+    Lane& ln = m_lanes[lane < m_lanes.size() ? lane : 0];
+
+    // Locate or claim the slot for this FrameID, pinned against reuse
+    FrameSlot* slot = PinSlot(hdr.FrameID, hdr.TotalPackets,
+                              FrameBytesHint(hdr, payload, payloadLen), ln, nowUs);
     if (!slot)
+    {
+        Metrics::Add(MetricCounter::PacketsOutOfRange);
         return nullptr;
-
-    // Ignore duplicate packets
-    if (slot->received[hdr.PacketIndex])
+    }
+    if (slot->totalPackets != hdr.TotalPackets)
+    {
+        slot->writers.fetch_sub(1, std::memory_order_release);
+        Metrics::Add(MetricCounter::PacketsOutOfRange);
         return nullptr;
+    }
 
-    // Packet 0 carries the FrameMetaPayload before pixel data
-    if (hdr.PacketIndex == 0)
+    // Past its deadline – the frame is considered lost, evict it
+    if (nowUs > slot->deadlineUs.load(std::memory_order_relaxed) &&
+        !slot->complete.load(std::memory_order_acquire))
     {
-        if (payloadLen < static_cast<int>(FRAME_META_SIZE))
-            return nullptr;
+        slot->writers.fetch_sub(1, std::memory_order_release);
+        Retire(*slot, hdr.FrameID, nowUs);
+        return nullptr;
+    }
 
-        FrameMetaPayload meta;
-        std::memcpy(&meta, payload, FRAME_META_SIZE);
+    FrameSlot* done = StorePacket(*slot, hdr, payload, payloadLen, ln, nowUs);
+    slot->writers.fetch_sub(1, std::memory_order_release);
+    return done;
+}
 
-        slot->width      = meta.width;
-        slot->height     = meta.height;
-        slot->totalBytes = meta.rawBytes;
+// ─── One packet into its pinned slot ─────────────────────────
+FrameSlot* MemoryReassembly::StorePacket(FrameSlot& s, const FuserPacketHeader& hdr,
+                                         const uint8_t* payload, uint32_t payloadLen,
+                                         Lane& lane, uint64_t nowUs)
+{
+    // Set the receipt bit first: whoever sets it owns the packet,
+    // every other copy (duplicate, or the same packet on a second
+    // lane) is dropped here
+    std::atomic<uint64_t>& word = s.received[hdr.PacketIndex >> 6];
+    const uint64_t         bit  = 1ull << (hdr.PacketIndex & 63);
+    if (word.fetch_or(bit, std::memory_order_relaxed) & bit)
+    {
+        Metrics::Add(MetricCounter::PacketsDuplicate);
+        return nullptr;
+    }
+    auto reject = [&](MetricCounter why) -> FrameSlot*
+    {
+        word.fetch_and(~bit, std::memory_order_relaxed);
+        Metrics::Add(why);
+        return nullptr;
+    };
 
-        // Resize pixel buffer once we know the frame size
-        if (slot->pixelData.size() != meta.rawBytes)
-            slot->pixelData.resize(meta.rawBytes, 0);
+    // Any flagged packet may carry the (replicated) frame metadata;
+    // the first one to arrive fills the frame fields
+    const uint8_t* pixels   = payload;
+    uint32_t       pixelLen = payloadLen;
+    if (hdr.Flags & PKT_FLAG_META)
+    {
+        if (pixelLen < FRAME_META_SIZE)
+            return reject(MetricCounter::PacketsMalformed);
 
-        // Copy pixel portion of packet 0
-        const int pixelLen = payloadLen - static_cast<int>(FRAME_META_SIZE);
-        if (pixelLen > 0)
+        if (!s.hasMeta.load(std::memory_order_acquire) &&
+            !s.metaClaimed.exchange(true, std::memory_order_acq_rel))
         {
-            uint32_t toCopy = static_cast<uint32_t>(pixelLen);
-            if (toCopy > meta.rawBytes) toCopy = meta.rawBytes;
-            std::memcpy(slot->pixelData.data(), payload + FRAME_META_SIZE, toCopy);
+            FrameMetaPayload meta;
+            std::memcpy(&meta, payload, FRAME_META_SIZE);
+            // The buffer was sized when the slot was claimed and can't
+            // grow under the other lanes; a frame larger than the
+            // packets promised is malformed, as is one whose pixels
+            // don't fill its (scaled) rectangle exactly in its format
+            // (a delta: don't code more than that; tiles: no more than
+            // every tile sent whole), or whose band is out of range
+            const uint32_t scale     = meta.scale ? meta.scale : 1;
+            const uint32_t bandCount = meta.bandCount ? meta.bandCount : 1;
+            const uint32_t scaledW   = FrameScale::ScaledSize(meta.width, scale);
+            const uint32_t scaledH   = FrameScale::ScaledSize(meta.height, scale);
+            const uint32_t bpp       = WirePixels::BytesPerPixel(meta.format);
+            const uint64_t rectBytes = static_cast<uint64_t>(scaledW) * scaledH * bpp;
+            if (meta.rawBytes > s.pixelData.size() || !FrameScale::ValidFactor(scale) ||
+                !WirePixels::ValidFormat(meta.format) || !FrameDelta::ValidCodec(meta.codec) ||
+                bandCount > MAX_BANDS || meta.band >= bandCount ||
+                (meta.codec == FrameDelta::DELTA ? rectBytes > MAX_FRAME_BYTES || meta.rawBytes > rectBytes
+               : meta.codec == FrameDelta::TILES ? rectBytes > MAX_FRAME_BYTES ||
+                                                   meta.rawBytes > TileCode::MaxCodedBytes(scaledW, scaledH, bpp)
+                                                 : rectBytes != meta.rawBytes))
+            {
+                s.metaClaimed.store(false, std::memory_order_release);
+                return reject(MetricCounter::PacketsMalformed);
+            }
+
+            s.width           = meta.width;
+            s.height          = meta.height;
+            s.originX         = meta.originX;
+            s.originY         = meta.originY;
+            s.totalBytes      = meta.rawBytes;
+            s.senderCaptureUs = meta.captureUs;
+            s.senderEncodeUs  = meta.encodeUs;
+            s.senderSendUs    = meta.sendUs;
+            s.scale           = scale;
+            s.format          = meta.format;
+            s.colour          = meta.colour;
+            s.band            = meta.band;
+            s.bandCount       = bandCount;
+            s.codec           = meta.codec;
+            s.refFrameID      = meta.refFrameID;
+            s.hasMeta.store(true, std::memory_order_release);
         }
+        pixels   += FRAME_META_SIZE;
+        pixelLen -= FRAME_META_SIZE;
     }
-    else
-    {
-        // Packets 1..N: locate write offset.
-        // Offset = pixelBytesInPkt0 + (pktIdx-1)*MAX_PIXEL_PAYLOAD
-        constexpr uint32_t pixelBytesInPkt0 = MAX_PIXEL_PAYLOAD - FRAME_META_SIZE;
-        const uint32_t writeOffset =
-            pixelBytesInPkt0 +
-            (static_cast<uint32_t>(hdr.PacketIndex) - 1) * MAX_PIXEL_PAYLOAD;
-
-        // Guard against buffer overflow (malformed packet)
-        if (slot->pixelData.empty())
-            return nullptr; // metadata packet 0 not arrived yet; discard
-        if (writeOffset >= slot->totalBytes)
-            return nullptr;
-
-        uint32_t toCopy = static_cast<uint32_t>(payloadLen);
-        if (writeOffset + toCopy > slot->totalBytes)
-            toCopy = slot->totalBytes - writeOffset;
-
-        std::memcpy(slot->pixelData.data() + writeOffset, payload, toCopy);
-    }
 
-    slot->received[hdr.PacketIndex] = true;
-    ++slot->receivedCount;
+    // Place the slice at its self-described offset. Before metadata
+    // arrives the claim-time size bound is the limit.
+    const uint64_t sliceEnd = static_cast<uint64_t>(hdr.PayloadOffset) + pixelLen;
+    const uint64_t limit    = s.hasMeta.load(std::memory_order_acquire) ? s.totalBytes : s.pixelData.size();
+    if (sliceEnd > limit)
+        return reject(MetricCounter::PacketsOutOfRange);
+    if (pixelLen > 0)
+        std::memcpy(s.pixelData.data() + hdr.PayloadOffset, pixels, pixelLen);
+
+    // Packets are still flowing – push the deadline out by what the
+    // remaining packets should take at the measured rate. The count
+    // is acq_rel so the thread that completes the frame sees every
+    // other lane's slice and metadata.
+    lane.jitter.OnPacket(hdr.FrameID, nowUs);
+    s.lastPacketUs.store(nowUs, std::memory_order_relaxed);
+    const uint32_t count = s.receivedCount.fetch_add(1, std::memory_order_acq_rel) + 1;
+    s.deadlineUs.store(ComputeDeadline(s, count, lane, nowUs), std::memory_order_relaxed);
 
-    // Check for frame timeout – drop incomplete frames to maintain low latency
-    const ULONGLONG now = FuserUtil::NowMs();
-    if (now - slot->firstPacketMs > FRAME_TIMEOUT_MS)
+    // Frame complete? (all packets in implies packet 0, so hasMeta
+    // only matters as a guard against malformed streams). Every
+    // bit is set now, so no other lane will touch the pixels again.
+    if (count == s.totalPackets && s.hasMeta.load(std::memory_order_acquire))
     {
-        // Too old – evict slot silently
-        ResetSlot(*slot);
-        return nullptr;
+        s.pixelData.resize(s.totalBytes);   // drop the claim-time slack
+        s.complete.store(true, std::memory_order_release);
+        Metrics::Add(MetricCounter::FramesCompleted);
+        Metrics::Add(MetricCounter::BytesCompleted, s.totalBytes);
+        Metrics::Set(MetricGauge::ArrivalGapUs,    static_cast<int64_t>(lane.jitter.MeanGapUs()));
+        Metrics::Set(MetricGauge::ArrivalJitterUs, static_cast<int64_t>(lane.jitter.JitterUs()));
+        EventTrace::Emit(TraceEvent::FrameComplete, s.frameID.load(std::memory_order_relaxed),
+                         s.totalPackets, s.totalBytes, static_cast<uint32_t>(nowUs - s.firstPacketUs));
+        return &s;
     }
 
-    // Frame complete?
-    if (slot->receivedCount == slot->totalPackets)
+    return nullptr;
+}
+
+// ─── Evict all incomplete slots past their deadline ─────────
+void MemoryReassembly::PurgeExpired(uint64_t nowUs)
+{
+    for (uint32_t i = 0; i < REASSEMBLY_SLOTS; ++i)
     {
-        slot->complete = true;
-        return slot;
+        FrameSlot&     s  = m_slots[i];
+        const uint32_t id = s.frameID.load(std::memory_order_acquire);
+        if (id != 0 && !s.complete.load(std::memory_order_acquire) &&
+            nowUs > s.deadlineUs.load(std::memory_order_relaxed))
+            Retire(s, id, nowUs);
     }
+}
 
-    return nullptr;
+void MemoryReassembly::ReleaseSlot(FrameSlot* slot)
+{
+    if (!slot) return;
+    std::lock_guard<std::mutex> lock(m_claimMtx);
+    Vacate(*slot);
+}
+
+// ─── Time out frameID's slot, unless another lane got there first
+void MemoryReassembly::Retire(FrameSlot& s, uint32_t frameID, uint64_t nowUs)
+{
+    std::lock_guard<std::mutex> lock(m_claimMtx);
+    if (s.frameID.load(std::memory_order_relaxed) != frameID ||
+        s.complete.load(std::memory_order_acquire) ||
+        nowUs <= s.deadlineUs.load(std::memory_order_relaxed))
+        return;
+
+    Metrics::Add(MetricCounter::FramesTimedOut);
+    EventTrace::Emit(TraceEvent::FrameTimedOut, frameID,
+                     s.receivedCount.load(std::memory_order_relaxed), s.totalPackets);
+    Vacate(s);
 }
 
-// ─── Evict all slots older than FRAME_TIMEOUT_MS ────────────
-void MemoryReassembly::PurgeExpired()
+// ─── Per-frame deadline ──────────────────────────────────────
+//  now + expected time for the outstanding packets (rate + jitter),
+//  clamped to [min, max] measured from the frame's first packet.
+//  The lanes receive in parallel, so this lane only waits for its
+//  share of what is outstanding, at its own gap.
+uint64_t MemoryReassembly::ComputeDeadline(const FrameSlot& s, uint32_t received, const Lane& lane,
+                                           uint64_t nowUs) const
 {
-    const ULONGLONG now = FuserUtil::NowMs();
-    for (auto& s : m_slots)
+    const uint32_t lanes       = static_cast<uint32_t>(m_lanes.size());
+    const uint32_t outstanding = s.totalPackets - std::min(received, s.totalPackets);
+    const uint64_t lo = s.firstPacketUs + m_minTimeoutUs;
+    const uint64_t hi = s.firstPacketUs + m_maxTimeoutUs;
+    const uint64_t d  = nowUs + lane.jitter.BudgetUs((outstanding + lanes - 1) / lanes);
+    return std::min(std::max(d, lo), hi);
+}
+
+// ─── Find frameID's slot and pin it (lock-free) ──────────────
+//  A pinned slot can't be vacated: Vacate() unpublishes the
+//  frameID and then waits for writers to drain, so re-checking
+//  the frameID after pinning closes the race.
+FrameSlot* MemoryReassembly::PinSlot(uint32_t frameID, uint32_t totalPackets,
+                                     uint32_t bytesHint, const Lane& lane, uint64_t nowUs)
+{
+    for (uint32_t i = 0; i < REASSEMBLY_SLOTS; ++i)
     {
-        if (s.frameID != 0 && !s.complete)
-        {
-            if (now - s.firstPacketMs > FRAME_TIMEOUT_MS)
-                ResetSlot(s);
-        }
+        FrameSlot& s = m_slots[i];
+        if (s.frameID.load(std::memory_order_acquire) != frameID)
+            continue;
+        s.writers.fetch_add(1, std::memory_order_seq_cst);
+        if (s.frameID.load(std::memory_order_seq_cst) == frameID)
+            return &s;
+        s.writers.fetch_sub(1, std::memory_order_release);
+        break;   // recycled under us – settle it under the lock
     }
+    return ClaimSlot(frameID, totalPackets, bytesHint, lane, nowUs);
 }
 
-// ─── Find an existing slot for frameID, or allocate a new one ─
-FrameSlot* MemoryReassembly::FindOrAllocSlot(uint32_t frameID,
-                                              uint32_t totalPackets)
+// ─── Claim a slot for a new frame (returned pinned) ─────────
+//  The first deadline comes from the claiming lane's own tracker;
+//  another lane's is written without a lock by its thread.
+FrameSlot* MemoryReassembly::ClaimSlot(uint32_t frameID, uint32_t totalPackets,
+                                       uint32_t bytesHint, const Lane& lane, uint64_t nowUs)
 {
-    // Search for existing slot
-    for (auto& s : m_slots)
+    std::lock_guard<std::mutex> lock(m_claimMtx);
+
+    // Another lane may have claimed it since the lock-free search;
+    // frameIDs only change under this lock
+    for (uint32_t i = 0; i < REASSEMBLY_SLOTS; ++i)
     {
-        if (s.frameID == frameID)
+        FrameSlot& s = m_slots[i];
+        if (s.frameID.load(std::memory_order_relaxed) == frameID)
+        {
+            s.writers.fetch_add(1, std::memory_order_seq_cst);
             return &s;
+        }
     }
 
-    // Find a free (unused or complete/expired) slot
+    // A free slot, else the oldest incomplete one. Completed slots
+    // belong to their consumer until ReleaseSlot().
     FrameSlot* victim = nullptr;
-    ULONGLONG  oldest = ULLONG_MAX;
-
-    for (auto& s : m_slots)
+    uint64_t   oldest = UINT64_MAX;
+    for (uint32_t i = 0; i < REASSEMBLY_SLOTS; ++i)
     {
-        if (s.frameID == 0 || s.complete)
+        FrameSlot& s = m_slots[i];
+        if (s.frameID.load(std::memory_order_relaxed) == 0)
         {
-            ResetSlot(s);
             victim = &s;
             break;
         }
-        // Track oldest incomplete slot as fallback eviction target
-        if (s.firstPacketMs < oldest)
+        if (!s.complete.load(std::memory_order_acquire) && s.firstPacketUs < oldest)
         {
-            oldest = s.firstPacketMs;
+            oldest = s.firstPacketUs;
             victim = &s;
         }
     }
 
     if (!victim)
         return nullptr;
+    if (victim->frameID.load(std::memory_order_relaxed) != 0)
+    {
+        Metrics::Add(MetricCounter::FramesEvicted);
+        EventTrace::Emit(TraceEvent::FrameEvicted, victim->frameID.load(std::memory_order_relaxed),
+                         victim->receivedCount.load(std::memory_order_relaxed), victim->totalPackets);
+        Vacate(*victim);
+    }
 
-    // Initialise the slot
-    ResetSlot(*victim);
-    victim->frameID      = frameID;
-    victim->totalPackets = totalPackets;
-    victim->received.assign(totalPackets, false);
-    victim->firstPacketMs = FuserUtil::NowMs();
+    // Initialise the slot, then publish the frameID to the other lanes
+    victim->totalPackets  = totalPackets;
+    victim->firstPacketUs = nowUs;
+    victim->lastPacketUs.store(nowUs, std::memory_order_relaxed);
+    victim->deadlineUs.store(ComputeDeadline(*victim, 0, lane, nowUs), std::memory_order_relaxed);
+    victim->pixelData.resize(bytesHint, 0);
+    victim->writers.fetch_add(1, std::memory_order_relaxed);
+    victim->frameID.store(frameID, std::memory_order_release);
+    EventTrace::Emit(TraceEvent::FirstPacket, frameID, totalPackets);
 
     return victim;
 }
 
+// ─── Unpublish a slot and reset it (claim lock held) ────────
+void MemoryReassembly::Vacate(FrameSlot& s)
+{
+    s.frameID.store(0, std::memory_order_seq_cst);
+    while (s.writers.load(std::memory_order_seq_cst) != 0)
+        std::this_thread::yield();   // a lane is mid-packet: one memcpy at most
+    ResetSlot(s);
+}
+
 void MemoryReassembly::ResetSlot(FrameSlot& s)
 {
-    s.frameID      = 0;
+    // Clear only the receipt words the last frame used
+    for (uint32_t w = 0, n = (s.totalPackets + 63) / 64; w < n; ++w)
+        s.received[w].store(0, std::memory_order_relaxed);
+
     s.totalPackets = 0;
-    s.receivedCount= 0;
+    s.receivedCount.store(0, std::memory_order_relaxed);
     s.totalBytes   = 0;
-    s.complete     = false;
-    s.firstPacketMs= 0;
+    s.complete.store(false, std::memory_order_relaxed);
+    s.metaClaimed.store(false, std::memory_order_relaxed);
+    s.hasMeta.store(false, std::memory_order_relaxed);
+    s.firstPacketUs= 0;
+    s.lastPacketUs.store(0, std::memory_order_relaxed);
+    s.deadlineUs.store(0, std::memory_order_relaxed);
     s.width        = 0;
     s.height       = 0;
-    // Don't release the memory – keep capacity for reuse
-    if (!s.received.empty())  s.received.assign(s.received.size(), false);
+    s.originX      = 0;
+    s.originY      = 0;
+    s.senderCaptureUs = 0;
+    s.senderEncodeUs  = 0;
+    s.senderSendUs    = 0;
+    s.scale           = 1;
+    s.format          = 0;
+    s.colour          = 0;
+    s.band            = 0;
+    s.bandCount       = 1;
+    s.codec           = 0;
+    s.refFrameID      = 0;
+    // Keep pixelData's capacity for reuse (if the consumer left it)
 }
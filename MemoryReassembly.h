@@ -4,26 +4,91 @@
 // ============================================================
 #include "NetworkFuser.h"
 
+// ─── Inter-packet arrival tracker ────────────────────────────
+// EWMA of the gap between consecutive packets of the same frame
+// plus an RFC 3550 style mean deviation (jitter). Used to turn a
+// packet count into a reassembly deadline.
+class ArrivalJitterTracker
+{
+public:
+    void     OnPacket(uint32_t frameID, uint64_t nowUs);
+
+    // Time budget for `packets` more packets to arrive, before clamping
+    uint64_t BudgetUs(uint32_t packets) const;
+
+    uint32_t MeanGapUs()  const { return m_gapUs  >> FIXED_SHIFT; }
+    uint32_t JitterUs()   const { return m_jitUs  >> FIXED_SHIFT; }
+
+private:
+    // Gains are 1/16 (as in RFC 3550); values kept in 28.4 fixed point
+    static constexpr uint32_t FIXED_SHIFT  = 4;
+    static constexpr uint32_t EWMA_SHIFT   = 4;
+    // Seed: one full-size datagram at ~1 Gbit/s before we have samples
+    static constexpr uint32_t SEED_GAP_US  = 12;
+    static constexpr uint32_t JITTER_MULT  = 4;     // deviations of headroom
+    static constexpr uint32_t SLACK_US     = 250;   // scheduler wake-up / NIC coalescing
+
+    uint32_t m_lastFrameID = 0;
+    uint64_t m_lastUs      = 0;
+    uint64_t m_gapUs       = static_cast<uint64_t>(SEED_GAP_US) << FIXED_SHIFT;
+    uint64_t m_jitUs       = 0;
+};
+
+// ─── Frame reassembly ────────────────────────────────────────
+// One instance is shared by all receive threads of a striped
+// stream; each thread passes its own lane (stripe index). The
+// per-packet path is lock-free: a thread pins the frame's slot,
+// sets the packet's receipt bit, copies the slice and counts it,
+// and the thread whose count completes the frame gets the slot.
+// Claiming a slot for a new frame and releasing or evicting one
+// take a short lock and wait for pinned threads to leave.
 class MemoryReassembly
 {
 public:
-    MemoryReassembly();
+    MemoryReassembly(uint32_t minTimeoutUs = REASM_MIN_TIMEOUT_US,
+                     uint32_t maxTimeoutUs = REASM_MAX_TIMEOUT_US,
+                     uint32_t lanes        = 1);
     ~MemoryReassembly();
 
-    // Feed one raw UDP payload (including header).
-    // Returns a pointer to a completed FrameSlot on frame completion,
-    // nullptr otherwise. The pointer is valid until the next call.
-    FrameSlot* ConsumePacket(const uint8_t* rawData, int rawLen);
+    // Feed one raw UDP payload (including header) that arrived on
+    // `lane` at `nowUs` – FuserUtil::NowUs(), or the trace's clock
+    // on replay; deadlines and jitter are measured on it. Returns
+    // the completed FrameSlot when this packet finished the frame,
+    // nullptr otherwise. The slot is the caller's until it hands it
+    // back with ReleaseSlot().
+    FrameSlot* ConsumePacket(const uint8_t* rawData, int rawLen, uint32_t lane, uint64_t nowUs);
 
-    // Call periodically to evict stale incomplete frames
-    void PurgeExpired();
+    // Call periodically (from any lane) to evict incomplete frames
+    // past their deadline at `nowUs` (same clock as ConsumePacket)
+    void PurgeExpired(uint64_t nowUs);
 
     // After consuming the completed frame, reset it so the slot can be reused
-    void ReleaseSlot(FrameSlot* slot) { if (slot) ResetSlot(*slot); }
+    void ReleaseSlot(FrameSlot* slot);
+
+    const ArrivalJitterTracker& Jitter(uint32_t lane = 0) const { return m_lanes[lane].jitter; }
 
 private:
-    FrameSlot* FindOrAllocSlot(uint32_t frameID, uint32_t totalPackets);
+    // Per receive thread; own cache line so lanes don't false-share
+    struct alignas(64) Lane
+    {
+        ArrivalJitterTracker jitter;
+    };
+
+    FrameSlot* PinSlot(uint32_t frameID, uint32_t totalPackets, uint32_t bytesHint,
+                       const Lane& lane, uint64_t nowUs);
+    FrameSlot* ClaimSlot(uint32_t frameID, uint32_t totalPackets, uint32_t bytesHint,
+                         const Lane& lane, uint64_t nowUs);
+    FrameSlot* StorePacket(FrameSlot& s, const FuserPacketHeader& hdr, const uint8_t* payload,
+                           uint32_t payloadLen, Lane& lane, uint64_t nowUs);
+    void       Retire(FrameSlot& s, uint32_t frameID, uint64_t nowUs);
+    void       Vacate(FrameSlot& s);
     void       ResetSlot(FrameSlot& s);
+    uint64_t   ComputeDeadline(const FrameSlot& s, uint32_t received, const Lane& lane,
+                               uint64_t nowUs) const;
 
-    std::vector<FrameSlot> m_slots;  // fixed-size ring
+    std::unique_ptr<FrameSlot[]> m_slots;      // REASSEMBLY_SLOTS, fixed
+    std::vector<Lane>            m_lanes;
+    std::mutex                   m_claimMtx;   // slot claim / release / eviction
+    uint32_t                     m_minTimeoutUs;
+    uint32_t                     m_maxTimeoutUs;
 };
@@ -0,0 +1,136 @@
+// ============================================================
+//  Metrics.cpp  –  Per-thread metric blocks + aggregation
+//  Zero-Latency Network Video Fuser
+// ============================================================
+
+#include "Metrics.h"
+#include <algorithm>
+#include <mutex>
+
+namespace
+{
+    // Static storage → zero-initialised before any thread runs
+    MetricsBlock          g_blocks[METRIC_MAX_THREADS + 1];
+    std::mutex            g_registerMtx;                  // guards the rest
+    uint32_t              g_used = 0;                     // blocks ever handed out
+    bool                  g_inUse[METRIC_MAX_THREADS];    // … and held by a live thread
+    uint64_t              g_retired[METRIC_COUNTERS];     // counters of threads that exited
+
+    void ClearGauges(MetricsBlock& b)
+    {
+        for (size_t i = 0; i < METRIC_GAUGES; ++i)
+            b.gauges[i].store(METRIC_GAUGE_UNSET, std::memory_order_relaxed);
+    }
+
+    MetricsBlock& Overflow()
+    {
+        static MetricsBlock* b = [] {
+            MetricsBlock* p = &g_blocks[METRIC_MAX_THREADS];
+            ClearGauges(*p);
+            p->shared = true;
+            return p;
+        }();
+        return *b;
+    }
+
+    // Gives the thread's block back when the thread exits
+    struct BlockLease
+    {
+        MetricsBlock* block = nullptr;
+
+        ~BlockLease()
+        {
+            if (!block)
+                return;
+            {
+                std::lock_guard<std::mutex> lock(g_registerMtx);
+                for (size_t i = 0; i < METRIC_COUNTERS; ++i)
+                {
+                    g_retired[i] += block->counters[i].load(std::memory_order_relaxed);
+                    block->counters[i].store(0, std::memory_order_relaxed);
+                }
+                ClearGauges(*block);
+                g_inUse[block - g_blocks] = false;
+            }
+            // Whatever the thread records on its way out goes to the shared block
+            Metrics::t_block = &Overflow();
+        }
+    };
+    thread_local BlockLease t_lease;
+
+    constexpr const char* COUNTER_NAMES[METRIC_COUNTERS] = {
+        "packets_received", "bytes_received", "packets_duplicate", "packets_out_of_range",
+        "packets_malformed", "packets_no_stream", "frames_timed_out", "frames_evicted", "frames_completed",
+        "bytes_completed", "frames_presented", "frames_dropped", "render_time_us_total",
+        "impair_dropped", "impair_duplicated", "impair_reordered", "frames_ref_missing",
+        "frames_captured", "capture_timeouts", "frames_empty", "frames_sent",
+        "packets_sent", "bytes_sent", "send_errors", "frames_unchanged", "frames_keepalive",
+        "captures_superseded", "frames_superseded", "capture_stage_us_total", "encode_stage_us_total",
+        "send_stage_us_total", "keyframes_sent", "delta_frames_sent", "delta_bytes_saved",
+        "keyframe_requests", "tile_hits", "tile_misses", "reports_other_stream",
+    };
+
+    constexpr const char* GAUGE_NAMES[METRIC_GAUGES] = {
+        "render_time_us", "arrival_gap_us", "arrival_jitter_us",
+        "clock_offset_us", "clock_rtt_us", "feedback_receivers", "worst_rx_loss_bp",
+        "pace_interval_us", "send_scale", "send_format", "tile_cache_used",
+    };
+}
+
+namespace Metrics
+{
+    thread_local MetricsBlock* t_block = nullptr;
+
+    MetricsBlock* AcquireBlock()
+    {
+        std::lock_guard<std::mutex> lock(g_registerMtx);
+        uint32_t idx = 0;
+        while (idx < g_used && g_inUse[idx])
+            ++idx;
+        if (idx == METRIC_MAX_THREADS)
+            return &Overflow();   // its gauges stay with it
+
+        // A block given back has zero counters and unset gauges already
+        if (idx == g_used)
+        {
+            ClearGauges(g_blocks[idx]);
+            ++g_used;
+        }
+        g_inUse[idx]  = true;
+        t_lease.block = &g_blocks[idx];
+        return &g_blocks[idx];
+    }
+
+    void Aggregate(MetricsSnapshot& out)
+    {
+        out = MetricsSnapshot{};
+        int64_t gauges[METRIC_GAUGES];
+        std::fill(gauges, gauges + METRIC_GAUGES, METRIC_GAUGE_UNSET);
+        auto sum = [&](const MetricsBlock& b) {
+            for (size_t i = 0; i < METRIC_COUNTERS; ++i)
+                out.counters[i] += b.counters[i].load(std::memory_order_relaxed);
+            for (size_t i = 0; i < METRIC_GAUGES; ++i)
+                gauges[i] = std::max(gauges[i], b.gauges[i].load(std::memory_order_relaxed));
+        };
+        std::lock_guard<std::mutex> lock(g_registerMtx);   // not while a block is given back
+        for (uint32_t i = 0; i < g_used; ++i)
+            sum(g_blocks[i]);
+        sum(Overflow());
+        for (size_t i = 0; i < METRIC_COUNTERS; ++i)
+            out.counters[i] += g_retired[i];
+        for (size_t i = 0; i < METRIC_GAUGES; ++i)
+            out.gauges[i] = gauges[i] == METRIC_GAUGE_UNSET ? 0 : gauges[i];
+    }
+
+    const char* Name(MetricCounter c)
+    {
+        const size_t i = static_cast<size_t>(c);
+        return i < METRIC_COUNTERS ? COUNTER_NAMES[i] : "?";
+    }
+
+    const char* Name(MetricGauge g)
+    {
+        const size_t i = static_cast<size_t>(g);
+        return i < METRIC_GAUGES ? GAUGE_NAMES[i] : "?";
+    }
+}
@@ -0,0 +1,164 @@
+#pragma once
+// ============================================================
+//  Metrics.h  –  Lock-free runtime counters and gauges
+//  Every thread that records gets its own cache-line-aligned
+//  block on first use, so the hot path is a plain load + store
+//  on memory no other thread writes. When the thread exits its
+//  counters move to a running total and its gauges are dropped,
+//  and the block goes to the next thread – modules can come and
+//  go in one process without leaving stale values behind.
+//  MetricsExporter sums the blocks periodically and publishes the
+//  totals; nothing here logs or allocates after registration.
+//
+//  Portable – no Windows headers.
+// ============================================================
+#include "LatencyStats.h"
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+enum class MetricCounter : uint32_t
+{
+    // Receiver
+    PacketsReceived,
+    BytesReceived,
+    PacketsDuplicate,     // already had this PacketIndex
+    PacketsOutOfRange,    // index / offset / packet count inconsistent with the frame
+    PacketsMalformed,     // too short, bad metadata, non-video datagrams
+    PacketsNoStream,      // from a source beyond the MAX_STREAMS the receiver tracks
+    FramesTimedOut,       // incomplete frame passed its reassembly deadline
+    FramesEvicted,        // incomplete frame pushed out by a newer one
+    FramesCompleted,
+    BytesCompleted,       // pixel bytes of completed frames (goodput)
+    FramesPresented,      // rendered, or published to the frame ring
+    FramesDropped,        // complete but not shown (ring slot too small)
+    RenderTimeUsTotal,    // sum over FramesPresented
+    ImpairDropped,        // impairment shim: lost, burst-lost or queue overflow
+    ImpairDuplicated,
+    ImpairReordered,
+    FramesRefMissing,     // delta / tiled frame whose reference wasn't held (lost / late) – dropped, keyframe asked for
+
+    // Sender
+    FramesCaptured,
+    CaptureTimeouts,
+    FramesEmpty,          // captured but fully transparent – sent as an empty frame on change / keepalive
+    FramesSent,
+    PacketsSent,
+    BytesSent,
+    SendErrors,
+    FramesUnchanged,      // captured (or reported by the source) identical to the last one sent – not sent
+    FramesKeepalive,      // unchanged frame resent after KeepaliveMs
+    CapturesSuperseded,   // replaced by a newer capture before the encode stage took it
+    FramesSuperseded,     // encoded, replaced by a newer frame before the transmit stage took it
+    CaptureStageUsTotal,  // time in the capture source, waiting for a frame included
+    EncodeStageUsTotal,   // bbox, crop / scale, compare and pack
+    SendStageUsTotal,     // delta code, packetise + sendto
+    KeyframesSent,        // DeltaCodec: bands sent whole (or tiled) as a new reference
+    DeltaFramesSent,      // DeltaCodec: bands sent as the difference to the last one
+    DeltaBytesSaved,      // pixel bytes the delta frames didn't send
+    KeyframeRequests,     // receivers that asked for a keyframe
+    TileHits,             // TileCache: tiles sent as a slot the receivers hold
+    TileMisses,           // TileCache: tiles sent whole (and cached)
+    ReportsOtherStream,   // loss reports / keyframe requests for another StreamId – ignored
+
+    Count
+};
+
+enum class MetricGauge : uint32_t
+{
+    RenderTimeUs,         // last frame
+    ArrivalGapUs,         // reassembly's smoothed intra-frame packet gap
+    ArrivalJitterUs,
+    ClockOffsetUs,        // receiver − sender
+    ClockRttUs,           // best RTT in the clock sync window
+    FeedbackReceivers,    // sender: receivers that reported loss in the last 3 s
+    WorstRxLossBp,        // sender: worst receiver's smoothed frame loss, 0.01 %
+    PaceIntervalUs,       // sender: loss-driven minimum frame interval (0 = unpaced)
+    SendScale,            // sender: resolution divisor of the last frame (1, 2, 4)
+    SendFormat,           // sender: WirePixels::Format of the last frame
+    TileCacheUsed,        // sender: tile cache slots filled
+
+    Count
+};
+
+static constexpr size_t METRIC_COUNTERS    = static_cast<size_t>(MetricCounter::Count);
+static constexpr size_t METRIC_GAUGES      = static_cast<size_t>(MetricGauge::Count);
+static constexpr size_t METRIC_MAX_THREADS = 32;   // further threads share one atomic block
+static constexpr int64_t METRIC_GAUGE_UNSET = INT64_MIN;   // block's thread hasn't set the gauge
+
+// ─── One thread's values ─────────────────────────────────────
+struct alignas(64) MetricsBlock
+{
+    std::atomic<uint64_t> counters[METRIC_COUNTERS];
+    std::atomic<int64_t>  gauges[METRIC_GAUGES];   // METRIC_GAUGE_UNSET until set
+    bool                  shared = false;   // overflow block: several writers
+
+    void Add(MetricCounter c, uint64_t n)
+    {
+        std::atomic<uint64_t>& v = counters[static_cast<size_t>(c)];
+        if (shared) v.fetch_add(n, std::memory_order_relaxed);
+        else        v.store(v.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+    void Set(MetricGauge g, int64_t value)
+    {
+        gauges[static_cast<size_t>(g)].store(value, std::memory_order_relaxed);
+    }
+};
+
+// ─── Summed over all threads ─────────────────────────────────
+// Counters add up. A gauge can be set by several threads – every
+// receive lane, every module in the process – and reports the
+// worst of them: lane 0's gap alone would hide the others', and
+// their sum means nothing.
+struct MetricsSnapshot
+{
+    uint64_t counters[METRIC_COUNTERS] = {};
+    int64_t  gauges[METRIC_GAUGES]     = {};   // largest value any thread set; 0 if none did
+
+    uint64_t operator[](MetricCounter c) const { return counters[static_cast<size_t>(c)]; }
+    int64_t  operator[](MetricGauge g)   const { return gauges[static_cast<size_t>(g)]; }
+};
+
+namespace Metrics
+{
+    // Block for the calling thread (registers it on first call)
+    MetricsBlock* AcquireBlock();
+
+    extern thread_local MetricsBlock* t_block;
+
+    inline MetricsBlock& Local()
+    {
+        if (!t_block) t_block = AcquireBlock();
+        return *t_block;
+    }
+
+    inline void Add(MetricCounter c, uint64_t n = 1) { Local().Add(c, n); }
+    inline void Set(MetricGauge g, int64_t value)    { Local().Set(g, value); }
+
+    void        Aggregate(MetricsSnapshot& out);
+
+    const char* Name(MetricCounter c);
+    const char* Name(MetricGauge g);
+}
+
+// ─── Shared-memory snapshot (written by MetricsExporter) ────
+// Named mapping "Local\\<StatsShmName>" (Windows) / "/<name>"
+// (POSIX). Seqlock like FrameRingSlot: re-read if `seq` is odd
+// or changed while copying.
+static constexpr uint32_t METRICS_SHM_MAGIC   = 0x534D4B46;   // 'FKMS'
+static constexpr uint32_t METRICS_SHM_VERSION = 11;
+static constexpr size_t   METRICS_STAGES      = static_cast<size_t>(LatencyStage::Count);
+
+struct alignas(64) MetricsShm
+{
+    uint32_t              magic;
+    uint32_t              version;
+    std::atomic<uint32_t> seq;
+    uint32_t              counterCount;   // METRIC_COUNTERS
+    uint32_t              gaugeCount;     // METRIC_GAUGES
+    uint32_t              stageCount;     // METRICS_STAGES
+    uint64_t              updatedUs;      // writer's steady clock
+    uint64_t              counters[METRIC_COUNTERS];
+    int64_t               gauges[METRIC_GAUGES];
+    uint64_t              latencyUs[METRICS_STAGES][4];   // p50, p99, p99.9, samples (since start)
+};
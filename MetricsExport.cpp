@@ -0,0 +1,225 @@
+// ============================================================
+//  MetricsExport.cpp  –  Stats endpoint + shared-memory snapshot
+//  Zero-Latency Network Video Fuser
+// ============================================================
+
+#include "MetricsExport.h"
+#include <new>
+
+bool MetricsExporter::Start(const FuserConfig& cfg, const LatencyStats* latency)
+{
+    m_cfg     = cfg;
+    m_latency = latency;
+    if (m_cfg.statsIntervalMs == 0)
+        return false;
+
+    if (!m_cfg.statsShmName.empty())
+    {
+        if (m_shmMap.Create(m_cfg.statsShmName, sizeof(MetricsShm)))
+        {
+            m_shm = new (m_shmMap.Base()) MetricsShm;
+            m_shm->magic        = METRICS_SHM_MAGIC;
+            m_shm->version      = METRICS_SHM_VERSION;
+            m_shm->seq.store(0, std::memory_order_relaxed);
+            m_shm->counterCount = static_cast<uint32_t>(METRIC_COUNTERS);
+            m_shm->gaugeCount   = static_cast<uint32_t>(METRIC_GAUGES);
+            m_shm->stageCount   = static_cast<uint32_t>(METRICS_STAGES);
+            FuserUtil::Log("[Stats] Snapshot in shared memory '%s'\n", m_cfg.statsShmName.c_str());
+        }
+        else
+        {
+            FuserUtil::Log("[Stats] Cannot create shared memory '%s'\n", m_cfg.statsShmName.c_str());
+        }
+    }
+
+    if (m_cfg.statsPort != 0)
+    {
+        m_sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+        sockaddr_in local{};
+        local.sin_family = AF_INET;
+        local.sin_port   = htons(m_cfg.statsPort);
+        inet_pton(AF_INET, "127.0.0.1", &local.sin_addr);
+        if (m_sock == INVALID_SOCKET ||
+            bind(m_sock, (sockaddr*)&local, sizeof(local)) == SOCKET_ERROR)
+        {
+            FuserUtil::Log("[Stats] Cannot bind 127.0.0.1:%u (code %d) – UDP endpoint disabled\n",
+                           m_cfg.statsPort, WSAGetLastError());
+            if (m_sock != INVALID_SOCKET) closesocket(m_sock);
+            m_sock = INVALID_SOCKET;
+        }
+        else
+        {
+            FuserUtil::Log("[Stats] Endpoint on udp://127.0.0.1:%u\n", m_cfg.statsPort);
+        }
+    }
+
+    m_running = true;
+    m_thread  = std::thread([this]{ ThreadProc(); });
+    return true;
+}
+
+void MetricsExporter::Stop()
+{
+    m_running = false;
+    if (m_thread.joinable()) m_thread.join();
+    if (m_sock != INVALID_SOCKET) { closesocket(m_sock); m_sock = INVALID_SOCKET; }
+    m_shm = nullptr;
+    m_shmMap.Close();
+}
+
+void MetricsExporter::ThreadProc()
+{
+    const uint64_t intervalUs = static_cast<uint64_t>(m_cfg.statsIntervalMs) * 1000;
+    uint64_t nextTick = 0;
+    char     req[64];
+
+    while (m_running)
+    {
+        uint64_t now = FuserUtil::NowUs();
+        if (now >= nextTick)
+        {
+            Publish(now);
+            nextTick = now + intervalUs;
+        }
+
+        // Wait for a query or the next tick, whichever is first
+        // (capped so Stop() is noticed promptly)
+        const uint64_t waitUs = std::min<uint64_t>(nextTick - now, 100000);
+        if (m_sock == INVALID_SOCKET)
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds(waitUs));
+            continue;
+        }
+
+        fd_set rd;
+        FD_ZERO(&rd);
+        FD_SET(m_sock, &rd);
+        timeval tv;
+        tv.tv_sec  = static_cast<long>(waitUs / 1000000);
+        tv.tv_usec = static_cast<long>(waitUs % 1000000);
+        if (select(0, &rd, nullptr, nullptr, &tv) <= 0)
+            continue;
+
+        sockaddr_in from{};
+        int fromLen = sizeof(from);
+        if (recvfrom(m_sock, req, sizeof(req), 0, (sockaddr*)&from, &fromLen) == SOCKET_ERROR)
+            continue;
+        sendto(m_sock, m_text.data(), static_cast<int>(m_text.size()), 0, (sockaddr*)&from, fromLen);
+    }
+}
+
+// ─── Aggregate once and fan out to every sink ────────────────
+void MetricsExporter::Publish(uint64_t nowUs)
+{
+    MetricsSnapshot snap;
+    Metrics::Aggregate(snap);
+
+    uint64_t lat[METRICS_STAGES][4] = {};
+    if (m_latency)
+    {
+        LatencySnapshot h;
+        for (size_t i = 0; i < METRICS_STAGES; ++i)
+        {
+            m_latency->Snapshot(static_cast<LatencyStage>(i), h);
+            lat[i][0] = h.Percentile(0.50);
+            lat[i][1] = h.Percentile(0.99);
+            lat[i][2] = h.Percentile(0.999);
+            lat[i][3] = h.total;
+        }
+    }
+
+    // ── Shared memory (seqlock) ──────────────────────────────
+    if (m_shm)
+    {
+        const uint32_t s0 = m_shm->seq.load(std::memory_order_relaxed);
+        m_shm->seq.store(s0 + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        m_shm->updatedUs = nowUs;
+        std::memcpy(m_shm->counters,  snap.counters, sizeof(snap.counters));
+        std::memcpy(m_shm->gauges,    snap.gauges,   sizeof(snap.gauges));
+        std::memcpy(m_shm->latencyUs, lat,           sizeof(lat));
+        m_shm->seq.store(s0 + 2, std::memory_order_release);
+    }
+
+    // ── Text for the UDP endpoint ────────────────────────────
+    char line[128];
+    m_text.clear();
+    snprintf(line, sizeof(line), "role %s\nnow_us %llu\n", m_cfg.isSender ? "sender" : "receiver",
+             static_cast<unsigned long long>(nowUs));
+    m_text += line;
+    for (size_t i = 0; i < METRIC_COUNTERS; ++i)
+    {
+        snprintf(line, sizeof(line), "%s %llu\n", Metrics::Name(static_cast<MetricCounter>(i)),
+                 static_cast<unsigned long long>(snap.counters[i]));
+        m_text += line;
+    }
+    for (size_t i = 0; i < METRIC_GAUGES; ++i)
+    {
+        snprintf(line, sizeof(line), "%s %lld\n", Metrics::Name(static_cast<MetricGauge>(i)),
+                 static_cast<long long>(snap.gauges[i]));
+        m_text += line;
+    }
+    if (m_latency)
+    {
+        for (size_t i = 0; i < METRICS_STAGES; ++i)
+        {
+            if (lat[i][3] == 0) continue;
+            snprintf(line, sizeof(line), "latency %s p50 %llu p99 %llu p99.9 %llu n %llu\n",
+                     LatencyStageName(static_cast<LatencyStage>(i)),
+                     static_cast<unsigned long long>(lat[i][0]), static_cast<unsigned long long>(lat[i][1]),
+                     static_cast<unsigned long long>(lat[i][2]), static_cast<unsigned long long>(lat[i][3]));
+            m_text += line;
+        }
+    }
+
+    LogSummary(snap, nowUs);
+}
+
+// ─── Rates since the previous summary, one log line ──────────
+void MetricsExporter::LogSummary(const MetricsSnapshot& now, uint64_t nowUs)
+{
+    if (m_cfg.statsLogIntervalMs == 0)
+        return;
+    if (m_lastLogUs == 0) { m_lastLogged = now; m_lastLogUs = nowUs; return; }
+    if (nowUs - m_lastLogUs < static_cast<uint64_t>(m_cfg.statsLogIntervalMs) * 1000)
+        return;
+
+    const double secs = (nowUs - m_lastLogUs) / 1e6;
+    auto d = [&](MetricCounter c) { return now[c] - m_lastLogged[c]; };
+
+    if (m_cfg.isSender)
+    {
+        FuserUtil::Log("[Stats] tx %.0f frames/s, %.0f pkt/s, %.1f MB/s | captured %llu, empty %llu, "
+                       "send errors %llu\n",
+                       d(MetricCounter::FramesSent) / secs, d(MetricCounter::PacketsSent) / secs,
+                       d(MetricCounter::BytesSent) / secs / 1e6,
+                       static_cast<unsigned long long>(d(MetricCounter::FramesCaptured)),
+                       static_cast<unsigned long long>(d(MetricCounter::FramesEmpty)),
+                       static_cast<unsigned long long>(d(MetricCounter::SendErrors)));
+
+        const uint64_t hits  = d(MetricCounter::TileHits);
+        const uint64_t tiles = hits + d(MetricCounter::TileMisses);
+        if (tiles)
+            FuserUtil::Log("[Stats] tile cache %.1f%% hit (%llu of %llu tiles), %lld slots in use\n",
+                           100.0 * hits / tiles, static_cast<unsigned long long>(hits),
+                           static_cast<unsigned long long>(tiles),
+                           static_cast<long long>(now[MetricGauge::TileCacheUsed]));
+    }
+    else
+    {
+        const uint64_t shown = d(MetricCounter::FramesPresented);
+        FuserUtil::Log("[Stats] rx %.0f pkt/s, %.1f MB/s | frames %.0f/s complete, %.0f/s shown | "
+                       "timeout %llu, evict %llu, dup %llu, bad %llu | render avg %.0f us\n",
+                       d(MetricCounter::PacketsReceived) / secs, d(MetricCounter::BytesReceived) / secs / 1e6,
+                       d(MetricCounter::FramesCompleted) / secs, shown / secs,
+                       static_cast<unsigned long long>(d(MetricCounter::FramesTimedOut)),
+                       static_cast<unsigned long long>(d(MetricCounter::FramesEvicted)),
+                       static_cast<unsigned long long>(d(MetricCounter::PacketsDuplicate)),
+                       static_cast<unsigned long long>(d(MetricCounter::PacketsOutOfRange) +
+                                                       d(MetricCounter::PacketsMalformed) +
+                                                       d(MetricCounter::PacketsNoStream)),
+                       shown ? static_cast<double>(d(MetricCounter::RenderTimeUsTotal)) / shown : 0.0);
+    }
+    m_lastLogged = now;
+    m_lastLogUs  = nowUs;
+}
@@ -0,0 +1,44 @@
+#pragma once
+// ============================================================
+//  MetricsExport.h  –  Periodic metrics aggregation + export
+//  Once per StatsIntervalMs the exporter sums all per-thread
+//  metric blocks (plus latency percentiles when a LatencyStats
+//  is attached) and publishes them:
+//    • shared memory  – MetricsShm (see Metrics.h)
+//    • UDP 127.0.0.1:StatsPort – any datagram is answered with
+//      the latest snapshot as "name value" text lines
+//    • a one-line summary in the log every StatsLogIntervalMs
+// ============================================================
+#include "NetworkFuser.h"
+#include "Metrics.h"
+#include "FrameRing.h"
+
+class MetricsExporter
+{
+public:
+    MetricsExporter() = default;
+    ~MetricsExporter() { Stop(); }
+    MetricsExporter(const MetricsExporter&)            = delete;
+    MetricsExporter& operator=(const MetricsExporter&) = delete;
+
+    // latency may be null (sender)
+    bool Start(const FuserConfig& cfg, const LatencyStats* latency);
+    void Stop();
+
+private:
+    void ThreadProc();
+    void Publish(uint64_t nowUs);
+    void LogSummary(const MetricsSnapshot& now, uint64_t nowUs);
+
+    FuserConfig          m_cfg;
+    const LatencyStats*  m_latency = nullptr;
+    SOCKET               m_sock    = INVALID_SOCKET;
+    FrameRingMapping     m_shmMap;
+    MetricsShm*          m_shm     = nullptr;
+    std::atomic<bool>    m_running{false};
+    std::thread          m_thread;
+
+    std::string          m_text;            // latest snapshot, served over UDP
+    MetricsSnapshot      m_lastLogged{};
+    uint64_t             m_lastLogUs = 0;
+};
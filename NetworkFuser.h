@@ -43,26 +43,44 @@
 // ─── Build-time constants ────────────────────────────────────
 static constexpr uint16_t FUSER_PORT          = 9877;          // UDP port
 static constexpr uint32_t MAX_UDP_PAYLOAD     = 1400;          // bytes per packet (avoids IP fragmentation)
-static constexpr uint32_t HEADER_SIZE         = 8;             // bytes: FrameID(4) + PktIdx(2) + TotalPkts(2)
-static constexpr uint32_t MAX_PIXEL_PAYLOAD   = MAX_UDP_PAYLOAD - HEADER_SIZE;  // 1392 bytes
+static constexpr uint32_t MIN_DATAGRAM_BYTES  = 512;           // PacketBytes lower bound
+static constexpr uint32_t MAX_DATAGRAM_BYTES  = 8972;          // PacketBytes upper bound (9000-byte jumbo MTU)
+static constexpr uint32_t HEADER_SIZE         = 16;            // bytes: see FuserPacketHeader
+static constexpr uint32_t MAX_PIXEL_PAYLOAD   = MAX_UDP_PAYLOAD - HEADER_SIZE;  // 1384 bytes
+static constexpr uint32_t META_REPEAT_INTERVAL = 32;           // FrameMetaPayload copy every N packets
 static constexpr uint32_t IOCP_RECV_BUFFERS   = 256;           // pending WSARecvFrom calls
 static constexpr uint32_t REASSEMBLY_SLOTS    = 8;             // ring-buffer depth for frame reassembly
-static constexpr uint32_t FRAME_TIMEOUT_MS    = 5;             // drop incomplete frame after N ms
+static constexpr uint32_t MAX_PACKETS_PER_FRAME = 0xFFFF;      // FuserPacketHeader::TotalPackets is 16-bit
+static constexpr uint32_t MAX_STRIPES         = 8;             // sockets / receive threads per stream
+static constexpr uint32_t MAX_STREAMS         = 8;             // concurrent senders one receiver composites
+static constexpr uint32_t MAX_STREAM_ID       = 90;            // keeps FeedbackPort below Port+100 (StatsPort)
+static constexpr uint32_t MAX_BANDS           = 8;             // horizontal bands a capture is sent in
+static constexpr uint32_t REASM_MIN_TIMEOUT_US = 1000;         // adaptive frame deadline lower bound
+static constexpr uint32_t REASM_MAX_TIMEOUT_US = 40000;        // adaptive frame deadline upper bound
 static constexpr uint32_t MAX_FRAME_BYTES     = 7680 * 4320 * 4; // worst-case 8K BGRA
 static constexpr uint32_t SENDER_CAPTURE_RES_W = 3840;
 static constexpr uint32_t SENDER_CAPTURE_RES_H = 2160;
 
-// ─── 8-byte packet header (packed, no padding) ──────────────
+// ─── 16-byte packet header (packed, no padding) ─────────────
+// Every packet is self-describing: PayloadOffset places its slice
+// without reference to any other packet, so slices can be stored
+// in whatever order they arrive.
 #pragma pack(push, 1)
 struct FuserPacketHeader
 {
     uint32_t FrameID;       // monotonically increasing frame counter
     uint16_t PacketIndex;   // 0-based index of this slice within the frame
     uint16_t TotalPackets;  // total slices that make up the complete frame
+    uint32_t PayloadOffset; // byte offset of this packet's slice in the frame
+    uint16_t Flags;         // PKT_FLAG_*
+    uint16_t StreamID;      // sender's StreamId; with its IP it keys reassembly
 };
 static_assert(sizeof(FuserPacketHeader) == HEADER_SIZE, "Header size mismatch");
 #pragma pack(pop)
 
+// FuserPacketHeader::Flags
+static constexpr uint16_t PKT_FLAG_META = 0x0001;  // FrameMetaPayload follows the header
+
 // ─── Bounding box for cropped transmission ──────────────────
 struct BoundingBox
 {
@@ -73,30 +91,173 @@ struct BoundingBox
 struct FuserConfig
 {
     bool     isSender       = false;
-    std::string localIP     = "0.0.0.0";   // sender: bind IP; receiver: ignored
+    std::string localIP     = "0.0.0.0";   // sender: bind IP; receiver: multicast join interface
     std::string remoteIP    = "0.0.0.0";   // sender: destination IP
     uint16_t port           = FUSER_PORT;
+    uint32_t packetBytes    = MAX_UDP_PAYLOAD;   // sender datagram size (MTU − IP/UDP headers)
+    uint32_t stripes        = 1;           // sockets a frame is striped across (see StripePort)
+    uint16_t streamID       = 0;           // sender: tells streams from one machine apart
     int      adapterIndex   = -1;          // -1 = auto-select
     int      captureMonitor = 0;           // DXGI output index
+
+    // IP multicast: one sender, any number of receivers. Empty group
+    // = unicast / broadcast to remoteIP. Both sides use localIP as
+    // the interface (0.0.0.0 = let the stack choose).
+    std::string multicastGroup = "";
+    uint32_t    multicastTtl   = 1;        // 1 = never leaves the local segment
+    bool        multicastLoop  = true;     // deliver to receivers on the sending host too
+
+    // Loss feedback (see LossFeedback.h): receivers report per stream
+    // to FeedbackPort, the sender paces its frame rate to the worst one
+    uint32_t    feedbackIntervalMs = 250;  // receiver; 0 = no reports
+    bool        adaptToLoss        = true; // sender; false = only log / export
+
+    // Sender frame source: "dxgi", "synthetic" or "file"
+    std::string captureSource        = "dxgi";
+    uint32_t    syntheticWidth       = 1920;
+    uint32_t    syntheticHeight      = 1080;
+    uint32_t    syntheticFps         = 144;
+    uint32_t    syntheticFillPercent = 5;
+    uint32_t    syntheticBoxes       = 8;
+    bool        syntheticText        = true;
+    std::string captureFilePath;                // raw BGRA frames, back to back
+    uint32_t    captureFileWidth     = 1920;
+    uint32_t    captureFileHeight    = 1080;
+    uint32_t    captureFileFps       = 144;
+
+    // Sender resolution divisor after the crop (FrameScale.h):
+    // 1 = full size, 2 / 4 = half / quarter, 0 = auto – step down
+    // while receivers report loss, before the frame rate is paced
+    uint32_t    downscale            = 1;
+
+    // Sender wire pixel format (WirePixels.h): "bgra", "bgr24",
+    // "rgb565" or "argb4444". wireMono tries A8 + one colour on
+    // every frame first and falls back to wireFormat when the
+    // frame has more than one colour.
+    uint32_t    wireFormat           = 0;      // WirePixels::Format
+    bool        wireMono             = false;
+
+    // Sender: horizontal bands each capture is cut into (1..MAX_BANDS).
+    // Every band is cropped, sent and placed on its own, as soon as
+    // the source has copied its rows – band 0 is on the wire while
+    // the rest of the frame is still coming off the GPU.
+    uint32_t    frameBands           = 1;
+
+    // Sender temporal delta coding (FrameDelta.h): each band goes out
+    // as its difference to the last one sent, with a keyframe every
+    // keyframeInterval frames of the band (0 = only when needed), on
+    // keepalive and whenever a receiver asks for one.
+    bool        deltaCodec           = false;
+    uint32_t    keyframeInterval     = 120;
+
+    // Sender tile cache (TileCache.h): what would go out whole is cut
+    // into 16×16 tiles, and those receivers already hold go as a slot
+    // of their LRU cache of tileCacheEntries (1..16384) tiles.
+    bool        tileCache            = false;
+    uint32_t    tileCacheEntries     = 4096;
+
+    // Sender capture scheduling (CaptureScheduler.h)
+    uint32_t    captureMaxFps        = 0;      // 0 = no cap
+    bool        skipUnchanged        = true;   // don't resend identical frames …
+    uint32_t    keepaliveMs          = 1000;   // … until this long has passed (0 = never)
+
+    // Reassembly deadline bounds (receiver). The actual per-frame
+    // deadline is derived from measured arrival rate + jitter.
+    uint32_t reasmMinTimeoutUs = REASM_MIN_TIMEOUT_US;
+    uint32_t reasmMaxTimeoutUs = REASM_MAX_TIMEOUT_US;
+
+    // Headless receiver: no overlay window / D3D11; completed frames
+    // are published to a shared-memory ring for local consumers.
+    bool        headless           = false;
+    std::string frameRingName      = "KnoxFuserFrames";
+    uint32_t    frameRingSlots     = 4;
+    uint32_t    frameRingSlotBytes = SENDER_CAPTURE_RES_W * SENDER_CAPTURE_RES_H * 4;
+
+    // Packet trace capture / replay (receiver)
+    std::string recordTracePath;           // empty = don't record
+    uint32_t    traceMaxMB         = 1024;
+    std::string replayTracePath;           // non-empty = replay instead of listening
+    bool        replayRealtime     = true; // false = as fast as possible
+
+    // NTP-style ping interval on the discovery port (receiver → sender)
+    uint32_t    clockSyncIntervalMs  = 250;    // 0 = no clock sync
+
+    // Runtime metrics export (both roles). StatsPort 0 = derive
+    // from Port (Port+100); StatsShmName empty = no shared memory.
+    uint16_t    statsPort            = 0;
+    uint32_t    statsIntervalMs      = 1000;   // 0 = exporter off
+    uint32_t    statsLogIntervalMs   = 10000;  // 0 = no summary log line
+    std::string statsShmName         = "KnoxFuserStats";
+
+    // Per-stage latency histograms are logged this often (receiver)
+    uint32_t    latencyLogIntervalMs = 5000;   // 0 = never
+
+    // Binary per-frame event trace (both roles); empty = off
+    std::string eventTracePath;
+    uint32_t    eventTraceMaxMB      = 256;
+
+    // Simulated lossy link on received datagrams (receiver, testing
+    // only – see NetworkImpairment.h); all zero = off
+    double      impairLossPercent       = 0;
+    double      impairBurstEnterPercent = 0;
+    double      impairBurstExitPercent  = 25;
+    double      impairBurstLossPercent  = 100;
+    uint32_t    impairRateMbps          = 0;
+    uint32_t    impairQueueKB           = 1024;
+    uint32_t    impairDelayUs           = 0;
+    uint32_t    impairJitterUs          = 0;
+    double      impairReorderPercent    = 0;
+    uint32_t    impairReorderUs         = 500;
+    double      impairDuplicatePercent  = 0;
+    uint32_t    impairSeed              = 1;
+
+    // Log calls only enqueue; a background thread formats + writes
+    bool        asyncLog             = true;
 };
 
 // ─── Reassembly slot (per-frame) ────────────────────────────
+// Filled by every receive thread at once (one per stripe). The
+// receipt bitmap, counters and deadline are atomics; everything
+// else is written either while MemoryReassembly holds the slot
+// exclusively (claim / release) or by the one thread that won
+// metaClaimed, and is read after hasMeta or receivedCount.
+static constexpr uint32_t RECEIPT_WORDS = (MAX_PACKETS_PER_FRAME + 63) / 64;
+
 struct FrameSlot
 {
-    uint32_t              frameID       = 0;
+    std::atomic<uint32_t> frameID{0};                 // 0 = free; published last on claim
+    std::atomic<uint32_t> writers{0};                 // receive threads currently inside the slot
     uint32_t              totalPackets  = 0;
-    uint32_t              receivedCount = 0;
+    std::atomic<uint32_t> receivedCount{0};
     uint32_t              totalBytes    = 0;
-    bool                  complete      = false;
-    ULONGLONG             firstPacketMs = 0;
+    std::atomic<bool>     complete{false};
+    std::atomic<bool>     metaClaimed{false};         // one thread copies the FrameMetaPayload …
+    std::atomic<bool>     hasMeta{false};             // … and sets this when it is done
+    uint64_t              firstPacketUs = 0;
+    std::atomic<uint64_t> lastPacketUs{0};
+    std::atomic<uint64_t> deadlineUs{0};              // evict if still incomplete after this
     std::vector<uint8_t>  pixelData;                  // assembled BGRA buffer
-    std::vector<bool>     received;                   // per-packet receipt flags
+    std::atomic<uint64_t> received[RECEIPT_WORDS]{};  // per-packet receipt bits
     uint32_t              width         = 0;
     uint32_t              height        = 0;
+    uint32_t              originX       = 0;          // top-left on the sender's surface
+    uint32_t              originY       = 0;
+    uint64_t              senderCaptureUs = 0;        // from FrameMetaPayload (sender clock)
+    uint64_t              senderEncodeUs  = 0;
+    uint64_t              senderSendUs    = 0;
+    uint32_t              scale           = 1;        // FrameMetaPayload::scale (1, 2, 4)
+    uint32_t              format          = 0;        // FrameMetaPayload::format (WirePixels)
+    uint32_t              colour          = 0;        // FrameMetaPayload::colour
+    uint32_t              band            = 0;        // FrameMetaPayload::band
+    uint32_t              bandCount       = 1;        // FrameMetaPayload::bandCount (≥ 1)
+    uint32_t              codec           = 0;        // FrameMetaPayload::codec (FrameDelta)
+    uint32_t              refFrameID      = 0;        // FrameMetaPayload::refFrameID
 };
 
 // ─── Frame metadata prepended before pixel slices ───────────
-// Sent as packet 0 payload extension after the FuserPacketHeader
+// Carried after the FuserPacketHeader of every packet flagged
+// PKT_FLAG_META: packet 0, every META_REPEAT_INTERVAL-th packet
+// and the last packet, so one lost packet can't orphan a frame.
 #pragma pack(push, 1)
 struct FrameMetaPayload
 {
@@ -104,10 +265,39 @@ struct FrameMetaPayload
     uint32_t height;
     uint32_t originX;
     uint32_t originY;
-    uint32_t rawBytes;   // total BGRA bytes in this frame
+    uint32_t rawBytes;   // total pixel bytes in this frame (in `format`)
+
+    // Sender steady-clock stamps (µs) for latency measurement
+    uint64_t captureUs;  // frame acquired from the capture source
+    uint64_t encodeUs;   // bbox + crop done
+    uint64_t sendUs;     // packet 0 handed to the socket
+
+    // Resolution divisor (FrameScale): the pixels are the width×height
+    // rectangle shrunk to ⌈width/scale⌉×⌈height/scale⌉; 0 or 1 = full size
+    uint8_t  scale;
+
+    // Wire pixel format (WirePixels::Format; 0 = BGRA32) and, for
+    // A8, the one colour every pixel has (0x00RRGGBB)
+    uint8_t  format;
+
+    // Horizontal band of the capture this frame replaces (FrameBands):
+    // the rectangle is the visible part of band `band` of `bandCount`,
+    // and the receiver keeps the other bands as they are. 0 or 1 =
+    // the frame is the whole capture.
+    uint8_t  band;
+    uint8_t  bandCount;
+    uint32_t colour;
+
+    // Temporal coding (FrameDelta::Codec; 0 = plain pixels). For
+    // DELTA, rawBytes is the coded size and the pixels are the
+    // residual against frame refFrameID of the same band; for TILES
+    // it is the tile code, refFrameID the stream's tiled frame before.
+    uint8_t  codec;
+    uint8_t  reserved[3];
+    uint32_t refFrameID;
 };
 #pragma pack(pop)
-static constexpr uint32_t FRAME_META_SIZE = sizeof(FrameMetaPayload); // 20 bytes
+static constexpr uint32_t FRAME_META_SIZE = sizeof(FrameMetaPayload); // 60 bytes
 
 // ─── Logger (included here so every module can call FuserUtil::Log) ─
 #include "Logger.h"
@@ -139,6 +329,95 @@ namespace FuserUtil
                 std::chrono::steady_clock::now().time_since_epoch()).count());
     }
 
+    // High-precision timestamp in microseconds (same clock as NowMs)
+    inline uint64_t NowUs()
+    {
+        return static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    // UDP port of stripe `stripe`: Port itself, then Port+2, Port+3,
+    // … (Port+1 is the discovery / clock sync port)
+    inline uint16_t StripePort(uint16_t basePort, uint32_t stripe)
+    {
+        return static_cast<uint16_t>(stripe == 0 ? basePort : basePort + 1 + stripe);
+    }
+
+    // UDP port a sender takes loss reports and keyframe requests on:
+    // Port+1 for StreamId 0, then Port+1+MAX_STRIPES+StreamId, past
+    // the stripes, so senders sharing a host each get their own
+    inline uint16_t FeedbackPort(uint16_t basePort, uint16_t streamID)
+    {
+        return static_cast<uint16_t>(streamID == 0 ? basePort + 1 : basePort + 1 + MAX_STRIPES + streamID);
+    }
+
+    // ── Packet layout (shared by sender + receiver) ──────────
+    inline bool PacketCarriesMeta(uint32_t pktIdx, uint32_t totalPackets)
+    {
+        return pktIdx == 0 || pktIdx + 1 == totalPackets ||
+               (pktIdx % META_REPEAT_INTERVAL) == 0;
+    }
+
+    // Number of packetBytes-sized packets needed for frameBytes of
+    // pixel data once the replicated metadata copies are accounted for
+    inline uint32_t PacketsForFrame(uint32_t frameBytes, uint32_t packetBytes = MAX_UDP_PAYLOAD)
+    {
+        const uint32_t pixelPayload = packetBytes - HEADER_SIZE;
+        auto capacity = [pixelPayload](uint64_t n) -> uint64_t
+        {
+            const uint64_t metaCopies = 1 + (n - 1) / META_REPEAT_INTERVAL +
+                                        (((n - 1) % META_REPEAT_INTERVAL) ? 1 : 0);
+            return n * pixelPayload - metaCopies * FRAME_META_SIZE;
+        };
+        uint64_t n = std::max<uint64_t>(1, (frameBytes + pixelPayload - 1) / pixelPayload);
+        while (capacity(n) < frameBytes) ++n;
+        return static_cast<uint32_t>(n);
+    }
+
+    // Build packets 0..totalPackets-1 of a frame into `packetBuf`
+    // (packetBytes bytes) and hand each to send(const uint8_t*, int):
+    //   header | [FrameMetaPayload] | pixel slice
+    // Every packet carries its own byte offset; the metadata is
+    // replicated per PacketCarriesMeta. totalPackets must come from
+    // PacketsForFrame(meta.rawBytes, packetBytes).
+    template <typename SendFn>
+    inline void PacketizeFrame(uint32_t frameID, uint32_t totalPackets,
+                               const FrameMetaPayload& meta, const uint8_t* pixels,
+                               uint8_t* packetBuf, uint32_t packetBytes, uint16_t streamID,
+                               SendFn&& send)
+    {
+        const uint32_t frameBytes = meta.rawBytes;
+        uint32_t       offset     = 0;
+        for (uint32_t pktIdx = 0; pktIdx < totalPackets; ++pktIdx)
+        {
+            const bool withMeta = PacketCarriesMeta(pktIdx, totalPackets);
+
+            FuserPacketHeader hdr;
+            hdr.FrameID       = frameID;
+            hdr.PacketIndex   = static_cast<uint16_t>(pktIdx);
+            hdr.TotalPackets  = static_cast<uint16_t>(totalPackets);
+            hdr.PayloadOffset = offset;
+            hdr.Flags         = withMeta ? PKT_FLAG_META : 0;
+            hdr.StreamID      = streamID;
+
+            uint8_t* p = packetBuf;
+            std::memcpy(p, &hdr, HEADER_SIZE);          p += HEADER_SIZE;
+            if (withMeta)
+            {
+                std::memcpy(p, &meta, FRAME_META_SIZE); p += FRAME_META_SIZE;
+            }
+
+            const uint32_t room  = packetBytes - HEADER_SIZE - (withMeta ? FRAME_META_SIZE : 0);
+            const uint32_t slice = std::min(room, frameBytes - offset);
+            std::memcpy(p, pixels + offset, slice);
+            p      += slice;
+            offset += slice;
+
+            send(static_cast<const uint8_t*>(packetBuf), static_cast<int>(p - packetBuf));
+        }
+    }
+
     // Log to debugger output + stdout
     void Log(const char* fmt, ...);
 
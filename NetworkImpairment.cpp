@@ -0,0 +1,110 @@
+// ============================================================
+//  NetworkImpairment.cpp  –  Lossy-link simulator for testing
+//  Zero-Latency Network Video Fuser
+// ============================================================
+
+#include "NetworkImpairment.h"
+#include "Metrics.h"
+#include <cstdio>
+
+NetworkImpairment::NetworkImpairment(const ImpairmentParams& p)
+    : m_p(p)
+    , m_rng(p.seed)
+{}
+
+bool NetworkImpairment::Chance(double percent)
+{
+    return percent > 0 && m_pct(m_rng) < percent;
+}
+
+bool NetworkImpairment::Lose()
+{
+    if (m_p.burstEnterPercent > 0)
+        m_bad = m_bad ? !Chance(m_p.burstExitPercent) : Chance(m_p.burstEnterPercent);
+    return Chance(m_bad ? m_p.burstLossPercent : m_p.lossPercent);
+}
+
+void NetworkImpairment::Push(const uint8_t* data, int len, uint64_t nowUs, uint32_t tag)
+{
+    if (len <= 0) return;
+
+    if (Lose())
+    {
+        Metrics::Add(MetricCounter::ImpairDropped);
+        return;
+    }
+
+    // Bottleneck: Mbit/s == bit/µs. A packet that would find more
+    // than queueKB already waiting is tail-dropped.
+    double dueUs = static_cast<double>(nowUs);
+    if (m_p.rateMbps > 0)
+    {
+        const double now     = static_cast<double>(nowUs);
+        const double backlog = std::max(0.0, m_linkFreeUs - now) * m_p.rateMbps / 8.0;   // bytes
+        if (backlog + len > static_cast<double>(m_p.queueKB) * 1024.0)
+        {
+            Metrics::Add(MetricCounter::ImpairDropped);
+            return;
+        }
+        m_linkFreeUs = std::max(m_linkFreeUs, now) + len * 8.0 / m_p.rateMbps;
+        dueUs        = m_linkFreeUs;
+    }
+
+    dueUs += m_p.delayUs;
+    if (m_p.jitterUs > 0)
+        dueUs += std::uniform_int_distribution<uint32_t>(0, m_p.jitterUs)(m_rng);
+    if (Chance(m_p.reorderPercent))
+    {
+        dueUs += m_p.reorderUs;
+        Metrics::Add(MetricCounter::ImpairReordered);
+    }
+
+    const uint64_t due = static_cast<uint64_t>(dueUs);
+    Hold(data, len, due, tag);
+    if (Chance(m_p.duplicatePercent))
+    {
+        Hold(data, len, due, tag);
+        Metrics::Add(MetricCounter::ImpairDuplicated);
+    }
+}
+
+void NetworkImpairment::Hold(const uint8_t* data, int len, uint64_t dueUs, uint32_t tag)
+{
+    uint32_t idx;
+    if (!m_free.empty())
+    {
+        idx = m_free.back();
+        m_free.pop_back();
+    }
+    else
+    {
+        idx = static_cast<uint32_t>(m_buffers.size());
+        m_buffers.emplace_back();
+    }
+    m_buffers[idx].assign(data, data + len);
+
+    m_heap.push_back({ dueUs, m_seq++, idx, static_cast<uint32_t>(len), tag });
+    std::push_heap(m_heap.begin(), m_heap.end(), Later);
+}
+
+void NetworkImpairment::Describe(char* out, size_t cap) const
+{
+    int n = snprintf(out, cap, "loss %.2f%%", m_p.lossPercent);
+    auto add = [&](const char* fmt, auto... args)
+    {
+        if (n >= 0 && static_cast<size_t>(n) < cap)
+            n += snprintf(out + n, cap - n, fmt, args...);
+    };
+    if (m_p.burstEnterPercent > 0)
+        add(", burst %.2f%%/%.2f%% (loss %.0f%%)", m_p.burstEnterPercent, m_p.burstExitPercent,
+            m_p.burstLossPercent);
+    if (m_p.rateMbps > 0)
+        add(", rate %u Mbit/s (queue %u KB)", m_p.rateMbps, m_p.queueKB);
+    if (m_p.delayUs > 0 || m_p.jitterUs > 0)
+        add(", delay %u us + 0..%u us", m_p.delayUs, m_p.jitterUs);
+    if (m_p.reorderPercent > 0)
+        add(", reorder %.2f%% by %u us", m_p.reorderPercent, m_p.reorderUs);
+    if (m_p.duplicatePercent > 0)
+        add(", duplicate %.2f%%", m_p.duplicatePercent);
+    add(", seed %u", m_p.seed);
+}
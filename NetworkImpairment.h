@@ -0,0 +1,107 @@
+#pragma once
+// ============================================================
+//  NetworkImpairment.h  –  Lossy-link simulator for testing
+//  Sits between recvfrom() and the reassembly path: every
+//  datagram is Push()ed in and comes back out of Release() when
+//  the simulated link would have delivered it – or never.
+//
+//  Applied in this order, like a bottleneck router + long path:
+//    1. loss      Gilbert–Elliott: random loss in the good state,
+//                 burst loss while in the bad state
+//    2. rate cap  serialised at rateMbps behind a drop-tail queue
+//                 of queueKB
+//    3. delay     fixed delayUs + uniform 0..jitterUs (jitter alone
+//                 can reorder, as on a real multi-path link)
+//    4. reorder   reorderPercent of packets held reorderUs longer
+//    5. duplicate duplicatePercent of packets delivered twice
+//
+//  Seeded, so a run with the same traffic is reproducible.
+//  Portable – no Windows headers.
+// ============================================================
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+
+struct ImpairmentParams
+{
+    double   lossPercent        = 0;     // per packet, good state
+    double   burstEnterPercent  = 0;     // per packet: good → bad (0 = no bursts)
+    double   burstExitPercent   = 25;    // per packet: bad → good (mean burst 1/exit)
+    double   burstLossPercent   = 100;   // per packet, bad state
+    uint32_t rateMbps           = 0;     // 0 = unlimited
+    uint32_t queueKB            = 1024;  // bottleneck buffer; overflow is dropped
+    uint32_t delayUs            = 0;
+    uint32_t jitterUs           = 0;
+    double   reorderPercent     = 0;
+    uint32_t reorderUs          = 500;
+    double   duplicatePercent   = 0;
+    uint32_t seed               = 1;
+
+    bool Active() const
+    {
+        return lossPercent > 0 || burstEnterPercent > 0 || rateMbps > 0 || delayUs > 0 ||
+               jitterUs > 0 || reorderPercent > 0 || duplicatePercent > 0;
+    }
+};
+
+class NetworkImpairment
+{
+public:
+    explicit NetworkImpairment(const ImpairmentParams& p);
+
+    // Take one datagram that arrived at nowUs (copied). `tag` is
+    // handed back with it on delivery (the receiver's source address).
+    void Push(const uint8_t* data, int len, uint64_t nowUs, uint32_t tag = 0);
+
+    // Hand every datagram due by nowUs to
+    // deliver(const uint8_t*, int, uint32_t tag), earliest first
+    template <typename DeliverFn>
+    void Release(uint64_t nowUs, DeliverFn&& deliver)
+    {
+        while (!m_heap.empty() && m_heap.front().dueUs <= nowUs)
+        {
+            std::pop_heap(m_heap.begin(), m_heap.end(), Later);
+            const Held h = m_heap.back();
+            m_heap.pop_back();
+            deliver(static_cast<const uint8_t*>(m_buffers[h.buffer].data()), static_cast<int>(h.len), h.tag);
+            m_free.push_back(h.buffer);
+        }
+    }
+
+    bool     Holding() const { return !m_heap.empty(); }
+    uint64_t NextDueUs() const { return m_heap.empty() ? UINT64_MAX : m_heap.front().dueUs; }
+
+    // One-line description of the active impairments
+    void     Describe(char* out, size_t cap) const;
+
+private:
+    struct Held
+    {
+        uint64_t dueUs;
+        uint64_t seq;      // keeps equal due times in arrival order
+        uint32_t buffer;
+        uint32_t len;
+        uint32_t tag;
+    };
+    static bool Later(const Held& a, const Held& b)
+    {
+        return a.dueUs != b.dueUs ? a.dueUs > b.dueUs : a.seq > b.seq;
+    }
+
+    bool Chance(double percent);
+    bool Lose();                                  // one Gilbert–Elliott step
+    void Hold(const uint8_t* data, int len, uint64_t dueUs, uint32_t tag);
+
+    ImpairmentParams                       m_p;
+    std::mt19937_64                        m_rng;
+    std::uniform_real_distribution<double> m_pct{0.0, 100.0};
+    bool                                   m_bad        = false;
+    double                                 m_linkFreeUs = 0;   // rate cap: link idle again at
+    uint64_t                               m_seq        = 0;
+
+    std::vector<Held>                      m_heap;      // min-heap on (dueUs, seq)
+    std::vector<std::vector<uint8_t>>      m_buffers;
+    std::vector<uint32_t>                  m_free;
+};
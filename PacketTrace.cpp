@@ -0,0 +1,152 @@
+// ============================================================
+//  PacketTrace.cpp  –  Trace recorder + replay driver
+//  Zero-Latency Network Video Fuser
+// ============================================================
+
+#include "PacketTrace.h"
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+namespace
+{
+    uint64_t SteadyUs()
+    {
+        return static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    // Sleep most of the way, spin the rest – keeps replay gaps honest
+    // down to a few µs without burning a core for long waits
+    void WaitUntilUs(uint64_t targetUs)
+    {
+        for (;;)
+        {
+            const uint64_t now = SteadyUs();
+            if (now >= targetUs) return;
+            const uint64_t left = targetUs - now;
+            if (left > 2000)
+                std::this_thread::sleep_for(std::chrono::microseconds(left - 1000));
+            else
+                std::this_thread::yield();
+        }
+    }
+}
+
+// ─────────────────────────────────────────────────────────────
+//  PacketTraceWriter
+// ─────────────────────────────────────────────────────────────
+bool PacketTraceWriter::Open(const std::string& path, uint64_t maxBytes)
+{
+    Close();
+    if (maxBytes < sizeof(PacketTraceHeader) + PACKET_TRACE_RECORD_HDR)
+        return false;
+    if (!m_file.CreateWrite(path, maxBytes))
+        return false;
+
+    PacketTraceHeader hdr{};
+    std::memcpy(hdr.magic, PACKET_TRACE_MAGIC, sizeof(hdr.magic));
+    hdr.version = 1;
+    std::memcpy(m_file.Data(), &hdr, sizeof(hdr));
+
+    m_offset  = sizeof(PacketTraceHeader);
+    m_lastUs  = 0;
+    m_startUs = 0;
+    m_count   = 0;
+    m_dropped = 0;
+    return true;
+}
+
+void PacketTraceWriter::Append(const uint8_t* data, uint32_t len, uint64_t nowUs)
+{
+    if (!m_file.IsOpen()) return;
+    if (len > 0xFFFF || m_offset + PACKET_TRACE_RECORD_HDR + len > m_file.Size())
+    {
+        ++m_dropped;
+        return;
+    }
+
+    if (m_count == 0) { m_startUs = nowUs; m_lastUs = nowUs; }
+    const uint64_t gap   = (nowUs > m_lastUs) ? nowUs - m_lastUs : 0;
+    const uint32_t delta = (gap > 0xFFFFFFFFull) ? 0xFFFFFFFFu : static_cast<uint32_t>(gap);
+    const uint16_t len16 = static_cast<uint16_t>(len);
+
+    uint8_t* p = m_file.Data() + m_offset;
+    std::memcpy(p,     &delta, 4);
+    std::memcpy(p + 4, &len16, 2);
+    std::memcpy(p + PACKET_TRACE_RECORD_HDR, data, len);
+
+    m_offset += PACKET_TRACE_RECORD_HDR + len;
+    m_lastUs  = nowUs;
+    ++m_count;
+
+    // Keep the header roughly current so a crashed session still replays
+    if ((m_count & 1023) == 0)
+        CommitHeader();
+}
+
+void PacketTraceWriter::Close()
+{
+    if (!m_file.IsOpen()) return;
+    CommitHeader();
+    m_file.Close(m_offset);
+}
+
+void PacketTraceWriter::CommitHeader()
+{
+    PacketTraceHeader hdr;
+    std::memcpy(&hdr, m_file.Data(), sizeof(hdr));
+    hdr.startUs      = m_startUs;
+    hdr.recordCount  = m_count;
+    hdr.recordBytes  = m_offset - sizeof(PacketTraceHeader);
+    hdr.droppedCount = m_dropped;
+    std::memcpy(m_file.Data(), &hdr, sizeof(hdr));
+}
+
+// ─────────────────────────────────────────────────────────────
+//  PacketTraceReplay
+// ─────────────────────────────────────────────────────────────
+bool PacketTraceReplay::Open(const std::string& path)
+{
+    m_hdr = nullptr;
+    if (!m_file.OpenRead(path) || m_file.Size() < sizeof(PacketTraceHeader))
+        return false;
+
+    const auto* hdr = reinterpret_cast<const PacketTraceHeader*>(m_file.Data());
+    if (std::memcmp(hdr->magic, PACKET_TRACE_MAGIC, sizeof(hdr->magic)) != 0 ||
+        sizeof(PacketTraceHeader) + hdr->recordBytes > m_file.Size())
+        return false;
+
+    m_hdr = hdr;
+    return true;
+}
+
+uint64_t PacketTraceReplay::Run(const Sink& sink, bool realtime, const std::atomic<bool>& running)
+{
+    if (!m_hdr) return 0;
+
+    const uint8_t* p   = m_file.Data() + sizeof(PacketTraceHeader);
+    const uint8_t* end = p + m_hdr->recordBytes;
+    const uint64_t t0  = SteadyUs();
+    uint64_t       rel = 0;     // trace time of the current record
+    uint64_t       n   = 0;
+
+    while (p + PACKET_TRACE_RECORD_HDR <= end && running)
+    {
+        uint32_t delta; uint16_t len;
+        std::memcpy(&delta, p,     4);
+        std::memcpy(&len,   p + 4, 2);
+        p += PACKET_TRACE_RECORD_HDR;
+        if (p + len > end) break;   // truncated tail
+
+        rel += delta;
+        if (realtime)
+            WaitUntilUs(t0 + rel);
+
+        sink(p, static_cast<int>(len), rel);
+        p += len;
+        ++n;
+    }
+    return n;
+}
@@ -0,0 +1,81 @@
+#pragma once
+// ============================================================
+//  PacketTrace.h  –  Datagram capture to a memory-mapped trace
+//  file, and deterministic replay of such a trace.
+//
+//  File layout:
+//    PacketTraceHeader (64 B)
+//    records: u32 deltaUs | u16 len | len bytes   (unaligned, packed)
+//  deltaUs is the arrival gap to the previous record, so the file
+//  costs 6 bytes per datagram over the payload itself.
+// ============================================================
+#include "MappedFile.h"
+#include <cstdint>
+#include <atomic>
+#include <functional>
+#include <string>
+
+static constexpr char     PACKET_TRACE_MAGIC[8]   = { 'K','F','T','R','A','C','E','1' };
+static constexpr uint32_t PACKET_TRACE_RECORD_HDR = 6;
+
+#pragma pack(push, 1)
+struct PacketTraceHeader
+{
+    char     magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t startUs;        // recorder's clock at first record
+    uint64_t recordCount;
+    uint64_t recordBytes;    // bytes of record data after the header
+    uint64_t droppedCount;   // datagrams not recorded (file full)
+    uint8_t  pad[16];
+};
+#pragma pack(pop)
+static_assert(sizeof(PacketTraceHeader) == 64, "Trace header size mismatch");
+
+// ─── Recorder ────────────────────────────────────────────────
+// Single-writer; Append is a bounds check + two memcpys into the
+// mapping, no syscalls, so it is safe to call on the recv thread.
+class PacketTraceWriter
+{
+public:
+    ~PacketTraceWriter() { Close(); }
+
+    bool Open(const std::string& path, uint64_t maxBytes);
+    void Append(const uint8_t* data, uint32_t len, uint64_t nowUs);
+    void Close();
+
+    uint64_t RecordCount()  const { return m_count; }
+    uint64_t DroppedCount() const { return m_dropped; }
+
+private:
+    void CommitHeader();
+
+    MappedFile m_file;
+    uint64_t   m_offset  = 0;   // write position in the mapping
+    uint64_t   m_lastUs  = 0;
+    uint64_t   m_startUs = 0;
+    uint64_t   m_count   = 0;
+    uint64_t   m_dropped = 0;
+};
+
+// ─── Replay driver ───────────────────────────────────────────
+class PacketTraceReplay
+{
+public:
+    // (datagram, length, original arrival time relative to trace start)
+    using Sink = std::function<void(const uint8_t*, int, uint64_t)>;
+
+    bool Open(const std::string& path);
+
+    // Feed every record to `sink`. realtime=true reproduces the original
+    // inter-arrival gaps; false runs as fast as the sink allows.
+    // Returns the number of records delivered (stops early if !running).
+    uint64_t Run(const Sink& sink, bool realtime, const std::atomic<bool>& running);
+
+    uint64_t RecordCount() const { return m_hdr ? m_hdr->recordCount : 0; }
+
+private:
+    MappedFile               m_file;
+    const PacketTraceHeader* m_hdr = nullptr;
+};
@@ -5,7 +5,17 @@
 
 #include "NetworkFuser.h"
 #include "Receiver.h"
-#include "MemoryReassembly.h"
+#include "StreamTable.h"
+#include "CompositorD3D11.h"
+#include "FrameRing.h"
+#include "PacketTrace.h"
+#include "ClockSync.h"
+#include "Metrics.h"
+#include "EventTrace.h"
+#include "NetworkImpairment.h"
+#include "LossFeedback.h"
+#include "FrameScale.h"
+#include "WirePixels.h"
 #include <d3d11.h>
 #include <dxgi.h>
 
@@ -18,7 +28,7 @@ struct IocpRecvContext {
     WSABUF       wsaBuf{};
     SOCKADDR_IN  fromAddr{};
     INT          fromLen = sizeof(SOCKADDR_IN);
-    uint8_t      data[MAX_UDP_PAYLOAD + 64]{};
+    uint8_t      data[MAX_DATAGRAM_BYTES + 64]{};
 };
 
 // ─── Hijack Logic ─────────────────────────────────────────────
@@ -76,7 +86,8 @@ static const char g_psSource[] =
 using D3DCompileFn = HRESULT(WINAPI*)(LPCVOID, SIZE_T, LPCSTR, const void*, void*, LPCSTR, LPCSTR, UINT, UINT, ID3DBlob**, ID3DBlob**);
 
 // ─── ReceiverModule Implementation ────────────────────────────
-ReceiverModule::ReceiverModule(const FuserConfig& cfg) : m_cfg(cfg) {}
+ReceiverModule::ReceiverModule(const FuserConfig& cfg)
+    : m_cfg(cfg), m_pending(MAX_STREAMS * MAX_BANDS), m_latency(std::make_unique<LatencyStats>()) {}
 ReceiverModule::~ReceiverModule() { Stop(); }
 
 bool ReceiverModule::Init() {
@@ -84,10 +95,44 @@ bool ReceiverModule::Init() {
 
     FuserUtil::Log("[Main] Auto-Discovery Enabled (Receiver Mode)\n");
 
-    if (!CreateOverlayWindow()) return false;
-    if (!InitDX11()) return false;
+    if (m_cfg.headless) {
+        // No window, no GPU: network + reassembly only, frames go to shared memory
+        if (!InitFrameRing()) return false;
+    } else {
+        if (!CreateOverlayWindow()) return false;
+        if (!InitDX11()) return false;
+    }
+
+    // Replay feeds the pipeline from a trace file instead of the network
+    if (!m_cfg.replayTracePath.empty()) return true;
+
     if (!InitSocket()) return false;
 
+    if (!m_cfg.recordTracePath.empty()) {
+        m_traceWriter = std::make_unique<PacketTraceWriter>();
+        if (m_traceWriter->Open(m_cfg.recordTracePath, static_cast<uint64_t>(m_cfg.traceMaxMB) << 20)) {
+            FuserUtil::Log("[Receiver] Recording datagrams to '%s' (max %u MB)\n",
+                           m_cfg.recordTracePath.c_str(), m_cfg.traceMaxMB);
+        } else {
+            FuserUtil::Log("[Receiver] Could not create trace '%s' – recording disabled\n",
+                           m_cfg.recordTracePath.c_str());
+            m_traceWriter.reset();
+        }
+    }
+
+    return true;
+}
+
+bool ReceiverModule::InitFrameRing() {
+    m_frameRing = std::make_unique<FrameRingWriter>();
+    if (!m_frameRing->Create(m_cfg.frameRingName, m_cfg.frameRingSlots, m_cfg.frameRingSlotBytes)) {
+        FuserUtil::Log("[Receiver] FATAL: Could not create frame ring '%s' (Error: %u)\n",
+                       m_cfg.frameRingName.c_str(), GetLastError());
+        m_frameRing.reset();
+        return false;
+    }
+    FuserUtil::Log("[Receiver] Headless: publishing frames to ring '%s' (%u slots x %u bytes)\n",
+                   m_cfg.frameRingName.c_str(), m_cfg.frameRingSlots, m_cfg.frameRingSlotBytes);
     return true;
 }
 
@@ -150,8 +195,9 @@ bool ReceiverModule::InitDX11() {
     vsB->Release(); psB->Release();
     FreeLibrary(hComp);
 
+    // The surface maps 1:1 onto the viewport – point sampling keeps it exact
     D3D11_SAMPLER_DESC smp{};
-    smp.Filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
+    smp.Filter = D3D11_FILTER_MIN_MAG_MIP_POINT;
     smp.AddressU = smp.AddressV = smp.AddressW = D3D11_TEXTURE_ADDRESS_CLAMP;
     m_d3dDevice->CreateSamplerState(&smp, &m_sampler);
 
@@ -168,6 +214,19 @@ bool ReceiverModule::InitDX11() {
 
     m_viewport = { 0.0f, 0.0f, (float)m_overlayW, (float)m_overlayH, 0.0f, 1.0f };
 
+    D3D11PresentTargets targets;
+    targets.device       = m_d3dDevice;
+    targets.context      = m_d3dContext;
+    targets.swapChain    = m_swapChain;
+    targets.renderTarget = m_renderTargetView;
+    targets.vertexShader = m_vertexShader;
+    targets.pixelShader  = m_pixelShader;
+    targets.sampler      = m_sampler;
+    targets.blendState   = m_blendState;
+    targets.viewport     = m_viewport;
+    m_compositor = std::make_unique<D3D11Compositor>(targets);
+    if (!m_compositor->Init(m_overlayW, m_overlayH)) return false;
+
     // AFTER DX11 is initialized on the window, WE HIJACK!
     if (m_hwndParent) {
         FuserUtil::Log("[Receiver] Performing stealth hijack on parent 0x%p\n", m_hwndParent);
@@ -183,155 +242,601 @@ bool ReceiverModule::InitDX11() {
     return true;
 }
 
-void ReceiverModule::RenderFrame(const uint8_t* bgra, uint32_t fw, uint32_t fh) {
-    if (!bgra || fw == 0 || fh == 0) return;
-
-    if (fw != m_frameWidth || fh != m_frameHeight) {
-        if (m_shaderResView) m_shaderResView->Release();
-        if (m_uploadTex) m_uploadTex->Release();
-        
-        D3D11_TEXTURE2D_DESC td{};
-        td.Width = fw; td.Height = fh; td.MipLevels = td.ArraySize = 1;
-        td.Format = DXGI_FORMAT_B8G8R8A8_UNORM; td.SampleDesc.Count = 1;
-        td.Usage = D3D11_USAGE_DYNAMIC; td.BindFlags = D3D11_BIND_SHADER_RESOURCE;
-        td.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-        
-        m_d3dDevice->CreateTexture2D(&td, nullptr, &m_uploadTex);
-        m_d3dDevice->CreateShaderResourceView(m_uploadTex, nullptr, &m_shaderResView);
-        m_frameWidth = fw; m_frameHeight = fh;
-    }
-
-    D3D11_MAPPED_SUBRESOURCE map;
-    if (SUCCEEDED(m_d3dContext->Map(m_uploadTex, 0, D3D11_MAP_WRITE_DISCARD, 0, &map))) {
-        for (uint32_t y = 0; y < fh; y++)
-            memcpy((uint8_t*)map.pData + y * map.RowPitch, bgra + y * fw * 4, fw * 4);
-        m_d3dContext->Unmap(m_uploadTex, 0);
-    }
-
-    float black[4] = {0,0,0,0};
-    m_d3dContext->ClearRenderTargetView(m_renderTargetView, black);
-    m_d3dContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
-    m_d3dContext->VSSetShader(m_vertexShader, nullptr, 0);
-    m_d3dContext->PSSetShader(m_pixelShader, nullptr, 0);
-    m_d3dContext->PSSetShaderResources(0, 1, &m_shaderResView);
-    m_d3dContext->PSSetSamplers(0, 1, &m_sampler);
-    m_d3dContext->OMSetRenderTargets(1, &m_renderTargetView, nullptr);
-    m_d3dContext->OMSetBlendState(m_blendState, nullptr, 0xFFFFFFFF);
-    m_d3dContext->RSSetViewports(1, &m_viewport);
-    m_d3dContext->Draw(4, 0);
-    m_swapChain->Present(0, 0);
-}
-
 void ReceiverModule::Stop() {
     m_running = false;
-    if (m_recvThread.joinable()) m_recvThread.join();
+    for (auto& t : m_recvThreads) if (t.joinable()) t.join();
+    m_recvThreads.clear();
+    if (m_syncThread.joinable()) m_syncThread.join();
+    if (m_feedbackThread.joinable()) m_feedbackThread.join();
+    if (m_discoveryThread.joinable()) m_discoveryThread.join();
+    for (SOCKET s : m_socks) closesocket(s);
+    m_socks.clear();
+    if (m_traceWriter) {
+        FuserUtil::Log("[Receiver] Trace closed: %llu datagrams recorded, %llu dropped (file full)\n",
+                       static_cast<unsigned long long>(m_traceWriter->RecordCount()),
+                       static_cast<unsigned long long>(m_traceWriter->DroppedCount()));
+        m_traceWriter.reset();
+    }
     ReleaseDX11();
 }
 
 void ReceiverModule::ReleaseDX11() {
+    m_compositor.reset();   // releases the surface texture before the device goes
 #define REL(p) if(p){p->Release();p=nullptr;}
     REL(m_renderTargetView); REL(m_swapChain); REL(m_d3dContext); REL(m_d3dDevice);
-    REL(m_uploadTex); REL(m_shaderResView); REL(m_vertexShader); REL(m_pixelShader);
+    REL(m_vertexShader); REL(m_pixelShader);
     REL(m_sampler); REL(m_blendState);
 }
 
 bool ReceiverModule::InitSocket() {
-    m_sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
-    
-    BOOL reuse = TRUE;
-    setsockopt(m_sock, SOL_SOCKET, SO_REUSEADDR, (char*)&reuse, sizeof(reuse));
+    // One socket per stripe (cfg.stripes), each on its own port so
+    // every stripe gets its own receive thread – and, off loopback,
+    // its own RSS queue
+    const uint32_t stripes = std::clamp<uint32_t>(m_cfg.stripes, 1, MAX_STRIPES);
+    for (uint32_t k = 0; k < stripes; ++k) {
+        const uint16_t port = FuserUtil::StripePort(m_cfg.port, k);
+        SOCKET s = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+        if (s == INVALID_SOCKET) {
+            FuserUtil::Log("[Socket] FATAL: socket() failed (Error: %d)\n", WSAGetLastError());
+            return false;
+        }
+        m_socks.push_back(s);
 
-    sockaddr_in local{}; 
-    local.sin_family = AF_INET; 
-    local.sin_addr.s_addr = INADDR_ANY; // Catch-all: Listen on all interfaces
-    local.sin_port = htons(m_cfg.port); 
-    
-    if (bind(m_sock, (sockaddr*)&local, sizeof(local)) == SOCKET_ERROR) {
-        FuserUtil::Log("[Socket] FATAL: Bind failed (Error: %d)\n", WSAGetLastError());
-        return false;
-    }
+        BOOL reuse = TRUE;
+        setsockopt(s, SOL_SOCKET, SO_REUSEADDR, (char*)&reuse, sizeof(reuse));
 
-    int rb = 16*1024*1024; setsockopt(m_sock, SOL_SOCKET, SO_RCVBUF, (char*)&rb, sizeof(rb));
-    u_long mode = 1; ioctlsocket(m_sock, FIONBIO, &mode);
+        sockaddr_in local{}; 
+        local.sin_family = AF_INET; 
+        local.sin_addr.s_addr = INADDR_ANY; // Catch-all: Listen on all interfaces
+        local.sin_port = htons(port); 
+        
+        if (bind(s, (sockaddr*)&local, sizeof(local)) == SOCKET_ERROR) {
+            FuserUtil::Log("[Socket] FATAL: Bind failed on port %u (Error: %d)\n", port, WSAGetLastError());
+            return false;
+        }
 
-    FuserUtil::Log("[Receiver] Catch-All listening on Port %u (ANY INTERFACE)\n", m_cfg.port);
+        int rb = 16*1024*1024; setsockopt(s, SOL_SOCKET, SO_RCVBUF, (char*)&rb, sizeof(rb));
+        u_long mode = 1; ioctlsocket(s, FIONBIO, &mode);
+
+        // Multicast: join the group on every stripe socket. SO_REUSEADDR
+        // above lets several receivers on one host share the port –
+        // each joined socket gets its own copy of every datagram.
+        if (!m_cfg.multicastGroup.empty()) {
+            ip_mreq mreq{};
+            if (inet_pton(AF_INET, m_cfg.multicastGroup.c_str(), &mreq.imr_multiaddr) != 1) {
+                FuserUtil::Log("[Socket] FATAL: '%s' is not an IPv4 multicast group\n", m_cfg.multicastGroup.c_str());
+                return false;
+            }
+            inet_pton(AF_INET, m_cfg.localIP.c_str(), &mreq.imr_interface);   // 0.0.0.0 = default interface
+            if (setsockopt(s, IPPROTO_IP, IP_ADD_MEMBERSHIP, (char*)&mreq, sizeof(mreq)) == SOCKET_ERROR) {
+                FuserUtil::Log("[Socket] FATAL: Cannot join group %s on %s (Error: %d)\n",
+                               m_cfg.multicastGroup.c_str(), m_cfg.localIP.c_str(), WSAGetLastError());
+                return false;
+            }
+        }
+    }
+    if (!m_cfg.multicastGroup.empty())
+        FuserUtil::Log("[Receiver] Joined multicast group %s on interface %s\n",
+                       m_cfg.multicastGroup.c_str(), m_cfg.localIP.c_str());
+
+    if (stripes == 1)
+        FuserUtil::Log("[Receiver] Catch-All listening on Port %u (ANY INTERFACE)\n", m_cfg.port);
+    else
+        FuserUtil::Log("[Receiver] Catch-All listening on %u striped ports: %u, %u..%u (ANY INTERFACE)\n",
+                       stripes, m_cfg.port, FuserUtil::StripePort(m_cfg.port, 1),
+                       FuserUtil::StripePort(m_cfg.port, stripes - 1));
     
     // SELF-TEST: Send a tiny packet to ourselves to prove the socket works
     sockaddr_in self{}; self.sin_family = AF_INET; self.sin_port = htons(m_cfg.port);
     inet_pton(AF_INET, "127.0.0.1", &self.sin_addr);
     const char* testMsg = "SELF_TEST";
-    sendto(m_sock, testMsg, 9, 0, (sockaddr*)&self, sizeof(self));
+    sendto(m_socks[0], testMsg, 9, 0, (sockaddr*)&self, sizeof(self));
     
     return true;
 }
 
-void ReceiverModule::RecvThreadProc() {
-    FuserUtil::Log("[Socket] Simple High-Speed Listener started.\n");
+// ─── Impairment shim settings (cfg.impair*) ───────────────────
+static ImpairmentParams ImpairmentFromConfig(const FuserConfig& cfg) {
+    ImpairmentParams p;
+    p.lossPercent       = cfg.impairLossPercent;
+    p.burstEnterPercent = cfg.impairBurstEnterPercent;
+    p.burstExitPercent  = cfg.impairBurstExitPercent;
+    p.burstLossPercent  = cfg.impairBurstLossPercent;
+    p.rateMbps          = cfg.impairRateMbps;
+    p.queueKB           = cfg.impairQueueKB;
+    p.delayUs           = cfg.impairDelayUs;
+    p.jitterUs          = cfg.impairJitterUs;
+    p.reorderPercent    = cfg.impairReorderPercent;
+    p.reorderUs         = cfg.impairReorderUs;
+    p.duplicatePercent  = cfg.impairDuplicatePercent;
+    p.seed              = cfg.impairSeed;
+    return p;
+}
 
-    MemoryReassembly reasm;
-    uint32_t frameCount = 0;
-    uint32_t pktCount = 0;
-    
-    std::vector<uint8_t> buffer(2000);
+void ReceiverModule::RecvThreadProc(uint32_t stripe) {
+    FuserUtil::Log("[Socket] Simple High-Speed Listener started (stripe %u, port %u).\n",
+                   stripe, FuserUtil::StripePort(m_cfg.port, stripe));
+
+    const SOCKET  sock    = m_socks[stripe];
+    StreamTable&  streams = *m_streams;
+    MetricsBlock& metrics = Metrics::Local();
+
+    // Optional simulated link between the socket and reassembly –
+    // one per stripe, each with its own random stream
+    std::unique_ptr<NetworkImpairment> impair;
+    ImpairmentParams impairParams = ImpairmentFromConfig(m_cfg);
+    impairParams.seed += stripe;
+    if (impairParams.Active()) {
+        impair = std::make_unique<NetworkImpairment>(impairParams);
+        char desc[256];
+        impair->Describe(desc, sizeof(desc));
+        FuserUtil::Log("[Socket] IMPAIRMENT ACTIVE (stripe %u): %s\n", stripe, desc);
+    }
+    uint64_t releaseUs = 0;   // when the impairment let the delivered datagrams through
+    auto deliver = [&](const uint8_t* d, int len, uint32_t from) {
+        HandleDatagram(streams, d, len, from, stripe, releaseUs);
+    };
+
+    std::vector<uint8_t> buffer(MAX_DATAGRAM_BYTES + 64);
     FuserUtil::Log("[Socket] Low-Level listener is ARMED. Watching for raw UDP...\n");
 
     while (m_running) {
         sockaddr_in from{};
         int fromLen = sizeof(from); // CRITICAL: Reset every loop
-        int nr = recvfrom(m_sock, (char*)buffer.data(), (int)buffer.size(), 0, (sockaddr*)&from, &fromLen);
+        int nr = recvfrom(sock, (char*)buffer.data(), (int)buffer.size(), 0, (sockaddr*)&from, &fromLen);
         
         if (nr > 0) {
-            // Check for self-test
-            if (nr == 9 && memcmp(buffer.data(), "SELF_TEST", 9) == 0) {
-                FuserUtil::Log("[Socket] SUCCESS: Receiver socket self-tested OK!\n");
-                continue;
-            }
-
-            // LOG ABSOLUTELY EVERYTHING FOR DIAGNOSTICS
-            char senderIP[INET_ADDRSTRLEN];
-            inet_ntop(AF_INET, &from.sin_addr, senderIP, INET_ADDRSTRLEN);
-            pktCount++;
-            
-            if (pktCount % 10 == 0) {
-                FuserUtil::Log("[Socket] Raw Packet #%u: %d bytes from %s\n", pktCount, nr, senderIP);
-            }
-
-            if (FrameSlot* s = reasm.ConsumePacket(buffer.data(), nr)) {
-                {
-                    std::lock_guard<std::mutex> l(m_frameMtx);
-                    m_pendingFrame = std::move(s->pixelData);
-                    m_pendingW = s->width; m_pendingH = s->height; m_frameReady = true;
-                }
-                m_frameCv.notify_one(); 
-                reasm.ReleaseSlot(s);
-
-                frameCount++;
-                if (frameCount % 100 == 0) {
-                    FuserUtil::Log("[Receiver] RENDERED %u full frames.\n", frameCount);
-                }
+            const uint64_t arrivalUs = FuserUtil::NowUs();
+            if (m_traceWriter) {
+                std::lock_guard<std::mutex> l(m_traceMtx);
+                m_traceWriter->Append(buffer.data(), static_cast<uint32_t>(nr), arrivalUs);
             }
+            metrics.Add(MetricCounter::PacketsReceived, 1);
+            metrics.Add(MetricCounter::BytesReceived, static_cast<uint64_t>(nr));
+
+            const uint32_t fromAddr = from.sin_addr.s_addr;
+            if (impair) impair->Push(buffer.data(), nr, arrivalUs, fromAddr);
+            else        HandleDatagram(streams, buffer.data(), nr, fromAddr, stripe, arrivalUs);
+        } else if (impair && impair->Holding()) {
+            // Delayed packets are due soon – don't oversleep them
+            std::this_thread::yield();
         } else {
             // No data, sleep tiny bit to save CPU
             std::this_thread::sleep_for(std::chrono::microseconds(50));
         }
-        reasm.PurgeExpired();
+        const uint64_t nowUs = FuserUtil::NowUs();
+        if (impair) {
+            releaseUs = nowUs;
+            impair->Release(nowUs, deliver);
+        }
+        streams.PurgeExpired(nowUs);
     }
 }
 
+// ─── One datagram → its stream's reassembly → render hand-off ─
+//  Shared by the socket listeners (lane = stripe) and trace
+//  replay. The stream is keyed by the source address and the
+//  header's StreamID; `nowUs` is the datagram's arrival time on
+//  the reassembly clock. Returns true when the datagram completed
+//  a frame.
+bool ReceiverModule::HandleDatagram(StreamTable& streams, const uint8_t* data, int len, uint32_t fromAddr,
+                                    uint32_t lane, uint64_t nowUs) {
+    // Check for self-test
+    if (len == 9 && memcmp(data, "SELF_TEST", 9) == 0) {
+        FuserUtil::Log("[Socket] SUCCESS: Receiver socket self-tested OK!\n");
+        return false;
+    }
+    // Sender's line-open heartbeat
+    if (len == 4 && memcmp(data, "BEEP", 4) == 0)
+        return false;
+
+    if (len < static_cast<int>(HEADER_SIZE)) {
+        Metrics::Add(MetricCounter::PacketsMalformed);
+        return false;
+    }
+    FuserPacketHeader hdr;
+    memcpy(&hdr, data, HEADER_SIZE);
+    // Stray traffic on the port must not take up a stream entry
+    if (hdr.TotalPackets == 0 || hdr.PacketIndex >= hdr.TotalPackets || hdr.FrameID == 0) {
+        Metrics::Add(MetricCounter::PacketsOutOfRange);
+        return false;
+    }
+
+    bool isNew = false;
+    SourceStream* stream = streams.Find(fromAddr, hdr.StreamID, isNew);
+    if (!stream) {
+        Metrics::Add(MetricCounter::PacketsNoStream);
+        LOG_SAMPLED(LogLevel::Warn, 1, 1000,
+                    "[Receiver] Already receiving %u streams – datagrams from further sources ignored\n",
+                    MAX_STREAMS);
+        return false;
+    }
+    if (isNew) {
+        char name[32];
+        stream->Describe(name, sizeof(name));
+        FuserUtil::Log("[Socket] Receiving video from %s (stream %u)\n", name, stream->Index());
+        // Clock sync and the cross-machine latency stages follow the first sender
+        if (stream->Index() == 0) m_senderAddr.store(fromAddr, std::memory_order_relaxed);
+    }
+    stream->OnPacket(lane, static_cast<uint32_t>(len));
+
+    MemoryReassembly& reasm = stream->Reasm();
+    FrameSlot* s = reasm.ConsumePacket(data, len, lane, nowUs);
+    if (!s) return false;
+    stream->OnFrameCompleted(lane, s->frameID.load(std::memory_order_relaxed));
+    if (!stream->DecodeFrame(*s)) {
+        Metrics::Add(MetricCounter::FramesRefMissing);
+        LOG_SAMPLED(LogLevel::Warn, 1, 500,
+                    "[Receiver] Frame %u refers to frame %u, which stream %u doesn't hold – keyframe requested\n",
+                    s->frameID.load(std::memory_order_relaxed), s->refFrameID, stream->Index());
+        reasm.ReleaseSlot(s);
+        return false;
+    }
 
+    {
+        std::lock_guard<std::mutex> l(m_frameMtx);
+        StreamFrame& f = m_pending[stream->Index() * MAX_BANDS + s->band];
+        f.pixels = std::move(s->pixelData);
+        f.id = s->frameID.load(std::memory_order_relaxed);
+        f.x = s->originX; f.y = s->originY;
+        f.w = s->width;   f.h = s->height;
+        f.scale = s->scale;
+        f.format = s->format; f.colour = s->colour;
+        f.band = s->band; f.bandCount = s->bandCount;
+        f.times = FrameTimestamps{};
+        f.times.senderCaptureUs = s->senderCaptureUs;
+        f.times.senderEncodeUs  = s->senderEncodeUs;
+        f.times.senderSendUs    = s->senderSendUs;
+        f.times.arrivalUs       = s->firstPacketUs;
+        f.times.completeUs      = s->lastPacketUs;
+        f.ready = true; m_frameReady = true;
+    }
+    m_frameCv.notify_one();
+    reasm.ReleaseSlot(s);
+    return true;
+}
 
+// ─── Trace replay in place of the socket listener ─────────────
+void ReceiverModule::ReplayThreadProc() {
+    PacketTraceReplay replay;
+    if (!replay.Open(m_cfg.replayTracePath)) {
+        FuserUtil::Log("[Replay] FATAL: Cannot open trace '%s'\n", m_cfg.replayTracePath.c_str());
+        m_running = false;
+        m_frameCv.notify_all();
+        return;
+    }
+    FuserUtil::Log("[Replay] Replaying %llu datagrams from '%s' (%s)\n",
+                   static_cast<unsigned long long>(replay.RecordCount()),
+                   m_cfg.replayTracePath.c_str(),
+                   m_cfg.replayRealtime ? "original timing" : "as fast as possible");
+
+    // A trace doesn't record source addresses: streams differ by StreamID only.
+    // Reassembly runs on the trace's clock, so deadlines, timeouts and
+    // jitter come out as they did on the recorded link at any speed.
+    StreamTable& streams = *m_streams;
+    uint64_t frames = 0;
+    const uint64_t t0 = FuserUtil::NowUs();
+
+    const uint64_t delivered = replay.Run(
+        [&](const uint8_t* d, int len, uint64_t relUs) {
+            if (HandleDatagram(streams, d, len, 0, 0, t0 + relUs)) ++frames;
+            streams.PurgeExpired(t0 + relUs);
+        },
+        m_cfg.replayRealtime, m_running);
+
+    const uint64_t us = std::max<uint64_t>(1, FuserUtil::NowUs() - t0);
+    FuserUtil::Log("[Replay] Done: %llu datagrams, %llu frames in %.3f ms "
+                   "(%.0f pkt/s, %.1f frames/s)\n",
+                   static_cast<unsigned long long>(delivered),
+                   static_cast<unsigned long long>(frames),
+                   us / 1000.0, delivered * 1e6 / us, frames * 1e6 / us);
+
+    // Wind down once the render thread has taken the last frames (it
+    // presents them before it next looks at m_running)
+    {
+        std::unique_lock<std::mutex> l(m_frameMtx);
+        m_frameCv.wait(l, [this]{ return !m_frameReady || !m_running; });
+    }
+    m_running = false;
+    m_frameCv.notify_all();
+}
 
+// ─── Present the streams' newest frames ───────────────────────
+//  Windowed: the latest frame of every stream and band is one
+//  layer on the surface; only layers with a new frame are
+//  re-uploaded. Headless: each new frame is published to the ring
+//  on its own, tagged with its stream index and band.
 void ReceiverModule::RenderThreadProc() {
+    constexpr uint32_t LAYERS = MAX_STREAMS * MAX_BANDS;
+    static_assert(LAYERS <= 64, "one fresh bit per layer");
+    const bool headless = (m_frameRing != nullptr);
+    std::vector<StreamFrame>    shown(LAYERS);   // what is on the surface, by layer (see m_pending)
+    std::vector<CompositeLayer> layers;
+    layers.reserve(LAYERS);
+    std::vector<uint8_t>        upscaled;   // headless: full-size copy of a scaled frame
+    std::vector<uint8_t>        unpacked;   // BGRA of a packed frame; swapped with its pixels
+
     while (m_running) {
-        std::vector<uint8_t> p; uint32_t w, h;
+        uint64_t fresh = 0;   // bit per layer with a new frame
         {
             std::unique_lock<std::mutex> l(m_frameMtx);
             m_frameCv.wait_for(l, std::chrono::milliseconds(8), [this]{ return m_frameReady || !m_running; });
-            if (!m_running || !m_frameReady) { PumpMessages(); continue; }
-            p = std::move(m_pendingFrame); w = m_pendingW; h = m_pendingH; m_frameReady = false;
+            if (!m_running || !m_frameReady) { if (!headless) PumpMessages(); continue; }
+            for (uint32_t i = 0; i < LAYERS; ++i) {
+                if (!m_pending[i].ready) continue;
+                shown[i] = std::move(m_pending[i]);
+                m_pending[i].ready = false;
+                fresh |= 1ull << i;
+            }
+            m_frameReady = false;
+        }
+        if (!m_cfg.replayTracePath.empty())
+            m_frameCv.notify_all();   // replay winds down once the hand-off is drained
+
+        // A sender that now cuts its captures into fewer bands leaves
+        // the old lower bands behind – take them off the surface
+        for (uint32_t i = 0; i < LAYERS; ++i) {
+            if (!(fresh & (1ull << i))) continue;
+            const uint32_t first = i - i % MAX_BANDS;
+            for (uint32_t b = shown[i].bandCount; b < MAX_BANDS; ++b)
+                if (!(fresh & (1ull << (first + b)))) shown[first + b] = StreamFrame{};
+        }
+
+        for (uint32_t i = 0; i < LAYERS; ++i)
+            if (fresh & (1ull << i))
+                EventTrace::Emit(TraceEvent::RenderBegin, shown[i].id, shown[i].w, shown[i].h);
+
+        // Back to BGRA once per new frame; a stream that stays on the
+        // surface is recomposited from the unpacked copy. The wire
+        // buffer is kept as the next frame's scratch.
+        for (uint32_t i = 0; i < LAYERS; ++i) {
+            StreamFrame& f = shown[i];
+            if (!(fresh & (1ull << i)) || f.format == WirePixels::BGRA32) continue;
+            const size_t pixels = static_cast<size_t>(FrameScale::ScaledSize(f.w, f.scale)) *
+                                  FrameScale::ScaledSize(f.h, f.scale);
+            unpacked.resize(pixels * 4);
+            WirePixels::Unpack(static_cast<WirePixels::Format>(f.format), f.pixels.data(), pixels,
+                               unpacked.data(), f.colour);
+            f.pixels.swap(unpacked);
+            f.format = WirePixels::BGRA32;
+        }
+
+        if (headless) {
+            for (uint32_t i = 0; i < LAYERS; ++i) {
+                if (!(fresh & (1ull << i))) continue;
+                StreamFrame& f = shown[i];
+                const uint8_t* pixels = f.pixels.data();
+                if (f.scale > 1) {
+                    upscaled.resize(static_cast<size_t>(f.w) * f.h * 4);
+                    FrameScale::Upscale(pixels, FrameScale::ScaledSize(f.w, f.scale) * 4,
+                                        FrameScale::ScaledSize(f.w, f.scale), FrameScale::ScaledSize(f.h, f.scale),
+                                        f.scale, upscaled.data(), f.w * 4, f.w, f.h);
+                    pixels = upscaled.data();
+                }
+                if (!m_frameRing->Publish(f.id, f.x, f.y, f.w, f.h, pixels, f.w * 4,
+                                          FuserUtil::NowUs(), i / MAX_BANDS, f.band, f.bandCount)) {
+                    LOG_SAMPLED(LogLevel::Warn, 1, 500,
+                                "[Receiver] Frame %u (%ux%u) exceeds ring slot size – dropped\n", f.id, f.w, f.h);
+                    Metrics::Add(MetricCounter::FramesDropped);
+                    EventTrace::Emit(TraceEvent::RenderEnd, f.id, f.w, f.h, 0);
+                    fresh &= ~(1ull << i);
+                    continue;
+                }
+                f.times.presentUs = FuserUtil::NowUs();
+            }
+        } else {
+            const uint64_t t0 = FuserUtil::NowUs();
+            layers.clear();
+            for (uint32_t i = 0; i < LAYERS; ++i) {
+                const StreamFrame& f = shown[i];
+                if (f.w == 0 || f.h == 0 || f.pixels.empty()) continue;
+                layers.push_back({ f.pixels.data(), FrameScale::ScaledSize(f.w, f.scale) * 4, { f.x, f.y, f.w, f.h },
+                                   (fresh & (1ull << i)) != 0, f.scale });
+            }
+            if (m_compositor) {
+                m_compositor->Compose(layers.data(), layers.size());
+                m_compositor->Present();
+            }
+            const uint64_t now = FuserUtil::NowUs();
+            for (uint32_t i = 0; i < LAYERS; ++i)
+                if (fresh & (1ull << i)) shown[i].times.presentUs = now;
+            Metrics::Add(MetricCounter::RenderTimeUsTotal, now - t0);
+            Metrics::Set(MetricGauge::RenderTimeUs, static_cast<int64_t>(now - t0));
+            PumpMessages();
+        }
+
+        const uint32_t senderAddr = m_senderAddr.load(std::memory_order_relaxed);
+        uint64_t lastPresentUs = 0;
+        for (uint32_t i = 0; i < LAYERS; ++i) {
+            if (!(fresh & (1ull << i))) continue;
+            const StreamFrame& f = shown[i];
+            SourceStream& stream = m_streams->At(i / MAX_BANDS);
+            stream.OnFramePresented();
+            Metrics::Add(MetricCounter::FramesPresented);
+            EventTrace::Emit(TraceEvent::RenderEnd, f.id, f.w, f.h, 1);
+            m_latency->RecordFrame(f.times, stream.Addr() == senderAddr);
+            lastPresentUs = std::max(lastPresentUs, f.times.presentUs);
+        }
+        if (lastPresentUs) {
+            ReportLatencyIfDue(lastPresentUs);
+            ReportStreamsIfDue(lastPresentUs);
         }
-        RenderFrame(p.data(), w, h);
-        PumpMessages();
+    }
+}
+
+// ─── Clock sync requester ─────────────────────────────────────
+//  Pings the sender's discovery port once it is known from the
+//  video stream: a quick burst to converge, then one ping every
+//  cfg.clockSyncIntervalMs. Each answered ping feeds the min-RTT
+//  filter; the drift-corrected offset goes to the latency stats.
+void ReceiverModule::ClockSyncThreadProc() {
+    SOCKET s = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (s == INVALID_SOCKET) return;
+    DWORD timeout = 100;
+    setsockopt(s, SOL_SOCKET, SO_RCVTIMEO, (char*)&timeout, sizeof(timeout));
+
+    ClockSyncEstimator est;
+    uint32_t seq = 0;
+    uint64_t lastLogUs = 0;
+
+    while (m_running) {
+        const uint32_t addr = m_senderAddr.load(std::memory_order_relaxed);
+        if (addr == 0) { std::this_thread::sleep_for(std::chrono::milliseconds(100)); continue; }
+
+        sockaddr_in to{};
+        to.sin_family      = AF_INET;
+        to.sin_port        = htons(static_cast<uint16_t>(m_cfg.port + 1));
+        to.sin_addr.s_addr = addr;
+
+        ClockSyncPacket ping{};
+        std::memcpy(ping.magic, CLOCK_SYNC_MAGIC, sizeof(ping.magic));
+        ping.seq = ++seq;
+        ping.t1  = FuserUtil::NowUs();
+        sendto(s, (const char*)&ping, sizeof(ping), 0, (sockaddr*)&to, sizeof(to));
+
+        // Wait for the matching pong; late answers to older pings are skipped
+        for (;;) {
+            ClockSyncPacket pong;
+            int nr = recvfrom(s, (char*)&pong, sizeof(pong), 0, nullptr, nullptr);
+            const uint64_t t4 = FuserUtil::NowUs();
+            if (nr == SOCKET_ERROR) break;   // timeout – sender not answering
+            if (nr != static_cast<int>(sizeof(pong)) ||
+                std::memcmp(pong.magic, CLOCK_SYNC_MAGIC, sizeof(pong.magic)) != 0 ||
+                pong.seq != ping.seq)
+                continue;
+            est.AddSample(pong.t1, pong.t2, pong.t3, t4);
+            break;
+        }
+
+        const uint64_t now = FuserUtil::NowUs();
+        if (est.Valid()) {
+            m_latency->SetClockOffsetUs(est.OffsetUs(now));
+            EventTrace::SetClockOffsetUs(est.OffsetUs(now));
+            Metrics::Set(MetricGauge::ClockOffsetUs, est.OffsetUs(now));
+            Metrics::Set(MetricGauge::ClockRttUs, static_cast<int64_t>(est.BestRttUs()));
+            if (now - lastLogUs >= 10000000) {
+                lastLogUs = now;
+                FuserUtil::Log("[ClockSync] offset %+lld us, drift %+.2f ppm, best RTT %llu us (%llu samples)\n",
+                               static_cast<long long>(est.OffsetUs(now)), est.DriftPpm(),
+                               static_cast<unsigned long long>(est.BestRttUs()),
+                               static_cast<unsigned long long>(est.SampleCount()));
+            }
+        }
+
+        const uint32_t waitMs = est.SampleCount() < CLOCK_SYNC_WINDOW / 4 ? 20 : m_cfg.clockSyncIntervalMs;
+        std::this_thread::sleep_for(std::chrono::milliseconds(waitMs));
+    }
+    closesocket(s);
+}
+
+// ─── Loss feedback to the senders ─────────────────────────────
+//  Every cfg.feedbackIntervalMs, one ReceiverReportPacket per
+//  stream to its sender's feedback port: how far the stream's
+//  frame IDs advanced and how many of those frames completed.
+//  In between, a stream that lost a delta frame's reference asks
+//  for a keyframe right away (even with loss reports off).
+void ReceiverModule::FeedbackThreadProc() {
+    SOCKET s = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (s == INVALID_SOCKET) return;
+
+    struct Baseline { uint32_t lastFrameID = 0; uint64_t completed = 0; uint64_t us = 0; bool valid = false; };
+    std::vector<Baseline> base(MAX_STREAMS);
+    uint32_t seq = 0;
+    uint64_t lastReportUs = FuserUtil::NowUs();
+
+    auto sendTo = [&](const SourceStream& stream, const ReceiverReportPacket& r) {
+        sockaddr_in to{};
+        to.sin_family      = AF_INET;
+        to.sin_port        = htons(FuserUtil::FeedbackPort(m_cfg.port, stream.StreamID()));
+        to.sin_addr.s_addr = stream.Addr();
+        sendto(s, (const char*)&r, sizeof(r), 0, (sockaddr*)&to, sizeof(to));
+    };
+
+    while (m_running) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));   // short steps so Stop() can join
+
+        const uint64_t now = FuserUtil::NowUs();
+        const uint32_t n   = m_streams->Count();
+        for (uint32_t i = 0; i < n; ++i) {
+            SourceStream& stream = m_streams->At(i);
+            if (!stream.TakeKeyframeRequest(now, FEEDBACK_KEY_RETRY_US)) continue;
+            ReceiverReportPacket r{};
+            std::memcpy(r.magic, FEEDBACK_MAGIC, sizeof(r.magic));
+            r.seq      = ++seq;
+            r.streamID = stream.StreamID();
+            r.flags    = REPORT_FLAG_KEYFRAME;
+            sendTo(stream, r);
+        }
+
+        if (m_cfg.feedbackIntervalMs == 0 ||
+            now - lastReportUs < static_cast<uint64_t>(m_cfg.feedbackIntervalMs) * 1000)
+            continue;
+        lastReportUs = now;
+        for (uint32_t i = 0; i < n; ++i) {
+            const SourceStream& stream = m_streams->At(i);
+            const StreamStats   st     = stream.Stats();
+            Baseline&           b      = base[i];
+            if (!b.valid || st.lastFrameID < b.lastFrameID) {
+                b = { st.lastFrameID, st.framesCompleted, now, true };   // first look, or sender restarted
+                continue;
+            }
+
+            ReceiverReportPacket r{};
+            std::memcpy(r.magic, FEEDBACK_MAGIC, sizeof(r.magic));
+            r.seq             = ++seq;
+            r.streamID        = stream.StreamID();
+            r.highestFrameID  = st.lastFrameID;
+            r.framesExpected  = st.lastFrameID - b.lastFrameID;
+            r.framesCompleted = static_cast<uint32_t>(st.framesCompleted - b.completed);
+            r.intervalUs      = static_cast<uint32_t>(std::min<uint64_t>(now - b.us, UINT32_MAX));
+            b = { st.lastFrameID, st.framesCompleted, now, true };
+            sendTo(stream, r);
+        }
+    }
+    closesocket(s);
+}
+
+// ─── Periodic per-stage latency summary ───────────────────────
+void ReceiverModule::ReportLatencyIfDue(uint64_t nowUs) {
+    if (m_cfg.latencyLogIntervalMs == 0) return;
+    if (m_lastLatencyLogUs == 0) { m_lastLatencyLogUs = nowUs; return; }
+    if (nowUs - m_lastLatencyLogUs < static_cast<uint64_t>(m_cfg.latencyLogIntervalMs) * 1000) return;
+    m_lastLatencyLogUs = nowUs;
+
+    std::string report;
+    m_latency->WindowReport(report);
+    if (report.empty()) return;
+    FuserUtil::Log("[Latency] Last %u ms%s:\n%s", m_cfg.latencyLogIntervalMs,
+                   m_latency->HasClockOffset() ? "" : " (no clock sync – cross-machine stages omitted)",
+                   report.c_str());
+}
+
+// ─── Per-stream rates, once more than one sender is seen ──────
+void ReceiverModule::ReportStreamsIfDue(uint64_t nowUs) {
+    if (m_cfg.statsLogIntervalMs == 0) return;
+    if (m_lastStreamLogUs == 0) { m_lastStreamLogUs = nowUs; return; }
+    if (nowUs - m_lastStreamLogUs < static_cast<uint64_t>(m_cfg.statsLogIntervalMs) * 1000) return;
+    const double secs = (nowUs - m_lastStreamLogUs) / 1e6;
+    m_lastStreamLogUs = nowUs;
+
+    const uint32_t n = m_streams->Count();
+    m_lastStreamStats.resize(n);
+    if (n < 2) {
+        if (n == 1) m_lastStreamStats[0] = m_streams->At(0).Stats();
+        return;
+    }
+    for (uint32_t i = 0; i < n; ++i) {
+        const SourceStream& stream = m_streams->At(i);
+        const StreamStats   now    = stream.Stats();
+        const StreamStats&  prev   = m_lastStreamStats[i];
+        char name[32];
+        stream.Describe(name, sizeof(name));
+        FuserUtil::Log("[Stats] stream %u %-21s rx %.0f pkt/s, %.1f MB/s | frames %.0f/s complete, "
+                       "%.0f/s shown\n",
+                       i, name, (now.packets - prev.packets) / secs, (now.bytes - prev.bytes) / secs / 1e6,
+                       (now.framesCompleted - prev.framesCompleted) / secs,
+                       (now.framesPresented - prev.framesPresented) / secs);
+        m_lastStreamStats[i] = now;
     }
 }
 
@@ -342,8 +847,17 @@ void ReceiverModule::PumpMessages() {
 void ReceiverModule::Run() {
     m_running = true;
 
+    m_streams = std::make_unique<StreamTable>(m_cfg.reasmMinTimeoutUs, m_cfg.reasmMaxTimeoutUs,
+                                              static_cast<uint32_t>(std::max<size_t>(m_socks.size(), 1)));
+
+    if (!m_cfg.replayTracePath.empty()) {
+        m_recvThreads.emplace_back([this]{ ReplayThreadProc(); });
+        RenderThreadProc();
+        return;
+    }
+
     // Launch discovery thread (broadcasts every 1.5s)
-    std::thread discoveryThread([this] {
+    m_discoveryThread = std::thread([this] {
         SOCKET ds = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
         if (ds == INVALID_SOCKET) return;
 
@@ -360,16 +874,22 @@ void ReceiverModule::Run() {
 
         while (m_running) {
             sendto(ds, msg, (int)strlen(msg), 0, (sockaddr*)&target, sizeof(target));
-            std::this_thread::sleep_for(std::chrono::milliseconds(1500));
+            for (int i = 0; i < 15 && m_running; ++i)   // short steps so Stop() can join
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
         }
         closesocket(ds);
     });
-    discoveryThread.detach();
 
-    m_recvThread = std::thread([this]{ 
-        SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL); 
-        RecvThreadProc(); 
-    });
+    if (m_cfg.clockSyncIntervalMs > 0)
+        m_syncThread = std::thread([this]{ ClockSyncThreadProc(); });
+    m_feedbackThread = std::thread([this]{ FeedbackThreadProc(); });   // loss reports + keyframe requests
+
+    for (uint32_t k = 0; k < m_socks.size(); ++k) {
+        m_recvThreads.emplace_back([this, k]{ 
+            SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL); 
+            RecvThreadProc(k); 
+        });
+    }
 
     SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL);
     RenderThreadProc();
@@ -3,8 +3,13 @@
 //  Receiver.h  -  High-Compatibility DX11 Hijack
 // ============================================================
 #include "NetworkFuser.h"
+#include "LatencyStats.h"
+#include "StreamTable.h"
 
 struct IocpRecvContext;
+class  Compositor;
+class  FrameRingWriter;
+class  PacketTraceWriter;
 
 class ReceiverModule
 {
@@ -16,33 +21,73 @@ public:
     void Run();
     void Stop();
 
+    // Per-stage latency histograms (safe to snapshot from any thread)
+    LatencyStats&       Latency()       { return *m_latency; }
+    const LatencyStats& Latency() const { return *m_latency; }
+
+    // Receiver clock − sender clock (µs), once clock sync has a sample
+    bool    ClockSynced()   const { return m_latency->HasClockOffset(); }
+    int64_t ClockOffsetUs() const { return m_latency->ClockOffsetUs(); }
+
 private:
     bool CreateOverlayWindow();
     bool InitDX11();
     bool InitSocket();
+    bool InitFrameRing();
     void ReleaseDX11();
 
-    void RecvThreadProc();
+    void RecvThreadProc(uint32_t stripe);
+    void ReplayThreadProc();
+    void ClockSyncThreadProc();
+    void FeedbackThreadProc();
+    bool HandleDatagram(StreamTable& streams, const uint8_t* data, int len, uint32_t fromAddr,
+                        uint32_t lane, uint64_t nowUs);
     void RenderThreadProc();
-    void RenderFrame(const uint8_t* bgra, uint32_t fw, uint32_t fh);
+    void ReportLatencyIfDue(uint64_t nowUs);
+    void ReportStreamsIfDue(uint64_t nowUs);
     void PumpMessages();
 
     // Config
     FuserConfig             m_cfg;
 
-    // Network
-    SOCKET                  m_sock    = INVALID_SOCKET;
+    // Network: one socket + receive thread per stripe, all feeding
+    // one reassembly per source stream (replay uses a single thread)
+    std::vector<SOCKET>     m_socks;
     std::atomic<bool>       m_running{false};
-    std::thread             m_recvThread;
+    std::vector<std::thread> m_recvThreads;
+    std::unique_ptr<StreamTable> m_streams;
+    std::thread             m_discoveryThread;   // "KNOX_DISCOVERY_v1" broadcast
+
+    // Clock sync: pings the sender of the first stream on port+1
+    std::thread             m_syncThread;
+    std::atomic<uint32_t>   m_senderAddr{0};   // IPv4, network byte order; 0 = unknown
+
+    // Loss reports to every stream's sender on its FeedbackPort (LossFeedback.h)
+    std::thread             m_feedbackThread;
 
-    // Frame hand-off
+    // Frame hand-off: latest complete frame of each stream
+    struct StreamFrame
+    {
+        std::vector<uint8_t> pixels;
+        uint32_t             id = 0, x = 0, y = 0, w = 0, h = 0;
+        uint32_t             scale = 1;        // pixels are w×h shrunk by this (FrameScale)
+        uint32_t             format = 0;       // pixels are in this WirePixels::Format …
+        uint32_t             colour = 0;       // … with this colour if A8
+        uint32_t             band = 0, bandCount = 1;   // horizontal band of the capture
+        FrameTimestamps      times{};
+        bool                 ready = false;
+    };
     std::mutex              m_frameMtx;
     std::condition_variable m_frameCv;
-    std::vector<uint8_t>    m_pendingFrame;
-    uint32_t                m_pendingW   = 0;
-    uint32_t                m_pendingH   = 0;
+    std::vector<StreamFrame> m_pending;        // by layer: stream index * MAX_BANDS + band
     bool                    m_frameReady = false;
 
+    // Capture → present latency, reported every cfg.latencyLogIntervalMs
+    std::unique_ptr<LatencyStats> m_latency;
+    uint64_t                m_lastLatencyLogUs = 0;
+    uint64_t                m_lastStreamLogUs  = 0;
+    std::vector<StreamStats> m_lastStreamStats;   // at m_lastStreamLogUs
+
     // Window
     HWND  m_hwndOverlay = nullptr;
     HWND  m_hwndParent  = nullptr;
@@ -54,14 +99,19 @@ private:
     ID3D11DeviceContext*      m_d3dContext       = nullptr;
     IDXGISwapChain*           m_swapChain        = nullptr;
     ID3D11RenderTargetView*   m_renderTargetView = nullptr;
-    ID3D11Texture2D*          m_uploadTex        = nullptr;
-    ID3D11ShaderResourceView* m_shaderResView    = nullptr;
     ID3D11VertexShader*       m_vertexShader     = nullptr;
     ID3D11PixelShader*        m_pixelShader      = nullptr;
     ID3D11SamplerState*       m_sampler          = nullptr;
     ID3D11BlendState*         m_blendState       = nullptr;
     D3D11_VIEWPORT            m_viewport{};
 
-    uint32_t m_frameWidth  = 0;
-    uint32_t m_frameHeight = 0;
+    // Persistent screen-sized surface; only received rects are uploaded
+    std::unique_ptr<Compositor> m_compositor;
+
+    // Headless output (cfg.headless): shared-memory frame ring
+    std::unique_ptr<FrameRingWriter> m_frameRing;
+
+    // Datagram capture (cfg.recordTracePath); shared by the stripes
+    std::unique_ptr<PacketTraceWriter> m_traceWriter;
+    std::mutex              m_traceMtx;
 };
@@ -1,10 +1,18 @@
 // ============================================================
-//  Sender.cpp  –  DXGI Desktop Duplication capture + UDP send
+//  Sender.cpp  –  Frame capture + UDP send
 //  Zero-Latency Network Video Fuser
 // ============================================================
 
 #include "NetworkFuser.h"
 #include "Sender.h"
+#include "CaptureDXGI.h"
+#include "FrameOps.h"
+#include "FrameScale.h"
+#include "WirePixels.h"
+#include "ClockSync.h"
+#include "Metrics.h"
+#include "EventTrace.h"
+#include "FrameDelta.h"
 
 // ─────────────────────────────────────────────────────────────
 //  Internal helpers
@@ -74,65 +82,6 @@ namespace
         }
         return false;
     }
-
-    // Scan a BGRA buffer and find the tightest bounding box of
-    // non-black (alpha > 0 OR any colour channel > threshold) pixels.
-    BoundingBox ComputeBoundingBox(const uint8_t* bgra,
-                                   uint32_t       width,
-                                   uint32_t       height,
-                                   uint8_t        threshold = 2)
-    {
-        uint32_t xMin = width,  yMin = height;
-        uint32_t xMax = 0,      yMax = 0;
-        bool     found = false;
-
-        const uint32_t stride = width * 4;
-        for (uint32_t y = 0; y < height; ++y)
-        {
-            const uint8_t* row = bgra + y * stride;
-            for (uint32_t x = 0; x < width; ++x)
-            {
-                const uint8_t b = row[x * 4 + 0];
-                const uint8_t g = row[x * 4 + 1];
-                const uint8_t r = row[x * 4 + 2];
-                const uint8_t a = row[x * 4 + 3];
-                if (b > threshold || g > threshold || r > threshold || a > threshold)
-                {
-                    if (x < xMin) xMin = x;
-                    if (x > xMax) xMax = x;
-                    if (y < yMin) yMin = y;
-                    if (y > yMax) yMax = y;
-                    found = true;
-                }
-            }
-        }
-
-        if (!found)
-            return BoundingBox{0, 0, 0, 0};
-
-        return BoundingBox{
-            xMin,
-            yMin,
-            xMax - xMin + 1,
-            yMax - yMin + 1
-        };
-    }
-
-    // Copy a sub-rectangle from a full-width BGRA buffer into dst
-    void CropBGRA(const uint8_t* src, uint32_t srcWidth,
-                  uint8_t*       dst,
-                  const BoundingBox& bb)
-    {
-        const uint32_t srcStride = srcWidth * 4;
-        const uint32_t dstStride = bb.w    * 4;
-
-        for (uint32_t row = 0; row < bb.h; ++row)
-        {
-            const uint8_t* srcRow = src + (bb.y + row) * srcStride + bb.x * 4;
-            uint8_t*       dstRow = dst + row * dstStride;
-            std::memcpy(dstRow, srcRow, dstStride);
-        }
-    }
 }
 
 // ─────────────────────────────────────────────────────────────
@@ -143,23 +92,28 @@ SenderModule::SenderModule(const FuserConfig& cfg)
     , m_sock(INVALID_SOCKET)
     , m_running(false)
     , m_frameID(0)
-    , m_d3dDevice(nullptr)
-    , m_d3dContext(nullptr)
-    , m_dxgiOutput1(nullptr)
-    , m_duplication(nullptr)
-    , m_stagingTex(nullptr)
+    , m_scale(cfg.downscale ? cfg.downscale : 1)
+    , m_schedule(CaptureScheduleParams{ cfg.captureMaxFps, cfg.keepaliveMs, cfg.skipUnchanged })
 {}
 
 SenderModule::~SenderModule()
 {
     Stop();
+
+    // Run() has returned by now – its caller joins that thread before
+    // destroying the module – so the source and socket are unused
+    m_source.reset();
+    for (SOCKET s : m_stripeSocks)
+        closesocket(s);
+    m_stripeSocks.clear();
+    m_sock = INVALID_SOCKET;
 }
 
-// ─── Public: initialise networking + DXGI ───────────────────
+// ─── Public: initialise networking + capture ────────────────
 bool SenderModule::Init()
 {
     if (!InitSocket())   return false;
-    if (!InitDXGI())     return false;
+    if (!InitCapture())  return false;
     return true;
 }
 
@@ -169,7 +123,12 @@ void SenderModule::Run()
 
     // Discovery phase if no IP target
     // Let config handle the IP (Targeting configurable address)
-    if (m_cfg.remoteIP.empty() || m_cfg.remoteIP == "0.0.0.0" || m_cfg.remoteIP == "AUTO") {
+    if (!m_cfg.multicastGroup.empty()) {
+        m_dest.sin_family = AF_INET;
+        m_dest.sin_port = htons(m_cfg.port);
+        inet_pton(AF_INET, m_cfg.multicastGroup.c_str(), &m_dest.sin_addr);
+        FuserUtil::Log("[Sender] MULTICAST -> group %s:%u\n", m_cfg.multicastGroup.c_str(), m_cfg.port);
+    } else if (m_cfg.remoteIP.empty() || m_cfg.remoteIP == "0.0.0.0" || m_cfg.remoteIP == "AUTO") {
         m_dest.sin_family = AF_INET;
         m_dest.sin_port = htons(m_cfg.port);
         m_dest.sin_addr.s_addr = INADDR_BROADCAST;
@@ -183,351 +142,837 @@ void SenderModule::Run()
 
     if (!m_running) return;
 
-    FuserUtil::Log("[Sender] Starting capture loop -> %u\n", m_cfg.port);
+    // Same host, one port per stripe
+    m_stripeDests.assign(m_stripeSocks.size(), m_dest);
+    for (uint32_t k = 0; k < m_stripeDests.size(); ++k)
+        m_stripeDests[k].sin_port = htons(FuserUtil::StripePort(m_cfg.port, k));
 
-    // Allocate scratch buffers
-    m_fullFrameBuf.resize(SENDER_CAPTURE_RES_W * SENDER_CAPTURE_RES_H * 4);
-    m_croppedBuf.resize(  SENDER_CAPTURE_RES_W * SENDER_CAPTURE_RES_H * 4);
-    m_packetBuf.resize(MAX_UDP_PAYLOAD);
+    m_syncThread = std::thread([this]{ ClockSyncResponderProc(); });
 
-    uint32_t sentCount = 0;
-    uint32_t failCount = 0;
+    FuserUtil::Log("[Sender] Starting capture pipeline -> %u\n", m_cfg.port);
 
-    while (m_running)
+    // Slots: full-frame capture buffers up front, send payloads
+    // grow to the largest band encoded
+    const size_t frameBytes = static_cast<size_t>(m_captureW) * m_captureH * 4;
+    for (uint32_t i = 0; i < CAPTURE_SLOTS; ++i)
     {
-        if (!CaptureFrame())
-        {
-            // Aggressive retry
-            continue;
-        }
-        failCount = 0;
-
-        // Force a heartbeat pixel in top-left
-        if (m_fullFrameBuf.size() >= 4) {
-            m_fullFrameBuf[0] = 2; m_fullFrameBuf[1] = 2; m_fullFrameBuf[2] = 2; m_fullFrameBuf[3] = 255;
-        }
-
-        SendFrame();
-
-        sentCount++;
-        if (sentCount % 100 == 0) {
-            FuserUtil::Log("[Sender] Still sending... (Last Frame sent to %s)\n", 
-                m_cfg.remoteIP.empty() ? "BROADCAST" : m_cfg.remoteIP.c_str());
-            
-            // Heartbeat: Prove the line is open
-            const char* beep = "BEEP";
-            int rc = sendto(m_sock, beep, 4, 0, (sockaddr*)&m_dest, sizeof(m_dest));
-            if (rc == SOCKET_ERROR) {
-                FuserUtil::Log("[Sender] ERROR: Network blocked outgoing heartbeat! Code: %d\n", WSAGetLastError());
-            }
-        }
+        m_captureSlots[i].pixels.resize(frameBytes);
+        m_captureFree.TryPush(i);
     }
+    for (uint32_t i = 0; i < SEND_SLOTS; ++i)
+    {
+        m_sendSlots[i].payload.resize(m_cfg.packetBytes);
+        m_sendFree.TryPush(i);
+    }
+    m_bandCount = std::clamp<uint32_t>(m_cfg.frameBands, 1, std::min(MAX_BANDS, m_captureH));
+    for (uint32_t b = 0; b < m_bandCount; ++b)
+    {
+        const size_t bandBytes = (FrameOps::BandStart(m_captureH, b + 1, m_bandCount) -
+                                  FrameOps::BandStart(m_captureH, b, m_bandCount)) * static_cast<size_t>(m_captureW) * 4;
+        m_bands[b].cropped.resize(bandBytes);
+        m_bands[b].prevCropped.resize(bandBytes);
+    }
+    m_encoded.SetDepth(m_bandCount);   // one capture's bands
+    m_packetBuf.resize(m_cfg.packetBytes);
+    for (uint32_t b = 0; b < m_bandCount && m_cfg.tileCache; ++b)
+        if (!m_tiles[b].cache)
+            m_tiles[b].cache = std::make_unique<TileCacheEncoder>(
+                std::max<uint32_t>(m_cfg.tileCacheEntries / m_bandCount, 1));
+    if (m_bandCount > 1)
+        FuserUtil::Log("[Sender] Sending each capture in %u bands\n", m_bandCount);
+
+    m_encodeThread = std::thread([this]{ EncodeStageProc(); });
+    m_sendThread   = std::thread([this]{ SendStageProc(); });
+
+    CaptureStageProc();
+
+    m_capturedSignal.Notify();
+    m_encodedSignal.Notify();
+    m_encodeThread.join();
+    m_sendThread.join();
 }
 
 void SenderModule::Stop()
 {
     m_running = false;
 
-    if (m_duplication)  { m_duplication->ReleaseFrame(); m_duplication->Release();  m_duplication  = nullptr; }
-    if (m_stagingTex)   { m_stagingTex->Release();   m_stagingTex   = nullptr; }
-    if (m_dxgiOutput1)  { m_dxgiOutput1->Release();  m_dxgiOutput1  = nullptr; }
-    if (m_d3dContext)   { m_d3dContext->Release();   m_d3dContext   = nullptr; }
-    if (m_d3dDevice)    { m_d3dDevice->Release();    m_d3dDevice    = nullptr; }
-
-    if (m_sock != INVALID_SOCKET)
-    {
-        // Cancel any pending discovery recv
-        closesocket(m_sock);
-        m_sock = INVALID_SOCKET;
-    }
+    if (m_syncThread.joinable()) m_syncThread.join();   // exits within its recv timeout
 }
 
 // ─── Private: socket init ────────────────────────────────────
 bool SenderModule::InitSocket()
 {
-    m_sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
-    if (m_sock == INVALID_SOCKET) return false;
+    // One socket per stripe: distinct source ports give each stripe
+    // its own flow hash, so the receiver's NIC spreads them over queues
+    const uint32_t stripes = std::clamp<uint32_t>(m_cfg.stripes, 1, MAX_STRIPES);
+    for (uint32_t k = 0; k < stripes; ++k)
+    {
+        SOCKET s = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+        if (s == INVALID_SOCKET) return false;
+        m_stripeSocks.push_back(s);
 
-    // Bind to any port locally
-    sockaddr_in local{};
-    local.sin_family = AF_INET;
-    local.sin_port = 0;
-    
-    // Bind to ANY interface for generic routing
-    local.sin_addr.s_addr = INADDR_ANY;
-    if (bind(m_sock, (sockaddr*)&local, sizeof(local)) == SOCKET_ERROR) {
-        FuserUtil::Log("[Sender] ERROR: Failed to bind socket. Code: %d\n", WSAGetLastError());
-    } else {
-        FuserUtil::Log("[Sender] Bound outgoing traffic to ANY interface.\n");
-    }
+        // Bind to any port locally
+        sockaddr_in local{};
+        local.sin_family = AF_INET;
+        local.sin_port = 0;
+        
+        // Bind to ANY interface for generic routing
+        local.sin_addr.s_addr = INADDR_ANY;
+        if (bind(s, (sockaddr*)&local, sizeof(local)) == SOCKET_ERROR) {
+            FuserUtil::Log("[Sender] ERROR: Failed to bind socket. Code: %d\n", WSAGetLastError());
+        } else if (k == 0) {
+            FuserUtil::Log("[Sender] Bound outgoing traffic to ANY interface.\n");
+        }
 
-    // Enable broadcasting
-    BOOL broadcast = TRUE;
-    setsockopt(m_sock, SOL_SOCKET, SO_BROADCAST, (char*)&broadcast, sizeof(broadcast));
+        // Enable broadcasting
+        BOOL broadcast = TRUE;
+        setsockopt(s, SOL_SOCKET, SO_BROADCAST, (char*)&broadcast, sizeof(broadcast));
+
+        if (!m_cfg.multicastGroup.empty()) {
+            DWORD ttl  = m_cfg.multicastTtl;
+            DWORD loop = m_cfg.multicastLoop ? 1 : 0;
+            in_addr iface{};
+            inet_pton(AF_INET, m_cfg.localIP.c_str(), &iface);   // 0.0.0.0 = routing table's choice
+            if (setsockopt(s, IPPROTO_IP, IP_MULTICAST_TTL,  (char*)&ttl,   sizeof(ttl))   == SOCKET_ERROR ||
+                setsockopt(s, IPPROTO_IP, IP_MULTICAST_LOOP, (char*)&loop,  sizeof(loop))  == SOCKET_ERROR ||
+                setsockopt(s, IPPROTO_IP, IP_MULTICAST_IF,   (char*)&iface, sizeof(iface)) == SOCKET_ERROR) {
+                FuserUtil::Log("[Sender] ERROR: Multicast socket options failed. Code: %d\n", WSAGetLastError());
+                return false;
+            }
+        }
+    }
+    m_sock = m_stripeSocks[0];
+    if (stripes > 1)
+        FuserUtil::Log("[Sender] Striping frames across %u sockets\n", stripes);
 
     // Prepare destination template
     m_dest.sin_family = AF_INET;
     m_dest.sin_port   = htons(m_cfg.port);
 
-    FuserUtil::Log("[Sender] Socket armed (Global Broadcast Mode enabled)\n");
+    if (m_cfg.multicastGroup.empty())
+        FuserUtil::Log("[Sender] Socket armed (Global Broadcast Mode enabled)\n");
+    else
+        FuserUtil::Log("[Sender] Socket armed (multicast, TTL %u, loopback %s, interface %s)\n",
+                       m_cfg.multicastTtl, m_cfg.multicastLoop ? "on" : "off", m_cfg.localIP.c_str());
 
     return true;
 }
 
 
 
-// ─── Private: DXGI Desktop Duplication ──────────────────────
-bool SenderModule::InitDXGI()
+// ─── Private: capture source ─────────────────────────────────
+bool SenderModule::InitCapture()
 {
-    // Create D3D11 device on the default adapter
-    D3D_FEATURE_LEVEL featureLevel;
-    UINT createFlags = 0;
-#ifdef _DEBUG
-    createFlags |= D3D11_CREATE_DEVICE_DEBUG;
-#endif
-
-    HRESULT hr = D3D11CreateDevice(
-        nullptr,
-        D3D_DRIVER_TYPE_HARDWARE,
-        nullptr,
-        createFlags,
-        nullptr, 0,
-        D3D11_SDK_VERSION,
-        &m_d3dDevice,
-        &featureLevel,
-        &m_d3dContext
-    );
-    if (FAILED(hr))
+    if (m_cfg.captureSource == "synthetic")
     {
-        FuserUtil::Log("[Sender] D3D11CreateDevice failed: 0x%08X\n", hr);
+        SyntheticCaptureParams p;
+        p.width       = m_cfg.syntheticWidth;
+        p.height      = m_cfg.syntheticHeight;
+        p.fps         = m_cfg.syntheticFps;
+        p.fillPercent = m_cfg.syntheticFillPercent;
+        p.boxes       = m_cfg.syntheticBoxes;
+        p.text        = m_cfg.syntheticText;
+        m_source = std::make_unique<SyntheticCaptureSource>(p);
+    }
+    else if (m_cfg.captureSource == "file")
+    {
+        MappedFileCaptureParams p;
+        p.path   = m_cfg.captureFilePath;
+        p.width  = m_cfg.captureFileWidth;
+        p.height = m_cfg.captureFileHeight;
+        p.fps    = m_cfg.captureFileFps;
+        m_source = std::make_unique<MappedFileCaptureSource>(p);
+    }
+    else
+    {
+        m_source = std::make_unique<DxgiCaptureSource>(m_cfg.captureMonitor);
+    }
+
+    if (!m_source->Init())
+    {
+        FuserUtil::Log("[Sender] Capture source '%s' failed to initialise\n", m_source->Name());
+        m_source.reset();
         return false;
     }
 
-    // Walk the DXGI adapter/output chain to find the requested monitor
-    IDXGIDevice*  dxgiDevice  = nullptr;
-    IDXGIAdapter* dxgiAdapter = nullptr;
-    m_d3dDevice->QueryInterface(__uuidof(IDXGIDevice),
-                                reinterpret_cast<void**>(&dxgiDevice));
-    dxgiDevice->GetParent(__uuidof(IDXGIAdapter),
-                          reinterpret_cast<void**>(&dxgiAdapter));
-    dxgiDevice->Release();
+    m_captureW = m_source->Width();
+    m_captureH = m_source->Height();
+    FuserUtil::Log("[Sender] Capture source '%s': %u x %u\n",
+                   m_source->Name(), m_captureW, m_captureH);
+    return true;
+}
+
+// ─── Capture stage (Run's thread) ────────────────────────────
+//  Only waits on the source and the frame-rate cap. The slot goes
+//  to the encode stage as soon as the source commits to a frame;
+//  a capture the encode stage hasn't taken yet is replaced by the
+//  next one.
+void SenderModule::CaptureStageProc()
+{
+    CaptureProgress progress;
+    progress.owner = this;
+    uint32_t slot          = NO_SLOT;
+    uint64_t lastCaptureUs = 0;
 
-    IDXGIOutput* output = nullptr;
-    int target = m_cfg.captureMonitor;
-    for (int i = 0; ; ++i)
+    while (m_running)
     {
-        IDXGIOutput* candidate = nullptr;
-        if (dxgiAdapter->EnumOutputs(i, &candidate) == DXGI_ERROR_NOT_FOUND)
-            break;
-        if (i == target)
+        PaceFrame(lastCaptureUs);
+        if (slot == NO_SLOT && !m_captureFree.TryPop(slot))
         {
-            output = candidate;
-            break;
+            std::this_thread::yield();   // can't happen with CAPTURE_SLOTS slots – belt and braces
+            continue;
         }
-        candidate->Release();
-    }
-    dxgiAdapter->Release();
 
-    if (!output)
-    {
-        FuserUtil::Log("[Sender] Monitor index %d not found.\n", target);
-        return false;
+        CaptureSlot& c = m_captureSlots[slot];
+        c.rows.store(0, std::memory_order_relaxed);
+        progress.slot     = slot;
+        progress.evicted  = NO_SLOT;
+        progress.nextBand = 1;
+        progress.begun    = false;
+
+        const uint64_t      t0 = FuserUtil::NowUs();
+        const CaptureStatus st = m_source->Capture(c.pixels.data(), CaptureScheduler::MAX_WAIT_MS, &progress);
+        Metrics::Add(MetricCounter::CaptureStageUsTotal, FuserUtil::NowUs() - t0);
+        if (st == CaptureStatus::Unchanged)
+        {
+            Metrics::Add(MetricCounter::FramesUnchanged);
+            continue;
+        }
+        if (st != CaptureStatus::Frame)
+        {
+            if (st == CaptureStatus::Timeout)
+                Metrics::Add(MetricCounter::CaptureTimeouts);
+            continue;
+        }
+
+        // Sources without row progress hand the frame over whole
+        if (!progress.begun)
+            progress.Begin();
+        progress.Rows(m_captureH);
+        Metrics::Add(MetricCounter::FramesCaptured);
+        lastCaptureUs = c.captureUs;
+        slot = progress.evicted;
     }
+}
 
-    hr = output->QueryInterface(__uuidof(IDXGIOutput1),
-                                reinterpret_cast<void**>(&m_dxgiOutput1));
-    output->Release();
-    if (FAILED(hr))
+void SenderModule::CaptureProgress::Begin()
+{
+    CaptureSlot& c = owner->m_captureSlots[slot];
+    c.captureUs = FuserUtil::NowUs();
+    begun       = true;
+
+    uint32_t dropped;
+    if (owner->m_captured.PushEvict(slot, dropped))
     {
-        FuserUtil::Log("[Sender] QueryInterface IDXGIOutput1 failed: 0x%08X\n", hr);
-        return false;
+        Metrics::Add(MetricCounter::CapturesSuperseded);
+        evicted = dropped;
     }
+    owner->m_capturedSignal.Notify();
+}
+
+void SenderModule::CaptureProgress::Rows(uint32_t rowsDone)
+{
+    const uint32_t H     = owner->m_captureH;
+    const uint32_t bands = owner->m_bandCount;
+    owner->m_captureSlots[slot].rows.store(rowsDone, std::memory_order_release);
+    if (rowsDone < FrameOps::BandStart(H, nextBand, bands))
+        return;   // the band the encode stage waits for isn't complete yet
+    while (nextBand < bands && FrameOps::BandStart(H, nextBand, bands) <= rowsDone)
+        ++nextBand;
+    owner->m_capturedSignal.Notify();
+}
 
-    hr = m_dxgiOutput1->DuplicateOutput(m_d3dDevice, &m_duplication);
-    if (FAILED(hr))
+// ─── Encode stage ────────────────────────────────────────────
+//  Turns the newest capture into wire frames, one per band, and
+//  decides – here, where the last sent bands are known – what
+//  goes out.
+void SenderModule::EncodeStageProc()
+{
+    while (m_running)
     {
-        FuserUtil::Log("[Sender] DuplicateOutput failed: 0x%08X\n", hr);
-        return false;
-    }
+        FrameChange change = FrameChange::None;
+        uint32_t    slot;
+        if (m_captured.TryPop(slot))
+        {
+            change = EncodeFrame(m_captureSlots[slot]);
+            m_captureFree.TryPush(slot);
+        }
 
-    DXGI_OUTDUPL_DESC duplDesc{};
-    m_duplication->GetDesc(&duplDesc);
-    m_captureW = duplDesc.ModeDesc.Width;
-    m_captureH = duplDesc.ModeDesc.Height;
+        const uint64_t   now = FuserUtil::NowUs();
+        const SendReason why = m_schedule.Decide(change, now);
+        if (why == SendReason::Skip)
+        {
+            if (change == FrameChange::Same)
+                Metrics::Add(MetricCounter::FramesUnchanged);
+            else if (change == FrameChange::None)
+                m_capturedSignal.Wait(m_schedule.WaitMs(now));
+            continue;
+        }
 
-    FuserUtil::Log("[Sender] Capture surface: %u x %u\n", m_captureW, m_captureH);
+        // Changed bands went out as they were encoded. A keepalive
+        // (or the scheduler wanting an unchanged capture again)
+        // resends every band.
+        bool empty = true;
+        if (change != FrameChange::New)
+        {
+            const bool keepalive = why == SendReason::Keepalive;
+            if (keepalive)
+                Metrics::Add(MetricCounter::FramesKeepalive);
+            const uint64_t t0 = FuserUtil::NowUs();
+            for (uint32_t b = 0; b < m_bandCount; ++b)
+            {
+                // The source says it is still what is on screen, so
+                // it is stamped as captured now
+                if (keepalive)
+                    m_bands[b].captureUs = m_bands[b].encodeUs = now;
+                QueueBand(b, keepalive);
+            }
+            Metrics::Add(MetricCounter::EncodeStageUsTotal, FuserUtil::NowUs() - t0);
+        }
+        for (uint32_t b = 0; b < m_bandCount; ++b)
+            empty = empty && m_bands[b].bb.w == 0;
+        m_schedule.OnSent(empty, FuserUtil::NowUs());
+    }
+}
 
-    // Pre-create a CPU-accessible staging texture sized to the desktop
-    D3D11_TEXTURE2D_DESC stagingDesc{};
-    stagingDesc.Width              = m_captureW;
-    stagingDesc.Height             = m_captureH;
-    stagingDesc.MipLevels          = 1;
-    stagingDesc.ArraySize          = 1;
-    stagingDesc.Format             = DXGI_FORMAT_B8G8R8A8_UNORM;  // BGRA
-    stagingDesc.SampleDesc.Count   = 1;
-    stagingDesc.Usage              = D3D11_USAGE_STAGING;
-    stagingDesc.CPUAccessFlags     = D3D11_CPU_ACCESS_READ;
-    stagingDesc.BindFlags          = 0;
+// Encodes the bands top to bottom as the source finishes them and
+// queues each one that has to go out. New if any band was queued,
+// Empty if nothing is visible (and that was sent already), else
+// Same; None if the module stopped mid-frame.
+FrameChange SenderModule::EncodeFrame(const CaptureSlot& c)
+{
+    const uint32_t firstID = m_frameID + 1;   // what band 0 goes out under if it changed
+    EventTrace::Emit(TraceEvent::FrameCaptured, firstID, m_captureW, m_captureH);
 
-    hr = m_d3dDevice->CreateTexture2D(&stagingDesc, nullptr, &m_stagingTex);
-    if (FAILED(hr))
+    const uint32_t scale  = m_scale.load(std::memory_order_relaxed);
+    bool           queued = false;
+    bool           empty  = true;
+    for (uint32_t b = 0; b < m_bandCount; ++b)
     {
-        FuserUtil::Log("[Sender] CreateTexture2D (staging) failed: 0x%08X\n", hr);
-        return false;
+        if (!WaitForRows(c, FrameOps::BandStart(m_captureH, b + 1, m_bandCount)))
+            return FrameChange::None;
+
+        const uint64_t    t0     = FuserUtil::NowUs();
+        BandState&        band   = m_bands[b];
+        band.captureUs           = c.captureUs;
+        const FrameChange change = EncodeBand(b, c.pixels.data(), scale);
+        empty = empty && change == FrameChange::Empty;
+        if (band.resend || band.queuedID == 0 || change == FrameChange::New ||
+            (change == FrameChange::Empty && !band.sentEmpty))
+        {
+            QueueBand(b, false);
+            queued = true;
+        }
+        Metrics::Add(MetricCounter::EncodeStageUsTotal, FuserUtil::NowUs() - t0);
     }
 
-    m_fullFrameBuf.resize(m_captureW * m_captureH * 4);
-    m_croppedBuf  .resize(m_captureW * m_captureH * 4);
+    if (empty)
+    {
+        Metrics::Add(MetricCounter::FramesEmpty);
+        EventTrace::Emit(TraceEvent::FrameEmpty, firstID);
+    }
+    return queued ? FrameChange::New : empty ? FrameChange::Empty : FrameChange::Same;
+}
 
+// Bounding box of one band's visible pixels, then its crop – or,
+// at reduced resolution, the box filtered straight out of the full
+// frame (the filter reads any stride, so the crop copy is skipped).
+// Same only if SkipUnchanged and the pixels, box and scale all
+// match the capture before; Empty if nothing in the band is visible.
+FrameChange SenderModule::EncodeBand(uint32_t b, const uint8_t* full, uint32_t scale)
+{
+    BandState&     band   = m_bands[b];
+    const uint32_t y0     = FrameOps::BandStart(m_captureH, b, m_bandCount);
+    const uint32_t y1     = FrameOps::BandStart(m_captureH, b + 1, m_bandCount);
+    const size_t   stride = static_cast<size_t>(m_captureW) * 4;
+
+    const BoundingBox prevBB    = band.bb;
+    const uint32_t    prevScale = band.scale;
+    band.bb = FrameOps::ComputeBoundingBox(full + y0 * stride, m_captureW, y1 - y0);
+    if (band.bb.w == 0 || band.bb.h == 0)
+    {
+        band.bb       = BoundingBox{0, 0, 0, 0};   // sent as an empty band
+        band.encodeUs = band.captureUs;
+        return FrameChange::Empty;
+    }
+    band.bb.y += y0;
+
+    band.cropped.swap(band.prevCropped);
+    band.scale = scale;
+    if (scale > 1)
+        FrameScale::Downscale(full + band.bb.y * stride + static_cast<size_t>(band.bb.x) * 4, stride,
+                              band.bb.w, band.bb.h, scale, band.cropped.data());
+    else
+        FrameOps::CropBGRA(full, m_captureW, band.cropped.data(), band.bb);
+
+    const size_t pixels = static_cast<size_t>(FrameScale::ScaledSize(band.bb.w, scale)) *
+                          FrameScale::ScaledSize(band.bb.h, scale);
+    if (m_cfg.skipUnchanged && scale == prevScale &&
+        band.bb.x == prevBB.x && band.bb.y == prevBB.y && band.bb.w == prevBB.w && band.bb.h == prevBB.h &&
+        std::memcmp(band.cropped.data(), band.prevCropped.data(), pixels * 4) == 0)
+        return FrameChange::Same;
+    return FrameChange::New;
+}
+
+// Blocks until the source has copied `rows` rows of the capture;
+// false if the module is stopping
+bool SenderModule::WaitForRows(const CaptureSlot& c, uint32_t rows)
+{
+    while (c.rows.load(std::memory_order_acquire) < rows)
+    {
+        if (!m_running)
+            return false;
+        m_capturedSignal.Wait(CaptureScheduler::MAX_WAIT_MS);
+    }
     return true;
 }
 
-// ─── Private: one capture + send cycle ──────────────────────
-bool SenderModule::CaptureFrame()
+// ─── Pack a band's crop into a send slot and hand it on ──────
+//  Reduces the colour depth on the way: A8 if the band is one
+//  colour and that is allowed, else the configured format. A band
+//  the transmit stage hasn't started on is replaced once a whole
+//  capture's worth is queued behind it; its ID never goes out, so
+//  receivers count it as lost and the loss pacer backs off the
+//  frame rate the link can't carry. If nothing newer of that band
+//  was queued, the next capture sends the band again.
+void SenderModule::QueueBand(uint32_t b, bool keepalive)
 {
-    IDXGIResource*           deskRes    = nullptr;
-    DXGI_OUTDUPL_FRAME_INFO  frameInfo  = {};
-
-    // AcquireNextFrame with a 0ms timeout for non-blocking poll;
-    // we rely on the DXGI present signal so 5ms is safe.
-    HRESULT hr = m_duplication->AcquireNextFrame(5, &frameInfo, &deskRes);
-    if (hr == DXGI_ERROR_WAIT_TIMEOUT)
-        return false;  // no new frame yet
-    if (FAILED(hr))
+    BandState&     band   = m_bands[b];
+    const uint32_t sentW  = FrameScale::ScaledSize(band.bb.w, band.scale);
+    const uint32_t sentH  = FrameScale::ScaledSize(band.bb.h, band.scale);
+    const size_t   pixels = static_cast<size_t>(sentW) * sentH;
+
+    uint32_t format = m_cfg.wireFormat;
+    if (FuserUtil::PacketsForFrame(static_cast<uint32_t>(pixels * WirePixels::BytesPerPixel(format)),
+                                   m_cfg.packetBytes) > 0xFFFF)
     {
-        FuserUtil::Log("[Sender] AcquireNextFrame failed: 0x%08X – reinitialising\n", hr);
-        // Attempt duplication recovery (monitor mode change, etc.)
-        m_duplication->Release();
-        m_duplication = nullptr;
-        HRESULT hr2 = m_dxgiOutput1->DuplicateOutput(m_d3dDevice, &m_duplication);
-        if (FAILED(hr2))
-            FuserUtil::Log("[Sender] DuplicateOutput recovery failed: 0x%08X\n", hr2);
-        return false;
+        LOG_EVERY_SEC(LogLevel::Warn, 1, "[Sender] Frame too large to packetise (%ux%u)\n", sentW, sentH);
+        return;
+    }
+    if (m_sendHeld == NO_SLOT && !m_sendFree.TryPop(m_sendHeld))
+        return;   // can't happen with SEND_SLOTS slots
+
+    SendSlot& s = m_sendSlots[m_sendHeld];
+    if (s.payload.size() < pixels * 4)
+        s.payload.resize(pixels * 4);
+    s.colour = 0;
+    if (pixels != 0)   // else an empty band – metadata only
+    {
+        if (m_cfg.wireMono && WirePixels::PackMono(band.cropped.data(), pixels, s.payload.data(), s.colour))
+            format = WirePixels::A8;
+        else if (format == WirePixels::BGRA32)
+            std::memcpy(s.payload.data(), band.cropped.data(), pixels * 4);
+        else
+            WirePixels::Pack(static_cast<WirePixels::Format>(format), band.cropped.data(), pixels,
+                             s.payload.data());
+    }
+    if (!keepalive && pixels != 0)
+    {
+        band.encodeUs = FuserUtil::NowUs();
+        Metrics::Set(MetricGauge::SendScale, band.scale);
+        Metrics::Set(MetricGauge::SendFormat, format);
+        EventTrace::Emit(TraceEvent::FrameCropped, m_frameID + 1, sentW, sentH,
+                         static_cast<uint32_t>(pixels * WirePixels::BytesPerPixel(format)), b);
     }
 
-    // Get the desktop texture
-    ID3D11Texture2D* desktopTex = nullptr;
-    hr = deskRes->QueryInterface(__uuidof(ID3D11Texture2D),
-                                 reinterpret_cast<void**>(&desktopTex));
-    deskRes->Release();
-    if (FAILED(hr))
+    s.bb        = band.bb;
+    s.frameID   = ++m_frameID;
+    s.band      = b;
+    s.scale     = band.scale;
+    s.format    = format;
+    s.captureUs = band.captureUs;
+    s.encodeUs  = band.encodeUs;
+    s.keepalive = keepalive;
+    band.queuedID  = s.frameID;
+    band.sentEmpty = pixels == 0;
+    band.resend    = false;
+
+    uint32_t evicted;
+    const uint32_t filled = m_sendHeld;
+    m_sendHeld = NO_SLOT;
+    if (m_encoded.PushEvict(filled, evicted))
     {
-        m_duplication->ReleaseFrame();
-        return false;
+        Metrics::Add(MetricCounter::FramesSuperseded);
+        const SendSlot& old = m_sendSlots[evicted];
+        if (m_bands[old.band].queuedID == old.frameID)
+            m_bands[old.band].resend = true;
+        m_sendHeld = evicted;
     }
+    m_encodedSignal.Notify();
+}
 
-    // Copy GPU → CPU-accessible staging texture
-    m_d3dContext->CopyResource(m_stagingTex, desktopTex);
-    desktopTex->Release();
+// ─── Transmit stage ──────────────────────────────────────────
+void SenderModule::SendStageProc()
+{
+    uint32_t sentCount = 0;
 
-    D3D11_MAPPED_SUBRESOURCE mapped{};
-    hr = m_d3dContext->Map(m_stagingTex, 0, D3D11_MAP_READ, 0, &mapped);
-    if (FAILED(hr))
+    while (m_running)
     {
-        m_duplication->ReleaseFrame();
-        return false;
+        uint32_t slot;
+        if (!m_encoded.TryPop(slot))
+        {
+            m_encodedSignal.Wait(CaptureScheduler::MAX_WAIT_MS);
+            continue;
+        }
+
+        SendSlot&       s  = m_sendSlots[slot];
+        const uint64_t  t0 = FuserUtil::NowUs();
+        SendFrame(s);
+        const uint64_t sentUs = FuserUtil::NowUs();
+        Metrics::Add(MetricCounter::SendStageUsTotal, sentUs - t0);
+
+        // Own frame interval (EWMA, gain 1/8) – where loss pacing
+        // starts from; the bands of one capture count once.
+        // Keepalives and gaps longer than the slowest pace are idle
+        // time, not the frame rate.
+        if (s.captureUs != m_lastSendCaptureUs) {
+            if (m_lastSendUs != 0 && !s.keepalive &&
+                sentUs - m_lastSendUs <= FEEDBACK_MAX_INTERVAL_US) {
+                const uint64_t gap  = sentUs - m_lastSendUs;
+                const uint64_t prev = m_sendIntervalUs.load(std::memory_order_relaxed);
+                m_sendIntervalUs.store(prev ? prev - prev / 8 + gap / 8 : gap, std::memory_order_relaxed);
+            }
+            m_lastSendUs        = sentUs;
+            m_lastSendCaptureUs = s.captureUs;
+        }
+        m_sendFree.TryPush(slot);
+
+        sentCount++;
+        if (sentCount % 100 == 0) {
+            // Heartbeat: Prove the line is open
+            const char* beep = "BEEP";
+            int rc = sendto(m_sock, beep, 4, 0, (sockaddr*)&m_dest, sizeof(m_dest));
+            if (rc == SOCKET_ERROR) {
+                LOG_EVERY_SEC(LogLevel::Error, 1,
+                              "[Sender] ERROR: Network blocked outgoing heartbeat! Code: %d\n", WSAGetLastError());
+            }
+        }
     }
+}
+
+void SenderModule::SendFrame(SendSlot& s)
+{
+    FrameMetaPayload meta{};
+    meta.width     = s.bb.w;
+    meta.height    = s.bb.h;
+    meta.originX   = s.bb.x;
+    meta.originY   = s.bb.y;
+    meta.rawBytes  = FrameScale::ScaledSize(s.bb.w, s.scale) * FrameScale::ScaledSize(s.bb.h, s.scale) *
+                     WirePixels::BytesPerPixel(s.format);
+    meta.captureUs = s.captureUs;
+    meta.encodeUs  = s.encodeUs;
+    meta.sendUs    = FuserUtil::NowUs();
+    meta.scale     = static_cast<uint8_t>(s.scale);
+    meta.format    = static_cast<uint8_t>(s.format);
+    meta.band      = static_cast<uint8_t>(s.band);
+    meta.bandCount = static_cast<uint8_t>(m_bandCount);
+    meta.colour    = s.colour;
+    const uint8_t* pixels       = CodeFrame(s, meta);
+    const uint32_t frameBytes   = meta.rawBytes;
+    const uint32_t totalPackets = FuserUtil::PacketsForFrame(frameBytes, m_cfg.packetBytes);
+
+    // ── Packets 0..N-1 (layout: FuserUtil::PacketizeFrame) ──
+    EventTrace::Emit(TraceEvent::SendBegin, s.frameID, totalPackets, frameBytes);
+
+    MetricsBlock& metrics = Metrics::Local();
+    uint64_t bytesSent  = 0;
+    uint32_t sendErrors = 0;
+    uint32_t stripe     = 0;   // packet i → stripe i % N
+    const uint32_t stripes = static_cast<uint32_t>(m_stripeSocks.size());
+    FuserUtil::PacketizeFrame(s.frameID, totalPackets, meta, pixels, m_packetBuf.data(),
+                              m_cfg.packetBytes, m_cfg.streamID,
+        [&](const uint8_t* pkt, int len)
+        {
+            const sockaddr_in& dest = m_stripeDests[stripe];
+            int rc = sendto(m_stripeSocks[stripe], reinterpret_cast<const char*>(pkt), len, 0,
+                            reinterpret_cast<const sockaddr*>(&dest), sizeof(dest));
+            if (++stripe == stripes) stripe = 0;
+            if (rc == SOCKET_ERROR) {
+                metrics.Add(MetricCounter::SendErrors, 1);
+                ++sendErrors;
+                LOG_SAMPLED(LogLevel::Error, 1, 500,
+                            "[Sender] ERROR: sendto explicitly blocked by Windows. Code: %d\n", WSAGetLastError());
+            } else {
+                bytesSent += static_cast<uint64_t>(rc);
+            }
+        });
+
+    metrics.Add(MetricCounter::FramesSent,  1);
+    metrics.Add(MetricCounter::PacketsSent, totalPackets);
+    metrics.Add(MetricCounter::BytesSent,   bytesSent);
+    EventTrace::Emit(TraceEvent::SendEnd, s.frameID, totalPackets,
+                     static_cast<uint32_t>(bytesSent), sendErrors);
+}
 
-    // Copy with stride correction (GPU pitch may be wider than width*4)
-    const uint32_t destStride = m_captureW * 4;
-    for (uint32_t row = 0; row < m_captureH; ++row)
+// ─── Temporal delta + tile-cache coding ──────────────────────
+//  DeltaCodec: codes the band against the last frame of it that
+//  went out, if that one has the same rectangle, scale and format;
+//  a keyframe instead when there is none, on keepalive, every
+//  KeyframeInterval frames, after a receiver asked, or when the
+//  code wouldn't be smaller. Either way the frame becomes the
+//  band's reference: its buffer is swapped in, not copied.
+//  TileCache: what would go out whole goes out as tiles, those
+//  the receivers already hold as cache slots of the band's cache
+//  (TileCache.h). A keyframe request empties every band's cache –
+//  the receiver asking has lost step with one.
+const uint8_t* SenderModule::CodeFrame(SendSlot& s, FrameMetaPayload& meta)
+{
+    DeltaRef& ref = m_deltaRefs[s.band];
+    const size_t n = meta.rawBytes;
+    if ((!m_cfg.deltaCodec && !m_cfg.tileCache) || n == 0)
     {
-        std::memcpy(
-            m_fullFrameBuf.data() + row * destStride,
-            reinterpret_cast<const uint8_t*>(mapped.pData) + row * mapped.RowPitch,
-            destStride);
+        ref.frameID = 0;   // an empty band leaves nothing to code against
+        return s.payload.data();
     }
 
-    m_d3dContext->Unmap(m_stagingTex, 0);
-    m_duplication->ReleaseFrame();
+    const uint32_t gen = m_keyframeGen.load(std::memory_order_relaxed);
+    bool key = !m_cfg.deltaCodec || ref.frameID == 0 || s.keepalive || ref.keyGen != gen ||
+               (m_cfg.keyframeInterval != 0 && ref.sinceKey + 1 >= m_cfg.keyframeInterval) ||
+               s.scale != ref.scale || s.format != ref.format || s.colour != ref.colour ||
+               s.bb.x != ref.bb.x || s.bb.y != ref.bb.y || s.bb.w != ref.bb.w || s.bb.h != ref.bb.h;
 
-    // Compute the tight bounding box of visible (non-black) pixels
-    m_lastBB = ComputeBoundingBox(m_fullFrameBuf.data(), m_captureW, m_captureH);
-    if (m_lastBB.w == 0 || m_lastBB.h == 0)
-        return false;   // fully black frame – nothing to send
+    size_t coded = 0;
+    if (!key)
+    {
+        if (m_codeBuf.size() < n)
+            m_codeBuf.resize(n);
+        key = !FrameDelta::Encode(s.payload.data(), ref.bytes.data(), n, m_codeBuf.data(), n - 1, coded);
+    }
 
-    // Crop
-    CropBGRA(m_fullFrameBuf.data(), m_captureW, m_croppedBuf.data(), m_lastBB);
+    const uint32_t tileW   = FrameScale::ScaledSize(s.bb.w, s.scale);
+    const uint32_t tileH   = FrameScale::ScaledSize(s.bb.h, s.scale);
+    const uint32_t bpp     = WirePixels::BytesPerPixel(s.format);
+    const uint64_t tileMax = TileCode::MaxCodedBytes(tileW, tileH, bpp);
+    if (!key)
+    {
+        meta.codec      = FrameDelta::DELTA;
+        meta.refFrameID = ref.frameID;
+        meta.rawBytes   = static_cast<uint32_t>(coded);
+        ++ref.sinceKey;
+        Metrics::Add(MetricCounter::DeltaFramesSent);
+        Metrics::Add(MetricCounter::DeltaBytesSaved, n - coded);
+    }
+    else if (m_tiles[s.band].cache && tileMax <= MAX_FRAME_BYTES &&
+             FuserUtil::PacketsForFrame(static_cast<uint32_t>(tileMax), m_cfg.packetBytes) <= 0xFFFF)
+    {
+        TileChain& chain = m_tiles[s.band];
+        if (chain.gen != gen)
+        {
+            chain.cache->Reset();
+            chain.gen    = gen;
+            chain.lastID = 0;
+        }
+        if (m_codeBuf.size() < tileMax)
+            m_codeBuf.resize(static_cast<size_t>(tileMax));
+        uint32_t hits = 0, misses = 0;
+        coded = chain.cache->Encode(s.payload.data(), tileW, tileH, bpp, m_codeBuf.data(), hits, misses);
+
+        meta.codec      = FrameDelta::TILES;
+        meta.refFrameID = chain.lastID;
+        meta.rawBytes   = static_cast<uint32_t>(coded);
+        chain.lastID    = s.frameID;
+        uint32_t used = 0;
+        for (uint32_t b = 0; b < m_bandCount; ++b)
+            used += m_tiles[b].cache ? m_tiles[b].cache->Used() : 0;
+        Metrics::Add(MetricCounter::TileHits,   hits);
+        Metrics::Add(MetricCounter::TileMisses, misses);
+        Metrics::Set(MetricGauge::TileCacheUsed, used);
+    }
+    else if (m_cfg.deltaCodec)
+    {
+        meta.codec = FrameDelta::KEY;
+    }
 
-    return true;
+    if (!m_cfg.deltaCodec)
+        return meta.codec == FrameDelta::TILES ? m_codeBuf.data() : s.payload.data();
+    if (key)
+    {
+        ref.sinceKey = 0;
+        Metrics::Add(MetricCounter::KeyframesSent);
+    }
+    ref.bytes.swap(s.payload);
+    ref.bb      = s.bb;
+    ref.scale   = s.scale;
+    ref.format  = s.format;
+    ref.colour  = s.colour;
+    ref.frameID = s.frameID;
+    ref.keyGen  = gen;
+    return meta.codec == FrameDelta::KEY ? ref.bytes.data() : m_codeBuf.data();
 }
 
-void SenderModule::SendFrame()
+// ─── Frame-rate cap + loss-driven frame pacing ───────────────
+//  Holds the next capture back until MaxFps and the interval the
+//  worst receiver's loss allows have both passed since the last
+//  capture.
+void SenderModule::PaceFrame(uint64_t lastCaptureUs)
 {
-    const uint32_t frameBytes = m_lastBB.w * m_lastBB.h * 4;
+    const uint64_t due = m_schedule.NextCaptureUs(lastCaptureUs,
+                                                  m_minFrameIntervalUs.load(std::memory_order_relaxed));
+    if (due == 0)
+        return;
+    const uint64_t now = FuserUtil::NowUs();
+    if (now < due)
+        std::this_thread::sleep_for(std::chrono::microseconds(due - now));
+}
 
-    // ── Packet 0: metadata + first pixel slice ───────────────
-    // Layout of packet 0 payload (after header):
-    //   FrameMetaPayload (20 bytes) | pixel_data[0..N]
-    const uint32_t pixelBytesInPkt0 = MAX_PIXEL_PAYLOAD - FRAME_META_SIZE;
+// ─── One receiver's loss report (responder thread) ──────────
+void SenderModule::OnReceiverReport(const ReceiverReportPacket& r, const sockaddr_in& from)
+{
+    if (r.streamID != m_cfg.streamID)
+    {
+        // Only on port+1, from a receiver that doesn't know this
+        // stream's own FeedbackPort
+        Metrics::Add(MetricCounter::ReportsOtherStream);
+        return;
+    }
 
-    // Pre-calculate total packets needed
-    const uint32_t remainingAfterPkt0 =
-        (frameBytes > pixelBytesInPkt0) ? (frameBytes - pixelBytesInPkt0) : 0;
-    const uint32_t extraPackets =
-        (remainingAfterPkt0 + MAX_PIXEL_PAYLOAD - 1) / MAX_PIXEL_PAYLOAD;
-    const uint16_t totalPackets = static_cast<uint16_t>(1 + extraPackets);
+    if (r.flags & REPORT_FLAG_KEYFRAME)
+    {
+        // Every band: the receiver may have lost more than one
+        m_keyframeGen.fetch_add(1, std::memory_order_relaxed);
+        Metrics::Add(MetricCounter::KeyframeRequests);
+    }
+    if (r.intervalUs == 0)
+        return;   // keyframe request between reports – no loss sample
+
+    const uint64_t now = FuserUtil::NowUs();
+    const uint64_t key = (static_cast<uint64_t>(from.sin_addr.s_addr) << 16) | from.sin_port;
+    m_feedback.OnReport(key, r, now);
+
+    const double   worst     = m_feedback.WorstLossPercent(now);
+    const uint32_t receivers = m_feedback.ActiveReceivers(now);
+    m_worstLossBp.store(static_cast<uint32_t>(worst * 100.0), std::memory_order_relaxed);
+    Metrics::Set(MetricGauge::FeedbackReceivers, receivers);
+    Metrics::Set(MetricGauge::WorstRxLossBp, static_cast<int64_t>(worst * 100.0));
+
+    // Several receivers each report once per interval – step the
+    // pacer once per interval, not once per report
+    if (!m_cfg.adaptToLoss || now - m_lastPaceUs < r.intervalUs * 9ull / 10)
+        return;
+    m_lastPaceUs = now;
+    if (m_cfg.downscale == 0 && StepScale(worst))
+        return;
+
+    const uint64_t before = m_pacer.MinIntervalUs();
+    m_pacer.Update(worst, m_sendIntervalUs.load(std::memory_order_relaxed));
+    const uint64_t after = m_pacer.MinIntervalUs();
+    m_minFrameIntervalUs.store(after, std::memory_order_relaxed);
+    Metrics::Set(MetricGauge::PaceIntervalUs, static_cast<int64_t>(after));
+    if ((before == 0) != (after == 0))
+        FuserUtil::Log(after ? "[Sender] Worst of %u receiver(s) loses %.1f%% of frames – pacing to %.0f fps\n"
+                             : "[Sender] Worst of %u receiver(s) loses %.1f%% of frames – pacing off\n",
+                       receivers, worst, after ? 1e6 / after : 0.0);
+}
 
-    const uint32_t thisFrameID = ++m_frameID;
-    const uint8_t* pixelPtr    = m_croppedBuf.data();
+// ─── Loss-driven resolution (Downscale = 0) ──────────────────
+//  Halves the resolution while the worst receiver loses frames
+//  and it can still go lower; gives it back only once the pacer
+//  has no frame rate left to recover. True if this step was taken.
+bool SenderModule::StepScale(double worstLossPct)
+{
+    const uint32_t scale = m_scale.load(std::memory_order_relaxed);
+    uint32_t next = scale;
+    if (worstLossPct > FEEDBACK_LOSS_HIGH_PCT && scale < FrameScale::MAX_FACTOR)
+        next = scale * 2;
+    else if (worstLossPct < FEEDBACK_LOSS_LOW_PCT && scale > 1 && m_pacer.MinIntervalUs() == 0)
+        next = scale / 2;
+    if (next == scale)
+        return false;
+
+    m_scale.store(next, std::memory_order_relaxed);
+    FuserUtil::Log("[Sender] Worst receiver loses %.1f%% of frames – sending at 1/%u resolution\n",
+                   worstLossPct, next);
+    return true;
+}
+
+// ─── Clock sync responder ────────────────────────────────────
+//  Shares the discovery port (port+1) with the receiver's
+//  KNOX_DISCOVERY broadcasts; anything that isn't a clock ping or
+//  a loss report is ignored. Stamps t2 on arrival and t3 just
+//  before the echo. A sender with StreamId ≠ 0 also binds its own
+//  FeedbackPort, exclusively: port+1 is shared by every sender on
+//  the host, and a report there reaches only one of them.
+void SenderModule::ClockSyncResponderProc()
+{
+    SOCKET s = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (s == INVALID_SOCKET) return;
 
-    // Build packet 0
+    SOCKET fb = INVALID_SOCKET;
+    const uint16_t fbPort = FuserUtil::FeedbackPort(m_cfg.port, m_cfg.streamID);
+    if (m_cfg.streamID != 0)
     {
-        FuserPacketHeader hdr;
-        hdr.FrameID      = thisFrameID;
-        hdr.PacketIndex  = 0;
-        hdr.TotalPackets = totalPackets;
-
-        FrameMetaPayload meta;
-        meta.width    = m_lastBB.w;
-        meta.height   = m_lastBB.h;
-        meta.originX  = m_lastBB.x;
-        meta.originY  = m_lastBB.y;
-        meta.rawBytes = frameBytes;
-
-        uint8_t* p = m_packetBuf.data();
-        std::memcpy(p, &hdr,  HEADER_SIZE);       p += HEADER_SIZE;
-        std::memcpy(p, &meta, FRAME_META_SIZE);   p += FRAME_META_SIZE;
-
-        const uint32_t pixToCopy = (frameBytes < pixelBytesInPkt0)
-                                   ? frameBytes : pixelBytesInPkt0;
-        std::memcpy(p, pixelPtr, pixToCopy);
-        pixelPtr += pixToCopy;
-
-        int sendLen = static_cast<int>(HEADER_SIZE + FRAME_META_SIZE + pixToCopy);
-        int rc = sendto(m_sock, reinterpret_cast<const char*>(m_packetBuf.data()),
-               sendLen, 0,
-               reinterpret_cast<const sockaddr*>(&m_dest), sizeof(m_dest));
-               
-        if (rc == SOCKET_ERROR) {
-            static int errCount = 0;
-            if (errCount++ % 500 == 0) FuserUtil::Log("[Sender] ERROR: sendto explicitly blocked by Windows. Code: %d\n", WSAGetLastError());
+        fb = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+        sockaddr_in local{};
+        local.sin_family      = AF_INET;
+        local.sin_port        = htons(fbPort);
+        local.sin_addr.s_addr = INADDR_ANY;
+        if (fb != INVALID_SOCKET && bind(fb, (sockaddr*)&local, sizeof(local)) == SOCKET_ERROR)
+        {
+            FuserUtil::Log("[Feedback] Cannot bind port %u (code %d) – another sender with StreamId %u "
+                           "on this host? Loss reports ignored\n", fbPort, WSAGetLastError(), m_cfg.streamID);
+            closesocket(fb);
+            fb = INVALID_SOCKET;
         }
     }
 
-    // ── Packets 1..N: remaining pixel slices ─────────────────
-    uint32_t remaining = remainingAfterPkt0;
-    uint16_t pktIdx    = 1;
+    BOOL reuse = TRUE;
+    setsockopt(s, SOL_SOCKET, SO_REUSEADDR, (char*)&reuse, sizeof(reuse));
+
+    sockaddr_in local{};
+    local.sin_family      = AF_INET;
+    local.sin_port        = htons(static_cast<uint16_t>(m_cfg.port + 1));
+    local.sin_addr.s_addr = INADDR_ANY;
+    if (bind(s, (sockaddr*)&local, sizeof(local)) == SOCKET_ERROR)
+    {
+        FuserUtil::Log("[ClockSync] Cannot bind port %u (code %d) – clock sync disabled\n",
+                       m_cfg.port + 1, WSAGetLastError());
+        closesocket(s);
+        if (fb != INVALID_SOCKET) closesocket(fb);
+        return;
+    }
+    FuserUtil::Log("[ClockSync] Responder listening on port %u\n", m_cfg.port + 1);
+    if (fb != INVALID_SOCKET)
+        FuserUtil::Log("[Feedback] Loss reports for StreamId %u on port %u\n", m_cfg.streamID, fbPort);
 
-    while (remaining > 0)
+    uint8_t buf[64];
+    while (m_running)
     {
-        FuserPacketHeader hdr;
-        hdr.FrameID      = thisFrameID;
-        hdr.PacketIndex  = pktIdx;
-        hdr.TotalPackets = totalPackets;
+        // Re-check m_running twice a second
+        fd_set rd;
+        FD_ZERO(&rd);
+        FD_SET(s, &rd);
+        if (fb != INVALID_SOCKET) FD_SET(fb, &rd);
+        timeval tv{ 0, 500000 };
+        if (select(0, &rd, nullptr, nullptr, &tv) <= 0)
+            continue;
+        const SOCKET ready = FD_ISSET(s, &rd) ? s : fb;
+
+        sockaddr_in from{};
+        int fromLen = sizeof(from);
+        int nr = recvfrom(ready, (char*)buf, sizeof(buf), 0, (sockaddr*)&from, &fromLen);
+        if (nr == SOCKET_ERROR)
+            continue;   // ICMP port unreachable from a stale peer
+        const uint64_t t2 = FuserUtil::NowUs();
 
-        uint32_t slice = (remaining > MAX_PIXEL_PAYLOAD) ? MAX_PIXEL_PAYLOAD : remaining;
+        if (nr == static_cast<int>(sizeof(ReceiverReportPacket)) &&
+            std::memcmp(buf, FEEDBACK_MAGIC, sizeof(FEEDBACK_MAGIC)) == 0)
+        {
+            ReceiverReportPacket report;
+            std::memcpy(&report, buf, sizeof(report));
+            OnReceiverReport(report, from);
+            continue;
+        }
 
-        uint8_t* p = m_packetBuf.data();
-        std::memcpy(p, &hdr, HEADER_SIZE); p += HEADER_SIZE;
-        std::memcpy(p, pixelPtr, slice);
-        pixelPtr  += slice;
-        remaining -= slice;
+        ClockSyncPacket pkt;
+        if (nr != static_cast<int>(sizeof(pkt)) ||
+            std::memcmp(buf, CLOCK_SYNC_MAGIC, sizeof(pkt.magic)) != 0)
+            continue;
+        std::memcpy(&pkt, buf, sizeof(pkt));
 
-        int sendLen = static_cast<int>(HEADER_SIZE + slice);
-        sendto(m_sock, reinterpret_cast<const char*>(m_packetBuf.data()),
-               sendLen, 0,
-               reinterpret_cast<const sockaddr*>(&m_dest), sizeof(m_dest));
-        ++pktIdx;
+        pkt.t2 = t2;
+        pkt.t3 = FuserUtil::NowUs();
+        sendto(ready, (const char*)&pkt, sizeof(pkt), 0, (sockaddr*)&from, fromLen);
     }
+    closesocket(s);
+    if (fb != INVALID_SOCKET) closesocket(fb);
 }
@@ -3,6 +3,12 @@
 //  Sender.h  –  SenderModule class declaration
 // ============================================================
 #include "NetworkFuser.h"
+#include "CaptureSource.h"
+#include "LossFeedback.h"
+#include "CaptureScheduler.h"
+#include "SpscRing.h"
+#include "TileCache.h"
+#include <memory>
 
 class SenderModule
 {
@@ -11,33 +17,169 @@ public:
     ~SenderModule();
 
     bool Init();
-    void Run();    // blocking – call from dedicated thread
-    void Stop();
+    void Run();    // blocking – call from dedicated thread (becomes the capture stage)
+    void Stop();   // Run() returns within one frame; capture + socket go with the module
+
+    // Worst smoothed frame loss (%) among receivers reporting back
+    double WorstReceiverLossPercent() const { return m_worstLossBp.load(std::memory_order_relaxed) / 100.0; }
 
 private:
     bool InitSocket();
-    bool InitDXGI();
-    bool CaptureFrame();     // returns false if no new frame
-    void SendFrame();
+    bool InitCapture();
+
+    // ─── Pipeline: capture (Run's thread) → encode → transmit ──
+    // A capture goes to the encode stage as soon as the source has
+    // it, and is encoded band by band (FrameBands) while the rest
+    // of its rows are still being copied; each band goes on to
+    // transmit on its own. Each hop is a ring of slot indices one
+    // capture deep: a stage that falls behind only ever finds the
+    // newest capture / bands, and what they replaced goes straight
+    // back to the producer. Finished slots return over the free
+    // rings, so no stage waits for another's buffer.
+    static constexpr uint32_t STAGE_DEPTH   = 1;
+    static constexpr uint32_t CAPTURE_SLOTS = STAGE_DEPTH + 2;   // + one each held by producer and consumer
+    static constexpr uint32_t SEND_SLOTS    = MAX_BANDS + 2;
+    static constexpr uint32_t FREE_RING     = 16;
+    static constexpr uint32_t NO_SLOT       = ~0u;
+    static_assert(FREE_RING >= CAPTURE_SLOTS && FREE_RING >= SEND_SLOTS, "a free ring must hold every slot");
+
+    struct CaptureSlot
+    {
+        std::vector<uint8_t>  pixels;     // full desktop BGRA
+        std::atomic<uint32_t> rows{0};    // rows of pixels the source has finished
+        uint64_t              captureUs = 0;
+    };
+    struct SendSlot
+    {
+        std::vector<uint8_t> payload;     // wire pixels in `format` (grows, never shrinks)
+        BoundingBox          bb{};        // 0×0 = empty band
+        uint32_t             frameID   = 0;
+        uint32_t             band      = 0;
+        uint32_t             scale     = 1;
+        uint32_t             format    = 0;   // WirePixels::Format
+        uint32_t             colour    = 0;   // when A8
+        uint64_t             captureUs = 0;
+        uint64_t             encodeUs  = 0;
+        bool                 keepalive = false;
+    };
+
+    // What the encode stage last made of one band
+    struct BandState
+    {
+        std::vector<uint8_t> cropped;       // visible part (downscaled when scale > 1)
+        std::vector<uint8_t> prevCropped;   // the capture before, for unchanged-band skipping
+        BoundingBox          bb{};          // capture coordinates; 0×0 = nothing visible
+        uint32_t             scale     = 1; // divisor `cropped` was made at
+        uint64_t             captureUs = 0; // latency stamps of `cropped`
+        uint64_t             encodeUs  = 0;
+        uint32_t             queuedID  = 0; // frame ID it last went to transmit under (0 = never)
+        bool                 sentEmpty = false;
+        bool                 resend    = false;   // that frame was superseded before it went out
+    };
+
+    // Capture stage: hands the slot on at Begin, publishes its rows
+    struct CaptureProgress final : CaptureRowSink
+    {
+        SenderModule* owner    = nullptr;
+        uint32_t      slot     = NO_SLOT;
+        uint32_t      evicted  = NO_SLOT;   // slot the hand-off gave back
+        uint32_t      nextBand = 1;         // wake the encode stage once band nextBand-1 is in
+        bool          begun    = false;
+        void Begin() override;
+        void Rows(uint32_t rowsDone) override;
+    };
+
+    void CaptureStageProc();
+    void EncodeStageProc();
+    void SendStageProc();
+    FrameChange EncodeFrame(const CaptureSlot& c);   // every band; queues those that changed
+    FrameChange EncodeBand(uint32_t band, const uint8_t* full, uint32_t scale);
+    bool WaitForRows(const CaptureSlot& c, uint32_t rows);
+    void QueueBand(uint32_t band, bool keepalive);   // pack a band's crop for transmit
+    void SendFrame(SendSlot& s);
+    const uint8_t* CodeFrame(SendSlot& s, FrameMetaPayload& meta);   // DeltaCodec / TileCache; the bytes to send
+    void ClockSyncResponderProc();   // answers receiver pings on port+1, takes loss reports on FeedbackPort
+    void OnReceiverReport(const ReceiverReportPacket& r, const sockaddr_in& from);
+    void PaceFrame(uint64_t lastCaptureUs);   // waits out the frame-rate cap / loss-driven interval
+    bool StepScale(double worstLossPct);   // Downscale = 0: resolution before frame rate
 
     FuserConfig             m_cfg;
-    SOCKET                  m_sock;
+    SOCKET                  m_sock;           // stripe 0 (heartbeat goes here too)
     sockaddr_in             m_dest{};
+
+    // Packets go round-robin over one socket per stripe, each to
+    // its own receiver port (FuserUtil::StripePort); [0] is m_sock
+    std::vector<SOCKET>     m_stripeSocks;
+    std::vector<sockaddr_in> m_stripeDests;
     std::atomic<bool>       m_running;
-    uint32_t                m_frameID;
-
-    // DXGI / D3D11
-    ID3D11Device*           m_d3dDevice;
-    ID3D11DeviceContext*    m_d3dContext;
-    IDXGIOutput1*           m_dxgiOutput1;
-    IDXGIOutputDuplication* m_duplication;
-    ID3D11Texture2D*        m_stagingTex;
+    uint32_t                m_frameID;        // encode stage: last ID handed to transmit
+
+    // Clock sync responder + loss feedback (discovery port)
+    std::thread             m_syncThread;
+    ReceiverFeedback        m_feedback;        // responder thread only
+    LossAdaptivePacer       m_pacer;           // responder thread only
+    uint64_t                m_lastPaceUs = 0;
+    std::atomic<uint64_t>   m_minFrameIntervalUs{0};   // responder → capture stage
+    std::atomic<uint64_t>   m_sendIntervalUs{0};       // transmit stage → responder (EWMA)
+    std::atomic<uint32_t>   m_worstLossBp{0};
+    uint64_t                m_lastSendUs = 0;          // transmit stage
+    uint64_t                m_lastSendCaptureUs = 0;   // transmit stage: capture m_lastSendUs belongs to
+    std::atomic<uint32_t>   m_scale{1};                // responder → encode stage (FrameScale factor)
+    std::atomic<uint32_t>   m_keyframeGen{0};          // responder → transmit stage: bumped per keyframe request
+
+    // Frame source (DXGI, synthetic or file – see CaptureSource.h)
+    std::unique_ptr<ICaptureSource> m_source;
     uint32_t                m_captureW = 0;
     uint32_t                m_captureH = 0;
+    CaptureScheduler        m_schedule;       // encode stage (NextCaptureUs: capture stage)
+    uint32_t                m_bandCount = 1;  // FrameBands, fixed while running
+
+    // Stage hand-off (see STAGE_DEPTH)
+    CaptureSlot             m_captureSlots[CAPTURE_SLOTS];
+    SendSlot                m_sendSlots[SEND_SLOTS];
+    SpscRing<uint32_t, STAGE_DEPTH> m_captured;      // capture → encode
+    SpscRing<uint32_t, FREE_RING>   m_captureFree;   // encode → capture
+    SpscRing<uint32_t, MAX_BANDS>   m_encoded;       // encode → transmit, m_bandCount deep
+    SpscRing<uint32_t, FREE_RING>   m_sendFree;      // transmit → encode
+    StageSignal             m_capturedSignal; // new capture, or more of its rows
+    StageSignal             m_encodedSignal;
+    std::thread             m_encodeThread;
+    std::thread             m_sendThread;
 
-    // Frame buffers
-    std::vector<uint8_t>    m_fullFrameBuf;   // full desktop BGRA
-    std::vector<uint8_t>    m_croppedBuf;     // cropped region
+    // Encode stage
+    BandState               m_bands[MAX_BANDS];
+    uint32_t                m_sendHeld = NO_SLOT;   // send slot being filled
+
+    // Transmit stage
     std::vector<uint8_t>    m_packetBuf;      // single packet scratch
-    BoundingBox             m_lastBB{};
+
+    // What receivers hold of each band (DeltaCodec): the frame sent
+    // last, in wire format. Kept here rather than in the encode
+    // stage, so a frame superseded before it went out never becomes
+    // a reference.
+    struct DeltaRef
+    {
+        std::vector<uint8_t> bytes;
+        BoundingBox          bb{};
+        uint32_t             scale    = 1;
+        uint32_t             format   = 0;
+        uint32_t             colour   = 0;
+        uint32_t             frameID  = 0;   // 0 = none – the next frame is a keyframe
+        uint32_t             sinceKey = 0;   // delta frames since the last keyframe
+        uint32_t             keyGen   = 0;   // m_keyframeGen it has answered
+    };
+    DeltaRef                m_deltaRefs[MAX_BANDS];
+    std::vector<uint8_t>    m_codeBuf;        // coded frame
+
+    // TileCache: the receivers' tile cache of each band as this end
+    // keeps it. Every band's tiled frames form a chain of their own,
+    // so bands that finish out of order at the receiver don't break
+    // it; the bands share tileCacheEntries.
+    struct TileChain
+    {
+        std::unique_ptr<TileCacheEncoder> cache;
+        uint32_t             gen    = 0;   // m_keyframeGen the cache was last emptied for
+        uint32_t             lastID = 0;   // 0 = emptied; the next tiled frame starts a chain
+    };
+    TileChain               m_tiles[MAX_BANDS];
 };
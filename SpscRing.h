@@ -0,0 +1,113 @@
+#pragma once
+// ============================================================
+//  SpscRing.h  –  Bounded single-producer / single-consumer ring
+//  of small values (slot indices), plus the wake-up the consumer
+//  sleeps on while it is empty.
+//
+//  PushEvict never blocks: on a full ring the producer takes the
+//  oldest entry back itself, so a consumer that falls behind
+//  always finds the newest items and the producer gets a buffer
+//  to reuse. Producer and consumer only ever race for the head,
+//  which both advance by compare-exchange.
+//  Portable – no Windows headers.
+// ============================================================
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <type_traits>
+
+template <typename T, uint32_t N>
+class SpscRing
+{
+    static_assert(N != 0 && (N & (N - 1)) == 0, "SpscRing capacity must be a power of two");
+    static_assert(std::is_trivially_copyable<T>::value, "SpscRing holds plain values");
+
+public:
+    // Entries held before the ring counts as full (1..N); set it
+    // before either side runs
+    void SetDepth(uint32_t depth) { m_depth = depth < 1 ? 1 : depth > N ? N : depth; }
+
+    // ─── Producer ───────────────────────────────────────────
+    bool TryPush(T v)
+    {
+        const uint32_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_head.load(std::memory_order_acquire) >= m_depth)
+            return false;
+        m_items[tail & (N - 1)].store(v, std::memory_order_relaxed);
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Always pushes; true if the oldest entry was dropped to make
+    // room (it is returned in `evicted`, owned by the caller again)
+    bool PushEvict(T v, T& evicted)
+    {
+        const uint32_t tail    = m_tail.load(std::memory_order_relaxed);
+        uint32_t       head    = m_head.load(std::memory_order_acquire);
+        bool           dropped = false;
+        if (tail - head >= m_depth)
+        {
+            // Only this thread writes items, so the read is stable;
+            // if the consumer wins the head there is room anyway
+            evicted = m_items[head & (N - 1)].load(std::memory_order_relaxed);
+            dropped = m_head.compare_exchange_strong(head, head + 1, std::memory_order_acq_rel);
+        }
+        m_items[tail & (N - 1)].store(v, std::memory_order_relaxed);
+        m_tail.store(tail + 1, std::memory_order_release);
+        return dropped;
+    }
+
+    // ─── Consumer ───────────────────────────────────────────
+    bool TryPop(T& out)
+    {
+        uint32_t head = m_head.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            if (head == m_tail.load(std::memory_order_acquire))
+                return false;
+            // May read an item the producer just wrote over an
+            // evicted one – the exchange fails and we retry
+            out = m_items[head & (N - 1)].load(std::memory_order_relaxed);
+            if (m_head.compare_exchange_weak(head, head + 1, std::memory_order_acq_rel,
+                                             std::memory_order_relaxed))
+                return true;
+        }
+    }
+
+private:
+    std::atomic<T>                    m_items[N] = {};
+    uint32_t                          m_depth    = N;
+    alignas(64) std::atomic<uint32_t> m_head{0};   // consumer (and an evicting producer)
+    alignas(64) std::atomic<uint32_t> m_tail{0};   // producer only
+};
+
+// ─── Consumer wake-up ────────────────────────────────────────
+// Set after a push; Wait returns at once if a push happened since
+// the last Wait, so a push between a failed TryPop and the Wait
+// is not slept through.
+class StageSignal
+{
+public:
+    void Notify()
+    {
+        {
+            std::lock_guard<std::mutex> l(m_mutex);
+            m_set = true;
+        }
+        m_cv.notify_one();
+    }
+
+    void Wait(uint32_t timeoutMs)
+    {
+        std::unique_lock<std::mutex> l(m_mutex);
+        m_cv.wait_for(l, std::chrono::milliseconds(timeoutMs), [this]{ return m_set; });
+        m_set = false;
+    }
+
+private:
+    std::mutex              m_mutex;
+    std::condition_variable m_cv;
+    bool                    m_set = false;
+};
@@ -0,0 +1,158 @@
+// ============================================================
+//  StreamTable.cpp  –  Per-source reassembly
+//  Zero-Latency Network Video Fuser
+// ============================================================
+
+#include "StreamTable.h"
+#include "FrameDelta.h"
+#include "FrameScale.h"
+#include "WirePixels.h"
+#include <cstdio>
+
+// ─────────────────────────────────────────────────────────────
+//  SourceStream
+// ─────────────────────────────────────────────────────────────
+SourceStream::SourceStream(uint32_t addr, uint16_t streamID, uint32_t index,
+                           uint32_t minTimeoutUs, uint32_t maxTimeoutUs, uint32_t lanes)
+    : m_addr(addr)
+    , m_streamID(streamID)
+    , m_index(index)
+    , m_reasm(minTimeoutUs, maxTimeoutUs, lanes)
+    , m_lanes(new Lane[std::max<uint32_t>(lanes, 1)])
+    , m_laneCount(std::max<uint32_t>(lanes, 1))
+{}
+
+StreamStats SourceStream::Stats() const
+{
+    StreamStats s;
+    for (uint32_t i = 0; i < m_laneCount; ++i)
+    {
+        s.packets         += m_lanes[i].packets.load(std::memory_order_relaxed);
+        s.bytes           += m_lanes[i].bytes.load(std::memory_order_relaxed);
+        s.framesCompleted += m_lanes[i].framesCompleted.load(std::memory_order_relaxed);
+        s.lastFrameID      = std::max(s.lastFrameID, m_lanes[i].lastFrameID.load(std::memory_order_relaxed));
+    }
+    s.framesPresented = m_framesPresented.load(std::memory_order_relaxed);
+    return s;
+}
+
+bool SourceStream::DecodeFrame(FrameSlot& s)
+{
+    if (s.codec == FrameDelta::PLAIN)
+        return true;
+
+    const size_t n = static_cast<size_t>(FrameScale::ScaledSize(s.width, s.scale)) *
+                     FrameScale::ScaledSize(s.height, s.scale) * WirePixels::BytesPerPixel(s.format);
+    const uint32_t id = s.frameID.load(std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(m_refMtx);
+    Reference& r = m_refs[s.band];
+    if (s.codec == FrameDelta::KEY)
+    {
+        r.bytes.assign(s.pixelData.begin(), s.pixelData.begin() + n);
+    }
+    else if (s.codec == FrameDelta::TILES)
+    {
+        if (s.refFrameID == 0)
+        {
+            r.tiles.Reset();
+            r.tilesInStep = true;
+            r.lastTiledID = 0;   // the chain the sender restarted, not the one we lost
+        }
+        r.frameID = 0;   // overwritten below, or no longer a reference
+        r.bytes.resize(n);
+        if (!r.tilesInStep || s.refFrameID != r.lastTiledID ||
+            !r.tiles.Decode(s.pixelData.data(), s.totalBytes, FrameScale::ScaledSize(s.width, s.scale),
+                            FrameScale::ScaledSize(s.height, s.scale), WirePixels::BytesPerPixel(s.format),
+                            r.bytes.data()))
+        {
+            r.tilesInStep = false;
+            m_keyframeWanted.store(true, std::memory_order_relaxed);
+            return false;
+        }
+        r.lastTiledID = id;
+        s.pixelData.resize(std::max(s.pixelData.size(), n));
+        std::memcpy(s.pixelData.data(), r.bytes.data(), n);
+        s.totalBytes = static_cast<uint32_t>(n);
+    }
+    else
+    {
+        if (r.frameID == 0 || r.frameID != s.refFrameID || r.bytes.size() != n ||
+            r.w != s.width || r.h != s.height || r.scale != s.scale || r.format != s.format ||
+            !FrameDelta::Apply(s.pixelData.data(), s.totalBytes, r.bytes.data(), n))
+        {
+            // A failed Apply leaves the reference half updated
+            if (r.frameID == s.refFrameID) r.frameID = 0;
+            m_keyframeWanted.store(true, std::memory_order_relaxed);
+            return false;
+        }
+        s.pixelData.resize(std::max(s.pixelData.size(), n));
+        std::memcpy(s.pixelData.data(), r.bytes.data(), n);
+        s.totalBytes = static_cast<uint32_t>(n);
+    }
+    r.frameID = id;
+    r.w       = s.width;
+    r.h       = s.height;
+    r.scale   = s.scale;
+    r.format  = s.format;
+    return true;
+}
+
+bool SourceStream::TakeKeyframeRequest(uint64_t nowUs, uint64_t retryUs)
+{
+    if (nowUs - m_lastKeyRequestUs < retryUs || !m_keyframeWanted.exchange(false, std::memory_order_relaxed))
+        return false;
+    m_lastKeyRequestUs = nowUs;
+    return true;
+}
+
+void SourceStream::Describe(char* out, size_t cap) const
+{
+    const uint8_t* a = reinterpret_cast<const uint8_t*>(&m_addr);
+    snprintf(out, cap, "%u.%u.%u.%u#%u", a[0], a[1], a[2], a[3], m_streamID);
+}
+
+// ─────────────────────────────────────────────────────────────
+//  StreamTable
+// ─────────────────────────────────────────────────────────────
+StreamTable::StreamTable(uint32_t minTimeoutUs, uint32_t maxTimeoutUs, uint32_t lanes)
+    : m_minTimeoutUs(minTimeoutUs)
+    , m_maxTimeoutUs(maxTimeoutUs)
+    , m_lanes(std::max<uint32_t>(lanes, 1))
+{}
+
+SourceStream* StreamTable::Find(uint32_t addr, uint16_t streamID, bool& isNew)
+{
+    isNew = false;
+    auto scan = [&](uint32_t from, uint32_t to) -> SourceStream*
+    {
+        for (uint32_t i = from; i < to; ++i)
+            if (m_streams[i]->Addr() == addr && m_streams[i]->StreamID() == streamID)
+                return m_streams[i].get();
+        return nullptr;
+    };
+
+    const uint32_t seen = Count();
+    if (SourceStream* s = scan(0, seen))
+        return s;
+
+    // New source: re-check what other lanes added meanwhile, then append
+    std::lock_guard<std::mutex> lock(m_addMtx);
+    const uint32_t n = m_count.load(std::memory_order_relaxed);
+    if (SourceStream* s = scan(seen, n))
+        return s;
+    if (n == MAX_STREAMS)
+        return nullptr;
+
+    m_streams[n] = std::make_unique<SourceStream>(addr, streamID, n, m_minTimeoutUs, m_maxTimeoutUs, m_lanes);
+    m_count.store(n + 1, std::memory_order_release);
+    isNew = true;
+    return m_streams[n].get();
+}
+
+void StreamTable::PurgeExpired(uint64_t nowUs)
+{
+    const uint32_t n = Count();
+    for (uint32_t i = 0; i < n; ++i)
+        m_streams[i]->Reasm().PurgeExpired(nowUs);
+}
@@ -0,0 +1,141 @@
+#pragma once
+// ============================================================
+//  StreamTable.h  –  Per-source reassembly for a receiver that
+//  composites several senders
+//  A stream is one (sender IPv4, header StreamID) pair. Each has
+//  its own MemoryReassembly, so frame IDs of different senders
+//  never collide, and its own packet / frame counters.
+//
+//  Streams are only ever appended (up to MAX_STREAMS) and are
+//  published with a release store of the count, so the per-packet
+//  lookup is a lock-free scan of a handful of entries.
+//
+//  A stream also holds the reference frame of each band for
+//  delta-coded frames (FrameDelta.h); frames of one stream can
+//  complete on any lane, so decoding takes a per-stream lock.
+// ============================================================
+#include "NetworkFuser.h"
+#include "MemoryReassembly.h"
+#include "TileCache.h"
+
+// ─── Per-stream totals (a snapshot) ──────────────────────────
+struct StreamStats
+{
+    uint64_t packets         = 0;
+    uint64_t bytes           = 0;
+    uint64_t framesCompleted = 0;
+    uint64_t framesPresented = 0;
+    uint32_t lastFrameID     = 0;   // newest completed frame (highest over lanes)
+};
+
+// ─── One sender's stream ─────────────────────────────────────
+class SourceStream
+{
+public:
+    SourceStream(uint32_t addr, uint16_t streamID, uint32_t index,
+                 uint32_t minTimeoutUs, uint32_t maxTimeoutUs, uint32_t lanes);
+
+    uint32_t          Addr()     const { return m_addr; }       // IPv4, network byte order
+    uint16_t          StreamID() const { return m_streamID; }
+    uint32_t          Index()    const { return m_index; }      // registration order, 0-based
+    MemoryReassembly& Reasm()          { return m_reasm; }
+
+    // Receive side: called from `lane`'s thread only
+    void OnPacket(uint32_t lane, uint32_t bytes)
+    {
+        Lane& l = m_lanes[lane];
+        l.packets.store(l.packets.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        l.bytes.store(l.bytes.load(std::memory_order_relaxed) + bytes, std::memory_order_relaxed);
+    }
+    void OnFrameCompleted(uint32_t lane, uint32_t frameID)
+    {
+        Lane& l = m_lanes[lane];
+        l.framesCompleted.store(l.framesCompleted.load(std::memory_order_relaxed) + 1,
+                                std::memory_order_relaxed);
+        l.lastFrameID.store(frameID, std::memory_order_relaxed);
+    }
+
+    // Any lane, once `s` is complete: turns a delta or tiled frame
+    // back into pixels and keeps the result as the band's reference.
+    // False if it refers to a frame this stream doesn't hold (lost,
+    // late or malformed) – drop it; a keyframe is then wanted.
+    bool DecodeFrame(FrameSlot& s);
+
+    // Feedback thread: true once per run of undecodable frames, at
+    // most every `retryUs`
+    bool TakeKeyframeRequest(uint64_t nowUs, uint64_t retryUs);
+
+    // Render side: called from the render thread only
+    void OnFramePresented()
+    {
+        m_framesPresented.store(m_framesPresented.load(std::memory_order_relaxed) + 1,
+                                std::memory_order_relaxed);
+    }
+
+    StreamStats Stats() const;
+
+    // "a.b.c.d#id"
+    void Describe(char* out, size_t cap) const;
+
+private:
+    // Counters of one receive thread; own cache line per lane
+    struct alignas(64) Lane
+    {
+        std::atomic<uint64_t> packets{0};
+        std::atomic<uint64_t> bytes{0};
+        std::atomic<uint64_t> framesCompleted{0};
+        std::atomic<uint32_t> lastFrameID{0};
+    };
+
+    uint32_t                m_addr;
+    uint16_t                m_streamID;
+    uint32_t                m_index;
+    MemoryReassembly        m_reasm;
+    std::unique_ptr<Lane[]> m_lanes;
+    uint32_t                m_laneCount;
+    std::atomic<uint64_t>   m_framesPresented{0};
+
+    // Last key / delta frame of each band, in its wire format, and
+    // the sender's tile cache of the band as of tiled frame
+    // lastTiledID – out of step once one is missed, until a frame
+    // that starts a new chain
+    struct Reference
+    {
+        std::vector<uint8_t> bytes;
+        uint32_t             frameID = 0;   // 0 = none held
+        uint32_t             w = 0, h = 0, scale = 1, format = 0;
+        TileCacheDecoder     tiles;
+        uint32_t             lastTiledID = 0;
+        bool                 tilesInStep = false;
+    };
+    std::mutex              m_refMtx;
+    Reference               m_refs[MAX_BANDS];
+    std::atomic<bool>       m_keyframeWanted{false};
+    uint64_t                m_lastKeyRequestUs = 0;   // feedback thread
+};
+
+// ─── All streams seen so far ─────────────────────────────────
+class StreamTable
+{
+public:
+    StreamTable(uint32_t minTimeoutUs, uint32_t maxTimeoutUs, uint32_t lanes = 1);
+
+    // The stream for (addr, streamID), registering it on first sight;
+    // `isNew` is set for the one call that registered it. nullptr
+    // once MAX_STREAMS streams exist.
+    SourceStream* Find(uint32_t addr, uint16_t streamID, bool& isNew);
+
+    uint32_t      Count() const { return m_count.load(std::memory_order_acquire); }
+    SourceStream& At(uint32_t i) const { return *m_streams[i]; }
+
+    // Evict stale incomplete frames of every stream (see MemoryReassembly)
+    void PurgeExpired(uint64_t nowUs);
+
+private:
+    std::unique_ptr<SourceStream> m_streams[MAX_STREAMS];
+    std::atomic<uint32_t>         m_count{0};
+    std::mutex                    m_addMtx;
+    uint32_t                      m_minTimeoutUs;
+    uint32_t                      m_maxTimeoutUs;
+    uint32_t                      m_lanes;
+};
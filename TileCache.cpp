@@ -0,0 +1,226 @@
+// ============================================================
+//  TileCache.cpp  –  Content-addressed tile cache
+//  Zero-Latency Network Video Fuser
+// ============================================================
+
+#include "TileCache.h"
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    inline uint64_t Load64(const uint8_t* p) { uint64_t v; std::memcpy(&v, p, 8); return v; }
+
+    inline uint64_t Mix(uint64_t h, uint64_t v)
+    {
+        h = (h ^ v) * 0x9E3779B97F4A7C15ull;
+        return h ^ (h >> 29);
+    }
+
+    // Tile of `th` rows of `rowBytes` at `stride`; the shape is part
+    // of the key, so equal bytes of a different shape don't collide
+    uint64_t HashTile(const uint8_t* src, size_t stride, uint32_t rowBytes, uint32_t th, uint32_t bpp)
+    {
+        uint64_t h = Mix(0xCBF29CE484222325ull, (static_cast<uint64_t>(rowBytes) << 32) | (th << 8) | bpp);
+        for (uint32_t y = 0; y < th; ++y, src += stride)
+        {
+            uint32_t i = 0;
+            for (; i + 8 <= rowBytes; i += 8)
+                h = Mix(h, Load64(src + i));
+            uint64_t tail = 0;
+            for (; i < rowBytes; ++i)
+                tail = (tail << 8) | src[i];
+            h = Mix(h, tail);
+        }
+        return h;
+    }
+
+    inline uint8_t* PutVarint(uint8_t* p, size_t v)
+    {
+        while (v >= 0x80)
+        {
+            *p++ = static_cast<uint8_t>(v | 0x80);
+            v >>= 7;
+        }
+        *p++ = static_cast<uint8_t>(v);
+        return p;
+    }
+
+    inline bool GetVarint(const uint8_t*& p, const uint8_t* end, size_t& v)
+    {
+        v = 0;
+        for (uint32_t shift = 0; p < end && shift < 64; shift += 7)
+        {
+            const uint8_t b = *p++;
+            v |= static_cast<size_t>(b & 0x7F) << shift;
+            if (!(b & 0x80))
+                return true;
+        }
+        return false;
+    }
+}
+
+// ─────────────────────────────────────────────────────────────
+//  TileCacheEncoder
+// ─────────────────────────────────────────────────────────────
+TileCacheEncoder::TileCacheEncoder(uint32_t capacity)
+    : m_entries(std::clamp<uint32_t>(capacity, 1, TILE_CACHE_MAX_ENTRIES))
+    , m_bytes(m_entries.size() * TILE_MAX_BYTES)
+{
+    m_index.reserve(m_entries.size());
+}
+
+void TileCacheEncoder::Reset()
+{
+    m_index.clear();
+    m_head = m_tail = NONE;
+    m_used = 0;
+}
+
+void TileCacheEncoder::Unlink(uint32_t slot)
+{
+    Entry& e = m_entries[slot];
+    (e.prev != NONE ? m_entries[e.prev].next : m_head) = e.next;
+    (e.next != NONE ? m_entries[e.next].prev : m_tail) = e.prev;
+    e.prev = e.next = NONE;
+}
+
+void TileCacheEncoder::PushFront(uint32_t slot)
+{
+    Entry& e = m_entries[slot];
+    e.prev = NONE;
+    e.next = m_head;
+    (m_head != NONE ? m_entries[m_head].prev : m_tail) = slot;
+    m_head = slot;
+}
+
+size_t TileCacheEncoder::Encode(const uint8_t* pixels, uint32_t w, uint32_t h, uint32_t bpp,
+                                uint8_t* dst, uint32_t& hits, uint32_t& misses)
+{
+    const size_t capacity = m_entries.size();
+    const size_t stride   = static_cast<size_t>(w) * bpp;
+    uint8_t*     p        = dst;
+
+    for (uint32_t ty = 0; ty < h; ty += TILE_SIZE)
+    {
+        const uint32_t th = std::min(TILE_SIZE, h - ty);
+        for (uint32_t tx = 0; tx < w; tx += TILE_SIZE)
+        {
+            const uint32_t tw       = std::min(TILE_SIZE, w - tx);
+            const uint32_t rowBytes = tw * bpp;
+            const uint8_t* src      = pixels + ty * stride + static_cast<size_t>(tx) * bpp;
+            const uint64_t hash     = HashTile(src, stride, rowBytes, th, bpp);
+
+            auto it = m_index.find(hash);
+            if (it != m_index.end())
+            {
+                const uint32_t slot   = it->second;
+                const Entry&   e      = m_entries[slot];
+                const uint8_t* cached = m_bytes.data() + static_cast<size_t>(slot) * TILE_MAX_BYTES;
+                bool same = e.w == tw && e.h == th && e.bpp == bpp;
+                for (uint32_t y = 0; same && y < th; ++y)
+                    same = std::memcmp(cached + y * rowBytes, src + y * stride, rowBytes) == 0;
+                if (same)
+                {
+                    Unlink(slot);
+                    PushFront(slot);
+                    p = PutVarint(p, static_cast<size_t>(slot) * 2);
+                    ++hits;
+                    continue;
+                }
+            }
+
+            // Miss: a free slot while there is one, else the least
+            // recently used – the receiver overwrites the same one
+            uint32_t slot;
+            if (m_used < capacity)
+            {
+                slot = m_used++;
+            }
+            else
+            {
+                slot = m_tail;
+                auto old = m_index.find(m_entries[slot].hash);
+                if (old != m_index.end() && old->second == slot)
+                    m_index.erase(old);
+                Unlink(slot);
+            }
+            Entry& e = m_entries[slot];
+            e.hash = hash;
+            e.w    = tw;
+            e.h    = th;
+            e.bpp  = bpp;
+            m_index[hash] = slot;
+            PushFront(slot);
+
+            uint8_t* cached = m_bytes.data() + static_cast<size_t>(slot) * TILE_MAX_BYTES;
+            p = PutVarint(p, static_cast<size_t>(slot) * 2 + 1);
+            for (uint32_t y = 0; y < th; ++y, p += rowBytes)
+            {
+                std::memcpy(cached + y * rowBytes, src + y * stride, rowBytes);
+                std::memcpy(p, src + y * stride, rowBytes);
+            }
+            ++misses;
+        }
+    }
+    return static_cast<size_t>(p - dst);
+}
+
+// ─────────────────────────────────────────────────────────────
+//  TileCacheDecoder
+// ─────────────────────────────────────────────────────────────
+void TileCacheDecoder::Reset()
+{
+    m_slots.clear();
+    m_bytes.clear();
+}
+
+bool TileCacheDecoder::Decode(const uint8_t* coded, size_t codedBytes, uint32_t w, uint32_t h, uint32_t bpp,
+                              uint8_t* out)
+{
+    const uint8_t* p      = coded;
+    const uint8_t* end    = coded + codedBytes;
+    const size_t   stride = static_cast<size_t>(w) * bpp;
+
+    for (uint32_t ty = 0; ty < h; ty += TILE_SIZE)
+    {
+        const uint32_t th = std::min(TILE_SIZE, h - ty);
+        for (uint32_t tx = 0; tx < w; tx += TILE_SIZE)
+        {
+            const uint32_t tw       = std::min(TILE_SIZE, w - tx);
+            const uint32_t rowBytes = tw * bpp;
+            uint8_t*       dst      = out + ty * stride + static_cast<size_t>(tx) * bpp;
+
+            size_t v;
+            if (!GetVarint(p, end, v) || v / 2 >= TILE_CACHE_MAX_ENTRIES)
+                return false;
+            const size_t slot = v / 2;
+
+            if (v & 1)
+            {
+                if (static_cast<size_t>(end - p) < static_cast<size_t>(rowBytes) * th)
+                    return false;
+                if (slot >= m_slots.size())
+                {
+                    m_slots.resize(slot + 1);
+                    m_bytes.resize((slot + 1) * TILE_MAX_BYTES);
+                }
+                m_slots[slot] = { tw, th, bpp };
+                std::memcpy(m_bytes.data() + slot * TILE_MAX_BYTES, p, static_cast<size_t>(rowBytes) * th);
+            }
+            else
+            {
+                const Slot s = slot < m_slots.size() ? m_slots[slot] : Slot{};
+                if (s.w != tw || s.h != th || s.bpp != bpp)
+                    return false;
+            }
+
+            const uint8_t* src = m_bytes.data() + slot * TILE_MAX_BYTES;
+            for (uint32_t y = 0; y < th; ++y)
+                std::memcpy(dst + y * stride, src + y * rowBytes, rowBytes);
+            if (v & 1)
+                p += static_cast<size_t>(rowBytes) * th;
+        }
+    }
+    return p == end;
+}
@@ -0,0 +1,106 @@
+#pragma once
+// ============================================================
+//  TileCache.h  –  Content-addressed tile cache shared by a
+//  sender and its receivers
+//  Overlay content repeats: the same corners, icons and glyphs
+//  come back frame after frame. With TileCache on, a band's
+//  packed wire pixels are cut into TILE_SIZE×TILE_SIZE tiles,
+//  row-major from the rectangle's top-left (the last column and
+//  row may be narrower). A tile the receiver already holds goes
+//  out as its cache slot; any other goes out whole, with the slot
+//  to keep it in (FrameDelta::TILES).
+//
+//  Only the sender hashes and evicts – least recently used of
+//  `capacity` slots, hash matches confirmed byte for byte – and
+//  the receiver stores and copies what it is told, so both caches
+//  stay the same as long as the receiver applies every tiled
+//  frame in order. Each band has a cache and chain of its own, so
+//  only one band's frames need to arrive in order: each names the
+//  band's tiled frame before it (refFrameID; 0 = cache cleared
+//  first). A receiver that missed one drops that band's tiled
+//  frames and asks for a keyframe; the sender then clears every
+//  band's cache and starts new chains.
+//
+//  Code, per tile in order: varint slot·2 + 1 and the tile's
+//  bytes (miss), or varint slot·2 (hit).
+//  Portable – no Windows headers.
+// ============================================================
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+static constexpr uint32_t TILE_SIZE              = 16;      // pixels per side
+static constexpr uint32_t TILE_MAX_BYTES         = TILE_SIZE * TILE_SIZE * 4;
+static constexpr uint32_t TILE_CACHE_MAX_ENTRIES = 16384;   // 16 MB of BGRA tiles
+
+namespace TileCode
+{
+    inline uint32_t Tiles(uint32_t w, uint32_t h)
+    {
+        return ((w + TILE_SIZE - 1) / TILE_SIZE) * ((h + TILE_SIZE - 1) / TILE_SIZE);
+    }
+
+    // Longest code for `w`×`h` pixels of `bpp` bytes: every tile a
+    // miss, slot varints of at most 3 bytes
+    inline uint64_t MaxCodedBytes(uint32_t w, uint32_t h, uint32_t bpp)
+    {
+        return static_cast<uint64_t>(w) * h * bpp + static_cast<uint64_t>(Tiles(w, h)) * 3;
+    }
+}
+
+// ─── Sender side: hashes, picks slots, writes the code ──────
+class TileCacheEncoder
+{
+public:
+    explicit TileCacheEncoder(uint32_t capacity);   // slots, clamped to 1..TILE_CACHE_MAX_ENTRIES
+
+    // Empty the cache; the next frame starts a new chain
+    void     Reset();
+
+    // `w`×`h` tight pixels of `bpp` bytes into `dst` (room for
+    // MaxCodedBytes); returns the code's size and adds the tiles
+    // that were / weren't cached to `hits` / `misses`
+    size_t   Encode(const uint8_t* pixels, uint32_t w, uint32_t h, uint32_t bpp,
+                    uint8_t* dst, uint32_t& hits, uint32_t& misses);
+
+    uint32_t Used() const { return m_used; }
+
+private:
+    static constexpr uint32_t NONE = ~0u;
+
+    struct Entry
+    {
+        uint64_t hash = 0;
+        uint32_t prev = NONE, next = NONE;   // LRU list, head = most recent
+        uint32_t w = 0, h = 0, bpp = 0;
+    };
+
+    void Unlink(uint32_t slot);
+    void PushFront(uint32_t slot);
+
+    std::vector<Entry>                     m_entries;
+    std::vector<uint8_t>                   m_bytes;   // TILE_MAX_BYTES per slot
+    std::unordered_map<uint64_t, uint32_t> m_index;   // hash → newest slot with it
+    uint32_t                               m_head = NONE;
+    uint32_t                               m_tail = NONE;
+    uint32_t                               m_used = 0;
+};
+
+// ─── Receiver side: stores and copies ────────────────────────
+class TileCacheDecoder
+{
+public:
+    void Reset();
+
+    // Code of a `w`×`h` rect of `bpp`-byte pixels into tight `out`.
+    // False if it is malformed or hits a slot that doesn't hold a
+    // tile of that shape – the cache no longer matches the sender's.
+    bool Decode(const uint8_t* coded, size_t codedBytes, uint32_t w, uint32_t h, uint32_t bpp,
+                uint8_t* out);
+
+private:
+    struct Slot { uint32_t w = 0, h = 0, bpp = 0; };
+    std::vector<Slot>    m_slots;   // grows to the highest slot the sender used
+    std::vector<uint8_t> m_bytes;
+};
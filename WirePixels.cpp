@@ -0,0 +1,323 @@
+// ============================================================
+//  WirePixels.cpp  –  BGRA ↔ BGR24 / RGB565 / ARGB4444 / A8
+//  Zero-Latency Network Video Fuser
+// ============================================================
+
+#include "WirePixels.h"
+#include "FrameScale.h"   // HasAVX2
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define WIREPIXELS_X64 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#define WIREPIXELS_AVX2
+#else
+#define WIREPIXELS_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace
+{
+    const char* const NAMES[WirePixels::FORMAT_COUNT] = { "bgra", "bgr24", "rgb565", "argb4444", "a8" };
+
+    // ─── One pixel, as 0xAARRGGBB (little-endian BGRA) ───────
+    // The AVX2 loops below do exactly these bit operations on
+    // eight or sixteen pixels at once.
+    inline uint32_t Load32(const uint8_t* p)           { uint32_t v; std::memcpy(&v, p, 4); return v; }
+    inline void     Store32(uint8_t* p, uint32_t v)    { std::memcpy(p, &v, 4); }
+    inline uint32_t Load16(const uint8_t* p)           { uint16_t v; std::memcpy(&v, p, 2); return v; }
+    inline void     Store16(uint8_t* p, uint32_t v)    { const uint16_t s = static_cast<uint16_t>(v); std::memcpy(p, &s, 2); }
+    inline uint32_t OpaqueUnlessBlack(uint32_t rgb)    { return rgb | (rgb ? 0xFF000000u : 0u); }
+
+    inline uint32_t To565(uint32_t px)
+    {
+        return ((px >> 3) & 0x001F) | ((px >> 5) & 0x07E0) | ((px >> 8) & 0xF800);
+    }
+    inline uint32_t From565(uint32_t v)
+    {
+        // Top bits repeated into the low ones, so 0x1F → 0xFF
+        const uint32_t rgb = ((v << 3) & 0x0000F8) | ((v >> 2) & 0x000007) |
+                             ((v << 5) & 0x00FC00) | ((v >> 1) & 0x000300) |
+                             ((v << 8) & 0xF80000) | ((v << 3) & 0x070000);
+        return v ? rgb | 0xFF000000u : 0;
+    }
+    inline uint32_t To4444(uint32_t px)
+    {
+        return ((px >> 4) & 0x000F) | ((px >> 8) & 0x00F0) | ((px >> 12) & 0x0F00) | ((px >> 16) & 0xF000);
+    }
+    inline uint32_t From4444(uint32_t v)
+    {
+        const uint32_t x = (v & 0x000F) | ((v & 0x00F0) << 4) | ((v & 0x0F00) << 8) | ((v & 0xF000) << 12);
+        return x | (x << 4);   // n·17
+    }
+
+#ifdef WIREPIXELS_X64
+    // ─── AVX2 bodies; each returns the pixels it did ─────────
+    WIREPIXELS_AVX2 size_t PackBGR24AVX2(const uint8_t* bgra, size_t n, uint8_t* dst)
+    {
+        // Per lane: 4 pixels → 12 bytes; then the two 12-byte runs together
+        const __m256i drop = _mm256_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1,
+                                              0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+        const __m256i join = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7);
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8)
+        {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bgra + i * 4));
+            v = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(v, drop), join);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 3), _mm256_castsi256_si128(v));
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + i * 3 + 16), _mm256_extracti128_si256(v, 1));
+        }
+        return i;
+    }
+
+    WIREPIXELS_AVX2 size_t UnpackBGR24AVX2(const uint8_t* src, size_t n, uint8_t* bgra)
+    {
+        const __m256i split  = _mm256_setr_epi32(0, 1, 2, 2, 3, 4, 5, 5);
+        const __m256i widen  = _mm256_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+                                                0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+        const __m256i opaque = _mm256_set1_epi32(static_cast<int>(0xFF000000u));
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8)
+        {
+            const uint8_t* s  = src + i * 3;   // exactly 24 bytes read
+            const __m256i  v  = _mm256_inserti128_si256(
+                _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s))),
+                _mm_loadl_epi64(reinterpret_cast<const __m128i*>(s + 16)), 1);
+            const __m256i rgb   = _mm256_shuffle_epi8(_mm256_permutevar8x32_epi32(v, split), widen);
+            const __m256i black = _mm256_cmpeq_epi32(rgb, _mm256_setzero_si256());
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(bgra + i * 4),
+                                _mm256_or_si256(rgb, _mm256_andnot_si256(black, opaque)));
+        }
+        return i;
+    }
+
+    // (v >> shift) & mask, (v << shift) & mask on every 32-bit lane
+    WIREPIXELS_AVX2 inline __m256i Shr(__m256i v, int shift, int mask)
+    {
+        return _mm256_and_si256(_mm256_srli_epi32(v, shift), _mm256_set1_epi32(mask));
+    }
+    WIREPIXELS_AVX2 inline __m256i Shl(__m256i v, int shift, int mask)
+    {
+        return _mm256_and_si256(_mm256_slli_epi32(v, shift), _mm256_set1_epi32(mask));
+    }
+
+    // To565 / To4444 on 8 pixels, one per 32-bit lane
+    WIREPIXELS_AVX2 inline __m256i To16(__m256i px, bool argb4444)
+    {
+        if (argb4444)
+            return _mm256_or_si256(_mm256_or_si256(Shr(px, 4, 0x000F), Shr(px, 8, 0x00F0)),
+                                   _mm256_or_si256(Shr(px, 12, 0x0F00), Shr(px, 16, 0xF000)));
+        return _mm256_or_si256(_mm256_or_si256(Shr(px, 3, 0x001F), Shr(px, 5, 0x07E0)), Shr(px, 8, 0xF800));
+    }
+
+    // From565 / From4444 on 8 zero-extended 16-bit values
+    WIREPIXELS_AVX2 inline __m256i From16(__m256i v, bool argb4444)
+    {
+        if (argb4444)
+        {
+            const __m256i x = _mm256_or_si256(_mm256_or_si256(Shl(v, 0, 0x0000000F), Shl(v, 4, 0x00000F00)),
+                                              _mm256_or_si256(Shl(v, 8, 0x000F0000), Shl(v, 12, 0x0F000000)));
+            return _mm256_or_si256(x, _mm256_slli_epi32(x, 4));
+        }
+        const __m256i rgb = _mm256_or_si256(
+            _mm256_or_si256(_mm256_or_si256(Shl(v, 3, 0x0000F8), Shr(v, 2, 0x000007)),
+                            _mm256_or_si256(Shl(v, 5, 0x00FC00), Shr(v, 1, 0x000300))),
+            _mm256_or_si256(Shl(v, 8, 0xF80000), Shl(v, 3, 0x070000)));
+        const __m256i black = _mm256_cmpeq_epi32(v, _mm256_setzero_si256());
+        return _mm256_or_si256(rgb, _mm256_andnot_si256(black, _mm256_set1_epi32(static_cast<int>(0xFF000000u))));
+    }
+
+    WIREPIXELS_AVX2 size_t Pack16AVX2(const uint8_t* bgra, size_t n, uint8_t* dst, bool argb4444)
+    {
+        size_t i = 0;
+        for (; i + 16 <= n; i += 16)
+        {
+            const __m256i a = To16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(bgra + i * 4)), argb4444);
+            const __m256i b = To16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(bgra + i * 4 + 32)), argb4444);
+            // packus works per lane: a0-3 b0-3 | a4-7 b4-7 → reorder the quarters
+            const __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi32(a, b), 0xD8);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 2), packed);
+        }
+        return i;
+    }
+
+    WIREPIXELS_AVX2 size_t Unpack16AVX2(const uint8_t* src, size_t n, uint8_t* bgra, bool argb4444)
+    {
+        size_t i = 0;
+        for (; i + 16 <= n; i += 16)
+        {
+            const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 2));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(bgra + i * 4),
+                                From16(_mm256_cvtepu16_epi32(_mm256_castsi256_si128(v)), argb4444));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(bgra + i * 4 + 32),
+                                From16(_mm256_cvtepu16_epi32(_mm256_extracti128_si256(v, 1)), argb4444));
+        }
+        return i;
+    }
+
+    // SIZE_MAX as soon as a pixel is neither zero nor `colour`
+    WIREPIXELS_AVX2 size_t PackMonoAVX2(const uint8_t* bgra, size_t n, uint8_t* dst, uint32_t colour)
+    {
+        const __m256i rgbMask = _mm256_set1_epi32(0x00FFFFFF);
+        const __m256i want    = _mm256_set1_epi32(static_cast<int>(colour));
+        const __m256i zero    = _mm256_setzero_si256();
+        const __m256i gather  = _mm256_setr_epi32(0, 4, 0, 4, 0, 4, 0, 4);
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8)
+        {
+            const __m256i px = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bgra + i * 4));
+            const __m256i ok = _mm256_or_si256(_mm256_cmpeq_epi32(px, zero),
+                                               _mm256_cmpeq_epi32(_mm256_and_si256(px, rgbMask), want));
+            if (_mm256_movemask_epi8(ok) != -1)
+                return SIZE_MAX;
+            __m256i a = _mm256_srli_epi32(px, 24);
+            a = _mm256_packus_epi16(_mm256_packus_epi32(a, a), zero);   // per lane: 4 alphas in dword 0
+            a = _mm256_permutevar8x32_epi32(a, gather);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + i), _mm256_castsi256_si128(a));
+        }
+        return i;
+    }
+
+    WIREPIXELS_AVX2 size_t UnpackA8AVX2(const uint8_t* src, size_t n, uint8_t* bgra, uint32_t colour)
+    {
+        const __m256i rgb = _mm256_set1_epi32(static_cast<int>(colour));
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8)
+        {
+            const __m256i a     = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + i)));
+            const __m256i clear = _mm256_cmpeq_epi32(a, _mm256_setzero_si256());
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(bgra + i * 4),
+                                _mm256_andnot_si256(clear, _mm256_or_si256(_mm256_slli_epi32(a, 24), rgb)));
+        }
+        return i;
+    }
+#endif
+}
+
+namespace WirePixels
+{
+    const char* Name(uint32_t f)
+    {
+        return ValidFormat(f) ? NAMES[f] : "?";
+    }
+
+    bool Parse(const char* name, Format& out)
+    {
+        for (uint32_t f = 0; f < FORMAT_COUNT; ++f)
+        {
+            const char* a = name;
+            const char* b = NAMES[f];
+            while (*a && std::tolower(static_cast<unsigned char>(*a)) == *b) { ++a; ++b; }
+            if (*a == 0 && *b == 0)
+            {
+                out = static_cast<Format>(f);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void Pack(Format format, const uint8_t* bgra, size_t n, uint8_t* dst)
+    {
+        const bool simd = FrameScale::HasAVX2();
+        size_t i = 0;
+        switch (format)
+        {
+        case BGR24:
+#ifdef WIREPIXELS_X64
+            if (simd) i = PackBGR24AVX2(bgra, n, dst);
+#endif
+            for (; i < n; ++i)
+                std::memcpy(dst + i * 3, bgra + i * 4, 3);
+            break;
+        case RGB565:
+#ifdef WIREPIXELS_X64
+            if (simd) i = Pack16AVX2(bgra, n, dst, false);
+#endif
+            for (; i < n; ++i)
+                Store16(dst + i * 2, To565(Load32(bgra + i * 4)));
+            break;
+        case ARGB4444:
+#ifdef WIREPIXELS_X64
+            if (simd) i = Pack16AVX2(bgra, n, dst, true);
+#endif
+            for (; i < n; ++i)
+                Store16(dst + i * 2, To4444(Load32(bgra + i * 4)));
+            break;
+        default:   // BGRA32 (A8 goes through PackMono)
+            std::memcpy(dst, bgra, n * 4);
+            break;
+        }
+        (void)simd;
+    }
+
+    bool PackMono(const uint8_t* bgra, size_t n, uint8_t* dst, uint32_t& colour)
+    {
+        // The first pixel that isn't all zero sets the colour
+        size_t i = 0;
+        for (; i < n && Load32(bgra + i * 4) == 0; ++i)
+            dst[i] = 0;
+        colour = i < n ? Load32(bgra + i * 4) & 0x00FFFFFFu : 0;
+
+#ifdef WIREPIXELS_X64
+        if (FrameScale::HasAVX2())
+        {
+            const size_t done = PackMonoAVX2(bgra + i * 4, n - i, dst + i, colour);
+            if (done == SIZE_MAX) return false;
+            i += done;
+        }
+#endif
+        for (; i < n; ++i)
+        {
+            const uint32_t px = Load32(bgra + i * 4);
+            if (px != 0 && (px & 0x00FFFFFFu) != colour)
+                return false;
+            dst[i] = static_cast<uint8_t>(px >> 24);
+        }
+        return true;
+    }
+
+    void Unpack(Format format, const uint8_t* src, size_t n, uint8_t* bgra, uint32_t colour)
+    {
+        const bool simd = FrameScale::HasAVX2();
+        size_t i = 0;
+        switch (format)
+        {
+        case BGR24:
+#ifdef WIREPIXELS_X64
+            if (simd) i = UnpackBGR24AVX2(src, n, bgra);
+#endif
+            for (; i < n; ++i)
+                Store32(bgra + i * 4, OpaqueUnlessBlack(src[i * 3] | (src[i * 3 + 1] << 8) | (src[i * 3 + 2] << 16)));
+            break;
+        case RGB565:
+#ifdef WIREPIXELS_X64
+            if (simd) i = Unpack16AVX2(src, n, bgra, false);
+#endif
+            for (; i < n; ++i)
+                Store32(bgra + i * 4, From565(Load16(src + i * 2)));
+            break;
+        case ARGB4444:
+#ifdef WIREPIXELS_X64
+            if (simd) i = Unpack16AVX2(src, n, bgra, true);
+#endif
+            for (; i < n; ++i)
+                Store32(bgra + i * 4, From4444(Load16(src + i * 2)));
+            break;
+        case A8:
+#ifdef WIREPIXELS_X64
+            if (simd) i = UnpackA8AVX2(src, n, bgra, colour);
+#endif
+            for (; i < n; ++i)
+                Store32(bgra + i * 4, src[i] ? colour | (static_cast<uint32_t>(src[i]) << 24) : 0);
+            break;
+        default:
+            std::memcpy(bgra, src, n * 4);
+            break;
+        }
+        (void)simd;
+    }
+}
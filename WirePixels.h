@@ -0,0 +1,58 @@
+#pragma once
+// ============================================================
+//  WirePixels.h  –  Reduced colour-depth wire formats
+//  The sender can pack the cropped BGRA rect into fewer bytes
+//  per pixel before packetising it (FrameMetaPayload::format);
+//  the receiver unpacks it back to BGRA before it is scaled up
+//  or reaches the surface. Every frame names its own format, so
+//  a receiver takes any mix of senders without a handshake.
+//
+//    BGRA32    4 B  as captured
+//    BGR24     3 B  alpha dropped
+//    RGB565    2 B  5/6/5 bits per channel, alpha dropped
+//    ARGB4444  2 B  4 bits per channel
+//    A8        1 B  alpha only – one colour for the whole frame
+//                   (FrameMetaPayload::colour); lossless for
+//                   single-colour overlays, see PackMono
+//
+//  Formats without alpha come back opaque where the colour isn't
+//  black and fully transparent where it is – the overlay window
+//  keys out black anyway.
+//  Portable – no Windows headers.
+// ============================================================
+#include <cstddef>
+#include <cstdint>
+
+namespace WirePixels
+{
+    enum Format : uint8_t
+    {
+        BGRA32   = 0,
+        BGR24    = 1,
+        RGB565   = 2,
+        ARGB4444 = 3,
+        A8       = 4,
+        FORMAT_COUNT
+    };
+
+    inline bool     ValidFormat(uint32_t f)      { return f < FORMAT_COUNT; }
+    inline uint32_t BytesPerPixel(uint32_t f)    { return f == BGRA32 ? 4 : f == BGR24 ? 3 : f == A8 ? 1 : 2; }
+
+    const char*     Name(uint32_t f);
+    // Case-insensitive Name() back to a format; false if unknown
+    bool            Parse(const char* name, Format& out);
+
+    // `n` tight BGRA pixels → `n` × BytesPerPixel(format) bytes.
+    // Not for A8 (use PackMono). AVX2 when the CPU has it.
+    void Pack(Format format, const uint8_t* bgra, size_t n, uint8_t* dst);
+
+    // A8 when every pixel is either all zero or one shared colour
+    // (at any alpha): writes the alphas and that colour (0x00RRGGBB)
+    // and returns true; only alpha-0 pixels don't survive exactly
+    // (they come back all zero). Stops at the first pixel that breaks the
+    // rule and returns false – dst is then garbage.
+    bool PackMono(const uint8_t* bgra, size_t n, uint8_t* dst, uint32_t& colour);
+
+    // Inverse of Pack / PackMono; `colour` is only read for A8
+    void Unpack(Format format, const uint8_t* src, size_t n, uint8_t* bgra, uint32_t colour = 0);
+}
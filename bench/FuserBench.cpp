@@ -0,0 +1,359 @@
+// ============================================================
+//  FuserBench.cpp  –  Microbenchmarks for the sender and
+//  receiver hot paths
+//  Zero-Latency Network Video Fuser
+//
+//  FuserBench [--filter substr] [--min-ms N] [--reps N]
+//
+//  Every case runs over frames from the synthetic capture source
+//  (boxes and text off, so the fill density alone sets the
+//  bounding box) at 720p / 1080p / 1440p / 2160p and 1 / 5 / 25 /
+//  100 % fill:
+//
+//    bbox            FrameOps::ComputeBoundingBox over the full frame
+//    crop            FrameOps::CropBGRA of that box
+//    downscale2/4    FrameScale::Downscale of that box out of the full
+//                    frame, 2:1 / 4:1 (AVX2 where available)
+//    pack_<fmt>      WirePixels::Pack of the cropped box to bgr24 /
+//                    rgb565 / argb4444
+//    delta_encode    FrameDelta::Encode of the next frame's pixels in
+//                    that box against this one's
+//    tile_encode     TileCacheEncoder::Encode of the box with every
+//                    tile cached (hash + compare, slots out)
+//    stride_copy     FrameOps::CopyRows from a padded (GPU-pitch) buffer
+//    packetize       FuserUtil::PacketizeFrame into a null socket
+//    reasm_inorder   MemoryReassembly::ConsumePacket, one frame per op
+//    reasm_reordered   … packets in a fixed random order
+//    reasm_lossy       … 2 % of packets dropped (frames time out / evict)
+//    render_copy     SoftwareCompositor::Compose of the cropped frame
+//                    (the CPU side of ReceiverModule::RenderFrame)
+//    render_scaled2    … of the same box sent at 2:1 (upscale + upload)
+//    unpack_<fmt>    WirePixels::Unpack of that box back to BGRA
+//    delta_apply     FrameDelta::Apply of the delta_encode code
+//    tile_decode     TileCacheDecoder::Decode of the tile_encode code
+//
+//  Output is CSV on stdout, one row per case, columns fixed:
+//    case,width,height,fill_pct,bytes_per_op,iterations,ns_per_op,gb_per_s
+//  ns_per_op is the median of --reps timed batches of at least
+//  --min-ms each; gb_per_s is bytes_per_op / ns_per_op.
+//
+//  Build: FuserBench.vcxproj (Release|x64).
+// ============================================================
+
+#include "../NetworkFuser.h"
+#include "../FrameOps.h"
+#include "../FrameScale.h"
+#include "../WirePixels.h"
+#include "../FrameDelta.h"
+#include "../TileCache.h"
+#include "../MemoryReassembly.h"
+#include "../Compositor.h"
+#include "../CaptureSource.h"
+#include <cstdio>
+#include <random>
+
+namespace
+{
+    struct Options
+    {
+        const char* filter = nullptr;
+        uint32_t    minMs  = 200;
+        uint32_t    reps   = 5;
+    };
+
+    struct Resolution { uint32_t w, h; };
+
+    constexpr Resolution RESOLUTIONS[] = { { 1280, 720 }, { 1920, 1080 }, { 2560, 1440 }, { 3840, 2160 } };
+    constexpr uint32_t   FILLS[]       = { 1, 5, 25, 100 };
+
+    volatile uint64_t g_sink = 0;   // keeps results observable
+
+    uint64_t NowNs()
+    {
+        return static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    // Time `op` in batches: calibrate the batch size to ~minMs, then
+    // take the median per-op time of `reps` batches.
+    template <typename Op>
+    void Run(const Options& opt, const char* name, const Resolution& res, uint32_t fill,
+             uint64_t bytesPerOp, Op&& op)
+    {
+        char label[96];
+        snprintf(label, sizeof(label), "%s/%ux%u/%u", name, res.w, res.h, fill);
+        if (opt.filter && !std::strstr(label, opt.filter))
+            return;
+
+        op();   // warm caches, fault in pages
+
+        const uint64_t targetNs = static_cast<uint64_t>(opt.minMs) * 1000000ull;
+        uint64_t batch = 1;
+        for (;;)
+        {
+            const uint64_t t0 = NowNs();
+            for (uint64_t i = 0; i < batch; ++i) op();
+            const uint64_t dt = NowNs() - t0;
+            if (dt >= targetNs / 4 || batch >= (1ull << 30))
+            {
+                batch = std::max<uint64_t>(1, batch * targetNs / std::max<uint64_t>(dt, 1));
+                break;
+            }
+            batch *= 4;
+        }
+
+        std::vector<double> perOp;
+        for (uint32_t r = 0; r < opt.reps; ++r)
+        {
+            const uint64_t t0 = NowNs();
+            for (uint64_t i = 0; i < batch; ++i) op();
+            perOp.push_back(static_cast<double>(NowNs() - t0) / static_cast<double>(batch));
+        }
+        std::sort(perOp.begin(), perOp.end());
+        const double ns = perOp[perOp.size() / 2];
+
+        printf("%s,%u,%u,%u,%llu,%llu,%.1f,%.3f\n", name, res.w, res.h, fill,
+               static_cast<unsigned long long>(bytesPerOp),
+               static_cast<unsigned long long>(batch * opt.reps),
+               ns, ns > 0 ? static_cast<double>(bytesPerOp) / ns : 0.0);
+        fflush(stdout);
+    }
+
+    // All packets of one frame, as the sender would put them on the wire
+    std::vector<std::vector<uint8_t>> BuildPackets(const uint8_t* cropped, const BoundingBox& bb)
+    {
+        FrameMetaPayload meta{};
+        meta.width    = bb.w;
+        meta.height   = bb.h;
+        meta.originX  = bb.x;
+        meta.originY  = bb.y;
+        meta.rawBytes = bb.w * bb.h * 4;
+
+        std::vector<std::vector<uint8_t>> packets;
+        std::vector<uint8_t> scratch(MAX_UDP_PAYLOAD);
+        FuserUtil::PacketizeFrame(1, FuserUtil::PacketsForFrame(meta.rawBytes), meta, cropped,
+                                  scratch.data(), MAX_UDP_PAYLOAD, 0,
+                                  [&](const uint8_t* p, int len) { packets.emplace_back(p, p + len); });
+        return packets;
+    }
+
+    // Feed `order` (indices into packets) as frame `frameID`
+    void FeedFrame(MemoryReassembly& reasm, std::vector<std::vector<uint8_t>>& packets,
+                   const std::vector<uint32_t>& order, uint32_t frameID)
+    {
+        for (uint32_t idx : order)
+        {
+            std::vector<uint8_t>& pkt = packets[idx];
+            std::memcpy(pkt.data(), &frameID, sizeof(frameID));   // FuserPacketHeader::FrameID
+            if (FrameSlot* done = reasm.ConsumePacket(pkt.data(), static_cast<int>(pkt.size()), 0, FuserUtil::NowUs()))
+            {
+                g_sink = g_sink + done->totalBytes;
+                reasm.ReleaseSlot(done);
+            }
+        }
+    }
+
+    void BenchFrame(const Options& opt, const Resolution& res, uint32_t fill)
+    {
+        SyntheticCaptureParams sp;
+        sp.width       = res.w;
+        sp.height      = res.h;
+        sp.fps         = 0;
+        sp.fillPercent = fill;
+        sp.boxes       = 0;
+        sp.text        = false;
+        SyntheticCaptureSource src(sp);
+        src.Init();
+
+        const size_t frameBytes = static_cast<size_t>(res.w) * res.h * 4;
+        std::vector<uint8_t> frame(frameBytes);
+        src.Render(frame.data(), 0);
+
+        const BoundingBox bb        = FrameOps::ComputeBoundingBox(frame.data(), res.w, res.h);
+        const uint32_t    cropBytes = bb.w * bb.h * 4;
+        std::vector<uint8_t> cropped(std::max<uint32_t>(cropBytes, 4));
+        FrameOps::CropBGRA(frame.data(), res.w, cropped.data(), bb);
+
+        // ── Sender ───────────────────────────────────────────
+        Run(opt, "bbox", res, fill, frameBytes, [&] {
+            const BoundingBox b = FrameOps::ComputeBoundingBox(frame.data(), res.w, res.h);
+            g_sink = g_sink + b.w;
+        });
+
+        Run(opt, "crop", res, fill, cropBytes, [&] {
+            FrameOps::CropBGRA(frame.data(), res.w, cropped.data(), bb);
+        });
+
+        const uint8_t* boxOrigin = frame.data() + (static_cast<size_t>(bb.y) * res.w + bb.x) * 4;
+        std::vector<uint8_t> scaled(std::max<size_t>(static_cast<size_t>(FrameScale::ScaledSize(bb.w, 2)) *
+                                                     FrameScale::ScaledSize(bb.h, 2) * 4, 4));
+        Run(opt, "downscale2", res, fill, cropBytes, [&] {
+            FrameScale::Downscale(boxOrigin, static_cast<size_t>(res.w) * 4, bb.w, bb.h, 2, scaled.data());
+        });
+        Run(opt, "downscale4", res, fill, cropBytes, [&] {
+            FrameScale::Downscale(boxOrigin, static_cast<size_t>(res.w) * 4, bb.w, bb.h, 4, scaled.data());
+        });
+        FrameScale::Downscale(boxOrigin, static_cast<size_t>(res.w) * 4, bb.w, bb.h, 2, scaled.data());
+
+        const WirePixels::Format WIRE_FORMATS[] = { WirePixels::BGR24, WirePixels::RGB565, WirePixels::ARGB4444 };
+        const size_t boxPixels = static_cast<size_t>(bb.w) * bb.h;
+        std::vector<uint8_t> packed(std::max<size_t>(boxPixels * 4, 4));
+        std::vector<uint8_t> unpacked(packed.size());
+        char name[32];
+        for (WirePixels::Format f : WIRE_FORMATS)
+        {
+            snprintf(name, sizeof(name), "pack_%s", WirePixels::Name(f));
+            Run(opt, name, res, fill, cropBytes, [&] {
+                WirePixels::Pack(f, cropped.data(), boxPixels, packed.data());
+            });
+        }
+
+        // The patch moves a few pixels a frame, so most of the box
+        // changes – close to the worst case for the delta coder
+        std::vector<uint8_t> next(frameBytes);
+        std::vector<uint8_t> nextCropped(cropped.size());
+        std::vector<uint8_t> coded(cropped.size() * 2 + 16);
+        src.Render(next.data(), 1);
+        FrameOps::CropBGRA(next.data(), res.w, nextCropped.data(), bb);
+        size_t codedBytes = 0;
+        Run(opt, "delta_encode", res, fill, cropBytes, [&] {
+            FrameDelta::Encode(nextCropped.data(), cropped.data(), cropBytes, coded.data(), coded.size(), codedBytes);
+        });
+
+        // First pass fills both caches; the timed ones only hit
+        TileCacheEncoder     tileEnc(TILE_CACHE_MAX_ENTRIES);
+        TileCacheDecoder     tileDec;
+        std::vector<uint8_t> tileCode(static_cast<size_t>(TileCode::MaxCodedBytes(bb.w, bb.h, 4)) + 1);
+        std::vector<uint8_t> tileOut(std::max<size_t>(cropBytes, 1));
+        uint32_t tileHits = 0, tileMisses = 0;
+        size_t   tileBytes = tileEnc.Encode(cropped.data(), bb.w, bb.h, 4, tileCode.data(), tileHits, tileMisses);
+        tileDec.Decode(tileCode.data(), tileBytes, bb.w, bb.h, 4, tileOut.data());
+        Run(opt, "tile_encode", res, fill, cropBytes, [&] {
+            tileBytes = tileEnc.Encode(cropped.data(), bb.w, bb.h, 4, tileCode.data(), tileHits, tileMisses);
+        });
+
+        if (fill == FILLS[0])   // independent of content
+        {
+            const size_t rowBytes = static_cast<size_t>(res.w) * 4;
+            size_t pitch = (rowBytes + 255) & ~static_cast<size_t>(255);
+            if (pitch == rowBytes) pitch += 256;
+            std::vector<uint8_t> staging(pitch * res.h, 0x40);
+            Run(opt, "stride_copy", res, 0, frameBytes, [&] {
+                FrameOps::CopyRows(frame.data(), rowBytes, staging.data(), pitch, rowBytes, res.h);
+            });
+            src.Render(frame.data(), 0);   // restore the frame content
+        }
+
+        if (cropBytes == 0 || FuserUtil::PacketsForFrame(cropBytes) > 0xFFFF)
+            return;
+
+        FrameMetaPayload meta{};
+        meta.width    = bb.w;
+        meta.height   = bb.h;
+        meta.originX  = bb.x;
+        meta.originY  = bb.y;
+        meta.rawBytes = cropBytes;
+        const uint32_t totalPackets = FuserUtil::PacketsForFrame(cropBytes);
+        std::vector<uint8_t> packetBuf(MAX_UDP_PAYLOAD);
+        uint32_t frameID = 0;
+        Run(opt, "packetize", res, fill, cropBytes, [&] {
+            uint64_t wire = 0;
+            FuserUtil::PacketizeFrame(++frameID, totalPackets, meta, cropped.data(), packetBuf.data(),
+                                      MAX_UDP_PAYLOAD, 0, [&](const uint8_t*, int len) { wire += static_cast<uint64_t>(len); });
+            g_sink = g_sink + wire;
+        });
+
+        // ── Receiver ─────────────────────────────────────────
+        std::vector<std::vector<uint8_t>> packets = BuildPackets(cropped.data(), bb);
+
+        std::vector<uint32_t> inOrder(packets.size());
+        for (uint32_t i = 0; i < inOrder.size(); ++i) inOrder[i] = i;
+
+        std::vector<uint32_t> shuffled = inOrder;
+        std::mt19937 rng(1234);
+        std::shuffle(shuffled.begin(), shuffled.end(), rng);
+
+        // 16 loss patterns, cycled, so not every frame loses the same packets
+        std::vector<std::vector<uint32_t>> lossy(16);
+        std::uniform_int_distribution<int> pct(0, 99);
+        for (auto& order : lossy)
+            for (uint32_t i : inOrder)
+                if (pct(rng) >= 2) order.push_back(i);
+
+        {
+            MemoryReassembly reasm;
+            uint32_t id = 0;
+            Run(opt, "reasm_inorder", res, fill, cropBytes, [&] { FeedFrame(reasm, packets, inOrder, ++id); });
+        }
+        {
+            MemoryReassembly reasm;
+            uint32_t id = 0;
+            Run(opt, "reasm_reordered", res, fill, cropBytes, [&] { FeedFrame(reasm, packets, shuffled, ++id); });
+        }
+        {
+            MemoryReassembly reasm;
+            uint32_t id = 0;
+            Run(opt, "reasm_lossy", res, fill, cropBytes, [&] {
+                ++id;
+                FeedFrame(reasm, packets, lossy[id % lossy.size()], id);
+            });
+        }
+
+        SoftwareCompositor comp;
+        comp.Init(res.w, res.h);
+        const CompositeLayer layer{ cropped.data(), bb.w * 4, { bb.x, bb.y, bb.w, bb.h } };
+        Run(opt, "render_copy", res, fill, cropBytes, [&] {
+            comp.Compose(&layer, 1);
+            comp.Present();
+        });
+
+        const CompositeLayer half{ scaled.data(), FrameScale::ScaledSize(bb.w, 2) * 4, { bb.x, bb.y, bb.w, bb.h },
+                                   true, 2 };
+        Run(opt, "render_scaled2", res, fill, cropBytes, [&] {
+            comp.Compose(&half, 1);
+            comp.Present();
+        });
+
+        for (WirePixels::Format f : WIRE_FORMATS)
+        {
+            WirePixels::Pack(f, cropped.data(), boxPixels, packed.data());
+            snprintf(name, sizeof(name), "unpack_%s", WirePixels::Name(f));
+            Run(opt, name, res, fill, cropBytes, [&] {
+                WirePixels::Unpack(f, packed.data(), boxPixels, unpacked.data());
+            });
+        }
+
+        std::vector<uint8_t> reference(cropped.begin(), cropped.begin() + cropBytes);
+        Run(opt, "delta_apply", res, fill, cropBytes, [&] {
+            FrameDelta::Apply(coded.data(), codedBytes, reference.data(), cropBytes);   // toggles frame 0 ↔ 1
+        });
+
+        Run(opt, "tile_decode", res, fill, cropBytes, [&] {
+            tileDec.Decode(tileCode.data(), tileBytes, bb.w, bb.h, 4, tileOut.data());
+        });
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options opt;
+    for (int i = 1; i < argc; ++i)
+    {
+        if      (!std::strcmp(argv[i], "--filter") && i + 1 < argc) opt.filter = argv[++i];
+        else if (!std::strcmp(argv[i], "--min-ms") && i + 1 < argc) opt.minMs  = static_cast<uint32_t>(std::atoi(argv[++i]));
+        else if (!std::strcmp(argv[i], "--reps")   && i + 1 < argc) opt.reps   = static_cast<uint32_t>(std::atoi(argv[++i]));
+        else
+        {
+            fprintf(stderr, "usage: FuserBench [--filter substr] [--min-ms N] [--reps N]\n");
+            return 2;
+        }
+    }
+    opt.reps = std::max<uint32_t>(opt.reps, 1);
+
+    printf("case,width,height,fill_pct,bytes_per_op,iterations,ns_per_op,gb_per_s\n");
+    for (const Resolution& res : RESOLUTIONS)
+        for (uint32_t fill : FILLS)
+            BenchFrame(opt, res, fill);
+    return 0;
+}
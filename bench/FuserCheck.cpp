@@ -0,0 +1,388 @@
+// ============================================================
+//  FuserCheck.cpp  –  Correctness checks for the receiver paths
+//  the benches and the loopback sweep can't pin down
+//  Zero-Latency Network Video Fuser
+//
+//  FuserCheck [--filter substr] [--rounds N] [--seed N]
+//
+//    reasm_lanes     MemoryReassembly shared by 1 / 2 / 3 / 4 lanes,
+//                    one thread each. Every round puts REASM_WINDOW
+//                    frames of random size and random bytes in
+//                    flight: their packets are shuffled together,
+//                    dealt round-robin to the lanes, and about
+//                    REASM_DUP_PCT % of them also go to another lane.
+//                    Each completed frame must be bit-exact with the
+//                    one packetized, and every frame must complete.
+//                    A duplicate that lands after its frame was
+//                    handed back re-opens it (reassembly keeps no
+//                    record of finished frames); such leftovers are
+//                    aged out between rounds, and if one completes
+//                    again it must be exact too.
+//    tile_chain      SourceStream::DecodeFrame of a tiled stream
+//                    (FrameDelta::TILES) in 1 and TILE_BANDS bands that
+//                    loses TILE_LOSS_PCT % of its frames; a capture's
+//                    bands reach the receiver in random order. The
+//                    sender side keeps a chain per band and restarts
+//                    them all (refFrameID 0) after each keyframe
+//                    request, as SenderModule does. Every frame whose
+//                    band's chain is intact back to its start must
+//                    decode bit-exact; every other one must be
+//                    refused.
+//
+//  Output is CSV on stdout, one row per case:
+//    case,variant,frames,completions,failures,result
+//  The first few failures are described on stderr. The exit code
+//  is 1 if any case failed.
+//
+//  Build: FuserCheck.vcxproj (Release|x64).
+// ============================================================
+
+#include "../NetworkFuser.h"
+#include "../MemoryReassembly.h"
+#include "../StreamTable.h"
+#include "../TileCache.h"
+#include "../FrameDelta.h"
+#include "../WirePixels.h"
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <random>
+
+namespace
+{
+    struct Options
+    {
+        const char* filter = nullptr;
+        uint32_t    rounds = 2000;
+        uint32_t    seed   = 1;
+    };
+
+    struct Result
+    {
+        uint32_t frames      = 0;
+        uint32_t completions = 0;
+        uint32_t failures    = 0;
+    };
+
+    constexpr uint32_t REASM_WINDOW   = REASSEMBLY_SLOTS / 2;   // leaves room for re-opened leftovers
+    constexpr uint32_t REASM_DUP_PCT  = 5;
+    constexpr uint32_t REASM_PACKET   = 1200;                   // more packets per frame than MTU-sized
+    constexpr uint32_t REASM_ROUND_US = 10000;                  // logical clock step between rounds
+    constexpr uint32_t REASM_TIMEOUT  = 1000;                   // well inside one step
+    constexpr uint32_t TILE_W         = 200;                    // not a multiple of TILE_SIZE
+    constexpr uint32_t TILE_H         = 120;
+    constexpr uint32_t TILE_LOSS_PCT  = 10;
+    constexpr uint32_t TILE_CHANGES   = 6;                      // tiles redrawn per frame
+    constexpr uint32_t TILE_BANDS     = 4;                      // the banded variant's FrameBands
+    constexpr uint32_t MAX_REPORTS    = 10;
+
+    uint32_t g_reported = 0;
+
+    void Fail(Result& r, const char* what, uint32_t a = 0, uint32_t b = 0)
+    {
+        ++r.failures;
+        if (g_reported++ < MAX_REPORTS)
+        {
+            fprintf(stderr, what, a, b);
+            fputc('\n', stderr);
+        }
+    }
+
+    bool Selected(const Options& opt, const char* label)
+    {
+        return !opt.filter || std::strstr(label, opt.filter);
+    }
+
+    void Report(const char* name, const char* variant, const Result& r)
+    {
+        printf("%s,%s,%u,%u,%u,%s\n", name, variant, r.frames, r.completions, r.failures,
+               r.failures ? "FAIL" : "ok");
+        fflush(stdout);
+    }
+
+    // ─── reasm_lanes ─────────────────────────────────────────
+    struct SourceFrame
+    {
+        std::vector<uint8_t> pixels;
+        uint32_t             completions = 0;   // written by whichever lane completed it
+    };
+
+    struct Delivery
+    {
+        uint32_t frame;    // index into the round's frames
+        uint32_t packet;   // index into that frame's packets
+    };
+
+    Result CheckLanes(const Options& opt, uint32_t lanes)
+    {
+        MemoryReassembly reasm(REASM_TIMEOUT, REASM_TIMEOUT, lanes);
+        std::mt19937     rng(opt.seed * 977 + lanes);
+        Result           result;
+
+        std::vector<SourceFrame>                        frames(REASM_WINDOW);
+        std::vector<std::vector<std::vector<uint8_t>>> packets(REASM_WINDOW);
+        std::vector<std::vector<Delivery>>             perLane(lanes);
+        std::vector<uint8_t>                           scratch(REASM_PACKET);
+        uint32_t firstID = 1;
+        uint64_t roundUs = 0;
+
+        // Lanes are persistent threads that run a round each time
+        // `go` moves on and count themselves out through `done`
+        std::atomic<uint32_t> go{0}, done{0};
+        std::atomic<bool>     quit{false};
+        std::mutex            resultMtx;
+
+        auto laneProc = [&](uint32_t lane) {
+            uint32_t seen = 0;
+            for (;;)
+            {
+                while (go.load(std::memory_order_acquire) == seen && !quit.load(std::memory_order_acquire))
+                    std::this_thread::yield();
+                if (quit.load(std::memory_order_acquire))
+                    return;
+                ++seen;
+
+                for (const Delivery& d : perLane[lane])
+                {
+                    const std::vector<uint8_t>& pkt = packets[d.frame][d.packet];
+                    FrameSlot* s = reasm.ConsumePacket(pkt.data(), static_cast<int>(pkt.size()), lane, roundUs);
+                    if (!s)
+                        continue;
+
+                    const uint32_t id  = s->frameID.load(std::memory_order_relaxed);
+                    const uint32_t idx = id - firstID;
+                    std::lock_guard<std::mutex> lock(resultMtx);
+                    ++result.completions;
+                    if (idx >= REASM_WINDOW)
+                        Fail(result, "lanes=%u: completed frame %u is not in flight", lanes, id);
+                    else
+                    {
+                        ++frames[idx].completions;
+                        if (s->pixelData != frames[idx].pixels)
+                            Fail(result, "lanes=%u: frame %u is not bit-exact", lanes, id);
+                    }
+                    reasm.ReleaseSlot(s);
+                }
+                done.fetch_add(1, std::memory_order_acq_rel);
+            }
+        };
+        std::vector<std::thread> threads;
+        for (uint32_t l = 0; l < lanes; ++l)
+            threads.emplace_back(laneProc, l);
+
+        std::vector<Delivery> order;
+        for (uint32_t round = 0; round < opt.rounds; ++round)
+        {
+            // Leftovers re-opened by late duplicates expire here
+            roundUs += REASM_ROUND_US;
+            reasm.PurgeExpired(roundUs);
+
+            order.clear();
+            for (uint32_t f = 0; f < REASM_WINDOW; ++f)
+            {
+                // 1 × 1 up to 512 × 48 BGRA – one packet up to ~80
+                const uint32_t w = 1 + rng() % 512;
+                const uint32_t h = 1 + rng() % 48;
+                SourceFrame& src = frames[f];
+                src.pixels.resize(static_cast<size_t>(w) * h * 4);
+                for (uint8_t& b : src.pixels)
+                    b = static_cast<uint8_t>(rng());
+                src.completions = 0;
+
+                FrameMetaPayload meta{};
+                meta.width    = w;
+                meta.height   = h;
+                meta.rawBytes = static_cast<uint32_t>(src.pixels.size());
+
+                packets[f].clear();
+                FuserUtil::PacketizeFrame(firstID + f, FuserUtil::PacketsForFrame(meta.rawBytes, REASM_PACKET),
+                                          meta, src.pixels.data(), scratch.data(), REASM_PACKET, 0,
+                                          [&](const uint8_t* p, int len) { packets[f].emplace_back(p, p + len); });
+                for (uint32_t p = 0; p < packets[f].size(); ++p)
+                    order.push_back({ f, p });
+            }
+            std::shuffle(order.begin(), order.end(), rng);
+
+            for (std::vector<Delivery>& l : perLane)
+                l.clear();
+            for (size_t i = 0; i < order.size(); ++i)
+            {
+                const uint32_t lane = static_cast<uint32_t>(i % lanes);
+                perLane[lane].push_back(order[i]);
+                if (lanes > 1 && rng() % 100 < REASM_DUP_PCT)
+                    perLane[(lane + 1 + rng() % (lanes - 1)) % lanes].push_back(order[i]);
+            }
+
+            done.store(0, std::memory_order_relaxed);
+            go.fetch_add(1, std::memory_order_acq_rel);
+            while (done.load(std::memory_order_acquire) != lanes)
+                std::this_thread::yield();
+
+            for (uint32_t f = 0; f < REASM_WINDOW; ++f)
+                if (frames[f].completions == 0)
+                    Fail(result, "lanes=%u: frame %u never completed", lanes, firstID + f);
+            result.frames += REASM_WINDOW;
+            firstID       += REASM_WINDOW;
+        }
+
+        quit.store(true, std::memory_order_release);
+        for (std::thread& t : threads)
+            t.join();
+        return result;
+    }
+
+    // ─── tile_chain ──────────────────────────────────────────
+    Result CheckTileChain(const Options& opt, uint32_t bands)
+    {
+        // What the sender keeps of one band's chain, and whether the
+        // receiver holds every frame of it so far
+        struct Band
+        {
+            std::unique_ptr<TileCacheEncoder> enc;
+            std::vector<uint8_t> pixels;
+            uint32_t             lastTiledID = 0;
+            bool                 intact      = false;
+        };
+
+        SourceStream stream(0, 0, 0, REASM_MIN_TIMEOUT_US, REASM_MAX_TIMEOUT_US, 1);
+        std::mt19937 rng(opt.seed * 131 + 7 + bands);
+        Result       result;
+
+        const uint32_t bpp = WirePixels::BytesPerPixel(WirePixels::BGRA32);
+        std::vector<Band> band(bands);
+        for (Band& b : band)
+        {
+            b.enc = std::make_unique<TileCacheEncoder>(TILE_CACHE_MAX_ENTRIES / bands);
+            b.pixels.resize(static_cast<size_t>(TILE_W) * TILE_H * bpp);
+            for (uint8_t& v : b.pixels)
+                v = static_cast<uint8_t>(rng());
+        }
+        std::vector<uint8_t> code(TileCode::MaxCodedBytes(TILE_W, TILE_H, bpp));
+        std::vector<uint32_t> order(bands);
+
+        bool     restart = true;   // sender: next frames start new chains
+        uint32_t id      = 0;
+        FrameSlot slot;
+
+        for (uint32_t capture = 0; capture < opt.rounds * REASM_WINDOW / bands; ++capture)
+        {
+            if (restart)
+            {
+                for (Band& b : band)
+                {
+                    b.enc->Reset();
+                    b.lastTiledID = 0;
+                }
+                restart = false;
+            }
+
+            // Bands get consecutive IDs but finish in any order
+            const uint32_t firstID = id + 1;
+            id += bands;
+            for (uint32_t i = 0; i < bands; ++i)
+                order[i] = i;
+            std::shuffle(order.begin(), order.end(), rng);
+
+            for (const uint32_t bi : order)
+            {
+                Band& b = band[bi];
+                const uint32_t frameID = firstID + bi;
+
+                // A few tiles change, the rest repeat and go out as hits
+                for (uint32_t c = 0; c < TILE_CHANGES; ++c)
+                {
+                    const uint32_t x = rng() % TILE_W, y = rng() % TILE_H;
+                    std::memset(&b.pixels[(static_cast<size_t>(y) * TILE_W + x) * bpp], static_cast<int>(rng()), bpp);
+                }
+
+                uint32_t hits = 0, misses = 0;
+                const size_t coded = b.enc->Encode(b.pixels.data(), TILE_W, TILE_H, bpp, code.data(), hits, misses);
+                const uint32_t ref = b.lastTiledID;
+                b.lastTiledID = frameID;
+                ++result.frames;
+
+                if (rng() % 100 < TILE_LOSS_PCT)
+                {
+                    b.intact = false;
+                    continue;
+                }
+                b.intact = ref == 0 || b.intact;
+
+                slot.frameID.store(frameID, std::memory_order_relaxed);
+                slot.width      = TILE_W;
+                slot.height     = TILE_H;
+                slot.scale      = 1;
+                slot.format     = WirePixels::BGRA32;
+                slot.band       = bi;
+                slot.bandCount  = bands;
+                slot.codec      = FrameDelta::TILES;
+                slot.refFrameID = ref;
+                slot.pixelData.assign(code.begin(), code.begin() + coded);
+                slot.totalBytes = static_cast<uint32_t>(coded);
+
+                const bool decoded = stream.DecodeFrame(slot);
+                if (decoded)
+                {
+                    ++result.completions;
+                    if (!b.intact)
+                        Fail(result, "tile_chain: frame %u (ref %u) decoded past a lost frame", frameID, ref);
+                    else if (slot.totalBytes != b.pixels.size() ||
+                             std::memcmp(slot.pixelData.data(), b.pixels.data(), b.pixels.size()) != 0)
+                        Fail(result, "tile_chain: frame %u (ref %u) is not bit-exact", frameID, ref);
+                }
+                else if (b.intact)
+                {
+                    Fail(result, "tile_chain: frame %u (ref %u) refused on an intact chain", frameID, ref);
+                }
+                b.intact = decoded;
+            }
+
+            // The keyframe request reaches the sender before its next capture
+            if (stream.TakeKeyframeRequest(static_cast<uint64_t>(capture + 1) * REASM_ROUND_US, 0))
+                restart = true;
+        }
+        return result;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options opt;
+    for (int i = 1; i < argc; ++i)
+    {
+        if      (!std::strcmp(argv[i], "--filter") && i + 1 < argc) opt.filter = argv[++i];
+        else if (!std::strcmp(argv[i], "--rounds") && i + 1 < argc) opt.rounds = static_cast<uint32_t>(std::atoi(argv[++i]));
+        else if (!std::strcmp(argv[i], "--seed")   && i + 1 < argc) opt.seed   = static_cast<uint32_t>(std::atoi(argv[++i]));
+        else
+        {
+            fprintf(stderr, "usage: FuserCheck [--filter substr] [--rounds N] [--seed N]\n");
+            return 2;
+        }
+    }
+
+    bool failed = false;
+    printf("case,variant,frames,completions,failures,result\n");
+    for (uint32_t lanes = 1; lanes <= 4; ++lanes)
+    {
+        char variant[32], label[64];
+        snprintf(variant, sizeof(variant), "lanes=%u", lanes);
+        snprintf(label, sizeof(label), "reasm_lanes/%s", variant);
+        if (!Selected(opt, label))
+            continue;
+        const Result r = CheckLanes(opt, lanes);
+        Report("reasm_lanes", variant, r);
+        failed |= r.failures != 0;
+    }
+    for (const uint32_t bands : { 1u, TILE_BANDS })
+    {
+        char variant[32], label[64];
+        snprintf(variant, sizeof(variant), "bands=%u,loss=%u%%", bands, TILE_LOSS_PCT);
+        snprintf(label, sizeof(label), "tile_chain/%s", variant);
+        if (!Selected(opt, label))
+            continue;
+        const Result r = CheckTileChain(opt, bands);
+        Report("tile_chain", variant, r);
+        failed |= r.failures != 0;
+    }
+    return failed ? 1 : 0;
+}
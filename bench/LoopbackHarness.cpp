@@ -0,0 +1,841 @@
+// ============================================================
+//  LoopbackHarness.cpp  –  End-to-end throughput / loss / latency
+//  sweep over 127.0.0.1
+//  Zero-Latency Network Video Fuser
+//
+//  LoopbackHarness [--res WxH,...] [--fps N,...] [--fill N,...]
+//                  [--packet N,...] [--stripes N,...] [--bands N,...]
+//                  [--sources N,...] [--receivers N,...] [--codec NAME,...]
+//                  [--group A.B.C.D] [--seconds S] [--port P]
+//                  [--two-process] [--impair key=value,...;...]
+//                  [--no-extras]
+//
+//  For every resolution × frame rate × fill × packet size × stripe
+//  count × band count × source count × receiver count × codec ×
+//  impairment point, that many SenderModules (synthetic capture,
+//  boxes and text off so the fill alone sets the frame size;
+//  FrameBands from --bands; StreamId 0..N-1) stream to that many
+//  headless ReceiverModules on loopback. With more than one
+//  receiver every sender multicasts to --group (default
+//  239.255.70.75, TTL 1, loopback on) and every receiver joins it on
+//  127.0.0.1. The harness reads each receiver's frame ring and
+//  checks each frame (or band of one) it sees, bit for bit, against
+//  the synthetic frames the sender rendered around that frame ID –
+//  a frame that matches none of them is a corrupt frame, as is a
+//  source that never gets a frame through to some receiver, and
+//  either makes the exit code 1.
+//
+//  --codec picks the senders' wire codec: raw (every band sent
+//  whole), delta (DeltaCodec on – a band goes out as its
+//  difference to the last one), tiles (TileCache on – tiles the
+//  receivers already hold go out as a slot) or delta+tiles (both;
+//  keyframes are tiled). The receivers rebuild coded frames before
+//  they publish them, so what reaches the ring is checked the same
+//  way. A coded point that dropped frames for a lost reference but
+//  never got a keyframe request back can't resync, and fails too.
+//
+//  --two-process runs each sender in a child copy of this program
+//  (its counters are read from the child's metrics shared memory),
+//  so sender and receiver don't share a heap or a scheduler quantum.
+//
+//  --impair puts every receiver behind NetworkImpairment, e.g.
+//    --impair loss=0.5,burst=0.1:25,rate=2000,jitter=300,reorder=1,dup=0.5
+//  keys: loss burst=enter:exit burstloss rate queue delay jitter
+//        reorder reorderus dup seed (percentages, Mbit/s, KB, µs)
+//  Several specs separated by ';' are an axis; "none" is the clean
+//  link. The default, "none;loss=1,seed=1", runs every point once
+//  clean and once lossy, so the coded points go through keyframe
+//  requests and resync. Receiver k uses seed + 100·k, so each sees
+//  its own loss pattern.
+//
+//  After the sweep come EXTRA_POINTS, combinations the default axes
+//  leave out, whatever the axes (--no-extras skips them): tiled
+//  bands over four stripes behind a reordering link, whose bands
+//  reach the receiver out of order.
+//
+//  Output is CSV on stdout, one row per point:
+//    mode,width,height,fps_target,fill_pct,packet_bytes,stripes,bands,
+//    sources,receivers,codec,seconds,frames_sent,frames_completed,frames_presented,
+//    completion_pct,fps,goodput_mbps,wire_mbps,lat_p50_us,lat_p99_us,
+//    lat_p999_us,frames_verified,frames_corrupt,streams_seen,
+//    worst_rx_loss_pct,frames_ref_missing,keyframe_requests,impair
+//  Frame counts and rates are totals over all sources and receivers,
+//  and a banded capture counts once per band.
+//  streams_seen is the fewest sources any one receiver had a frame
+//  verified from. completion_pct = completed / (sent × receivers);
+//  goodput counts pixel bytes of completed frames, wire every
+//  datagram byte received. Latency is capture → published to the
+//  ring over all receivers (every end shares one clock).
+//  worst_rx_loss_pct is the smoothed loss of the worst receiver as
+//  the senders last heard it through LossFeedback reports.
+//  frames_ref_missing counts delta frames the receivers had to drop
+//  because the frame they build on was lost, keyframe_requests the
+//  requests for a fresh reference the senders got back; both stay 0
+//  for raw.
+//
+//  Build: LoopbackHarness.vcxproj (Release|x64).
+// ============================================================
+
+#include "../NetworkFuser.h"
+#include "../Sender.h"
+#include "../Receiver.h"
+#include "../FrameRing.h"
+#include "../FrameOps.h"
+#include "../Metrics.h"
+#include "../MetricsExport.h"
+#include <cstdio>
+
+namespace
+{
+    struct Resolution { uint32_t w, h; };
+
+    // Wire codec of a point: which of the senders' coders are on
+    struct Codec
+    {
+        const char* name;
+        bool        delta;   // FuserConfig::deltaCodec
+        bool        tiles;   // FuserConfig::tileCache
+    };
+
+    constexpr Codec CODECS[] = {
+        { "raw", false, false }, { "delta", true, false }, { "tiles", false, true }, { "delta+tiles", true, true } };
+    constexpr uint32_t CODEC_COUNT = sizeof(CODECS) / sizeof(CODECS[0]);
+
+    struct Options
+    {
+        std::vector<Resolution> res     = { { 1280, 720 }, { 1920, 1080 }, { 3840, 2160 } };
+        std::vector<uint32_t>   fps     = { 60, 144, 0 };
+        std::vector<uint32_t>   fill    = { 5, 25 };
+        std::vector<uint32_t>   packet  = { MAX_UDP_PAYLOAD, MAX_DATAGRAM_BYTES };
+        std::vector<uint32_t>   stripes = { 1 };
+        std::vector<uint32_t>   bands   = { 1, 4 };
+        std::vector<uint32_t>   sources = { 1 };
+        std::vector<uint32_t>   receivers = { 1 };
+        std::vector<uint32_t>   codec   = { 0, 1, 2, 3 };   // indices into CODECS
+        std::string             group   = "239.255.70.75";
+        double                  seconds = 3.0;
+        uint16_t                port    = 19877;
+        bool                    twoProcess = false;
+        std::vector<std::string> impair = { "", "loss=1,seed=1" };   // --impair specs, "" = clean link
+        bool                    extras  = true;
+    };
+
+    struct Point
+    {
+        uint32_t    w, h, fps, fill, packetBytes, stripes, bands, sources, receivers, codec;
+        std::string impair;   // --impair spec, "" = clean link
+        uint16_t    port;
+    };
+
+    // Run after the sweep (port filled in there)
+    const Point EXTRA_POINTS[] = {
+        { 1920, 1080, 144, 25, MAX_UDP_PAYLOAD, 4, 4, 1, 1, 2 /* tiles */, "reorder=2,reorderus=2000,seed=3", 0 },
+    };
+
+    constexpr uint32_t MAX_RECEIVERS = 8;
+
+    // Ports per point: video stripes and clock sync (port ..
+    // port+MAX_STRIPES), the senders' feedback ports (FeedbackPort,
+    // up to port+MAX_STRIPES+MAX_STREAMS), then one stats port per
+    // child sender
+    constexpr uint16_t STATS_PORT_OFFSET = MAX_STRIPES + MAX_STREAMS + 1;
+    constexpr uint16_t PORTS_PER_POINT   = STATS_PORT_OFFSET + MAX_STREAMS;
+
+    constexpr uint32_t WARMUP_MS      = 500;
+    constexpr uint32_t FIRST_FRAME_MS = 5000;
+    constexpr uint32_t KEY_REQUEST_GRACE_MS = 1000;   // > FuserConfig::feedbackIntervalMs
+
+    std::string g_exePath;
+
+    SyntheticCaptureParams SyntheticFor(const Point& pt)
+    {
+        SyntheticCaptureParams p;
+        p.width       = pt.w;
+        p.height      = pt.h;
+        p.fps         = pt.fps;
+        p.fillPercent = pt.fill;
+        p.boxes       = 0;
+        p.text        = false;
+        return p;
+    }
+
+    // Several receivers → everyone on the multicast group, on loopback
+    void ApplyMulticast(const std::string& group, const Point& pt, FuserConfig& cfg)
+    {
+        if (pt.receivers <= 1) return;
+        cfg.multicastGroup = group;
+        cfg.multicastTtl   = 1;
+        cfg.multicastLoop  = true;
+        cfg.localIP        = "127.0.0.1";
+    }
+
+    FuserConfig SenderConfig(const Point& pt, uint16_t streamID, const std::string& group)
+    {
+        const SyntheticCaptureParams sp = SyntheticFor(pt);
+        FuserConfig cfg;
+        ApplyMulticast(group, pt, cfg);
+        cfg.isSender             = true;
+        cfg.remoteIP             = "127.0.0.1";
+        cfg.port                 = pt.port;
+        cfg.packetBytes          = pt.packetBytes;
+        cfg.stripes              = pt.stripes;
+        cfg.frameBands           = pt.bands;
+        cfg.streamID             = streamID;
+        cfg.captureSource        = "synthetic";
+        cfg.syntheticWidth       = sp.width;
+        cfg.syntheticHeight      = sp.height;
+        cfg.syntheticFps         = sp.fps;
+        cfg.syntheticFillPercent = sp.fillPercent;
+        cfg.syntheticBoxes       = sp.boxes;
+        cfg.syntheticText        = sp.text;
+        cfg.deltaCodec           = CODECS[pt.codec].delta;
+        cfg.tileCache            = CODECS[pt.codec].tiles;
+        cfg.statsIntervalMs      = 0;
+        return cfg;
+    }
+
+    // "loss=1,burst=0.2:25,..." → cfg.impair*; false on a bad key
+    bool ApplyImpairment(const std::string& spec, FuserConfig& cfg)
+    {
+        size_t pos = 0;
+        while (pos < spec.size())
+        {
+            size_t end = spec.find(',', pos);
+            if (end == std::string::npos) end = spec.size();
+            const std::string item = spec.substr(pos, end - pos);
+            pos = end + 1;
+
+            const size_t eq = item.find('=');
+            if (eq == std::string::npos) return false;
+            const std::string key = item.substr(0, eq);
+            const char*       val = item.c_str() + eq + 1;
+            const double      num = std::atof(val);
+            const uint32_t    u32 = static_cast<uint32_t>(std::strtoul(val, nullptr, 10));
+
+            if      (key == "loss")      cfg.impairLossPercent      = num;
+            else if (key == "burstloss") cfg.impairBurstLossPercent = num;
+            else if (key == "rate")      cfg.impairRateMbps         = u32;
+            else if (key == "queue")     cfg.impairQueueKB          = u32;
+            else if (key == "delay")     cfg.impairDelayUs          = u32;
+            else if (key == "jitter")    cfg.impairJitterUs         = u32;
+            else if (key == "reorder")   cfg.impairReorderPercent   = num;
+            else if (key == "reorderus") cfg.impairReorderUs        = u32;
+            else if (key == "dup")       cfg.impairDuplicatePercent = num;
+            else if (key == "seed")      cfg.impairSeed             = u32;
+            else if (key == "burst")
+            {
+                const char* colon = std::strchr(val, ':');
+                cfg.impairBurstEnterPercent = num;
+                if (colon) cfg.impairBurstExitPercent = std::atof(colon + 1);
+            }
+            else return false;
+        }
+        return true;
+    }
+
+    FuserConfig ReceiverConfig(const Options& opt, const Point& pt, uint32_t index)
+    {
+        FuserConfig cfg;
+        ApplyImpairment(pt.impair, cfg);
+        ApplyMulticast(opt.group, pt, cfg);
+        cfg.impairSeed          += 100 * index;
+        cfg.port                 = pt.port;
+        cfg.stripes              = pt.stripes;
+        cfg.headless             = true;
+        cfg.frameRingName        = "KnoxFuserHarness" + std::to_string(GetCurrentProcessId()) +
+                                   "_" + std::to_string(pt.port) + "_" + std::to_string(index);
+        cfg.frameRingSlots       = 4;
+        cfg.frameRingSlotBytes   = pt.w * pt.h * 4;
+        cfg.clockSyncIntervalMs  = 0;   // one machine, one clock
+        cfg.statsIntervalMs      = 0;
+        cfg.latencyLogIntervalMs = 0;
+        return cfg;
+    }
+
+    std::string SenderShmName(uint16_t port, uint16_t streamID)
+    {
+        return "KnoxFuserHarnessTx" + std::to_string(port) + "_" + std::to_string(streamID);
+    }
+
+    // ─── Frame check against the sender's synthetic source ───
+    class FrameVerifier
+    {
+    public:
+        explicit FrameVerifier(const SyntheticCaptureParams& p)
+            : m_src(p), m_full(static_cast<size_t>(p.width) * p.height * 4) {}
+
+        // Frame IDs no longer map to source frames one to one: the
+        // sender's pipeline drops captures it can't keep up with, and
+        // a capture sent in bands takes one ID per band. Every capture
+        // takes at most bandCount IDs, so the frame's source index is
+        // at least (ID-1)/bandCount, and never below the last one
+        // matched on that stream (`cursor`, ~0 before the first). The
+        // view matches if one of the next WINDOW source frames has
+        // exactly its pixels in that band.
+        bool Matches(const FrameRingView& v, uint64_t& cursor)
+        {
+            const uint32_t bands = std::max(1u, v.bandCount);
+            const uint64_t floor = (v.frameID - 1) / bands;
+            const uint64_t first = (cursor == ~0ull || cursor < floor) ? floor : cursor;
+            for (uint64_t index = first; index < first + WINDOW; ++index)
+            {
+                if (BandMatches(v, index))
+                {
+                    cursor = index;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+    private:
+        static constexpr uint64_t WINDOW = 64;
+
+        bool BandMatches(const FrameRingView& v, uint64_t index)
+        {
+            const uint32_t W = m_src.Width(), H = m_src.Height();
+            const uint32_t bands = std::max(1u, v.bandCount);
+            if (v.band >= bands) return false;
+            if (index != m_rendered)
+            {
+                m_src.Render(m_full.data(), index);
+                m_rendered = index;
+            }
+
+            const uint32_t y0 = FrameOps::BandStart(H, v.band, bands);
+            const uint32_t y1 = FrameOps::BandStart(H, v.band + 1, bands);
+            BoundingBox bb = FrameOps::ComputeBoundingBox(m_full.data() + static_cast<size_t>(y0) * W * 4, W, y1 - y0);
+            if (bb.w == 0 || bb.h == 0) bb = BoundingBox{0, 0, 0, 0};
+            else bb.y += y0;
+            if (v.x != bb.x || v.y != bb.y || v.w != bb.w || v.h != bb.h || v.bytes != bb.w * bb.h * 4)
+                return false;
+
+            const size_t rowBytes = static_cast<size_t>(bb.w) * 4;
+            for (uint32_t row = 0; row < bb.h; ++row)
+            {
+                const uint8_t* want = m_full.data() + ((static_cast<size_t>(bb.y) + row) * W + bb.x) * 4;
+                if (std::memcmp(v.pixels + row * rowBytes, want, rowBytes) != 0)
+                    return false;
+            }
+            return true;
+        }
+
+        SyntheticCaptureSource m_src;
+        std::vector<uint8_t>   m_full;
+        uint64_t               m_rendered = ~0ull;   // source index in m_full
+    };
+
+    // ─── Sender in a child process (--two-process) ───────────
+    class ChildSender
+    {
+    public:
+        ~ChildSender() { Stop(); }
+
+        bool Start(const Point& pt, uint16_t streamID, const std::string& group)
+        {
+            char cmd[512];
+            snprintf(cmd, sizeof(cmd), "\"%s\" --child-sender %u %u %u %u %u %u %u %u %u %u %u %s",
+                     g_exePath.c_str(), pt.w, pt.h, pt.fps, pt.fill, pt.packetBytes, pt.stripes, pt.bands,
+                     streamID, pt.port, pt.receivers, pt.codec, group.c_str());
+            STARTUPINFOA si{ sizeof(si) };
+            if (!CreateProcessA(nullptr, cmd, nullptr, nullptr, FALSE, 0, nullptr, nullptr, &si, &m_pi))
+                return false;
+
+            // The child publishes its counters every 50 ms once running
+            const std::string shm = SenderShmName(pt.port, streamID);
+            for (int i = 0; i < 100; ++i)
+            {
+                if (m_stats.Open(shm)) return true;
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            }
+            return false;
+        }
+
+        // FramesSent, KeyframeRequests and WorstRxLossBp from the
+        // child's last published snapshot
+        bool Read(uint64_t& framesSent, uint64_t& keyRequests, int64_t& worstLossBp) const
+        {
+            const auto* shm = reinterpret_cast<const MetricsShm*>(m_stats.Base());
+            if (!shm || shm->magic != METRICS_SHM_MAGIC || shm->version != METRICS_SHM_VERSION)
+                return false;
+            for (int tries = 0; tries < 1000; ++tries)
+            {
+                const uint32_t s0 = shm->seq.load(std::memory_order_acquire);
+                if (s0 & 1) continue;
+                const uint64_t sent = shm->counters[static_cast<size_t>(MetricCounter::FramesSent)];
+                const uint64_t keys = shm->counters[static_cast<size_t>(MetricCounter::KeyframeRequests)];
+                const int64_t  loss = shm->gauges[static_cast<size_t>(MetricGauge::WorstRxLossBp)];
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (shm->seq.load(std::memory_order_relaxed) == s0)
+                {
+                    framesSent  = sent;
+                    keyRequests = keys;
+                    worstLossBp = loss;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void Stop()
+        {
+            m_stats.Close();
+            if (!m_pi.hProcess) return;
+            TerminateProcess(m_pi.hProcess, 0);
+            WaitForSingleObject(m_pi.hProcess, 5000);
+            CloseHandle(m_pi.hThread);
+            CloseHandle(m_pi.hProcess);
+            m_pi = PROCESS_INFORMATION{};
+        }
+
+    private:
+        PROCESS_INFORMATION m_pi{};
+        FrameRingMapping    m_stats;
+    };
+
+    int RunChildSender(int argc, char** argv)
+    {
+        if (argc < 14) return 2;
+        Point pt{};
+        pt.w           = static_cast<uint32_t>(std::atoi(argv[2]));
+        pt.h           = static_cast<uint32_t>(std::atoi(argv[3]));
+        pt.fps         = static_cast<uint32_t>(std::atoi(argv[4]));
+        pt.fill        = static_cast<uint32_t>(std::atoi(argv[5]));
+        pt.packetBytes = static_cast<uint32_t>(std::atoi(argv[6]));
+        pt.stripes     = static_cast<uint32_t>(std::atoi(argv[7]));
+        pt.bands       = static_cast<uint32_t>(std::atoi(argv[8]));
+        const auto streamID = static_cast<uint16_t>(std::atoi(argv[9]));
+        pt.port        = static_cast<uint16_t>(std::atoi(argv[10]));
+        pt.receivers   = static_cast<uint32_t>(std::atoi(argv[11]));
+        pt.codec       = std::min<uint32_t>(static_cast<uint32_t>(std::atoi(argv[12])), CODEC_COUNT - 1);
+
+        FuserConfig cfg = SenderConfig(pt, streamID, argv[13]);
+        cfg.statsIntervalMs    = 50;
+        cfg.statsLogIntervalMs = 0;
+        cfg.statsPort          = static_cast<uint16_t>(pt.port + STATS_PORT_OFFSET + streamID);
+        cfg.statsShmName       = SenderShmName(pt.port, streamID);
+
+        SenderModule sender(cfg);
+        if (!sender.Init()) return 1;
+        MetricsExporter stats;
+        stats.Start(cfg, nullptr);
+        sender.Run();   // until the parent terminates us
+        return 0;
+    }
+
+    // ─── One sweep point ─────────────────────────────────────
+    struct Result
+    {
+        double   seconds    = 0;
+        uint64_t sent       = 0;
+        uint64_t completed  = 0;
+        uint64_t presented  = 0;
+        uint64_t goodBytes  = 0;
+        uint64_t wireBytes  = 0;
+        uint64_t p50 = 0, p99 = 0, p999 = 0;
+        uint64_t verified   = 0;
+        uint64_t corrupt    = 0;
+        uint32_t streamsSeen = 0;
+        double   worstLossPct = 0;
+        uint64_t refMissing  = 0;
+        uint64_t keyRequests = 0;
+    };
+
+    bool RunPoint(const Options& opt, const Point& pt, Result& r)
+    {
+        std::vector<std::unique_ptr<ReceiverModule>> rx;
+        std::vector<std::thread>                     rxThreads;
+        bool ok = true;
+        for (uint32_t k = 0; k < pt.receivers && ok; ++k)
+        {
+            rx.push_back(std::make_unique<ReceiverModule>(ReceiverConfig(opt, pt, k)));
+            ok = rx.back()->Init();
+            if (!ok)
+            {
+                fprintf(stderr, "LoopbackHarness: receiver %u init failed on port %u\n", k, pt.port);
+                break;
+            }
+            rx.back()->Latency().SetClockOffsetUs(0);
+            rxThreads.emplace_back([m = rx.back().get()] { m->Run(); });
+        }
+
+        std::vector<std::unique_ptr<SenderModule>> tx;
+        std::vector<std::thread>                   txThreads;
+        std::vector<ChildSender>                   children(opt.twoProcess ? pt.sources : 0);
+        for (uint32_t k = 0; k < pt.sources && ok; ++k)
+        {
+            const auto streamID = static_cast<uint16_t>(k);
+            if (opt.twoProcess)
+            {
+                ok = children[k].Start(pt, streamID, opt.group);
+                continue;
+            }
+            tx.push_back(std::make_unique<SenderModule>(SenderConfig(pt, streamID, opt.group)));
+            ok = tx.back()->Init();
+            if (ok) txThreads.emplace_back([s = tx.back().get()] { s->Run(); });
+        }
+
+        std::vector<FrameRingReader> readers(pt.receivers);
+        for (uint32_t k = 0; k < pt.receivers && ok; ++k)
+            ok = readers[k].Open(ReceiverConfig(opt, pt, k).frameRingName);
+
+        // Wait for the stream to reach every receiver, then let it settle
+        FrameRingView view;
+        std::vector<uint64_t> lastSeq(pt.receivers, 0);
+        if (ok)
+        {
+            const uint64_t giveUp = FuserUtil::NowMs() + FIRST_FRAME_MS;
+            for (uint32_t k = 0; k < pt.receivers && ok; ++k)
+            {
+                view = FrameRingView{};
+                while (!readers[k].AcquireLatest(view, 0) && FuserUtil::NowMs() < giveUp)
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                ok = view.publishSeq != 0;
+                if (!ok) fprintf(stderr, "LoopbackHarness: no frame at receiver %u within %u ms\n", k, FIRST_FRAME_MS);
+            }
+        }
+        if (ok)
+            std::this_thread::sleep_for(std::chrono::milliseconds(WARMUP_MS));
+
+        // A sender-side counter, from this process or summed over the children
+        auto senderCount = [&](const MetricsSnapshot& m, MetricCounter which) -> uint64_t
+        {
+            if (!opt.twoProcess) return m[which];
+            uint64_t total = 0;
+            for (const ChildSender& c : children)
+            {
+                uint64_t n = 0, keys = 0;
+                int64_t  loss = 0;
+                if (c.Read(n, keys, loss)) total += which == MetricCounter::FramesSent ? n : keys;
+            }
+            return total;
+        };
+
+        auto latency = [&](LatencySnapshot& out)
+        {
+            out = LatencySnapshot{};
+            for (auto& m : rx)
+            {
+                LatencySnapshot one;
+                m->Latency().Snapshot(LatencyStage::CaptureToPresent, one);
+                for (size_t b = 0; b < one.counts.size(); ++b) out.counts[b] += one.counts[b];
+                out.total += one.total;
+            }
+        };
+
+        if (ok)
+        {
+            MetricsSnapshot m0, m1;
+            LatencySnapshot l0, l1;
+            Metrics::Aggregate(m0);
+            const uint64_t sent0 = senderCount(m0, MetricCounter::FramesSent);
+            const uint64_t keys0 = senderCount(m0, MetricCounter::KeyframeRequests);
+            latency(l0);
+            const uint64_t t0 = FuserUtil::NowUs();
+            const uint64_t t1 = t0 + static_cast<uint64_t>(opt.seconds * 1e6);
+
+            // Every source renders the same synthetic frames, so one
+            // verifier serves all streams and receivers
+            FrameVerifier verifier(SyntheticFor(pt));
+            std::vector<uint32_t> seenMask(pt.receivers, 0);
+            std::vector<uint64_t> cursor(static_cast<size_t>(pt.receivers) * MAX_STREAMS, ~0ull);
+            while (FuserUtil::NowUs() < t1)
+            {
+                bool any = false;
+                for (uint32_t k = 0; k < pt.receivers; ++k)
+                {
+                    if (!readers[k].AcquireLatest(view, lastSeq[k]))
+                        continue;
+                    any = true;
+                    uint64_t&      at    = cursor[k * MAX_STREAMS + std::min(view.stream, MAX_STREAMS - 1)];
+                    const uint64_t was   = at;
+                    const bool     match = verifier.Matches(view, at);
+                    if (!FrameRingReader::Validate(view))
+                    {
+                        at = was;
+                        continue;   // overwritten while comparing – says nothing
+                    }
+                    lastSeq[k] = view.publishSeq;
+                    if (match)
+                    {
+                        ++r.verified;
+                        if (view.stream < MAX_STREAMS) seenMask[k] |= 1u << view.stream;
+                    }
+                    else
+                    {
+                        ++r.corrupt;
+                        fprintf(stderr, "LoopbackHarness: receiver %u: frame %u of stream %u (%u,%u %ux%u) "
+                                        "differs from the source\n",
+                                k, view.frameID, view.stream, view.x, view.y, view.w, view.h);
+                    }
+                }
+                if (!any) std::this_thread::yield();
+            }
+            r.streamsSeen = MAX_STREAMS;
+            for (uint32_t k = 0; k < pt.receivers; ++k)
+            {
+                uint32_t seen = 0;
+                for (uint32_t s = 0; s < MAX_STREAMS; ++s)
+                    if (seenMask[k] & (1u << s)) ++seen;
+                if (seen < pt.sources)
+                    fprintf(stderr, "LoopbackHarness: only %u of %u sources got a frame through to receiver %u\n",
+                            seen, pt.sources, k);
+                r.streamsSeen = std::min(r.streamsSeen, seen);
+            }
+
+            Metrics::Aggregate(m1);
+            r.sent        = senderCount(m1, MetricCounter::FramesSent) - sent0;
+            r.keyRequests = senderCount(m1, MetricCounter::KeyframeRequests) - keys0;
+            latency(l1);
+            r.seconds   = (FuserUtil::NowUs() - t0) / 1e6;
+            r.completed = m1[MetricCounter::FramesCompleted] - m0[MetricCounter::FramesCompleted];
+            r.presented = m1[MetricCounter::FramesPresented] - m0[MetricCounter::FramesPresented];
+            r.goodBytes = m1[MetricCounter::BytesCompleted]  - m0[MetricCounter::BytesCompleted];
+            r.wireBytes = m1[MetricCounter::BytesReceived]   - m0[MetricCounter::BytesReceived];
+            r.refMissing = m1[MetricCounter::FramesRefMissing] - m0[MetricCounter::FramesRefMissing];
+
+            // A reference lost just before the end is asked for with
+            // the receivers' next report; give that one time to land
+            if (r.refMissing > 0 && r.keyRequests == 0)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(KEY_REQUEST_GRACE_MS));
+                MetricsSnapshot m2;
+                Metrics::Aggregate(m2);
+                r.keyRequests = senderCount(m2, MetricCounter::KeyframeRequests) - keys0;
+            }
+
+            const LatencySnapshot lat = l1.Since(l0);
+            r.p50  = lat.Percentile(0.50);
+            r.p99  = lat.Percentile(0.99);
+            r.p999 = lat.Percentile(0.999);
+
+            for (auto& s : tx) r.worstLossPct = std::max(r.worstLossPct, s->WorstReceiverLossPercent());
+            for (const ChildSender& c : children)
+            {
+                uint64_t n = 0, keys = 0;
+                int64_t  loss = 0;
+                if (c.Read(n, keys, loss)) r.worstLossPct = std::max(r.worstLossPct, loss / 100.0);
+            }
+        }
+
+        for (auto& s : tx) s->Stop();
+        for (auto& t : txThreads) if (t.joinable()) t.join();
+        tx.clear();
+        for (ChildSender& c : children) c.Stop();
+        for (auto& m : rx) m->Stop();
+        for (auto& t : rxThreads) if (t.joinable()) t.join();
+        return ok;
+    }
+
+    // ─── Argument parsing ────────────────────────────────────
+    std::vector<uint32_t> ParseList(const char* s)
+    {
+        std::vector<uint32_t> out;
+        for (const char* p = s; *p; )
+        {
+            char* end = nullptr;
+            out.push_back(static_cast<uint32_t>(std::strtoul(p, &end, 10)));
+            p = end;
+            if (*p == ',') ++p;
+            else break;
+        }
+        return out;
+    }
+
+    std::vector<Resolution> ParseResolutions(const char* s)
+    {
+        std::vector<Resolution> out;
+        for (const char* p = s; *p; )
+        {
+            char* end = nullptr;
+            Resolution r{};
+            r.w = static_cast<uint32_t>(std::strtoul(p, &end, 10));
+            if (*end != 'x' && *end != 'X') break;
+            r.h = static_cast<uint32_t>(std::strtoul(end + 1, &end, 10));
+            if (r.w && r.h) out.push_back(r);
+            p = end;
+            if (*p == ',') ++p;
+            else break;
+        }
+        return out;
+    }
+
+    // "raw,delta+tiles" → indices into CODECS; empty on an unknown name
+    std::vector<uint32_t> ParseCodecs(const char* s)
+    {
+        std::vector<uint32_t> out;
+        for (const char* p = s; *p; )
+        {
+            const char* end = std::strchr(p, ',');
+            const size_t len = end ? static_cast<size_t>(end - p) : std::strlen(p);
+            uint32_t c = 0;
+            while (c < CODEC_COUNT && (std::strlen(CODECS[c].name) != len || std::strncmp(CODECS[c].name, p, len)))
+                ++c;
+            if (c == CODEC_COUNT) return {};
+            out.push_back(c);
+            p += len;
+            if (*p == ',') ++p;
+        }
+        return out;
+    }
+
+    // "none;loss=1,seed=2" → { "", "loss=1,seed=2" }
+    std::vector<std::string> ParseImpairments(const char* s)
+    {
+        std::vector<std::string> out;
+        for (const char* p = s; ; )
+        {
+            const char* end = std::strchr(p, ';');
+            std::string spec(p, end ? static_cast<size_t>(end - p) : std::strlen(p));
+            out.push_back(spec == "none" ? std::string() : spec);
+            if (!end) break;
+            p = end + 1;
+        }
+        return out;
+    }
+
+    void Usage()
+    {
+        fprintf(stderr,
+                "usage: LoopbackHarness [--res WxH,...] [--fps N,...] [--fill N,...]\n"
+                "                       [--packet N,...] [--stripes N,...] [--bands N,...]\n"
+                "                       [--sources N,...] [--receivers N,...]\n"
+                "                       [--codec raw|delta|tiles|delta+tiles,...]\n"
+                "                       [--group A.B.C.D] [--seconds S] [--port P] [--two-process]\n"
+                "                       [--impair loss=P,burst=P:P,burstloss=P,rate=MBPS,queue=KB,\n"
+                "                                 delay=US,jitter=US,reorder=P,reorderus=US,dup=P,seed=N\n"
+                "                                 [;...] | none] [--no-extras]\n");
+    }
+}
+
+int main(int argc, char** argv)
+{
+    {
+        char path[MAX_PATH]{};
+        GetModuleFileNameA(nullptr, path, MAX_PATH);
+        g_exePath = path;
+    }
+    const std::string exeDir = g_exePath.substr(0, g_exePath.find_last_of("\\/") + 1);
+    Logger::Init(exeDir + "Logs");   // synchronous: nothing on stdout but the CSV
+
+    WSADATA wsa{};
+    if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0)
+        return 1;
+
+    if (argc > 1 && !std::strcmp(argv[1], "--child-sender"))
+    {
+        const int rc = RunChildSender(argc, argv);
+        WSACleanup();
+        return rc;
+    }
+
+    Options opt;
+    for (int i = 1; i < argc; ++i)
+    {
+        const bool more = i + 1 < argc;
+        if      (!std::strcmp(argv[i], "--res")     && more) opt.res     = ParseResolutions(argv[++i]);
+        else if (!std::strcmp(argv[i], "--fps")     && more) opt.fps     = ParseList(argv[++i]);
+        else if (!std::strcmp(argv[i], "--fill")    && more) opt.fill    = ParseList(argv[++i]);
+        else if (!std::strcmp(argv[i], "--packet")  && more) opt.packet  = ParseList(argv[++i]);
+        else if (!std::strcmp(argv[i], "--stripes") && more) opt.stripes = ParseList(argv[++i]);
+        else if (!std::strcmp(argv[i], "--bands")   && more) opt.bands   = ParseList(argv[++i]);
+        else if (!std::strcmp(argv[i], "--sources") && more) opt.sources = ParseList(argv[++i]);
+        else if (!std::strcmp(argv[i], "--receivers") && more) opt.receivers = ParseList(argv[++i]);
+        else if (!std::strcmp(argv[i], "--codec")   && more) opt.codec   = ParseCodecs(argv[++i]);
+        else if (!std::strcmp(argv[i], "--group")   && more) opt.group   = argv[++i];
+        else if (!std::strcmp(argv[i], "--seconds") && more) opt.seconds = std::atof(argv[++i]);
+        else if (!std::strcmp(argv[i], "--port")    && more) opt.port    = static_cast<uint16_t>(std::atoi(argv[++i]));
+        else if (!std::strcmp(argv[i], "--two-process"))     opt.twoProcess = true;
+        else if (!std::strcmp(argv[i], "--impair")  && more) opt.impair  = ParseImpairments(argv[++i]);
+        else if (!std::strcmp(argv[i], "--no-extras"))       opt.extras  = false;
+        else { Usage(); return 2; }
+    }
+    for (uint32_t& p : opt.packet) p = std::clamp(p, MIN_DATAGRAM_BYTES, MAX_DATAGRAM_BYTES);
+    for (uint32_t& f : opt.fill)   f = std::clamp(f, 1u, 100u);   // an empty frame is never sent
+    for (uint32_t& s : opt.stripes) s = std::clamp(s, 1u, MAX_STRIPES);
+    for (uint32_t& b : opt.bands)   b = std::clamp(b, 1u, MAX_BANDS);
+    for (uint32_t& s : opt.sources) s = std::clamp(s, 1u, MAX_STREAMS);
+    for (uint32_t& n : opt.receivers) n = std::clamp(n, 1u, MAX_RECEIVERS);
+    FuserConfig probe;
+    if (opt.res.empty() || opt.fps.empty() || opt.fill.empty() || opt.packet.empty() || opt.stripes.empty() ||
+        opt.bands.empty() || opt.sources.empty() || opt.receivers.empty() || opt.codec.empty() || opt.seconds <= 0 ||
+        !std::all_of(opt.impair.begin(), opt.impair.end(),
+                     [&](const std::string& s) { return ApplyImpairment(s, probe); }))
+    {
+        Usage();
+        return 2;
+    }
+
+    printf("mode,width,height,fps_target,fill_pct,packet_bytes,stripes,bands,sources,receivers,codec,seconds,"
+           "frames_sent,frames_completed,frames_presented,completion_pct,fps,"
+           "goodput_mbps,wire_mbps,lat_p50_us,lat_p99_us,lat_p999_us,"
+           "frames_verified,frames_corrupt,streams_seen,worst_rx_loss_pct,"
+           "frames_ref_missing,keyframe_requests,impair\n");
+    fflush(stdout);
+
+    std::vector<Point> points;
+    for (const Resolution& res : opt.res)
+    for (uint32_t fps : opt.fps)
+    for (uint32_t fill : opt.fill)
+    for (uint32_t packet : opt.packet)
+    for (uint32_t stripes : opt.stripes)
+    for (uint32_t bands : opt.bands)
+    for (uint32_t sources : opt.sources)
+    for (uint32_t receivers : opt.receivers)
+    for (uint32_t codec : opt.codec)
+    for (const std::string& impair : opt.impair)
+        points.push_back({ res.w, res.h, fps, fill, packet, stripes, bands, sources, receivers, codec, impair, 0 });
+    if (opt.extras)
+        points.insert(points.end(), std::begin(EXTRA_POINTS), std::end(EXTRA_POINTS));
+
+    uint64_t failed = 0;
+    uint16_t port   = opt.port;
+    for (Point& pt : points)
+    {
+        pt.port = port;
+        port    = static_cast<uint16_t>(port + PORTS_PER_POINT);
+        std::string impairColumn = pt.impair;   // one CSV field: ',' → ' '
+        std::replace(impairColumn.begin(), impairColumn.end(), ',', ' ');
+        fprintf(stderr, "LoopbackHarness: %ux%u @ %u fps, %u%% fill, %u-byte packets, %u stripe(s), "
+                        "%u band(s), %u source(s), %u receiver(s), %s, impair %s\n",
+                pt.w, pt.h, pt.fps, pt.fill, pt.packetBytes, pt.stripes, pt.bands, pt.sources, pt.receivers,
+                CODECS[pt.codec].name, impairColumn.empty() ? "none" : impairColumn.c_str());
+
+        Result r;
+        const bool ran = RunPoint(opt, pt, r);
+        failed += r.corrupt + (ran && r.streamsSeen < pt.sources ? 1 : 0);
+        if (ran && r.refMissing > 0 && r.keyRequests == 0)
+        {
+            fprintf(stderr, "LoopbackHarness: %llu frame(s) lost their reference but no keyframe was asked for\n",
+                    static_cast<unsigned long long>(r.refMissing));
+            ++failed;
+        }
+
+        const double secs = r.seconds > 0 ? r.seconds : 1.0;
+        const double expected = static_cast<double>(r.sent) * pt.receivers;
+        printf("%s,%u,%u,%u,%u,%u,%u,%u,%u,%u,%s,%.2f,%llu,%llu,%llu,%.2f,%.1f,%.1f,%.1f,%llu,%llu,%llu,%llu,%llu,%u,%.2f,"
+               "%llu,%llu,%s\n",
+               opt.twoProcess ? "two_process" : "one_process",
+               pt.w, pt.h, pt.fps, pt.fill, pt.packetBytes, pt.stripes, pt.bands, pt.sources, pt.receivers,
+               CODECS[pt.codec].name, r.seconds,
+               static_cast<unsigned long long>(r.sent),
+               static_cast<unsigned long long>(r.completed),
+               static_cast<unsigned long long>(r.presented),
+               expected > 0 ? 100.0 * static_cast<double>(r.completed) / expected : 0.0,
+               r.presented / secs, r.goodBytes * 8 / secs / 1e6, r.wireBytes * 8 / secs / 1e6,
+               static_cast<unsigned long long>(r.p50),
+               static_cast<unsigned long long>(r.p99),
+               static_cast<unsigned long long>(r.p999),
+               static_cast<unsigned long long>(r.verified),
+               static_cast<unsigned long long>(r.corrupt),
+               r.streamsSeen, r.worstLossPct,
+               static_cast<unsigned long long>(r.refMissing),
+               static_cast<unsigned long long>(r.keyRequests),
+               impairColumn.empty() ? "none" : impairColumn.c_str());
+        fflush(stdout);
+    }
+
+    WSACleanup();
+    Logger::Shutdown();
+    return failed ? 1 : 0;
+}
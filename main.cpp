@@ -10,58 +10,182 @@
 #include "ConfigUI.h"
 #include "Sender.h"
 #include "Receiver.h"
+#include "MetricsExport.h"
+#include "EventTrace.h"
+#include "FrameScale.h"
+#include "WirePixels.h"
+#include "TileCache.h"
 
 // ─────────────────────────────────────────────────────────────
-//  FuserUtil implementations
+//  Advanced / tuning keys – not exposed in the launcher UI,
+//  read straight from config.ini on top of whatever it collected
 // ─────────────────────────────────────────────────────────────
-namespace FuserUtil
+static bool LoadTuning(const std::string& iniPath, FuserConfig& cfg)
 {
-    // Minimal INI reader – no external deps
-    std::string ReadIniString(const std::string& path,
-                              const std::string& section,
-                              const std::string& key,
-                              const std::string& defaultVal)
+    cfg.packetBytes = static_cast<uint32_t>(
+        FuserUtil::ReadIniInt(iniPath, "Fuser", "PacketBytes", static_cast<int>(MAX_UDP_PAYLOAD)));
+    cfg.packetBytes = std::clamp<uint32_t>(cfg.packetBytes, MIN_DATAGRAM_BYTES, MAX_DATAGRAM_BYTES);
+    cfg.stripes     = std::clamp<uint32_t>(static_cast<uint32_t>(
+        FuserUtil::ReadIniInt(iniPath, "Fuser", "Stripes", 1)), 1, MAX_STRIPES);
+    const int streamID = FuserUtil::ReadIniInt(iniPath, "Fuser", "StreamId", 0);
+    if (streamID < 0 || streamID > static_cast<int>(MAX_STREAM_ID))
     {
-        char buf[1024]{};
-        DWORD ret = GetPrivateProfileStringA(
-            section.c_str(), key.c_str(), defaultVal.c_str(),
-            buf, sizeof(buf), path.c_str());
-        return std::string(buf, ret);
+        Logger::Fatal("[Main] StreamId %d out of range (0..%u)", streamID, MAX_STREAM_ID);
+        return false;
     }
+    cfg.streamID    = static_cast<uint16_t>(streamID);
 
-    int ReadIniInt(const std::string& path,
-                   const std::string& section,
-                   const std::string& key,
-                   int defaultVal)
+    cfg.multicastGroup     = FuserUtil::ReadIniString(iniPath, "Fuser", "MulticastGroup", "");
+    cfg.multicastTtl       = static_cast<uint32_t>(std::clamp(
+        FuserUtil::ReadIniInt(iniPath, "Fuser", "MulticastTtl", 1), 1, 255));
+    cfg.multicastLoop      = FuserUtil::ReadIniInt(iniPath, "Fuser", "MulticastLoop", 1) != 0;
+    cfg.feedbackIntervalMs = static_cast<uint32_t>(
+        FuserUtil::ReadIniInt(iniPath, "Fuser", "FeedbackIntervalMs",
+                              static_cast<int>(cfg.feedbackIntervalMs)));
+    cfg.adaptToLoss        = FuserUtil::ReadIniInt(iniPath, "Fuser", "AdaptToLoss", 1) != 0;
+
+    cfg.reasmMinTimeoutUs = static_cast<uint32_t>(
+        FuserUtil::ReadIniInt(iniPath, "Fuser", "ReassemblyMinTimeoutUs",
+                              static_cast<int>(REASM_MIN_TIMEOUT_US)));
+    cfg.reasmMaxTimeoutUs = static_cast<uint32_t>(
+        FuserUtil::ReadIniInt(iniPath, "Fuser", "ReassemblyMaxTimeoutUs",
+                              static_cast<int>(REASM_MAX_TIMEOUT_US)));
+
+    cfg.headless           = FuserUtil::ReadIniInt(iniPath, "Fuser", "Headless", 0) != 0;
+    cfg.frameRingName      = FuserUtil::ReadIniString(iniPath, "Fuser", "FrameRingName",
+                                                      cfg.frameRingName);
+    cfg.frameRingSlots     = static_cast<uint32_t>(
+        FuserUtil::ReadIniInt(iniPath, "Fuser", "FrameRingSlots",
+                              static_cast<int>(cfg.frameRingSlots)));
+    cfg.frameRingSlotBytes = static_cast<uint32_t>(
+        FuserUtil::ReadIniInt(iniPath, "Fuser", "FrameRingSlotMB",
+                              static_cast<int>(cfg.frameRingSlotBytes >> 20) + 1)) << 20;
+
+    cfg.captureSource        = FuserUtil::ReadIniString(iniPath, "Fuser", "CaptureSource", "dxgi");
+    cfg.syntheticWidth       = static_cast<uint32_t>(FuserUtil::ReadIniInt(iniPath, "Fuser", "SyntheticWidth",       1920));
+    cfg.syntheticHeight      = static_cast<uint32_t>(FuserUtil::ReadIniInt(iniPath, "Fuser", "SyntheticHeight",      1080));
+    cfg.syntheticFps         = static_cast<uint32_t>(FuserUtil::ReadIniInt(iniPath, "Fuser", "SyntheticFps",         144));
+    cfg.syntheticFillPercent = static_cast<uint32_t>(FuserUtil::ReadIniInt(iniPath, "Fuser", "SyntheticFillPercent", 5));
+    cfg.syntheticBoxes       = static_cast<uint32_t>(FuserUtil::ReadIniInt(iniPath, "Fuser", "SyntheticBoxes",       8));
+    cfg.syntheticText        = FuserUtil::ReadIniInt(iniPath, "Fuser", "SyntheticText", 1) != 0;
+    cfg.captureFilePath      = FuserUtil::ReadIniString(iniPath, "Fuser", "CaptureFile", "");
+    cfg.captureFileWidth     = static_cast<uint32_t>(FuserUtil::ReadIniInt(iniPath, "Fuser", "CaptureFileWidth",     1920));
+    cfg.captureFileHeight    = static_cast<uint32_t>(FuserUtil::ReadIniInt(iniPath, "Fuser", "CaptureFileHeight",    1080));
+    cfg.captureFileFps       = static_cast<uint32_t>(FuserUtil::ReadIniInt(iniPath, "Fuser", "CaptureFileFps",       144));
+    cfg.downscale            = static_cast<uint32_t>(FuserUtil::ReadIniInt(iniPath, "Fuser", "Downscale",            1));
+    if (cfg.downscale != 0 && !FrameScale::ValidFactor(cfg.downscale))
+        cfg.downscale = 1;
     {
-        return static_cast<int>(GetPrivateProfileIntA(
-            section.c_str(), key.c_str(), defaultVal, path.c_str()));
+        const std::string wire = FuserUtil::ReadIniString(iniPath, "Fuser", "WireFormat", "bgra");
+        WirePixels::Format f = WirePixels::BGRA32;
+        if (!WirePixels::Parse(wire.c_str(), f) || f == WirePixels::A8)
+            f = WirePixels::BGRA32;   // A8 only per frame, through WireMono
+        cfg.wireFormat = f;
     }
+    cfg.wireMono             = FuserUtil::ReadIniInt(iniPath, "Fuser", "WireMono", 0) != 0;
+    cfg.captureMaxFps        = static_cast<uint32_t>(FuserUtil::ReadIniInt(iniPath, "Fuser", "MaxFps",               0));
+    cfg.skipUnchanged        = FuserUtil::ReadIniInt(iniPath, "Fuser", "SkipUnchanged", 1) != 0;
+    cfg.keepaliveMs          = static_cast<uint32_t>(FuserUtil::ReadIniInt(iniPath, "Fuser", "KeepaliveMs",          1000));
+    cfg.frameBands           = static_cast<uint32_t>(
+        std::clamp(FuserUtil::ReadIniInt(iniPath, "Fuser", "FrameBands", 1), 1, static_cast<int>(MAX_BANDS)));
+    cfg.deltaCodec           = FuserUtil::ReadIniInt(iniPath, "Fuser", "DeltaCodec", 0) != 0;
+    cfg.keyframeInterval     = static_cast<uint32_t>(
+        std::max(0, FuserUtil::ReadIniInt(iniPath, "Fuser", "KeyframeInterval", 120)));
+    cfg.tileCache            = FuserUtil::ReadIniInt(iniPath, "Fuser", "TileCache", 0) != 0;
+    cfg.tileCacheEntries     = static_cast<uint32_t>(std::clamp(
+        FuserUtil::ReadIniInt(iniPath, "Fuser", "TileCacheEntries", 4096), 1, static_cast<int>(TILE_CACHE_MAX_ENTRIES)));
+
+    cfg.recordTracePath    = FuserUtil::ReadIniString(iniPath, "Fuser", "RecordTrace", "");
+    cfg.traceMaxMB         = static_cast<uint32_t>(
+        FuserUtil::ReadIniInt(iniPath, "Fuser", "TraceMaxMB", static_cast<int>(cfg.traceMaxMB)));
+    cfg.replayTracePath    = FuserUtil::ReadIniString(iniPath, "Fuser", "ReplayTrace", "");
+    cfg.replayRealtime     = FuserUtil::ReadIniInt(iniPath, "Fuser", "ReplayRealtime", 1) != 0;
 
-    void Log(const char* fmt, ...)
+    cfg.clockSyncIntervalMs  = static_cast<uint32_t>(
+        FuserUtil::ReadIniInt(iniPath, "Fuser", "ClockSyncIntervalMs",
+                              static_cast<int>(cfg.clockSyncIntervalMs)));
+    cfg.statsPort            = static_cast<uint16_t>(
+        FuserUtil::ReadIniInt(iniPath, "Fuser", "StatsPort", 0));
+    if (cfg.statsPort == 0)
+        cfg.statsPort = static_cast<uint16_t>(cfg.port + 100);
+    cfg.statsIntervalMs      = static_cast<uint32_t>(
+        FuserUtil::ReadIniInt(iniPath, "Fuser", "StatsIntervalMs",
+                              static_cast<int>(cfg.statsIntervalMs)));
+    cfg.statsLogIntervalMs   = static_cast<uint32_t>(
+        FuserUtil::ReadIniInt(iniPath, "Fuser", "StatsLogIntervalMs",
+                              static_cast<int>(cfg.statsLogIntervalMs)));
+    cfg.statsShmName         = FuserUtil::ReadIniString(iniPath, "Fuser", "StatsShmName",
+                                                        cfg.statsShmName);
+    cfg.latencyLogIntervalMs = static_cast<uint32_t>(
+        FuserUtil::ReadIniInt(iniPath, "Fuser", "LatencyLogIntervalMs",
+                              static_cast<int>(cfg.latencyLogIntervalMs)));
+    cfg.eventTracePath       = FuserUtil::ReadIniString(iniPath, "Fuser", "EventTrace", "");
+    cfg.eventTraceMaxMB      = static_cast<uint32_t>(
+        FuserUtil::ReadIniInt(iniPath, "Fuser", "EventTraceMaxMB",
+                              static_cast<int>(cfg.eventTraceMaxMB)));
+    cfg.asyncLog             = FuserUtil::ReadIniInt(iniPath, "Fuser", "AsyncLog", 1) != 0;
+
+    // Impairment percentages may be fractional ("0.5")
+    auto readPercent = [&](const char* key, double def)
     {
-        va_list args;
-        va_start(args, fmt);
-        // Route through Logger so every existing call goes to the log file
-        Logger::WriteV(LogLevel::Info, fmt, args);
-        va_end(args);
-    }
+        const std::string v = FuserUtil::ReadIniString(iniPath, "Fuser", key, "");
+        return v.empty() ? def : std::clamp(std::atof(v.c_str()), 0.0, 100.0);
+    };
+    auto readU32 = [&](const char* key, uint32_t def)
+    {
+        return static_cast<uint32_t>(FuserUtil::ReadIniInt(iniPath, "Fuser", key, static_cast<int>(def)));
+    };
+    cfg.impairLossPercent       = readPercent("ImpairLossPercent",       cfg.impairLossPercent);
+    cfg.impairBurstEnterPercent = readPercent("ImpairBurstEnterPercent", cfg.impairBurstEnterPercent);
+    cfg.impairBurstExitPercent  = readPercent("ImpairBurstExitPercent",  cfg.impairBurstExitPercent);
+    cfg.impairBurstLossPercent  = readPercent("ImpairBurstLossPercent",  cfg.impairBurstLossPercent);
+    cfg.impairRateMbps          = readU32("ImpairRateMbps",  cfg.impairRateMbps);
+    cfg.impairQueueKB           = readU32("ImpairQueueKB",   cfg.impairQueueKB);
+    cfg.impairDelayUs           = readU32("ImpairDelayUs",   cfg.impairDelayUs);
+    cfg.impairJitterUs          = readU32("ImpairJitterUs",  cfg.impairJitterUs);
+    cfg.impairReorderPercent    = readPercent("ImpairReorderPercent",    cfg.impairReorderPercent);
+    cfg.impairReorderUs         = readU32("ImpairReorderUs", cfg.impairReorderUs);
+    cfg.impairDuplicatePercent  = readPercent("ImpairDuplicatePercent",  cfg.impairDuplicatePercent);
+    cfg.impairSeed              = readU32("ImpairSeed",      cfg.impairSeed);
 
-    void ElevateProcessPriority()
+    // Every port a stream uses must fit below 65536 and stay off the
+    // stats port, or reports would land on some other socket
+    const uint32_t feedbackPort = static_cast<uint32_t>(cfg.port) + 1 + MAX_STRIPES + cfg.streamID;
+    if (feedbackPort > 0xFFFF)
     {
-        if (!SetPriorityClass(GetCurrentProcess(), REALTIME_PRIORITY_CLASS))
-            FuserUtil::Log("[Main] SetPriorityClass REALTIME failed: %u\n", GetLastError());
-        if (!SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL))
-            FuserUtil::Log("[Main] SetThreadPriority TIME_CRITICAL failed: %u\n", GetLastError());
+        Logger::Fatal("[Main] Port %u too high for StreamId %u (feedback port %u)",
+                      cfg.port, cfg.streamID, feedbackPort);
+        return false;
     }
-
-    void PinThreadToCore(DWORD coreIndex)
+    for (uint32_t k = 0; k < cfg.stripes; ++k)
+        if (FuserUtil::StripePort(cfg.port, k) == cfg.statsPort)
+        {
+            Logger::Fatal("[Main] StatsPort %u collides with stripe %u's port", cfg.statsPort, k);
+            return false;
+        }
+    if (FuserUtil::FeedbackPort(cfg.port, cfg.streamID) == cfg.statsPort)
     {
-        DWORD_PTR mask = static_cast<DWORD_PTR>(1) << coreIndex;
-        SetThreadAffinityMask(GetCurrentThread(), mask);
+        Logger::Fatal("[Main] StatsPort %u collides with StreamId %u's feedback port",
+                      cfg.statsPort, cfg.streamID);
+        return false;
     }
+    return true;
 }
 
+// ─────────────────────────────────────────────────────────────
+//  Binary event trace (cfg.eventTracePath, both roles)
+// ─────────────────────────────────────────────────────────────
+static void StartEventTrace(const FuserConfig& cfg, TraceRole role)
+{
+    if (cfg.eventTracePath.empty()) return;
+    const uint64_t maxBytes = static_cast<uint64_t>(cfg.eventTraceMaxMB) << 20;
+    if (EventTrace::Start(cfg.eventTracePath, maxBytes, role))
+        FuserUtil::Log("[Main] Event trace -> '%s' (%llu events max)\n", cfg.eventTracePath.c_str(),
+                       static_cast<unsigned long long>(maxBytes / sizeof(EventRecord)));
+    else
+        FuserUtil::Log("[Main] Could not create event trace '%s' – tracing disabled\n",
+                       cfg.eventTracePath.c_str());
+}
 
 // ─────────────────────────────────────────────────────────────
 //  Config loader
@@ -79,6 +203,7 @@ static FuserConfig LoadConfig(const std::string& iniPath)
                                                   static_cast<int>(FUSER_PORT)));
     cfg.adapterIndex  = FuserUtil::ReadIniInt(iniPath, "Fuser", "AdapterIndex", -1);
     cfg.captureMonitor= FuserUtil::ReadIniInt(iniPath, "Fuser", "CaptureMonitor", 0);
+    LoadTuning(iniPath, cfg);
 
     return cfg;
 }
@@ -102,8 +227,11 @@ static void WriteDefaultIni(const std::string& iniPath)
         "RemoteIP       = 192.168.50.2\n"
         "Port           = %u\n"
         "AdapterIndex   = -1\n"
-        "CaptureMonitor = 0\n",
-        static_cast<unsigned>(FUSER_PORT));
+        "CaptureMonitor = 0\n"
+        "ReassemblyMinTimeoutUs = %u\n"
+        "ReassemblyMaxTimeoutUs = %u\n",
+        static_cast<unsigned>(FUSER_PORT),
+        REASM_MIN_TIMEOUT_US, REASM_MAX_TIMEOUT_US);
     fclose(f);
 
     FuserUtil::Log("[Main] Wrote default config.ini\n");
@@ -114,13 +242,17 @@ static void WriteDefaultIni(const std::string& iniPath)
 // ─────────────────────────────────────────────────────────────
 int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int)
 {
-    // ── Initialise Logger first – catches crashes from this point on ──
+    std::string exeDir;
     {
         char exePathBuf[MAX_PATH]{};
         GetModuleFileNameA(nullptr, exePathBuf, MAX_PATH);
-        std::string exeDir(exePathBuf);
+        exeDir = exePathBuf;
         auto sl = exeDir.find_last_of("\\/");
         if (sl != std::string::npos) exeDir = exeDir.substr(0, sl + 1);
+    }
+
+    // ── Initialise Logger first – catches crashes from this point on ──
+    {
         std::string logDir = exeDir + "Logs";
         Logger::Init(logDir);
         Logger::Info("[Main] Knox Fuser starting. Log dir: %s", logDir.c_str());
@@ -146,6 +278,13 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int)
         WSACleanup();
         return 0;
     }
+    if (!LoadTuning(exeDir + "config.ini", cfg))
+    {
+        MessageBoxW(nullptr, L"Invalid port / StreamId settings in config.ini – see the log.",
+                    L"Knox Fuser", MB_ICONERROR);
+        WSACleanup();
+        return 1;
+    }
 
     // ── Allocate a debug console (after the UI closes) ───────
     AllocConsole();
@@ -153,13 +292,62 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int)
     freopen_s(&dummy, "CONOUT$", "w", stdout);
     freopen_s(&dummy, "CONOUT$", "w", stderr);
 
+    // Writer thread prints to stdout too – start it once that is final
+    if (cfg.asyncLog)
+        Logger::StartAsync();
+
     Logger::Info("[Main] --- Configuration ---");
     Logger::Info("[Main] Mode     : %s", cfg.isSender ? "SENDER" : "RECEIVER");
     Logger::Info("[Main] LocalIP  : %s", cfg.localIP.c_str());
     Logger::Info("[Main] RemoteIP : %s", cfg.remoteIP.c_str());
     Logger::Info("[Main] Port     : %u", cfg.port);
+    if (cfg.stripes > 1)
+        Logger::Info("[Main] Stripes  : %u (ports %u, %u..%u)", cfg.stripes, cfg.port,
+                     FuserUtil::StripePort(cfg.port, 1), FuserUtil::StripePort(cfg.port, cfg.stripes - 1));
+    if (cfg.isSender)
+        Logger::Info("[Main] Packet   : %u bytes", cfg.packetBytes);
+    if (cfg.isSender && cfg.streamID != 0)
+        Logger::Info("[Main] StreamId : %u", cfg.streamID);
+    if (!cfg.multicastGroup.empty())
+        Logger::Info("[Main] Multicast: %s (TTL %u, loopback %s)", cfg.multicastGroup.c_str(),
+                     cfg.multicastTtl, cfg.multicastLoop ? "on" : "off");
     Logger::Info("[Main] Monitor  : %d", cfg.captureMonitor);
-    Logger::Info("[Main] Log file : %s", Logger::GetLogPath().c_str());
+    Logger::Info("[Main] Reasm    : %u..%u us deadline", cfg.reasmMinTimeoutUs, cfg.reasmMaxTimeoutUs);
+    if (cfg.isSender)
+        Logger::Info("[Main] Capture  : %s", cfg.captureSource.c_str());
+    if (cfg.isSender && cfg.downscale != 1)
+        Logger::Info(cfg.downscale ? "[Main] Scale    : 1/%u" : "[Main] Scale    : auto (on receiver loss)",
+                     cfg.downscale);
+    if (cfg.isSender && cfg.captureMaxFps)
+        Logger::Info("[Main] MaxFps   : %u", cfg.captureMaxFps);
+    if (cfg.isSender)
+        Logger::Info(cfg.skipUnchanged ? "[Main] Unchanged: skipped, keepalive every %u ms" : "[Main] Unchanged: resent",
+                     cfg.keepaliveMs);
+    if (cfg.isSender && cfg.frameBands > 1)
+        Logger::Info("[Main] Bands    : %u per capture", cfg.frameBands);
+    if (cfg.isSender && cfg.deltaCodec)
+        Logger::Info(cfg.keyframeInterval ? "[Main] Delta    : on, keyframe every %u frames"
+                                          : "[Main] Delta    : on, keyframes on request / keepalive only",
+                     cfg.keyframeInterval);
+    if (cfg.isSender && cfg.tileCache)
+        Logger::Info("[Main] Tiles    : %ux%u, cache of %u (%u KB at BGRA)", TILE_SIZE, TILE_SIZE,
+                     cfg.tileCacheEntries, cfg.tileCacheEntries * TILE_MAX_BYTES / 1024);
+    if (cfg.isSender && (cfg.wireFormat != WirePixels::BGRA32 || cfg.wireMono))
+        Logger::Info("[Main] Wire     : %s%s (%u bytes/pixel)", WirePixels::Name(cfg.wireFormat),
+                     cfg.wireMono ? ", a8 when one colour" : "", WirePixels::BytesPerPixel(cfg.wireFormat));
+    if (!cfg.isSender && cfg.headless)
+        Logger::Info("[Main] Headless : ring '%s' (%u x %u MB)", cfg.frameRingName.c_str(),
+                     cfg.frameRingSlots, cfg.frameRingSlotBytes >> 20);
+    if (!cfg.isSender && !cfg.replayTracePath.empty())
+        Logger::Info("[Main] Replay   : %s", cfg.replayTracePath.c_str());
+    else if (!cfg.isSender && !cfg.recordTracePath.empty())
+        Logger::Info("[Main] Record   : %s", cfg.recordTracePath.c_str());
+    if (cfg.statsIntervalMs > 0)
+        Logger::Info("[Main] Stats    : udp://127.0.0.1:%u, shm '%s'", cfg.statsPort, cfg.statsShmName.c_str());
+    if (!cfg.eventTracePath.empty())
+        Logger::Info("[Main] Events   : %s (max %u MB)", cfg.eventTracePath.c_str(), cfg.eventTraceMaxMB);
+    Logger::Info("[Main] Log file : %s (%s)", Logger::GetLogPath().c_str(),
+                 cfg.asyncLog ? "async" : "sync");
 
     // ── Branch: Sender ───────────────────────────────────────
     if (cfg.isSender)
@@ -174,6 +362,10 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int)
             return 1;
         }
 
+        MetricsExporter stats;
+        stats.Start(cfg, nullptr);
+        StartEventTrace(cfg, TraceRole::Sender);
+
         // Run on a dedicated high-priority thread
         std::thread senderThread([&sender]
         {
@@ -207,9 +399,16 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int)
             return 1;
         }
 
+        MetricsExporter stats;
+        stats.Start(cfg, &receiver.Latency());
+        StartEventTrace(cfg, TraceRole::Receiver);
+
         receiver.Run();   // blocking – exits when overlay window is destroyed
     }
 
+    // Every emitting thread has been joined by now
+    EventTrace::Stop();
+
     WSACleanup();
     Logger::Info("[Main] Exiting cleanly.");
     Logger::Shutdown();
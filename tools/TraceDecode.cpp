@@ -0,0 +1,245 @@
+// ============================================================
+//  TraceDecode.cpp  –  Offline decoder for EventTrace files
+//  Zero-Latency Network Video Fuser
+//
+//  TraceDecode [--text | --chrome] [-o out] trace.kfev [more.kfev ...]
+//
+//  Several traces (typically one from the sender and one from the
+//  receiver) are merged on one timeline. Sender timestamps are
+//  moved onto the receiver's clock with the offset the receiver
+//  stored in its trace header; without one they stay as recorded.
+//
+//    --text    one line per event, time-ordered (default)
+//    --chrome  Chrome trace JSON (chrome://tracing, ui.perfetto.dev):
+//              crop / send / reassemble / render slices per thread,
+//              a flow arrow per frame from send to render, and
+//              instants for capture, empty, timeout and eviction.
+//
+//  Build: TraceDecode.vcxproj, or
+//    g++ -std=c++17 -O2 -I.. TraceDecode.cpp ../EventTrace.cpp ../MappedFile.cpp
+// ============================================================
+
+#include "../EventTrace.h"
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+    struct Event
+    {
+        int64_t     timeNs;     // on the merged timeline
+        uint32_t    pid;        // TraceRole (Unknown → file index + 10)
+        EventRecord rec;
+    };
+
+    const char* RoleName(uint32_t pid)
+    {
+        switch (static_cast<TraceRole>(pid))
+        {
+        case TraceRole::Sender:   return "Sender";
+        case TraceRole::Receiver: return "Receiver";
+        default:                  return "Trace";
+        }
+    }
+
+    // Slice kinds built from begin/end pairs on one thread
+    struct SliceDef
+    {
+        TraceEvent  begin;
+        TraceEvent  end;
+        const char* name;
+    };
+
+    constexpr SliceDef SLICES[] = {
+        { TraceEvent::FrameCaptured, TraceEvent::FrameCropped,  "crop"       },
+        { TraceEvent::SendBegin,     TraceEvent::SendEnd,       "send"       },
+        { TraceEvent::FirstPacket,   TraceEvent::FrameComplete, "reassemble" },
+        { TraceEvent::RenderBegin,   TraceEvent::RenderEnd,     "render"     },
+    };
+
+    void Usage()
+    {
+        fprintf(stderr,
+                "usage: TraceDecode [--text | --chrome] [-o out] trace.kfev [more.kfev ...]\n");
+    }
+
+    void WriteText(FILE* out, const std::vector<Event>& events, int64_t t0)
+    {
+        for (const Event& e : events)
+        {
+            const TraceEvent ev = static_cast<TraceEvent>(e.rec.event);
+            fprintf(out, "%14.3f us  %-8s t%-3u %-14s frame=%u",
+                    (e.timeNs - t0) / 1000.0, RoleName(e.pid), e.rec.thread,
+                    EventTrace::Name(ev), e.rec.frameID);
+            for (int i = 0; i < 4; ++i)
+                if (const char* a = EventTrace::ArgName(ev, i))
+                    fprintf(out, " %s=%u", a, e.rec.args[i]);
+            fputc('\n', out);
+        }
+    }
+
+    void WriteChrome(FILE* out, const std::vector<Event>& events, int64_t t0)
+    {
+        fprintf(out, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+        bool first = true;
+        auto sep = [&]() { if (!first) fputs(",\n", out); first = false; };
+
+        // Process names
+        std::vector<uint32_t> pids;
+        for (const Event& e : events)
+            if (std::find(pids.begin(), pids.end(), e.pid) == pids.end())
+                pids.push_back(e.pid);
+        for (uint32_t pid : pids)
+        {
+            sep();
+            fprintf(out, "{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":%u,\"tid\":0,"
+                         "\"args\":{\"name\":\"%s\"}}", pid, RoleName(pid));
+        }
+
+        auto us = [t0](int64_t ns) { return (ns - t0) / 1000.0; };
+
+        // Open begin events: (pid, thread, slice, frame) → index into events
+        std::unordered_map<uint64_t, size_t> open;
+        auto key = [](const Event& e, size_t slice) {
+            return (static_cast<uint64_t>(e.pid)       << 56) |
+                   (static_cast<uint64_t>(e.rec.thread) << 40) |
+                   (static_cast<uint64_t>(slice)        << 32) | e.rec.frameID;
+        };
+
+        for (size_t i = 0; i < events.size(); ++i)
+        {
+            const Event&     e  = events[i];
+            const TraceEvent ev = static_cast<TraceEvent>(e.rec.event);
+
+            bool handled = false;
+            for (size_t s = 0; s < sizeof(SLICES) / sizeof(SLICES[0]); ++s)
+            {
+                if (ev == SLICES[s].begin)
+                {
+                    open[key(e, s)] = i;
+                    handled = (ev != TraceEvent::FrameCaptured);   // capture also shows as an instant
+                }
+                else if (ev == SLICES[s].end)
+                {
+                    auto it = open.find(key(e, s));
+                    if (it == open.end()) continue;
+                    const Event& b = events[it->second];
+                    open.erase(it);
+
+                    sep();
+                    fprintf(out, "{\"ph\":\"X\",\"name\":\"%s\",\"cat\":\"frame\",\"pid\":%u,\"tid\":%u,"
+                                 "\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"frame\":%u",
+                            SLICES[s].name, e.pid, e.rec.thread, us(b.timeNs),
+                            (e.timeNs - b.timeNs) / 1000.0, e.rec.frameID);
+                    for (int a = 0; a < 4; ++a)
+                        if (const char* n = EventTrace::ArgName(ev, a))
+                            fprintf(out, ",\"%s\":%u", n, e.rec.args[a]);
+                    fputs("}}", out);
+
+                    // One flow per frame: send → reassemble → render
+                    const char* flow = nullptr;
+                    if      (ev == TraceEvent::SendEnd)       flow = "s";
+                    else if (ev == TraceEvent::FrameComplete) flow = "t";
+                    else if (ev == TraceEvent::RenderEnd)     flow = "f";
+                    if (flow)
+                    {
+                        sep();
+                        fprintf(out, "{\"ph\":\"%s\",\"name\":\"frame\",\"cat\":\"frame\",\"id\":%u,"
+                                     "\"pid\":%u,\"tid\":%u,\"ts\":%.3f%s}",
+                                flow, e.rec.frameID, e.pid, e.rec.thread, us(b.timeNs),
+                                flow[0] == 'f' ? ",\"bp\":\"e\"" : "");
+                    }
+                    handled = true;
+                }
+            }
+            if (handled) continue;
+
+            sep();
+            fprintf(out, "{\"ph\":\"i\",\"s\":\"t\",\"name\":\"%s\",\"cat\":\"event\",\"pid\":%u,\"tid\":%u,"
+                         "\"ts\":%.3f,\"args\":{\"frame\":%u",
+                    EventTrace::Name(ev), e.pid, e.rec.thread, us(e.timeNs), e.rec.frameID);
+            for (int a = 0; a < 4; ++a)
+                if (const char* n = EventTrace::ArgName(ev, a))
+                    fprintf(out, ",\"%s\":%u", n, e.rec.args[a]);
+            fputs("}}", out);
+        }
+        fputs("\n]}\n", out);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    bool                     chrome  = false;
+    const char*              outPath = nullptr;
+    std::vector<std::string> inputs;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if      (!std::strcmp(argv[i], "--text"))    chrome = false;
+        else if (!std::strcmp(argv[i], "--chrome"))  chrome = true;
+        else if (!std::strcmp(argv[i], "-o") && i + 1 < argc) outPath = argv[++i];
+        else if (argv[i][0] == '-') { Usage(); return 2; }
+        else inputs.emplace_back(argv[i]);
+    }
+    if (inputs.empty()) { Usage(); return 2; }
+
+    std::vector<EventTraceReader> readers(inputs.size());
+    int64_t offsetUs  = 0;
+    bool    hasOffset = false;
+    for (size_t f = 0; f < inputs.size(); ++f)
+    {
+        if (!readers[f].Open(inputs[f]))
+        {
+            fprintf(stderr, "TraceDecode: '%s' is not a readable event trace\n", inputs[f].c_str());
+            return 1;
+        }
+        const EventTraceHeader& h = readers[f].Header();
+        if (h.role == static_cast<uint32_t>(TraceRole::Receiver) && h.hasClockOffset)
+        {
+            offsetUs  = h.clockOffsetUs;
+            hasOffset = true;
+        }
+        if (h.droppedCount)
+            fprintf(stderr, "TraceDecode: '%s': %" PRIu64 " events were dropped (file full)\n",
+                    inputs[f].c_str(), h.droppedCount);
+    }
+    if (!hasOffset && inputs.size() > 1)
+        fprintf(stderr, "TraceDecode: no receiver clock offset – sender times are uncorrected\n");
+
+    std::vector<Event> events;
+    for (size_t f = 0; f < readers.size(); ++f)
+    {
+        const EventTraceHeader& h = readers[f].Header();
+        const uint32_t pid   = h.role ? h.role : static_cast<uint32_t>(f + 10);
+        const int64_t  shift = (h.role == static_cast<uint32_t>(TraceRole::Sender)) ? offsetUs * 1000 : 0;
+        for (uint64_t i = 0; i < readers[f].Count(); ++i)
+        {
+            const EventRecord& r = readers[f][i];
+            if (r.event == 0 || r.event >= static_cast<uint16_t>(TraceEvent::Count))
+                continue;
+            events.push_back({ static_cast<int64_t>(r.timeNs) + shift, pid, r });
+        }
+    }
+    std::stable_sort(events.begin(), events.end(),
+                     [](const Event& a, const Event& b) { return a.timeNs < b.timeNs; });
+    const int64_t t0 = events.empty() ? 0 : events.front().timeNs;
+
+    FILE* out = stdout;
+    if (outPath && !(out = std::fopen(outPath, "w")))
+    {
+        fprintf(stderr, "TraceDecode: cannot write '%s'\n", outPath);
+        return 1;
+    }
+
+    if (chrome) WriteChrome(out, events, t0);
+    else        WriteText(out, events, t0);
+
+    if (out != stdout) std::fclose(out);
+    fprintf(stderr, "TraceDecode: %zu events from %zu file(s)\n", events.size(), inputs.size());
+    return 0;
+}